@@ -37,16 +37,18 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 // Written by: Stevan Gavrilovic, Frank McKenna
 
 #include "CSVReaderWriter.h"
+#include "GMPEEngine.h"
 #include "GMPEWidget.h"
 #include "GMWidget.h"
 #include "GmAppConfig.h"
 #include "GmAppConfigWidget.h"
 #include "GmCommon.h"
-#include "GridNode.h"
 #include "IntensityMeasureWidget.h"
 #include "Utils/ProgramOutputDialog.h"
 #include "MapViewSubWidget.h"
 #include "NGAW2Converter.h"
+#include "NGAW2RecordCache.h"
+#include "PointSourceRupture.h"
 #include "RecordSelectionWidget.h"
 #include "RuptureWidget.h"
 #include "SimCenterPreferences.h"
@@ -55,6 +57,8 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "SiteScatterWidget.h"
 #include "SiteWidget.h"
 #include "SpatialCorrelationWidget.h"
+#include "StationLayerBuilder.h"
+#include "TaskRunner.h"
 #include "VisualizationWidget.h"
 #include "Vs30Widget.h"
 #include "WorkflowAppR2D.h"
@@ -70,6 +74,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #endif
 
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QFileInfo>
 #include <QList>
@@ -83,6 +88,8 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QTabWidget>
 #include <QScrollArea>
 
+#include <cmath>
+
 // GIS includes
 #include "SimCenterMapcanvasWidget.h"
 #include "QGISVisualizationWidget.h"
@@ -124,6 +131,7 @@ GMWidget::GMWidget(VisualizationWidget* visWidget, QWidget *parent) : SimCenterA
     this->m_selectionWidget = new RecordSelectionWidget(*this->m_selectionconfig);
 
     m_runButton = new QPushButton(tr("&Run Hazard Simulation"));
+    m_previewButton = new QPushButton(tr("&Preview Median Field"));
     //m_settingButton = new QPushButton(tr("&Path Settings"));
 
     // Adding vs30 widget
@@ -132,6 +140,7 @@ GMWidget::GMWidget(VisualizationWidget* visWidget, QWidget *parent) : SimCenterA
 
     auto buttonsLayout = new QHBoxLayout();
     //buttonsLayout->addWidget(this->m_settingButton);
+    buttonsLayout->addWidget(this->m_previewButton);
     buttonsLayout->addWidget(this->m_runButton);
 
 
@@ -306,6 +315,8 @@ void GMWidget::setupConnections()
         this->statusMessage(statusUpdate);
     });
 
+    connect(m_previewButton, &QPushButton::clicked, this, &GMWidget::runHazardPreview);
+
     //connect(m_settingButton, &QPushButton::clicked, this, &GMWidget::setAppConfig);
 
     // connect output director path change to EventGMDirWidget
@@ -315,10 +326,12 @@ void GMWidget::setupConnections()
     connect(m_siteConfigWidget->getSiteGridWidget(), &SiteGridWidget::selectGridOnMap, this, &GMWidget::showGISWindow);
 
 
+    // The main client is the first of the clients that download the record batches
+    downloadClients.push_back(&peerClient);
+
     connect(&peerClient, &PeerNgaWest2Client::recordsDownloaded, this, [this](QString zipFile)
     {
-        this->parseDownloadedRecords(zipFile);
-        this->getProgressDialog()->hideProgressBar();
+        this->handleRecordsDownloaded(&peerClient, zipFile);
     });
 
     // connect use event and ground motion dir to Hazard widget to switch
@@ -832,23 +845,20 @@ void GMWidget::runHazardSimulation(void)
             return;
         }
 
+        // Flat buffer of latitude, longitude pairs
         auto gridNodeVec = userGrid->getGridNodeVec();
-        auto mapCanvas = mapViewSubWidget->getMapCanvasWidget()->mapCanvas();
+        auto numNodes = gridNodeVec.size()/2;
 
-        for(int i = 0; i<gridNodeVec.size(); ++i)
+        for(int i = 0; i<numNodes; ++i)
         {
-            auto gridNode = gridNodeVec.at(i);
-
             QStringList stationRow;
 
             // The station id
             stationRow.push_back(QString::number(i));
 
-            auto screenPoint = gridNode->getPoint();
-
             // The latitude and longitude
-            auto longitude = theVisualizationWidget->getLongFromScreenPoint(screenPoint,mapCanvas);
-            auto latitude = theVisualizationWidget->getLatFromScreenPoint(screenPoint,mapCanvas);
+            auto latitude = gridNodeVec.at(2*i);
+            auto longitude = gridNodeVec.at(2*i+1);
 
             stationRow.push_back(QString::number(latitude));
             stationRow.push_back(QString::number(longitude));
@@ -951,6 +961,210 @@ void GMWidget::runHazardSimulation(void)
 }
 
 
+void GMWidget::runHazardPreview(void)
+{
+    // The preview is only available for a point source, the other rupture types need the backend to sample the ruptures
+    if(m_ruptureWidget->getWidgetType().compare("OpenSHA Point") != 0)
+    {
+        QString msg = "The median field preview is only available for a point source rupture";
+        this->infoMessage(msg);
+        return;
+    }
+
+    GMPEEngine engine;
+
+    QString err;
+    if(!engine.setModel(m_gmpe->type(), GMPEEngine::getDefaultDataDirectory(), err))
+    {
+        this->errorMessage(err);
+        return;
+    }
+
+    // The periods of the intensity measures, PGA has a period of zero
+    QVector<double> periods;
+    QStringList imNames;
+    if(m_intensityMeasure->type().compare("Spectral Accelerations (SA)") == 0)
+    {
+        for(auto&& period : m_intensityMeasure->periods())
+        {
+            periods.push_back(period);
+            imNames.push_back("SA("+QString::number(period)+")");
+        }
+    }
+    else
+    {
+        periods.push_back(0.0);
+        imNames.push_back("PGA");
+    }
+
+    if(periods.isEmpty())
+    {
+        QString msg = "Please specify at least one period before continuing";
+        this->statusMessage(msg);
+        return;
+    }
+
+    // Get the sites, the Vs30 is taken from the site file if it is given, otherwise a reference rock site is used
+    // The Vs30 models in m_vs30 are maps that are only available in the backend, so they cannot be queried for the preview
+    const double defaultVs30 = 760.0;
+    int numDefaultVs30 = 0;
+
+    GMSiteArrays sites;
+
+    auto type = m_siteConfig->getType();
+
+    if(type == SiteConfig::SiteType::Single)
+    {
+        sites.resize(1);
+        sites.latitude[0] = m_siteConfig->site().location().latitude();
+        sites.longitude[0] = m_siteConfig->site().location().longitude();
+        sites.vs30[0] = defaultVs30;
+        numDefaultVs30 = 1;
+    }
+    else if(type == SiteConfig::SiteType::Grid)
+    {
+        if(!m_siteConfigWidget->getSiteGridWidget()->getGridCreated() || userGrid == nullptr)
+        {
+            QString msg = "Please select a grid before continuing";
+            this->statusMessage(msg);
+            return;
+        }
+
+        // Flat buffer of latitude, longitude pairs
+        auto gridNodeVec = userGrid->getGridNodeVec();
+        auto numNodes = gridNodeVec.size()/2;
+
+        sites.resize(numNodes);
+        for(int i = 0; i<numNodes; ++i)
+        {
+            sites.latitude[i] = gridNodeVec.at(2*i);
+            sites.longitude[i] = gridNodeVec.at(2*i+1);
+            sites.vs30[i] = defaultVs30;
+        }
+
+        numDefaultVs30 = numNodes;
+    }
+    else if(type == SiteConfig::SiteType::Scatter)
+    {
+        const auto& siteList = m_siteConfig->siteScatter().getSiteList();
+
+        sites.resize(siteList.size());
+        for(int i = 0; i<siteList.size(); ++i)
+        {
+            const auto& site = siteList.at(i);
+
+            sites.latitude[i] = site.Latitude;
+            sites.longitude[i] = site.Longitude;
+
+            // A missing Vs30 is NaN and falls back to the default
+            if(site.Vs30 > 0.0)
+            {
+                sites.vs30[i] = site.Vs30;
+            }
+            else
+            {
+                sites.vs30[i] = defaultVs30;
+                ++numDefaultVs30;
+            }
+        }
+    }
+
+    if(sites.size() == 0)
+    {
+        QString msg = "No sites are available for the median field preview";
+        this->statusMessage(msg);
+        return;
+    }
+
+    auto pointSource = m_ruptureWidget->getPointSourceRupture();
+
+    GMRupture rupture;
+    rupture.magnitude = pointSource->magnitude();
+    rupture.latitude = pointSource->location().latitude();
+    rupture.longitude = pointSource->location().longitude();
+    rupture.hypoDepth = pointSource->location().depth();
+    rupture.rake = pointSource->averageRake();
+    rupture.dip = pointSource->averageDip();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    GMField field;
+    if(!engine.computeField(rupture, sites, periods, field, err))
+    {
+        this->errorMessage(err);
+        return;
+    }
+
+    // Sample one realization with the selected correlation models, the models that are not implemented in the application are only available in the backend
+    auto corrObj = spatialCorrWidget->getJsonCorr();
+    auto interEventModel = corrObj.value("SaInterEvent").toString();
+    auto intraEventModel = corrObj.value("SaIntraEvent").toString();
+
+    QVector<double> lnSamples;
+    QString sampleErr;
+    const bool hasSamples = engine.sampleField(field, sites, interEventModel, intraEventModel, 1, 1, lnSamples, sampleErr);
+
+    auto elapsed = timer.elapsed();
+
+    this->statusMessage("Computed the median field for "+QString::number(sites.size())+" sites and "+QString::number(periods.size())+" intensity measures in "+QString::number(elapsed)+" ms");
+
+    if(!hasSamples)
+        this->infoMessage("A realization of the field is not included in the preview. "+sampleErr);
+
+    if(numDefaultVs30 > 0)
+        this->infoMessage("The "+m_vs30->type()+" Vs30 model is only applied in the hazard simulation, a Vs30 of "+QString::number(defaultVs30)+" m/s is used for the "+QString::number(numDefaultVs30)+" sites of the preview without a Vs30 value");
+
+    auto qgisVizWidget = static_cast<QGISVisualizationWidget*>(theVisualizationWidget);
+
+    if(qgisVizWidget == nullptr)
+    {
+        qDebug()<<"Failed to cast to QGISVisualizationWidget";
+        return;
+    }
+
+    const auto numSites = sites.size();
+    const auto numIMs = periods.size();
+
+    // Create the columns of the layer
+    StationLayerBuilder layerBuilder("GroundMotionGridPoint", "Median Field Preview");
+    layerBuilder.setLocations(sites.latitude, sites.longitude);
+    layerBuilder.addNumberColumn("Latitude", sites.latitude);
+    layerBuilder.addNumberColumn("Longitude", sites.longitude);
+    layerBuilder.addNumberColumn("Vs30", sites.vs30);
+
+    for(int j = 0; j<numIMs; ++j)
+    {
+        QVector<double> medians(numSites);
+        QVector<double> sigmas(numSites);
+
+        for(int i = 0; i<numSites; ++i)
+        {
+            medians[i] = std::exp(field.lnMedian.at(field.index(i,j)));
+            sigmas[i] = field.getTotalSigma(i,j);
+        }
+
+        layerBuilder.addNumberColumn("Median "+imNames.at(j), medians);
+        layerBuilder.addNumberColumn("Sigma "+imNames.at(j), sigmas);
+
+        if(hasSamples)
+        {
+            QVector<double> samples(numSites);
+            for(int i = 0; i<numSites; ++i)
+                samples[i] = std::exp(lnSamples.at(field.index(i,j)));
+
+            layerBuilder.addNumberColumn("Realization "+imNames.at(j), samples);
+        }
+    }
+
+    QString errMsg;
+    auto vectorLayer = layerBuilder.createLayer(qgisVizWidget, "Median Field Preview", errMsg);
+
+    if(vectorLayer == nullptr)
+        this->errorMessage(errMsg);
+}
+
+
 void GMWidget::handleProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
 {
     this->m_runButton->setEnabled(true);
@@ -1001,6 +1215,8 @@ void GMWidget::handleProcessFinished(int exitCode, QProcess::ExitStatus exitStat
 
     numDownloaded = 0;
     downloadComplete = false;
+    downloadFailed = false;
+    busyDownloadClients.clear();
     recordsListToDownload.clear();
     NGA2Results = QJsonObject();
 
@@ -1058,7 +1274,10 @@ int GMWidget::downloadRecords(void)
             QByteArray line = theRecordsListFile.readLine();
             foreach (const QByteArray &item, line.split(','))
             {
-                recordsToDownload.append(QString::fromLocal8Bit(item).trimmed()); // Assuming local 8-bit.
+                auto record = QString::fromLocal8Bit(item).trimmed(); // Assuming local 8-bit.
+
+                if(!record.isEmpty())
+                    recordsToDownload.append(record);
             }
         }
     }
@@ -1089,40 +1308,106 @@ int GMWidget::downloadRecords(void)
     }
 
 
-    qDebug()<<QString::number(recordsListToDownload.isEmpty());
-    qDebug()<<QString::number(recordsListToDownload.empty());
+    // Copy the records that were downloaded in earlier runs from the local record cache, only the remaining records are downloaded
     if (!recordsListToDownload.isEmpty())
     {
-            this->downloadRecordBatch();
+        QStringList missingRecords;
+        QString errMsg;
+        auto numRestored = NGAW2RecordCache::restoreRecords(recordsListToDownload, pathToGMFilesDirectory, missingRecords, errMsg);
+
+        if(!errMsg.isEmpty())
+            this->statusMessage(errMsg);
+
+        if(numRestored > 0)
+            this->statusMessage("Copied " + QString::number(numRestored) + " ground motion records from the local record cache");
+
+        recordsListToDownload = missingRecords;
     }
 
+    if (recordsListToDownload.isEmpty())
+    {
+        this->finishRecordDownload();
+        return 0;
+    }
+
+    this->downloadRecordBatch();
+
     return 0;
 }
 
 
 void GMWidget::downloadRecordBatch(void)
 {
-    if(recordsListToDownload.empty())
-        return;
+    while(!recordsListToDownload.empty() && !downloadFailed)
+    {
+        auto client = this->getIdleDownloadClient();
+
+        // The next batch is sent once a client is done or signed in
+        if(client == nullptr)
+            return;
+
+        auto recordsBatch = PeerNgaWest2Client::takeRecordBatch(recordsListToDownload);
+
+        numDownloaded += recordsBatch.size();
+
+        busyDownloadClients.insert(client);
+
+        client->selectRecords(recordsBatch);
+    }
+}
 
-    auto maxBatchSize = 100;
 
-    if(recordsListToDownload.size() < maxBatchSize)
+PeerNgaWest2Client* GMWidget::getIdleDownloadClient(void)
+{
+    for(auto&& client : downloadClients)
     {
-        peerClient.selectRecords(recordsListToDownload);
-        numDownloaded = recordsListToDownload.size();
+        if(busyDownloadClients.contains(client))
+            continue;
 
-        recordsListToDownload.clear();
+        // The main client signs in when the run starts, and signs in again if the search is rejected
+        if(client == &peerClient || client->loggedIn())
+            return client;
     }
-    else
+
+    while(downloadClients.size() < maxConcurrentDownloads)
     {
-        auto recordsBatch = recordsListToDownload.mid(0,maxBatchSize-1);
+        auto client = new PeerNgaWest2Client(this);
+
+        connect(client, &PeerNgaWest2Client::loginFinished, this, [this](bool result)
+        {
+            if(result)
+                this->downloadRecordBatch();
+        });
+
+        connect(client, &PeerNgaWest2Client::recordsDownloaded, this, [this, client](QString zipFile)
+        {
+            this->handleRecordsDownloaded(client, zipFile);
+        });
+
+        downloadClients.push_back(client);
+
+        client->signIn(getPEERUserName(), getPEERPassWord());
+    }
+
+    return nullptr;
+}
 
-        numDownloaded += recordsBatch.size();
 
-        peerClient.selectRecords(recordsBatch);
+void GMWidget::handleRecordsDownloaded(PeerNgaWest2Client* client, const QString& zipFile)
+{
+    busyDownloadClients.remove(client);
+
+    if(downloadFailed)
+        return;
+
+    auto res = this->parseDownloadedRecords(zipFile);
 
-        recordsListToDownload = recordsListToDownload.mid(maxBatchSize-1,recordsListToDownload.size()-1);
+    if(res != 0)
+    {
+        // Do not send or process any more batches
+        downloadFailed = true;
+        recordsListToDownload.clear();
+        this->getProgressDialog()->hideProgressBar();
     }
 }
 
@@ -1181,13 +1466,9 @@ int GMWidget::processDownloadedRecords(QString& errorMessage)
 
     auto motionDir = inputFile.dir().absolutePath() ;
 
-    QApplication::processEvents();
-
     this->getProgressDialog()->setProgressBarRange(0,inputFiles.size());
     this->getProgressDialog()->setProgressBarValue(0);
 
-    QApplication::processEvents();
-
     // Get the headers in the first station file - assume that the rest will be the same
     auto rowStr = data.at(1);
     auto stationName = rowStr[0];
@@ -1214,147 +1495,47 @@ int GMWidget::processDownloadedRecords(QString& errorMessage)
     // Get the header file
     auto stationDataHeadings = sampleStationData.first();
 
-    // Create the fields
-    QList<QgsField> attribFields;
-    attribFields.push_back(QgsField("AssetType", QVariant::String));
-    attribFields.push_back(QgsField("TabName", QVariant::String));
-    attribFields.push_back(QgsField("Station Name", QVariant::String));
-    attribFields.push_back(QgsField("Latitude", QVariant::Double));
-    attribFields.push_back(QgsField("Longitude", QVariant::Double));
-
-    for(auto&& it : stationDataHeadings)
-        attribFields.push_back(QgsField(it, QVariant::String));
-
-
     // Pop off the row that contains the header information
     data.pop_front();
 
-    auto numRows = data.size();
-
-    int count = 0;
-
-    auto maxToDisp = 20;
-
+    // Read the station files in parallel in the thread pool and wait for the result
+    // The longitude is in the second column and the latitude in the third column of the event grid
+    StationLayerBuilder layerBuilder("GroundMotionGridPoint", "Ground Motion Grid Point");
     QgsFeatureList featureList;
-    // Get the data
-    for(int i = 0; i<numRows; ++i)
-    {
-        auto rowStr = data.at(i);
-
-        auto stationName = rowStr[0];
-
-        // Path to station files, e.g., site0.csv
-        auto stationPath = motionDir + QDir::separator() + stationName;
-
-        bool ok;
-        auto lon = rowStr[1].toDouble(&ok);
-
-        if(!ok)
-        {
-            errorMessage = "Error longitude to a double, check the value";
-            return -1;
-        }
-
-        auto lat = rowStr[2].toDouble(&ok);
-
-        if(!ok)
-        {
-            errorMessage = "Error latitude to a double, check the value";
-            return -1;
-        }
 
-        GroundMotionStation GMStation(stationPath,lat,lon);
-
-        try
+    auto res = TaskRunner::getInstance()->runAndWait<bool>([&](TaskContext& context)
+    {
+        auto readStation = [](const QString& stationPath, const double lat, const double lon)
         {
+            GroundMotionStation GMStation(stationPath,lat,lon);
             GMStation.importGroundMotions();
-        }
-        catch(QString msg)
-        {
-            errorMessage = "Error importing ground motion file: " + stationName+"\n"+msg;
-            return -1;
-        }
-
-        auto stationData = GMStation.getStationData();
-
-        // create the feature attributes
-        QgsAttributes featAttributes(attribFields.size());
-
-        auto latitude = GMStation.getLatitude();
-        auto longitude = GMStation.getLongitude();
 
-        featAttributes[0] = "GroundMotionGridPoint";     // "AssetType"
-        featAttributes[1] = "Ground Motion Grid Point";  // "TabName"
-        featAttributes[2] = stationName;                 // "Station Name"
-        featAttributes[3] = latitude;                    // "Latitude"
-        featAttributes[4] = longitude;                   // "Longitude"
+            return GMStation.getStationData();
+        };
 
-        // The number of headings in the file
-        auto numParams = stationData.front().size();
+        if(!layerBuilder.addStationFiles(data, motionDir, 2, 1, stationDataHeadings, readStation, err, &context))
+            return false;
 
-        maxToDisp = (maxToDisp<stationData.size() ? maxToDisp : stationData.size());
-
-        QVector<QString> dataStrs(numParams);
-
-        for(int i = 0; i<maxToDisp-1; ++i)
-        {
-            auto stationParams = stationData[i];
-
-            for(int j = 0; j<numParams; ++j)
-            {
-                dataStrs[j] += stationParams[j] + ", ";
-            }
-        }
-
-        for(int j = 0; j<numParams; ++j)
-        {
-            auto str = dataStrs[j] ;
-            str += stationData[maxToDisp-1][j];
-
-            if(maxToDisp<stationData.size())
-                str += "...";
-
-            featAttributes[5+j] = str;
-        }
-
-        // Create the feature
-        QgsFeature feature;
-        feature.setGeometry(QgsGeometry::fromPointXY(QgsPointXY(longitude,latitude)));
-        feature.setAttributes(featAttributes);
-        featureList.append(feature);
-
-        ++count;
-        this->getProgressDialog()->setProgressBarValue(count);
-
-        QApplication::processEvents();
-    }
-
-
-    auto vectorLayer = qgisVizWidget->addVectorLayer("Point", "Ground Motion Grid");
+        return layerBuilder.createFeatures(featureList, err);
+    }, [this](const TaskProgress& progress){
+        this->getProgressDialog()->setProgressBarRange(0,progress.total);
+        this->getProgressDialog()->setProgressBarValue(progress.done);
+    });
 
-    if(vectorLayer == nullptr)
+    if(!res)
     {
-        errorMessage = "Error creating a layer";
+        errorMessage = err;
         return -1;
     }
 
-    auto dProvider = vectorLayer->dataProvider();
-    auto res = dProvider->addAttributes(attribFields);
+    auto vectorLayer = layerBuilder.createLayer(qgisVizWidget, "Ground Motion Grid", featureList, err);
 
-    if(!res)
+    if(vectorLayer == nullptr)
     {
-        errorMessage = "Error adding attribute fields to layer";
-        qgisVizWidget->removeLayer(vectorLayer);
+        errorMessage = err;
         return -1;
     }
 
-    vectorLayer->updateFields(); // tell the vector layer to fetch changes from the provider
-
-    dProvider->addFeatures(featureList);
-    vectorLayer->updateExtents();
-
-    qgisVizWidget->createSymbolRenderer(Qgis::MarkerShape::Cross,Qt::black,2.0,vectorLayer);
-
     return 0;
 }
 
@@ -1381,13 +1562,7 @@ int GMWidget::parseDownloadedRecords(QString zipFile)
         return -1;
     }
 
-    // if more records to download due to 100 record limit .. go download them
-    if (!recordsListToDownload.empty())
-    {
-        this->downloadRecordBatch();
-        return 0;
-    }
-
+    // Convert the records of this batch before the next batch is unzipped into the same folder
     QJsonObject createdRecords;
     auto res = tool.convertToSimCenterEvent(pathToOutputDirectory + QDir::separator(), NGA2Results, errMsg, &createdRecords);
     if(res != 0)
@@ -1401,10 +1576,34 @@ int GMWidget::parseDownloadedRecords(QString zipFile)
         return res;
     }
 
+    // Add the records to the local record cache so that they are not downloaded again
+    QString cacheErr;
+    if(NGAW2RecordCache::storeRecords(createdRecords, cacheErr) != 0)
+        this->statusMessage(cacheErr);
+
+    // If more records to download due to the record limit per search .. go download them
+    if (!recordsListToDownload.empty())
+    {
+        this->downloadRecordBatch();
+        return 0;
+    }
+
+    // Wait for the batches that are still downloading
+    if (!busyDownloadClients.isEmpty())
+        return 0;
+
+    return this->finishRecordDownload();
+}
+
+
+int GMWidget::finishRecordDownload(void)
+{
+    QString errMsg;
     auto res2 = this->processDownloadedRecords(errMsg);
     if(res2 != 0)
     {
         this->errorMessage("Failed to process event grid file with the following error: " + errMsg);
+        this->getProgressDialog()->hideProgressBar();
         return res2;
     }
 
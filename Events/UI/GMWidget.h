@@ -45,6 +45,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 #include <QProcess>
 #include <QJsonObject>
+#include <QSet>
 
 class EventGMDirWidget;
 class GMPE;
@@ -102,6 +103,9 @@ public slots:
     void showGISWindow(void);
     void runHazardSimulation(void);
 
+    // Computes the median and standard deviation fields in the application for a point source, without running the backend hazard simulation
+    void runHazardPreview(void);
+
     // Handles the results when the user is finished
     void handleProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
 
@@ -114,10 +118,10 @@ public slots:
     // Download records once selected
     int downloadRecords(void);
 
-    // Download records once selected
+    // Sends the next batches of records to the download clients that are not busy
     void downloadRecordBatch(void);
 
-    // Process the outfile files once the hazard simulation is complete
+    // Converts a downloaded batch of records and adds them to the local record cache
     int parseDownloadedRecords(QString);
 
     // Send event file and motion dir
@@ -143,6 +147,7 @@ private:
     SiteConfig* m_siteConfig;
     SiteConfigWidget* m_siteConfigWidget;
     QPushButton* m_runButton;
+    QPushButton* m_previewButton;
     //QPushButton* m_settingButton;
     GmAppConfig* m_appConfig;
     Vs30* m_vs30;
@@ -164,8 +169,22 @@ private:
 
     int processDownloadedRecords(QString& errorMessage);
 
+    // Loads the results once all of the records are in the output directory
+    int finishRecordDownload(void);
+
+    void handleRecordsDownloaded(PeerNgaWest2Client* client, const QString& zipFile);
+
+    // Returns a client that is signed in and not busy, or a null pointer if there is none. Adds clients up to the maximum number of concurrent downloads
+    PeerNgaWest2Client* getIdleDownloadClient(void);
+
+    // The record batches are downloaded by several clients at the same time, each with its own session
+    const int maxConcurrentDownloads = 3;
+    QVector<PeerNgaWest2Client*> downloadClients;
+    QSet<PeerNgaWest2Client*> busyDownloadClients;
+
     int numDownloaded;
     bool downloadComplete;
+    bool downloadFailed = false;
     QStringList recordsListToDownload;
     QJsonObject NGA2Results;
 };
@@ -48,14 +48,18 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QDir>
 #include <QHttpMultiPart>
 #include <QSslConfiguration>
+#include <QUuid>
 
 PeerNgaWest2Client::PeerNgaWest2Client(QObject *parent) : QObject(parent),
-    nRecords(3), isLoggedIn(false), retries(0)
+    serverUrl("https://ngawest2.berkeley.edu"), nRecords(3), isLoggedIn(false), retries(0)
 {
     QNetworkCookie cookie("sourceDb_flag", "1");
-    cookie.setDomain("ngawest2.berkeley.edu");
+    cookie.setDomain(serverUrl.host());
     networkManager.cookieJar()->insertCookie(cookie);
 
+    // Each client downloads to its own file so that several clients can download at the same time
+    recordsFileName = "PeerRecords_" + QUuid::createUuid().toString(QUuid::WithoutBraces) + ".zip";
+
     searchScaleFlag = -1;
 
     setupConnection();
@@ -67,6 +71,22 @@ bool PeerNgaWest2Client::loggedIn()
 }
 
 
+void PeerNgaWest2Client::setServerUrl(const QUrl& url)
+{
+    serverUrl = url;
+
+    QNetworkCookie cookie("sourceDb_flag", "1");
+    cookie.setDomain(serverUrl.host());
+    networkManager.cookieJar()->insertCookie(cookie);
+}
+
+
+QUrl PeerNgaWest2Client::getServerUrl(const QString& path) const
+{
+    return serverUrl.resolved(QUrl(path));
+}
+
+
 void PeerNgaWest2Client::signIn(QString username, QString password)
 {
     emit statusUpdated("Logging in to PEER NGA West 2 Database");
@@ -75,7 +95,7 @@ void PeerNgaWest2Client::signIn(QString username, QString password)
     this->username = username;
     this->password = password;
     
-    QNetworkRequest peerSignInPageRequest(QUrl("https://ngawest2.berkeley.edu/users/sign_in"));
+    QNetworkRequest peerSignInPageRequest(this->getServerUrl("/users/sign_in"));
     signInPageReply = networkManager.get(peerSignInPageRequest);
 }
 
@@ -90,7 +110,7 @@ void PeerNgaWest2Client::selectRecords(QList<QPair<double, double>> spectrum, in
     this->distanceRange = distanceRange;
     this->vs30Range = vs30Range;
 
-    uploadFileRequest.setUrl(QUrl("https://ngawest2.berkeley.edu/spectras/uploadFile"));
+    uploadFileRequest.setUrl(this->getServerUrl("/spectras/uploadFile"));
     QHttpMultiPart* multiPart = new QHttpMultiPart(QHttpMultiPart::FormDataType);
 
     //Token part
@@ -134,10 +154,10 @@ void PeerNgaWest2Client::selectRecords(double sds, double sd1, double tl, int nR
     this->nRecords = nRecords;
 
     QNetworkCookie cookie("SpectrumModel_Dropdown", "99");
-    cookie.setDomain("ngawest2.berkeley.edu");
+    cookie.setDomain(serverUrl.host());
     networkManager.cookieJar()->insertCookie(cookie);
 
-    postSpectraRequest.setUrl(QUrl("https://ngawest2.berkeley.edu/spectras"));
+    postSpectraRequest.setUrl(this->getServerUrl("/spectras"));
     postSpectraRequest.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
 
     postSpectraParameters.clear();
@@ -168,10 +188,10 @@ void PeerNgaWest2Client::selectRecords(QStringList records)
     emit statusUpdated("Performing Record Selection...");
 
     QNetworkCookie cookie("SpectrumModel_Dropdown", "88");
-    cookie.setDomain("ngawest2.berkeley.edu");
+    cookie.setDomain(serverUrl.host());
     networkManager.cookieJar()->insertCookie(cookie);
 
-    postSpectraRequest.setUrl(QUrl("https://ngawest2.berkeley.edu/spectras"));
+    postSpectraRequest.setUrl(this->getServerUrl("/spectras"));
     postSpectraRequest.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
 
     postSpectraParameters.clear();
@@ -274,7 +294,7 @@ void PeerNgaWest2Client::processSignInPageReply()
     authenticityToken = match.captured(1);
 #endif
 
-    peerSignInRequest.setUrl(QUrl("https://ngawest2.berkeley.edu/users/sign_in"));
+    peerSignInRequest.setUrl(this->getServerUrl("/users/sign_in"));
     peerSignInRequest.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
 
     signInParameters.clear();
@@ -336,10 +356,10 @@ void PeerNgaWest2Client::processUploadFileReply()
 {
 
     QNetworkCookie cookie("SpectrumModel_Dropdown", "0");
-    cookie.setDomain("ngawest2.berkeley.edu");
+    cookie.setDomain(serverUrl.host());
     networkManager.cookieJar()->insertCookie(cookie);
 
-    postSpectraRequest.setUrl(QUrl("https://ngawest2.berkeley.edu/spectras"));
+    postSpectraRequest.setUrl(this->getServerUrl("/spectras"));
     postSpectraRequest.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
 
     postSpectraParameters.clear();
@@ -352,7 +372,7 @@ void PeerNgaWest2Client::processUploadFileReply()
     postSpectraParameters.addQueryItem("model[ID]", "0");
     postSpectraParameters.addQueryItem("spectra[menu_Mechanism]", "1");
 
-    for (auto& cookie: networkManager.cookieJar()->cookiesForUrl(QUrl("https://ngawest2.berkeley.edu")))
+    for (auto& cookie: networkManager.cookieJar()->cookiesForUrl(serverUrl))
         if (0 == cookie.name().compare("upload_file"))
             postSpectraParameters.addQueryItem("spectra[filename]", cookie.value());
 
@@ -499,7 +519,7 @@ void PeerNgaWest2Client::processGetRecordsReply()
 {
     emit statusUpdated("Downloading Ground Motions from PEER NGA West 2 Database");
     auto replyText = QString(getRecordsReply->readAll());
-    auto url = replyText.remove("window.location.href = \"").remove("\";").prepend("https://ngawest2.berkeley.edu");
+    auto url = this->getServerUrl(replyText.remove("window.location.href = \"").remove("\";"));
 
     QNetworkRequest downloadRecordsRequest(url);
     downloadRecordsReply = networkManager.get(downloadRecordsRequest);
@@ -519,7 +539,7 @@ void PeerNgaWest2Client::processDownloadRecordsReply()
         }
     }
     //TODO: we might need to use temporary files
-    QString recordsPath = tempLocation.append("/PeerRecords.zip");
+    QString recordsPath = tempLocation.append("/" + recordsFileName);
 
     QFile file(recordsPath);
     if(!file.open(QIODevice::WriteOnly))
@@ -546,7 +566,7 @@ void PeerNgaWest2Client::retryPostSpectra()
 
 void PeerNgaWest2Client::retrySignIn()
 {
-    QNetworkRequest peerSignInPageRequest(QUrl("https://ngawest2.berkeley.edu/users/sign_in"));
+    QNetworkRequest peerSignInPageRequest(this->getServerUrl("/users/sign_in"));
     signInPageReply = networkManager.get(peerSignInPageRequest);
 }
 
@@ -579,3 +599,13 @@ void PeerNgaWest2Client::setScalingParameters(const int scaleFlag,
     searchWeightPoints = weightPoints;
     searchSinglePeriodScalingT = scalingPeriod;
 }
+
+
+QStringList PeerNgaWest2Client::takeRecordBatch(QStringList& records)
+{
+    auto batch = records.mid(0, maxRecordsPerSearch);
+
+    records = records.mid(maxRecordsPerSearch);
+
+    return batch;
+}
@@ -53,6 +53,9 @@ class PeerNgaWest2Client : public QObject
 public:
     explicit PeerNgaWest2Client(QObject *parent = nullptr);
     bool loggedIn();
+
+    // The server defaults to the PEER NGA West 2 database, another server, e.g., a local stand-in for testing, can be set here
+    void setServerUrl(const QUrl& url);
     void signIn(QString username, QString password);
     void selectRecords(double sds, double sd1, double tl, int nRecords, QVariant magnitudeRange, QVariant distanceRange, QVariant vs30Range);
     void selectRecords(QList<QPair<double, double>> spectrum, int nRecords, QVariant magnitudeRange, QVariant distanceRange, QVariant vs30Range);
@@ -63,6 +66,12 @@ public:
                               const QString& weightPoints,
                               const QString& scalingPeriod);
 
+    // The PEER server returns up to 99 records per search
+    static const int maxRecordsPerSearch = 99;
+
+    // Removes the records of the next search from the front of the list and returns them
+    static QStringList takeRecordBatch(QStringList& records);
+
 signals:
     void loginFinished(bool result);
     void recordsDownloaded(QString recordsPath);
@@ -84,6 +93,9 @@ private:
     QNetworkReply* downloadRecordsReply;
     QNetworkReply* uploadFileReply;
 
+    QUrl serverUrl;
+    QString recordsFileName;
+
     QString authenticityToken;
     QString username;
     QString password;
@@ -108,6 +120,8 @@ private:
     QNetworkRequest uploadFileRequest;
     QStringList recordsToDownload;
 
+    QUrl getServerUrl(const QString& path) const;
+
     void setupConnection();
     void processNetworkReply(QNetworkReply *reply);
 
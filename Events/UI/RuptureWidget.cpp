@@ -192,6 +192,12 @@ QString RuptureWidget::getEQNum() const
 }
 
 
+PointSourceRupture* RuptureWidget::getPointSourceRupture() const
+{
+    return pointSourceWidget->getRuptureSource();
+}
+
+
 QString RuptureWidget::getGMPELogicTree() const
 {
     QString gmpeLT = "";
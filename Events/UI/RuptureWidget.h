@@ -40,6 +40,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 #include "SimCenterAppWidget.h"
 
+class PointSourceRupture;
 class PointSourceRuptureWidget;
 class EarthquakeRuptureForecastWidget;
 class OpenQuakeScenarioWidget;
@@ -61,6 +62,7 @@ public:
     QString getWidgetType(void) const;
     QString getGMPELogicTree(void) const;
     QString getEQNum(void) const;
+    PointSourceRupture* getPointSourceRupture(void) const;
     bool outputToJSON(QJsonObject &jsonObject);
     bool inputFromJSON(QJsonObject &jsonObject);
 
@@ -38,6 +38,27 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 #include "SiteScatter.h"
 
+#include <cmath>
+#include <limits>
+
+namespace {
+
+quint64 makeCellKey(qint64 row, qint64 col)
+{
+    return (static_cast<quint64>(static_cast<quint32>(row)) << 32) | static_cast<quint32>(col);
+}
+
+}
+
+UserSpecifiedSite::UserSpecifiedSite()
+{
+    Vs30 = std::numeric_limits<double>::quiet_NaN();
+    z1pt0 = std::numeric_limits<double>::quiet_NaN();
+    z2pt5 = std::numeric_limits<double>::quiet_NaN();
+    zTR = std::numeric_limits<double>::quiet_NaN();
+}
+
+
 SiteScatter::SiteScatter(QObject *parent) : QObject(parent)
 {
     allSites.reserve(0);
@@ -53,43 +74,224 @@ int SiteScatter::getNumSites()
 void SiteScatter::initialize(int L)
 {
     allSites.reserve(L);
+    siteCells.reserve(L);
 }
 
 
 void SiteScatter::addSite(const UserSpecifiedSite &userSite)
 {
     allSites.push_back(userSite);
+    this->insertIntoIndex(allSites.size()-1);
+
+    emit siteChanged();
+}
+
+
+void SiteScatter::addSites(const QVector<UserSpecifiedSite> &userSites)
+{
+    if(userSites.empty())
+        return;
+
+    allSites.reserve(allSites.size() + userSites.size());
+
+    for(auto&& site : userSites)
+    {
+        allSites.push_back(site);
+        this->insertIntoIndex(allSites.size()-1);
+    }
+
+    emit siteChanged();
+}
+
+
+bool SiteScatter::deleteSite(const UserSpecifiedSite &userSite, double tolerance)
+{
+    auto index = this->findSite(userSite.Latitude, userSite.Longitude, tolerance);
+
+    if(index < 0)
+        return false;
+
+    this->removeAt(index);
+
     emit siteChanged();
+
+    return true;
 }
 
 
-void SiteScatter::deleteSite(const UserSpecifiedSite &userSite)
+int SiteScatter::deleteSites(const QVector<UserSpecifiedSite> &userSites, double tolerance)
 {
-    for (int i = 0; i != allSites.count(); ++i)
+    QVector<bool> removed(allSites.size(), false);
+
+    auto numRemoved = 0;
+    for(auto&& site : userSites)
     {
-        // Checking latitude and longitude
-        if (userSite.Latitude.compare(allSites[i].Latitude) && userSite.Longitude.compare(allSites[i].Longitude))
+        auto index = this->findSite(site.Latitude, site.Longitude, tolerance);
+
+        if(index >= 0 && !removed.at(index))
         {
-            allSites.removeAt(i);
-            emit siteChanged();
-            return;
+            removed[index] = true;
+            ++numRemoved;
         }
     }
+
+    if(numRemoved == 0)
+        return 0;
+
+    // Compact the list in one pass so that the remaining sites keep their order, then index them again once
+    auto numKept = 0;
+    for(int i = 0; i < allSites.size(); ++i)
+    {
+        if(removed.at(i))
+            continue;
+
+        if(numKept != i)
+            allSites[numKept] = allSites.at(i);
+
+        ++numKept;
+    }
+
+    allSites.resize(numKept);
+
+    this->rebuildIndex();
+
+    emit siteChanged();
+
+    return numRemoved;
 }
 
 
 void SiteScatter::clearSites()
 {
     allSites.clear();
+    siteCells.clear();
 }
 
 
-QList<UserSpecifiedSite> SiteScatter::getSiteList()
+const QVector<UserSpecifiedSite>& SiteScatter::getSiteList() const
 {
     return allSites;
 }
 
 
+int SiteScatter::findSite(double latitude, double longitude, double tolerance) const
+{
+    if(allSites.empty() || std::isnan(latitude) || std::isnan(longitude))
+        return -1;
+
+    tolerance = std::abs(tolerance);
+
+    auto minRow = static_cast<qint64>(std::floor((latitude - tolerance)/cellSize));
+    auto maxRow = static_cast<qint64>(std::floor((latitude + tolerance)/cellSize));
+    auto minCol = static_cast<qint64>(std::floor((longitude - tolerance)/cellSize));
+    auto maxCol = static_cast<qint64>(std::floor((longitude + tolerance)/cellSize));
+
+    int closestIndex = -1;
+    double closestDistance = tolerance*tolerance;
+
+    // Scan the sites directly when the tolerance covers more cells than there are occupied cells
+    if((maxRow - minRow + 1)*(maxCol - minCol + 1) > siteCells.size())
+    {
+        for(int i = 0; i < allSites.size(); ++i)
+        {
+            auto dLat = allSites.at(i).Latitude - latitude;
+            auto dLon = allSites.at(i).Longitude - longitude;
+            auto distance = dLat*dLat + dLon*dLon;
+
+            if(distance <= closestDistance)
+            {
+                closestDistance = distance;
+                closestIndex = i;
+            }
+        }
+
+        return closestIndex;
+    }
+
+    for(auto row = minRow; row <= maxRow; ++row)
+    {
+        for(auto col = minCol; col <= maxCol; ++col)
+        {
+            auto it = siteCells.constFind(makeCellKey(row, col));
+            if(it == siteCells.constEnd())
+                continue;
+
+            for(auto&& index : it.value())
+            {
+                const auto& site = allSites.at(index);
+
+                auto dLat = site.Latitude - latitude;
+                auto dLon = site.Longitude - longitude;
+                auto distance = dLat*dLat + dLon*dLon;
+
+                if(distance <= closestDistance)
+                {
+                    closestDistance = distance;
+                    closestIndex = index;
+                }
+            }
+        }
+    }
+
+    return closestIndex;
+}
+
+
+quint64 SiteScatter::getCellKey(double latitude, double longitude) const
+{
+    auto row = static_cast<qint64>(std::floor(latitude/cellSize));
+    auto col = static_cast<qint64>(std::floor(longitude/cellSize));
+
+    return makeCellKey(row, col);
+}
+
+
+void SiteScatter::insertIntoIndex(int index)
+{
+    const auto& site = allSites.at(index);
+
+    siteCells[this->getCellKey(site.Latitude, site.Longitude)].push_back(index);
+}
+
+
+void SiteScatter::removeAt(int index)
+{
+    const auto lastIndex = allSites.size() - 1;
+
+    auto key = this->getCellKey(allSites.at(index).Latitude, allSites.at(index).Longitude);
+
+    auto& cell = siteCells[key];
+    cell.removeOne(index);
+    if(cell.empty())
+        siteCells.remove(key);
+
+    // Move the last site into the freed slot so that the removal does not shift the rest of the list
+    if(index != lastIndex)
+    {
+        auto lastSite = allSites.at(lastIndex);
+
+        auto& lastCell = siteCells[this->getCellKey(lastSite.Latitude, lastSite.Longitude)];
+        auto pos = lastCell.indexOf(lastIndex);
+        if(pos >= 0)
+            lastCell[pos] = index;
+
+        allSites[index] = lastSite;
+    }
+
+    allSites.removeLast();
+}
+
+
+void SiteScatter::rebuildIndex()
+{
+    siteCells.clear();
+    siteCells.reserve(allSites.size());
+
+    for(int i = 0; i < allSites.size(); ++i)
+        this->insertIntoIndex(i);
+}
+
+
 bool SiteScatter::outputToJSON(QJsonObject &jsonObject)
 {
     jsonObject.insert("Type","Scatter");
@@ -108,4 +310,3 @@ void SiteScatter::reset(void)
 {
 
 }
-
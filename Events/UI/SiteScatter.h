@@ -39,18 +39,23 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 // Written by: Kuanshi Zhong
 
 #include <QObject>
+#include <QHash>
+#include <QVector>
 #include "JsonSerializable.h"
 
 
 struct UserSpecifiedSite
 {
-    int SiteNum;
-    QString Longitude;
-    QString Latitude;
-    QString Vs30;
-    QString z1pt0; // z1.0
-    QString z2pt5; // z2.5
-    QString zTR; // depth to the bedrock
+    int SiteNum = 0;
+    double Longitude = 0.0;
+    double Latitude = 0.0;
+    // Optional site parameters are NaN when they are not given
+    double Vs30;
+    double z1pt0; // z1.0
+    double z2pt5; // z2.5
+    double zTR; // depth to the bedrock
+
+    UserSpecifiedSite();
 };
 
 
@@ -66,18 +71,28 @@ public:
     void initialize(int L);
     // add site
     void addSite(const UserSpecifiedSite &userSite);
-    // delete site
-    void deleteSite(const UserSpecifiedSite &userSite);
+    // add a batch of sites, emits siteChanged once
+    void addSites(const QVector<UserSpecifiedSite> &userSites);
+    // delete the site at the location of the given site, returns false if there is no site there
+    bool deleteSite(const UserSpecifiedSite &userSite, double tolerance = defaultTolerance);
+    // delete the sites at the locations of the given sites, emits siteChanged once and returns the number of sites deleted
+    int deleteSites(const QVector<UserSpecifiedSite> &userSites, double tolerance = defaultTolerance);
     // clear
     void clearSites();
     // get site list
-    QList<UserSpecifiedSite> getSiteList();
+    const QVector<UserSpecifiedSite>& getSiteList() const;
+
+    // Returns the index of the site closest to the location within the tolerance (in degrees), or -1 if there is none
+    int findSite(double latitude, double longitude, double tolerance = defaultTolerance) const;
 
     bool outputToJSON(QJsonObject &jsonObject);
     bool inputFromJSON(QJsonObject &jsonObject);
 
     void reset(void);
 
+    // Default tolerance when matching sites by location, in degrees
+    static constexpr double defaultTolerance = 1.0e-6;
+
 signals:
 
     void siteChanged();
@@ -86,8 +101,19 @@ public slots:
 
 private:
 
+    quint64 getCellKey(double latitude, double longitude) const;
+    void insertIntoIndex(int index);
+    void removeAt(int index);
+    void rebuildIndex();
+
     // Site list
-    QList<UserSpecifiedSite> allSites;
+    QVector<UserSpecifiedSite> allSites;
+
+    // Spatial index, a uniform grid from the cell key to the indices of the sites in the cell
+    QHash<quint64, QVector<int>> siteCells;
+
+    // Size of the spatial index cells, in degrees
+    const double cellSize = 0.01;
 
 };
 
@@ -50,6 +50,9 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QFileDialog>
 #include <QHeaderView>
 
+#include <cmath>
+#include <limits>
+
 SiteScatterWidget::SiteScatterWidget(SiteScatter& siteScatter, QWidget *parent) : SimCenterWidget(parent), m_siteScatter(siteScatter)
 {
     fileLoaded = false;
@@ -247,9 +250,17 @@ int SiteScatterWidget::parseSiteFile(const QString& pathToFile)
         }
     }
 
-    // Parse site data
-    m_siteScatter.clearSites();
-    m_siteScatter.initialize(tmpData.length());
+    // Optional fields are NaN when they are missing or not numbers
+    auto toOptionalDouble = [](const QString& str)
+    {
+        bool OK = false;
+        auto val = str.toDouble(&OK);
+        return OK ? val : std::numeric_limits<double>::quiet_NaN();
+    };
+
+    // Parse site data, the sites are added in one batch so that the site list only changes once
+    QVector<UserSpecifiedSite> sites;
+    sites.reserve(tmpData.length()-1);
     for (int stag = 1; stag != tmpData.length(); stag++)
     {
         auto curSite = tmpData[stag];
@@ -273,7 +284,15 @@ int SiteScatterWidget::parseSiteFile(const QString& pathToFile)
         }
         if (colName.contains("Latitude"))
         {
-            site.Latitude = curSite[attributeIndex["Latitude"]];
+            bool OK = false;
+            site.Latitude = curSite[attributeIndex["Latitude"]].toDouble(&OK);
+            if (!OK)
+            {
+                QString errMsg = "The latitude of the site " + QString::number(site.SiteNum) + " is not a number.";
+                qDebug() << errMsg;
+                this->errorMessage(errMsg);
+                return 1;
+            }
         }
         else
         {
@@ -284,7 +303,15 @@ int SiteScatterWidget::parseSiteFile(const QString& pathToFile)
         }
         if (colName.contains("Longitude"))
         {
-            site.Longitude = curSite[attributeIndex["Longitude"]];
+            bool OK = false;
+            site.Longitude = curSite[attributeIndex["Longitude"]].toDouble(&OK);
+            if (!OK)
+            {
+                QString errMsg = "The longitude of the site " + QString::number(site.SiteNum) + " is not a number.";
+                qDebug() << errMsg;
+                this->errorMessage(errMsg);
+                return 1;
+            }
         }
         else
         {
@@ -297,36 +324,32 @@ int SiteScatterWidget::parseSiteFile(const QString& pathToFile)
         // Optional fields (can be extended in future)
         if (colName.contains("Vs30"))
         {
-            site.Vs30 = curSite[attributeIndex["Vs30"]];
+            site.Vs30 = toOptionalDouble(curSite[attributeIndex["Vs30"]]);
         }
-        else
-            site.Vs30 = "";
         if (colName.contains("z1pt0"))
         {
-            site.z1pt0 = curSite[attributeIndex["z1pt0"]];
+            site.z1pt0 = toOptionalDouble(curSite[attributeIndex["z1pt0"]]);
         }
-        else
-            site.z1pt0 = "";
         if (colName.contains("z2pt5"))
         {
-            site.z2pt5 = curSite[attributeIndex["z2pt5"]];
+            site.z2pt5 = toOptionalDouble(curSite[attributeIndex["z2pt5"]]);
         }
-        else
-            site.z2pt5 = "";
         if (colName.contains("zTR"))
         {
-            site.zTR = curSite[attributeIndex["zTR"]];
+            site.zTR = toOptionalDouble(curSite[attributeIndex["zTR"]]);
         }
         else if (colName.contains("DepthToRock"))
         {
-            site.zTR = curSite[attributeIndex["DepthToRock"]];
+            site.zTR = toOptionalDouble(curSite[attributeIndex["DepthToRock"]]);
         }
-        else
-            site.zTR = "";
 
-        m_siteScatter.addSite(site);
+        sites.push_back(site);
     }
 
+    m_siteScatter.clearSites();
+    m_siteScatter.initialize(sites.size());
+    m_siteScatter.addSites(sites);
+
     this->statusMessage("Site file parsed.");
 
     // update the table
@@ -460,7 +483,7 @@ QStringList SiteScatterWidget::parseLineCSV(const QString &csvString)
 }
 
 
-void SiteScatterWidget::updateSiteSpreadSheet(const QList<UserSpecifiedSite>& siteList)
+void SiteScatterWidget::updateSiteSpreadSheet(const QVector<UserSpecifiedSite>& siteList)
 {
 
     if(siteList.empty())
@@ -486,11 +509,17 @@ void SiteScatterWidget::updateSiteSpreadSheet(const QList<UserSpecifiedSite>& si
         preview_size = 100;
     else
         preview_size = siteList.size();
+    // Missing optional fields are left blank
+    auto toString = [](double val)
+    {
+        return std::isnan(val) ? QString() : QString::number(val, 'g', 10);
+    };
+
     for (int i = 0; i< preview_size; ++i)
     {
         QList<QString> tableRow;
-        tableRow << QString::number(siteList[i].SiteNum) << siteList[i].Latitude << siteList[i].Longitude
-                 << siteList[i].Vs30 << siteList[i].zTR << siteList[i].z1pt0 << siteList[i].z2pt5;
+        tableRow << QString::number(siteList[i].SiteNum) << toString(siteList[i].Latitude) << toString(siteList[i].Longitude)
+                 << toString(siteList[i].Vs30) << toString(siteList[i].zTR) << toString(siteList[i].z1pt0) << toString(siteList[i].z2pt5);
 
         QTableWidgetItem *item;
         for (int j = 0; j != defaultCSVHeader.length(); ++j)
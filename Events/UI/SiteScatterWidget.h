@@ -97,7 +97,7 @@ private:
     // Functions to parse csv files
     QVector<QStringList> parseCSVFile(const QString &string);
     QStringList parseLineCSV(const QString &string);
-    void updateSiteSpreadSheet(const QList<UserSpecifiedSite>& siteList);
+    void updateSiteSpreadSheet(const QVector<UserSpecifiedSite>& siteList);
     bool updatingSiteTable;
     QStringList defaultCSVHeader;
 
@@ -37,7 +37,6 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 // Written: Stevan Gavrilovic
 
-#include "GridNode.h"
 #include "NodeHandle.h"
 #include "RectangleGrid.h"
 #include "SiteConfig.h"
@@ -62,6 +61,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 RectangleGrid::RectangleGrid(QgsMapCanvas* parent) : QgsMapTool(parent), mapCanvas(parent)
 {
     gridSiteConfig = nullptr;
+    theVisWidget = nullptr;
 
     setCacheMode(DeviceCoordinateCache);
     setZValue(-1);
@@ -79,6 +79,9 @@ RectangleGrid::RectangleGrid(QgsMapCanvas* parent) : QgsMapTool(parent), mapCanv
 
     color.setRgb(0,0,255,30);
 
+    nodeColor.setRgb(0,0,255,100);
+    nodeDiameter = 5.0;
+
     auto width = 150;
     auto height = 150;
 
@@ -260,6 +263,17 @@ void RectangleGrid::paint(QPainter *painter, const QStyleOptionGraphicsItem *opt
     painter->setPen(Qt::NoPen);
     painter->setBrush(QBrush(color));
     painter->drawRect(rectangleGeometry);
+
+    if(gridNodePoints.isEmpty())
+        return;
+
+    // Draw all of the grid nodes in a single call, a round pen cap gives a filled circle per point
+    QPen nodePen(nodeColor);
+    nodePen.setWidthF(nodeDiameter);
+    nodePen.setCapStyle(Qt::RoundCap);
+
+    painter->setPen(nodePen);
+    painter->drawPoints(gridNodePoints.constData(), gridNodePoints.size());
 }
 
 
@@ -287,6 +301,8 @@ void RectangleGrid::updateGeometry(void)
         gridSiteConfig->siteGrid().longitude().set(lonMin, lonMax, numDivisionsVertical);
     }
 
+    this->updateGridNodes();
+
     // qDebug() << "RectangleRrid - emitting geometryChanged()";
     // qDebug() << mapCanvas->extent().toRectF();
     
@@ -294,9 +310,22 @@ void RectangleGrid::updateGeometry(void)
 }
 
 
-QVector<GridNode *> RectangleGrid::getGridNodeVec() const
+QVector<double> RectangleGrid::getGridNodeVec() const
 {
-    return gridNodeVec;
+    QVector<double> latLonVec;
+
+    if(theVisWidget == nullptr)
+        return latLonVec;
+
+    latLonVec.reserve(2*gridNodePoints.size());
+
+    for(auto&& point : gridNodePoints)
+    {
+        latLonVec.push_back(theVisWidget->getLatFromScreenPoint(point,mapCanvas));
+        latLonVec.push_back(theVisWidget->getLongFromScreenPoint(point,mapCanvas));
+    }
+
+    return latLonVec;
 }
 
 
@@ -538,8 +567,11 @@ void RectangleGrid::handleCenterNodeChanged(const QPointF& pos)
 
 void RectangleGrid::clearGrid()
 {
-    qDeleteAll(gridNodeVec);
-    gridNodeVec.clear();
+    gridNodePoints.clear();
+    gridWeightsHoriz.clear();
+    gridWeightsVert.clear();
+
+    this->update();
 }
 
 
@@ -548,56 +580,55 @@ void RectangleGrid::createGrid()
     auto ni = numDivisionsHoriz;
     auto nj = numDivisionsVertical;
 
-    gridNodeVec.reserve(ni*nj);
+    // The weights only depend on the number of divisions, compute them once here so that dragging a handle only has to interpolate
+    gridWeightsHoriz.resize(static_cast<int>(ni+1));
+    gridWeightsVert.resize(static_cast<int>(nj+1));
 
     for (size_t i=0; i<=ni; ++i)
-    {
-        for (size_t j=0;j<=nj; ++j)
-        {
+        gridWeightsHoriz[i] = ni > 0 ? static_cast<double>(i)/static_cast<double>(ni) : 0.0;
 
-            // X COORDINATE
-            std::function<double(void)> xCoordinatelambda = [=]
-            {
-                auto divisor = static_cast<double>(ni*nj);
+    for (size_t j=0; j<=nj; ++j)
+        gridWeightsVert[j] = nj > 0 ? static_cast<double>(j)/static_cast<double>(nj) : 0.0;
 
-                auto n1X = bottomLeftNode->pos().x();
-                auto n2X = bottomRightNode->pos().x();
-                auto n3X = topRightNode->pos().x();
-                auto n4X = topLeftNode->pos().x();
+    gridNodePoints.resize(gridWeightsHoriz.size()*gridWeightsVert.size());
 
-                return static_cast<double>(i*j*n1X-i*j*n2X+i*j*n3X-i*j*n4X-i*n1X*nj+i*n2X*nj-j*n1X*ni+j*n4X*ni+n1X*ni*nj)/(divisor);
-            };
+    this->updateGridNodes();
+}
 
-            // Y COORDINATE
-            std::function<double(void)> yCoordinatelambda = [=]
-            {
-                auto divisor = static_cast<double>(ni*nj);
 
-                auto n1Y = bottomLeftNode->pos().y();
-                auto n2Y = bottomRightNode->pos().y();
-                auto n3Y = topRightNode->pos().y();
-                auto n4Y = topLeftNode->pos().y();
+void RectangleGrid::updateGridNodes(void)
+{
+    if(gridNodePoints.isEmpty())
+        return;
 
-                return static_cast<double>(i*j*n1Y-i*j*n2Y+i*j*n3Y-i*j*n4Y-i*n1Y*nj+i*n2Y*nj-j*n1Y*ni+j*n4Y*ni+n1Y*ni*nj)/(divisor);
-            };
+    const QPointF n1 = bottomLeftNode->pos();
+    const QPointF n2 = bottomRightNode->pos();
+    const QPointF n3 = topRightNode->pos();
+    const QPointF n4 = topLeftNode->pos();
 
-            auto x = xCoordinatelambda();
-            auto y = yCoordinatelambda();
+    const int numHoriz = gridWeightsHoriz.size();
+    const int numVert = gridWeightsVert.size();
 
-            // Create the grid node
-            GridNode* newGridNode = new GridNode(this);
+    auto points = gridNodePoints.data();
 
-            newGridNode->setX(x);
-            newGridNode->setY(y);
+    // Bilinear interpolation between the four corners, nodes are stored row by row along the horizontal direction
+    for (int i=0; i<numHoriz; ++i)
+    {
+        const double s = gridWeightsHoriz[i];
 
-            newGridNode->setXPos(xCoordinatelambda);
-            newGridNode->setYPos(yCoordinatelambda);
+        // Interpolate along the bottom and top edges first, then between the two edges
+        const QPointF bottom = (1.0-s)*n1 + s*n2;
+        const QPointF top = (1.0-s)*n4 + s*n3;
 
-            gridNodeVec.push_back(newGridNode);
+        for (int j=0; j<numVert; ++j)
+        {
+            const double t = gridWeightsVert[j];
 
-            connect(this,&RectangleGrid::geometryChanged,newGridNode,&GridNode::updateGeometry);
+            points[i*numVert+j] = (1.0-t)*bottom + t*top;
         }
     }
+
+    this->update();
 }
 
 
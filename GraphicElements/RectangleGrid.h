@@ -45,7 +45,6 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 class QgsMapCanvas;
 class NodeHandle;
-class GridNode;
 class SiteConfig;
 class VisualizationWidget;
 
@@ -59,7 +58,8 @@ class RectangleGrid : public QgsMapTool, public QGraphicsItem
     RectangleGrid(QgsMapCanvas* parent);
     ~RectangleGrid();
 
-    QVector<GridNode *> getGridNodeVec() const;
+    // Returns the grid nodes as a flat buffer of latitude, longitude pairs, i.e., [lat0, lon0, lat1, lon1, ...]
+    QVector<double> getGridNodeVec() const;
     void setVisualizationWidget(VisualizationWidget *value);
     void clearGrid();
     void createGrid();
@@ -123,6 +123,9 @@ protected:
 
     void updateGeometry(void);
 
+    // Recomputes the grid node positions in place from the current corner handle positions
+    void updateGridNodes(void);
+
 signals:
     void geometryChanged();
 
@@ -144,7 +147,15 @@ private:
     SiteConfig* gridSiteConfig;
     VisualizationWidget* theVisWidget;
 
-    QVector<GridNode*> gridNodeVec;
+    // All grid nodes are painted by this item from a contiguous array of points in item coordinates
+    QVector<QPointF> gridNodePoints;
+
+    // The normalized (0 to 1) position of each grid line along the horizontal and vertical edges
+    QVector<double> gridWeightsHoriz;
+    QVector<double> gridWeightsVert;
+
+    QColor nodeColor;
+    double nodeDiameter;
 
     double latMin;
     double lonMin;
@@ -37,13 +37,33 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 // Written by: Dr. Stevan Gavrilovic, UC Berkeley
 
 #include "ComponentTableModel.h"
+#include "CSVReaderWriter.h"
+
+#include <qgsvectorlayer.h>
+#include <qgsvectorlayerfeatureiterator.h>
+#include <qgsfeatureiterator.h>
+#include <qgsfeaturerequest.h>
 
 #include <QDataStream>
 #include <QDebug>
 #include <QMimeData>
 #include <QStringList>
+#include <QUndoStack>
 #include <QUuid>
 
+#include <algorithm>
+#include <memory>
+
+namespace
+{
+// Number of rows in a page of the layer cache and the number of pages that are kept
+const int pageSize = 256;
+const int maxNumPages = 64;
+
+// Number of rows written at once when saving a layer backed table
+const int csvChunkSize = 10000;
+}
+
 ComponentTableModel::ComponentTableModel(QObject *parent) : QAbstractTableModel(parent)
 {    
     numRows = 0;
@@ -60,6 +80,8 @@ ComponentTableModel::~ComponentTableModel()
 // Create a method to populate the model with data:
 void ComponentTableModel::populateData(const QVector<QStringList>& data, const QStringList& header)
 {
+    this->clear();
+
     tableData = data;
     headerStringList = header;
 
@@ -72,6 +94,58 @@ void ComponentTableModel::populateData(const QVector<QStringList>& data, const Q
 }
 
 
+void ComponentTableModel::populateData(QgsVectorLayer* vectorLayer)
+{
+    this->populateFromLayer(vectorLayer);
+
+    emit layoutChanged();
+}
+
+
+void ComponentTableModel::populateFromLayer(QgsVectorLayer* vectorLayer)
+{
+    this->clear();
+
+    if(vectorLayer == nullptr)
+        return;
+
+    layer = vectorLayer;
+
+    auto fields = layer->fields();
+    for(int i = 0; i<fields.size(); ++i)
+        headerStringList.push_back(fields.at(i).name());
+
+    // Only the feature ids are read here, the attributes are fetched when the rows are shown
+    auto numFeatures = layer->featureCount();
+    if(numFeatures > 0)
+    {
+        rowFids.reserve(numFeatures);
+        fidRows.reserve(numFeatures);
+    }
+
+    QgsFeatureRequest request;
+    request.setFlags(QgsFeatureRequest::NoGeometry);
+    request.setNoAttributes();
+
+    auto features = layer->getFeatures(request);
+
+    QgsFeature feat;
+    while (features.nextFeature(feat))
+    {
+        fidRows.insert(feat.id(), rowFids.size());
+        rowFids.push_back(feat.id());
+    }
+
+    numRows = rowFids.size();
+    numCols = headerStringList.size();
+
+    connect(layer, &QgsVectorLayer::updatedFields, this, &ComponentTableModel::handleLayerFieldsChanged);
+    connect(layer, &QgsVectorLayer::attributeValueChanged, this, &ComponentTableModel::handleLayerAttributeValueChanged);
+    connect(layer, &QgsVectorLayer::dataChanged, this, &ComponentTableModel::handleLayerDataChanged);
+    connect(layer, &QObject::destroyed, this, &ComponentTableModel::handleLayerDestroyed);
+}
+
+
 void ComponentTableModel::clear(void)
 {
     numRows = 0;
@@ -79,6 +153,201 @@ void ComponentTableModel::clear(void)
 
     tableData.clear();
     headerStringList.clear();
+
+    if(layer)
+        disconnect(layer, nullptr, this, nullptr);
+
+    layer = nullptr;
+    rowFids.clear();
+    fidRows.clear();
+    this->clearLayerCache();
+}
+
+
+void ComponentTableModel::clearLayerCache(void) const
+{
+    featurePages.clear();
+    pageQueue.clear();
+}
+
+
+const QgsAttributes& ComponentTableModel::getRowAttributes(const int row) const
+{
+    const auto page = row/pageSize;
+
+    auto it = featurePages.constFind(page);
+
+    if(it == featurePages.constEnd())
+    {
+        const auto begin = page*pageSize;
+        const auto end = std::min(begin+pageSize,numRows);
+
+        QgsFeatureIds pageFids;
+        for(int i = begin; i<end; ++i)
+            pageFids.insert(rowFids.at(i));
+
+        QgsFeatureRequest request;
+        request.setFilterFids(pageFids);
+        request.setFlags(QgsFeatureRequest::NoGeometry);
+
+        QHash<QgsFeatureId, QgsAttributes> attributesByFid;
+        attributesByFid.reserve(end-begin);
+
+        auto features = layer->getFeatures(request);
+
+        QgsFeature feat;
+        while (features.nextFeature(feat))
+            attributesByFid.insert(feat.id(),feat.attributes());
+
+        QVector<QgsAttributes> pageRows(end-begin);
+        for(int i = begin; i<end; ++i)
+            pageRows[i-begin] = attributesByFid.value(rowFids.at(i));
+
+        if(pageQueue.size() >= maxNumPages)
+            featurePages.remove(pageQueue.takeFirst());
+
+        pageQueue.push_back(page);
+        it = featurePages.insert(page,pageRows);
+    }
+
+    return it.value().at(row-page*pageSize);
+}
+
+
+void ComponentTableModel::handleLayerFieldsChanged(void)
+{
+    auto vectorLayer = layer.data();
+
+    beginResetModel();
+    this->populateFromLayer(vectorLayer);
+    endResetModel();
+}
+
+
+void ComponentTableModel::handleLayerDestroyed(void)
+{
+    beginResetModel();
+    this->clear();
+    endResetModel();
+}
+
+
+void ComponentTableModel::handleLayerAttributeValueChanged(QgsFeatureId fid, int idx, const QVariant& value)
+{
+    auto row = fidRows.value(fid, -1);
+
+    if(row == -1 || idx < 0 || idx >= numCols)
+        return;
+
+    // The cached row gets the new value so that a paste of many cells does not read the page again for every cell
+    const auto page = row/pageSize;
+
+    auto it = featurePages.find(page);
+    if(it != featurePages.end())
+    {
+        auto& attributes = it.value()[row-page*pageSize];
+
+        if(idx < attributes.size())
+            attributes[idx] = value;
+    }
+
+    emit dataChanged(this->index(row,0),this->index(row,numCols-1));
+}
+
+
+void ComponentTableModel::handleLayerDataChanged(void)
+{
+    if(numRows == 0 || numCols == 0)
+        return;
+
+    this->clearLayerCache();
+
+    emit dataChanged(this->index(0,0),this->index(numRows-1,numCols-1));
+}
+
+
+QgsVectorLayer* ComponentTableModel::getLayer(void) const
+{
+    return layer.data();
+}
+
+
+QgsFeatureId ComponentTableModel::getRowFid(const int row) const
+{
+    return rowFids.value(row,FID_NULL);
+}
+
+
+int ComponentTableModel::saveCSVFile(const QString& pathToFile, QString& err)
+{
+    return this->createCSVFileWriter(pathToFile)(err);
+}
+
+
+std::function<int(QString&)> ComponentTableModel::createCSVFileWriter(const QString& pathToFile) const
+{
+    if(!layer)
+    {
+        auto data = tableData;
+        data.push_front(headerStringList);
+
+        return [data, pathToFile](QString& err)
+        {
+            CSVReaderWriter csvTool;
+            return csvTool.saveCSVFile(data,pathToFile,err);
+        };
+    }
+
+    // The feature source is a snapshot of the layer, including the edits in the edit buffer, that can be read in any thread
+    auto source = std::make_shared<QgsVectorLayerFeatureSource>(layer.data());
+
+    auto header = headerStringList;
+    auto numColumns = numCols;
+
+    return [source, header, numColumns, pathToFile](QString& err)
+    {
+        CSVReaderWriter csvTool;
+
+        auto res = csvTool.saveCSVFile(QVector<QStringList>{header},pathToFile,err);
+        if(res != 0)
+            return res;
+
+        // Stream the features from the snapshot
+        QgsFeatureRequest request;
+        request.setFlags(QgsFeatureRequest::NoGeometry);
+
+        auto features = source->getFeatures(request);
+
+        QVector<QStringList> chunk;
+        chunk.reserve(csvChunkSize);
+
+        QgsFeature feat;
+        while (features.nextFeature(feat))
+        {
+            QStringList row;
+            row.reserve(numColumns);
+
+            auto attributes = feat.attributes();
+            for(int i = 0; i<numColumns; ++i)
+                row.push_back(attributes.value(i).toString());
+
+            chunk.push_back(row);
+
+            if(chunk.size() == csvChunkSize)
+            {
+                res = csvTool.saveCSVFile(chunk,pathToFile,err,true);
+                if(res != 0)
+                    return res;
+
+                chunk.clear();
+            }
+        }
+
+        if(!chunk.isEmpty())
+            res = csvTool.saveCSVFile(chunk,pathToFile,err,true);
+
+        return res;
+    };
 }
 
 
@@ -96,6 +365,10 @@ Qt::ItemFlags ComponentTableModel::flags(const QModelIndex &index) const
 int ComponentTableModel::rowCount(const QModelIndex &parent) const
 {
     Q_UNUSED(parent);
+
+    if(layer)
+        return numRows;
+
     return tableData.size();
 }
 
@@ -104,6 +377,9 @@ int ComponentTableModel::columnCount(const QModelIndex &parent) const
 {
     Q_UNUSED(parent);
 
+    if(layer)
+        return numCols;
+
     if(tableData.isEmpty())
         return 0;
 
@@ -136,16 +412,156 @@ bool ComponentTableModel::setData(const QModelIndex &index, const QVariant &valu
 
     auto strVal = value.toString();
 
-    if(!strVal.isEmpty())
+    if(strVal.isEmpty())
+        return true;
+
+    if(layer)
+    {
+        // Put the change in the edit buffer, the source of the layer is only changed if the edits are saved
+        if(!layer->isEditable() && !layer->startEditing())
+            return false;
+
+        auto newVal = value;
+        if(!layer->fields().at(col).convertCompatible(newVal))
+            return false;
+
+        if(!layer->changeAttributeValue(rowFids.at(row),col,newVal))
+            return false;
+    }
+    else
     {
         tableData[row][col] = strVal;
-        emit handleCellChanged(row,col);
     }
 
+    emit handleCellChanged(row,col);
+
     return true;
 }
 
 
+bool ComponentTableModel::setValues(const int row, const int col, const QVector<QStringList>& values, QString& err)
+{
+    if(col>= numCols || row>= numRows || row < 0 || col < 0)
+    {
+        err = "Error, the cell where the values start is outside of the table";
+        return false;
+    }
+
+    bulkEditOldValues.clear();
+    bulkEditOnLayer = false;
+
+    emit bulkEditStarted();
+
+    if(layer)
+    {
+        if(!layer->isEditable() && !layer->startEditing())
+        {
+            err = "Error, could not start editing the layer "+layer->name();
+            emit bulkEditFinished(err);
+            return false;
+        }
+
+        layer->beginEditCommand("Set values");
+    }
+
+    // The values that do not fit in the table are skipped
+    const auto lastRow = std::min(numRows, row+values.size())-1;
+    auto lastCol = col;
+
+    for(int i = row; i<=lastRow && err.isEmpty(); ++i)
+    {
+        const auto& rowValues = values.at(i-row);
+        const auto end = std::min(numCols, col+rowValues.size());
+
+        for(int j = col; j<end; ++j)
+        {
+            const auto& strVal = rowValues.at(j-col);
+
+            // An empty value leaves the cell as it is, as in setData
+            if(strVal.isEmpty())
+                continue;
+
+            if(layer)
+            {
+                QVariant newVal(strVal);
+                if(!layer->fields().at(j).convertCompatible(newVal) || !layer->changeAttributeValue(rowFids.at(i),j,newVal))
+                {
+                    err = "Error, could not set the value "+strVal+" in the row "+QString::number(i+1)+" of the column "+headerStringList.at(j);
+                    break;
+                }
+            }
+            else
+            {
+                bulkEditOldValues.push_back({i, j, tableData.at(i).at(j)});
+                tableData[i][j] = strVal;
+            }
+
+            lastCol = std::max(lastCol, j);
+
+            emit handleCellChanged(i,j);
+        }
+    }
+
+    if(layer)
+    {
+        // Destroying the command puts back the values that were already changed in the edit buffer
+        if(err.isEmpty())
+        {
+            layer->endEditCommand();
+            bulkEditOnLayer = true;
+        }
+        else
+        {
+            layer->destroyEditCommand();
+        }
+    }
+    else
+    {
+        if(!err.isEmpty())
+            this->restoreBulkEditValues();
+
+        // The cells of a layer backed table are refreshed by the attribute change signals of the layer
+        emit dataChanged(this->index(row,col),this->index(lastRow,lastCol));
+    }
+
+    emit bulkEditFinished(err);
+
+    return err.isEmpty();
+}
+
+
+void ComponentTableModel::revertBulkEdit(void)
+{
+    if(layer)
+    {
+        if(bulkEditOnLayer)
+            layer->undoStack()->undo();
+    }
+    else
+    {
+        this->restoreBulkEditValues();
+    }
+
+    bulkEditOnLayer = false;
+}
+
+
+void ComponentTableModel::restoreBulkEditValues(void)
+{
+    // Go backwards so that a cell that was set more than once gets its first value back
+    for(int i = bulkEditOldValues.size()-1; i>=0; --i)
+    {
+        const auto& cell = bulkEditOldValues.at(i);
+
+        tableData[cell.row][cell.col] = cell.value;
+
+        emit dataChanged(this->index(cell.row,cell.col),this->index(cell.row,cell.col));
+    }
+
+    bulkEditOldValues.clear();
+}
+
+
 QVariant ComponentTableModel::headerData(int section, Qt::Orientation orientation, int role) const
 {
     if(headerStringList.isEmpty())
@@ -163,6 +579,9 @@ QVariant ComponentTableModel::item(const int row, const int col) const
     if(col>= numCols || row>= numRows || row < 0 || col < 0)
         return QVariant();
 
+    if(layer)
+        return this->getRowAttributes(row).value(col);
+
     return tableData[row][col];
 }
 
@@ -38,7 +38,15 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 // Written by: Dr. Stevan Gavrilovic, UC Berkeley
 
+#include <qgsfeature.h>
+
 #include <QAbstractTableModel>
+#include <QHash>
+#include <QPointer>
+
+#include <functional>
+
+class QgsVectorLayer;
 
 class ComponentTableModel : public QAbstractTableModel
 {
@@ -55,8 +63,19 @@ public:
 
     bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole)  Q_DECL_OVERRIDE;
 
+    // Sets a block of cells starting at the row and column, e.g., the rows of tab separated values pasted from a spreadsheet
+    // The block is framed by bulkEditStarted and bulkEditFinished so that the listeners of handleCellChanged can batch their updates
+    // The cells are left as they were if one of the values cannot be set
+    bool setValues(const int row, const int col, const QVector<QStringList>& values, QString& err);
+
+    // Puts back the cells of the last block of values that was set, e.g., when a listener could not apply the changes
+    void revertBulkEdit(void);
+
     void populateData(const QVector<QStringList>& data, const QStringList& header);
 
+    // Shows the attributes of the layer without copying them, the rows are read from the layer in pages that are cached and edits go into the edit buffer of the layer
+    void populateData(QgsVectorLayer* layer);
+
     int rowCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
 
     int columnCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
@@ -69,15 +88,73 @@ public:
 
     QStringList getHeaderStringList() const;
 
+    // Returns the layer if the model is backed by a layer, otherwise nullptr
+    QgsVectorLayer* getLayer(void) const;
+
+    // Returns the feature id of the row in a layer backed table, otherwise FID_NULL
+    QgsFeatureId getRowFid(const int row) const;
+
+    // Saves the table including the header row to a csv file, a layer backed table is written in chunks of rows
+    int saveCSVFile(const QString& pathToFile, QString& err);
+
+    // Returns a function that saves the table like saveCSVFile, the data is snapshotted now so the function can be called later in any thread
+    std::function<int(QString&)> createCSVFileWriter(const QString& pathToFile) const;
+
 signals:
 
     void handleCellChanged(int row, int col);
 
+    void bulkEditStarted(void);
+
+    // The error is empty if all of the values were set
+    void bulkEditFinished(const QString& err);
+
+private slots:
+
+    void handleLayerFieldsChanged(void);
+    void handleLayerAttributeValueChanged(QgsFeatureId fid, int idx, const QVariant& value);
+    void handleLayerDataChanged(void);
+    void handleLayerDestroyed(void);
+
 private:
 
+    // Sets up the model for the layer without emitting any signals, the callers emit the signals that fit
+    void populateFromLayer(QgsVectorLayer* vectorLayer);
+
+    // Returns the attributes of a row in a layer backed table, fetching the page that the row is on if it is not cached
+    const QgsAttributes& getRowAttributes(const int row) const;
+
+    void clearLayerCache(void) const;
+
+    // Puts back the old values of the cells of a table that is not backed by a layer
+    void restoreBulkEditValues(void);
+
     QVector<QStringList> tableData;
     QStringList headerStringList;
 
+    QPointer<QgsVectorLayer> layer;
+
+    // The feature ids of the rows in the order of the layer, and the row of each feature id
+    QVector<QgsFeatureId> rowFids;
+    QHash<QgsFeatureId, int> fidRows;
+
+    // Cache of pages of rows, the oldest page is dropped when the cache is full
+    mutable QHash<int, QVector<QgsAttributes>> featurePages;
+    mutable QList<int> pageQueue;
+
+    // The old values of the cells of the last bulk edit of a table that is not backed by a layer
+    struct CellValue
+    {
+        int row;
+        int col;
+        QString value;
+    };
+
+    QVector<CellValue> bulkEditOldValues;
+
+    // True if the last bulk edit is the top command of the undo stack of the layer
+    bool bulkEditOnLayer = false;
+
     int numRows;
     int numCols;
 };
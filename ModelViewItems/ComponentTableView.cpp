@@ -40,7 +40,10 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "ComponentTableView.h"
 #include "VisualizationWidget.h"
 
+#include <QApplication>
+#include <QClipboard>
 #include <QDebug>
+#include <QKeyEvent>
 #include <QMenu>
 #include <QVariant>
 #include <QHeaderView>
@@ -104,3 +107,48 @@ QVariant ComponentTableView::item(int row, int col)
 {
     return tableModel->item(row,col);
 }
+
+
+void ComponentTableView::keyPressEvent(QKeyEvent *event)
+{
+    if(event->matches(QKeySequence::Paste) && this->currentIndex().isValid())
+    {
+        this->pasteValues();
+        event->accept();
+        return;
+    }
+
+    QTableView::keyPressEvent(event);
+}
+
+
+void ComponentTableView::pasteValues(void)
+{
+    auto text = QApplication::clipboard()->text();
+
+    if(text.isEmpty())
+        return;
+
+    // Spreadsheets copy the cells as rows of tab separated values that end with a new line
+    auto lines = text.split('\n');
+
+    if(lines.last().isEmpty())
+        lines.removeLast();
+
+    QVector<QStringList> values;
+    values.reserve(lines.size());
+
+    for(auto&& line : lines)
+    {
+        if(line.endsWith('\r'))
+            line.chop(1);
+
+        values.push_back(line.split('\t'));
+    }
+
+    // The errors are reported by the listeners of the model
+    auto index = this->currentIndex();
+
+    QString err;
+    tableModel->setValues(index.row(), index.column(), values, err);
+}
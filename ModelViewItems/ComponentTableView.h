@@ -63,8 +63,15 @@ public:
 
     QVariant item(int row, int col);
 
+protected:
+
+    // Pastes the rows of tab separated values in the clipboard at the current cell
+    void keyPressEvent(QKeyEvent *event) Q_DECL_OVERRIDE;
+
 private:
 
+    void pasteValues(void);
+
     ComponentTableModel* tableModel;
 };
 
@@ -263,11 +263,7 @@ void CustomListWidget::showPopup(const QPoint &position)
 
     auto itemIndex = this->indexAt(position);
 
-    auto itemName = itemIndex.data(0).toString();
-
-    auto parentName = itemIndex.parent().data(0).toString();
-
-    TreeItem *item = treeModel->getTreeItem(itemName,parentName);
+    TreeItem *item = this->getItem(itemIndex);
 
     if (!item)
         return;
@@ -324,7 +320,8 @@ void CustomListWidget::update()
 {
     auto childVec = treeModel->getAllChildren();
 
-    std::function<void(TreeItem* item)> nestedUpdater = [](TreeItem* item){
+    // Only the rows whose text changes are updated in the view
+    std::function<void(TreeItem* item)> nestedUpdater = [this](TreeItem* item){
 
         auto childItems = item->getChildItems();
 
@@ -345,7 +342,7 @@ void CustomListWidget::update()
 
             QString newItemText = QString::number(rowNum+1) + ". " + modelStr + " - weight="+ weightStr;
 
-            it->setData(newItemText,0);
+            treeModel->setItemText(it, newItemText);
         }
     };
 
@@ -172,11 +172,24 @@ TreeItem* ListTreeModel::addItemToTree(const QString itemText, TreeItem* parent)
     // Create a unique ID for the item as some items may have the same name
     auto id = QUuid::createUuid().toString();
 
+    auto row = parent->childCount();
+
+    beginInsertRows(this->getIndex(parent), row, row);
+
     auto childItem = new TreeItem(childText,id, parent);
 
     parent->appendChild(childItem);
 
-    emit layoutChanged();
+    itemsByID.insert(id, childItem);
+
+    endInsertRows();
+
+    // Keep the index valid if the item is deleted by its parent instead of through the model
+    connect(childItem, &QObject::destroyed, this, [this, id, childItem]()
+    {
+        if(itemsByID.value(id) == childItem)
+            itemsByID.remove(id);
+    });
 
     return childItem;
 }
@@ -184,129 +197,113 @@ TreeItem* ListTreeModel::addItemToTree(const QString itemText, TreeItem* parent)
 
 TreeItem *ListTreeModel::getItem(const QString& itemID) const
 {
-    std::function<TreeItem*(TreeItem*, const QString&)> nestedItemFinder = [&](TreeItem* item, const QString& ID) -> TreeItem*
-    {
-        // First check for this item
-        auto thisItemID = item->getItemID();
+    if(itemID.compare(rootItem->getItemID()) == 0)
+        return rootItem;
 
-        if(ID.compare(thisItemID) == 0)
-            return item;
+    return itemsByID.value(itemID, nullptr);
+}
 
-        // Then check any and all children
-        QVector<TreeItem *> children = item->getChildItems();
-        for(int i = 0; i<children.size(); ++i)
-        {
-            auto child = children.at(i);
-            auto childID = child->getItemID();
 
-            if(ID.compare(childID) == 0)
-                return child;
+QModelIndex ListTreeModel::getIndex(TreeItem* item) const
+{
+    if(item == nullptr || item == rootItem)
+        return QModelIndex();
 
-            auto grandChild = nestedItemFinder(child,ID);
+    return createIndex(item->row(), 0, item);
+}
 
-            if(grandChild)
-                return grandChild;
-        }
 
+void ListTreeModel::setItemText(TreeItem* item, const QString& text)
+{
+    if(item == nullptr || item->data(0).toString() == text)
+        return;
 
-        // if we got this far then item not found
-        return nullptr;
-    };
+    QString newText = text;
+    item->setData(newText, 0);
 
-    auto res = nestedItemFinder(rootItem, itemID);
+    auto index = this->getIndex(item);
 
-    return res;
+    emit dataChanged(index, index, {Qt::DisplayRole});
 }
 
 
-bool ListTreeModel::removeItemFromTree(const QString& itemID)
+void ListTreeModel::removeFromIndex(TreeItem* item)
 {
-    std::function<bool(TreeItem*, const QString&)> nestedDeleter = [&](TreeItem* item, const QString& ID)
-    {
-        QVector<TreeItem *> children = item->getChildItems();
-
-        auto index = -1;
-        for(int i = 0; i<children.size(); ++i)
-        {
-            auto child = children.at(i);
+    itemsByID.remove(item->getItemID());
 
-            auto childID = child->getItemID();
+    for(auto&& child : item->getChildItems())
+        this->removeFromIndex(child);
+}
 
-            if(ID.compare(childID) == 0)
-            {
-                index = i;
-                break;
-            }
 
-            if(nestedDeleter(child,ID))
-                return true;
-        }
+bool ListTreeModel::removeItemFromTree(const QString& itemID)
+{
+    auto item = itemsByID.value(itemID, nullptr);
 
-        if(index > -1)
-        {
-            item->removeChild(index);
+    if(item == nullptr)
+        return false;
 
-            return true;
-        }
+    auto parentItem = item->getParentItem();
 
+    if(parentItem == nullptr)
         return false;
 
-    };
+    auto row = item->row();
 
-    auto res = nestedDeleter(rootItem, itemID);
+    beginRemoveRows(this->getIndex(parentItem), row, row);
 
-    emit layoutChanged();
+    this->removeFromIndex(item);
 
-    return res;
+    parentItem->removeChild(row);
+
+    endRemoveRows();
+
+    return true;
 }
 
 
 TreeItem* ListTreeModel::getTreeItem(const QString& itemName, const TreeItem* parent) const
 {
-    QString parentName;
+    if(parent == nullptr)
+        parent = rootItem;
 
-    if(parent != nullptr)
+    for(auto&& child : parent->getChildItems())
     {
-        parentName = parent->getName();
+        if(itemName.compare(child->data(0).toString()) == 0)
+            return child;
     }
 
-    return this->getTreeItem(itemName,parentName);
+    return nullptr;
 }
 
 
 TreeItem* ListTreeModel::getTreeItem(const QString& itemName, const QString& parentName) const
 {
-
-    std::function<TreeItem* (TreeItem*, const QString&, const QString&)> nestedItemFinder = [&](TreeItem* item, const QString& name, const QString& parentName) -> TreeItem*
+    // An item matches if it has the name and is either at the root of the tree or its parent has the parent name
+    // The tree is walked depth first in the order of the rows, not through the hash of the ids, so that the first match is the same every time when names repeat
+    QVector<TreeItem*> stack;
+    auto rootChildren = rootItem->getChildItems();
+    for(auto it = rootChildren.rbegin(); it != rootChildren.rend(); ++it)
+        stack.push_back(*it);
+
+    while(!stack.isEmpty())
     {
-        auto thisItemParent = item->getParentItem();
-
-        // Check if this is the item
-        auto thisItemName = item->data(0).toString();
-        if(name.compare(thisItemName) == 0 )
-        {
-            auto thisItemParentName = thisItemParent->getName();
-            if(thisItemParent == rootItem || parentName.compare(thisItemParentName) == 0)
-                return item;
-        }
-
+        auto item = stack.takeLast();
 
-        // Now check the children of this item
-        QVector<TreeItem *> children = item->getChildItems();
-        for(int i = 0; i<children.size(); ++i)
+        if(itemName.compare(item->data(0).toString()) == 0)
         {
-            auto child = children.at(i);
+            auto thisItemParent = item->getParentItem();
 
-            // Check the childrens children
-            if(auto foundChild = nestedItemFinder(child,name, parentName))
-                return foundChild;
+            if(thisItemParent == rootItem || parentName.compare(thisItemParent->getName()) == 0)
+                return item;
         }
 
-        // Return a null item if none is found
-        return nullptr;
-    };
+        auto children = item->getChildItems();
+        for(auto it = children.rbegin(); it != children.rend(); ++it)
+            stack.push_back(*it);
+    }
 
-    return nestedItemFinder(rootItem, itemName, parentName);
+    return nullptr;
 }
 
 
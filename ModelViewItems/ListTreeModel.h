@@ -39,9 +39,13 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 // Written by: Stevan Gavrilovic
 
 #include <QAbstractItemModel>
+#include <QHash>
 
 class TreeItem;
 
+// The items are indexed by their unique ID so that finding an item does not search through the tree
+// Adding, removing and renaming items only notifies the views of the rows that changed
+
 class ListTreeModel : public QAbstractItemModel
 {
     Q_OBJECT
@@ -70,12 +74,20 @@ public:
 
     TreeItem *getItem(const QString& itemID) const;
 
+    // Returns the model index of the item, or an invalid index for the root item
+    QModelIndex getIndex(TreeItem* item) const;
+
+    // Sets the text of the item and updates the views of that row only
+    void setItemText(TreeItem* item, const QString& text);
+
     // If parent item is not provided, the item will get added to the root of the tree
     TreeItem* addItemToTree(const QString itemText, TreeItem* parent = nullptr);
 
     bool removeItemFromTree(const QString& itemID);
 
     TreeItem *getTreeItem(const QString& itemName, const QString& parentName) const;
+
+    // Only searches the children of the parent, or the items at the root of the tree if a parent is not provided
     TreeItem* getTreeItem(const QString& itemName, const TreeItem* parent) const;
 
     bool moveRows(const QModelIndex &srcParent, int srcRow, int count, const QModelIndex &dstParent, int dstChild) override;
@@ -95,7 +107,13 @@ signals:
     void rowPositionChanged(const int oldPos, const int newPos);
 
 private:
+
+    // Removes the item and all of its children from the index
+    void removeFromIndex(TreeItem* item);
+
     TreeItem *rootItem;
+
+    QHash<QString, TreeItem*> itemsByID;
 };
 
 #endif // ListTreeModel_H
@@ -99,15 +99,33 @@ SOURCES +=  $$PWD/Events/UI/EarthquakeRuptureForecast.cpp \
             $$PWD/ModelViewItems/CustomListWidget.cpp \
             $$PWD/Tools/AssetInputDelegate.cpp \
             $$PWD/Tools/AssetFilterDelegate.cpp \
+            $$PWD/Tools/AssetFilterEngine.cpp \
+            $$PWD/Tools/AssetInventoryCache.cpp \
             $$PWD/Tools/ComponentDatabase.cpp \
+            $$PWD/Tools/ComponentTableEditor.cpp \
             $$PWD/Tools/CSVReaderWriter.cpp \
             $$PWD/Tools/GeoJSONReaderWriter.cpp \
+            $$PWD/Tools/GroundMotionModels.cpp \
+            $$PWD/Tools/GMPEEngine.cpp \
+            $$PWD/Tools/FaultRuptureSet.cpp \
+            $$PWD/Tools/HurricaneWindFieldModel.cpp \
+            $$PWD/Tools/SiteResponseEngine.cpp \
+            $$PWD/Tools/SpatialJoinEngine.cpp \
+            $$PWD/Tools/StationLayerBuilder.cpp \
             $$PWD/Tools/ComponentDatabaseManager.cpp \
             $$PWD/Tools/NGAW2Converter.cpp \
+            $$PWD/Tools/NGAW2RecordCache.cpp \
+            $$PWD/Tools/OpenQuakeSourceModel.cpp \
+            $$PWD/Tools/OQAttributeColumn.cpp \
     $$PWD/Tools/Pelicun3PostProcessor.cpp \
             $$PWD/Tools/PelicunPostProcessor.cpp \
             $$PWD/Tools/CBCitiesPostProcessor.cpp \
             $$PWD/Tools/REmpiricalProbabilityDistribution.cpp \
+            $$PWD/Tools/ReportWriter.cpp \
+            $$PWD/Tools/NetworkInventoryLoader.cpp \
+            $$PWD/Tools/StagingQueue.cpp \
+            $$PWD/Tools/TaskRunner.cpp \
+            $$PWD/Tools/UnitConvertedTable.cpp \
             $$PWD/Tools/TablePrinter.cpp \
             $$PWD/Tools/XMLAdaptor.cpp \
             $$PWD/UIWidgets/AnalysisWidget.cpp \
@@ -222,15 +240,33 @@ HEADERS +=  $$PWD/Events/UI/EarthquakeRuptureForecast.h \
             $$PWD/Events/UI/Vs30Widget.h \
             $$PWD/Tools/AssetInputDelegate.h \
             $$PWD/Tools/AssetFilterDelegate.h \
+            $$PWD/Tools/AssetFilterEngine.h \
+            $$PWD/Tools/AssetInventoryCache.h \
             $$PWD/Tools/ComponentDatabase.h \
+            $$PWD/Tools/ComponentTableEditor.h \
             $$PWD/Tools/CSVReaderWriter.h \
             $$PWD/Tools/GeoJSONReaderWriter.h \
+            $$PWD/Tools/GroundMotionModels.h \
+            $$PWD/Tools/GMPEEngine.h \
+            $$PWD/Tools/FaultRuptureSet.h \
+            $$PWD/Tools/HurricaneWindFieldModel.h \
+            $$PWD/Tools/SiteResponseEngine.h \
+            $$PWD/Tools/SpatialJoinEngine.h \
+            $$PWD/Tools/StationLayerBuilder.h \
             $$PWD/Tools/ComponentDatabaseManager.h \
             $$PWD/Tools/NGAW2Converter.h \
+            $$PWD/Tools/NGAW2RecordCache.h \
+            $$PWD/Tools/OpenQuakeSourceModel.h \
+            $$PWD/Tools/OQAttributeColumn.h \
     $$PWD/Tools/Pelicun3PostProcessor.h \
             $$PWD/Tools/PelicunPostProcessor.h \
             $$PWD/Tools/CBCitiesPostProcessor.h \
             $$PWD/Tools/REmpiricalProbabilityDistribution.h \
+            $$PWD/Tools/ReportWriter.h \
+            $$PWD/Tools/NetworkInventoryLoader.h \
+            $$PWD/Tools/StagingQueue.h \
+            $$PWD/Tools/TaskRunner.h \
+            $$PWD/Tools/UnitConvertedTable.h \
             $$PWD/Tools/TableNumberItem.h \
             $$PWD/Tools/TablePrinter.h \
             $$PWD/Tools/XMLAdaptor.h \
@@ -37,15 +37,183 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 // Created by: Dr. Stevan Gavrilovic, UC Berkeley
 
 #include "AgaveCurl.h"
+#include "AssetFilterEngine.h"
 #include "WorkflowAppR2D.h"
 #include "MainWindowWorkflowApp.h"
 #include "LocalApplication.h"
 #include "SimCenterPreferences.h"
+#include "GMPEEngine.h"
+#include "GmCommon.h"
+#include "NGAW2RecordCache.h"
+#include "PeerNgaWest2Client.h"
+
+#include <qgsexpression.h>
+#include <qgsexpressioncontext.h>
+#include <qgsvectordataprovider.h>
+#include <qgsvectorlayer.h>
 
 #include <QRegExp>
 #include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStandardPaths>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QTimer>
+#include <QUrlQuery>
 #include <QtTest/QtTest>
 
+namespace
+{
+
+// A local stand-in for the PEER NGA West 2 server, it answers the requests of a record download the same way as the server does
+// The RSNs of every search are kept so that the batches that reached the server can be checked
+class PeerServerStandIn
+{
+public:
+    PeerServerStandIn()
+    {
+        QObject::connect(&server, &QTcpServer::newConnection, &server, [this]()
+        {
+            while(auto socket = server.nextPendingConnection())
+            {
+                QObject::connect(socket, &QTcpSocket::readyRead, socket, [this, socket]()
+                {
+                    this->readRequest(socket);
+                });
+
+                QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            }
+        });
+    }
+
+    bool listen(void)
+    {
+        return server.listen(QHostAddress::LocalHost);
+    }
+
+    QUrl getUrl(void) const
+    {
+        return QUrl("http://127.0.0.1:" + QString::number(server.serverPort()));
+    }
+
+    QVector<QStringList> searches;
+
+private:
+
+    void readRequest(QTcpSocket* socket)
+    {
+        auto& buffer = buffers[socket];
+        buffer.append(socket->readAll());
+
+        auto headerEnd = buffer.indexOf("\r\n\r\n");
+        if(headerEnd < 0)
+            return;
+
+        auto headerLines = buffer.left(headerEnd).split('\n');
+
+        int contentLength = 0;
+        for(auto&& it : headerLines)
+        {
+            auto line = it.trimmed();
+            if(line.toLower().startsWith("content-length:"))
+                contentLength = line.mid(15).trimmed().toInt();
+        }
+
+        // Wait for the rest of the body
+        if(buffer.size() < headerEnd + 4 + contentLength)
+            return;
+
+        auto requestLine = headerLines.first().trimmed().split(' ');
+        auto body = buffer.mid(headerEnd + 4, contentLength);
+
+        buffers.remove(socket);
+
+        if(requestLine.size() < 2)
+        {
+            this->reply(socket, "400 Bad Request");
+            return;
+        }
+
+        this->handleRequest(socket, requestLine.at(0), QString(requestLine.at(1)), body);
+    }
+
+
+    void handleRequest(QTcpSocket* socket, const QByteArray& method, const QString& path, const QByteArray& body)
+    {
+        auto baseUrl = this->getUrl().toString();
+
+        if(method == "GET" && path == "/users/sign_in")
+        {
+            this->reply(socket, "200 OK", QByteArray(), "<form>\n<div><input name=\"authenticity_token\" type=\"hidden\" value=\"standInToken\" /></div>\n</form>\n");
+        }
+        else if(method == "POST" && path == "/users/sign_in")
+        {
+            this->reply(socket, "302 Found", (baseUrl + "/").toUtf8());
+        }
+        else if(method == "POST" && path == "/spectras")
+        {
+            this->reply(socket, "302 Found", (baseUrl + "/spectras/1/edit").toUtf8());
+        }
+        else if(method == "POST" && path == "/spectras/1/searches")
+        {
+            QUrlQuery params(QString::fromUtf8(body));
+            auto records = params.queryItemValue("search[search_nga_number]", QUrl::FullyDecoded).split(",", Qt::SkipEmptyParts);
+
+            searches.push_back(records);
+
+            auto searchId = QString::number(searches.size());
+            this->reply(socket, "302 Found", (baseUrl + "/spectras/1/searches/" + searchId + "/edit").toUtf8());
+        }
+        else if(method == "GET" && path.startsWith("/spectras/1/searches/") && path.endsWith("/?getRecords=1"))
+        {
+            auto searchId = path.section('/', 4, 4);
+            this->reply(socket, "200 OK", QByteArray(), ("window.location.href = \"/downloads/" + searchId + ".zip\";").toUtf8());
+        }
+        else if(method == "GET" && path.startsWith("/downloads/"))
+        {
+            // The records of the search stand in for the zip file
+            auto searchId = QFileInfo(path).baseName().toInt();
+
+            if(searchId < 1 || searchId > searches.size())
+            {
+                this->reply(socket, "404 Not Found");
+                return;
+            }
+
+            this->reply(socket, "200 OK", QByteArray(), searches.at(searchId-1).join(",").toUtf8());
+        }
+        else
+        {
+            this->reply(socket, "404 Not Found");
+        }
+    }
+
+
+    void reply(QTcpSocket* socket, const QByteArray& status, const QByteArray& location = QByteArray(), const QByteArray& body = QByteArray())
+    {
+        QByteArray response = "HTTP/1.1 " + status + "\r\n";
+
+        if(!location.isEmpty())
+            response += "Location: " + location + "\r\n";
+
+        response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+        response += "Connection: close\r\n\r\n";
+        response += body;
+
+        socket->write(response);
+        socket->disconnectFromHost();
+    }
+
+    QTcpServer server;
+    QHash<QTcpSocket*, QByteArray> buffers;
+};
+
+}
+
+
 class R2DUnitTests: public QObject
 {
 
@@ -78,6 +246,9 @@ public:
 
 private slots:
     void testExamples();
+    void testJayaramBakerRange();
+    void testNGAW2RecordDownload();
+    void testAssetFilterEngine();
 
 private:
 
@@ -195,6 +366,254 @@ void R2DUnitTests::testExamples()
 }
 
 
+void R2DUnitTests::testJayaramBakerRange()
+{
+    // Below 1 s the range is 8.5 + 17.2*T
+    QCOMPARE(GMPEEngine::getJayaramBakerRange(0.0), 8.5);
+    QCOMPARE(GMPEEngine::getJayaramBakerRange(0.5), 17.1);
+
+    // From 1 s on the range is 22.0 + 3.7*T
+    QCOMPARE(GMPEEngine::getJayaramBakerRange(1.0), 25.7);
+    QCOMPARE(GMPEEngine::getJayaramBakerRange(2.0), 29.4);
+    QCOMPARE(GMPEEngine::getJayaramBakerRange(5.0), 40.5);
+
+    // The two branches meet at 1 s
+    QVERIFY(qAbs(GMPEEngine::getJayaramBakerRange(0.999999) - GMPEEngine::getJayaramBakerRange(1.0)) < 1.0e-4);
+}
+
+
+void R2DUnitTests::testNGAW2RecordDownload()
+{
+    // Keep the record cache of the test out of the cache of the application
+    QStandardPaths::setTestModeEnabled(true);
+
+    QDir cacheDir(GmCommon::getCacheLocation() + QDir::separator() + "NGAWest2Records");
+    cacheDir.removeRecursively();
+
+    QTemporaryDir outputDir;
+    QVERIFY(outputDir.isValid());
+
+    // Records from an earlier run are in the cache
+    QJsonObject cachedRecords;
+    cachedRecords["RSN1"] = QJsonObject({{"name", "RSN1"}, {"dT", 0.01}, {"data_x", QJsonArray({0.1, -0.2, 0.3})}});
+    cachedRecords["RSN5"] = QJsonObject({{"name", "RSN5"}, {"dT", 0.005}, {"data_x", QJsonArray({0.4, 0.5})}});
+
+    QString err;
+    QCOMPARE(NGAW2RecordCache::storeRecords(cachedRecords, err), 0);
+    QVERIFY2(err.isEmpty(), err.toLocal8Bit());
+
+    QStringList RSNs;
+    for(int i = 1; i<=250; ++i)
+        RSNs.append(QString::number(i));
+
+    // Only the records that are not in the cache are downloaded
+    QStringList missingRecords;
+    QCOMPARE(NGAW2RecordCache::restoreRecords(RSNs, outputDir.path(), missingRecords, err), 2);
+    QVERIFY2(err.isEmpty(), err.toLocal8Bit());
+    QCOMPARE(missingRecords.size(), 248);
+    QVERIFY(!missingRecords.contains("1") && !missingRecords.contains("5"));
+
+    QFile restoredFile(QDir(outputDir.path()).filePath("RSN5.json"));
+    QVERIFY(restoredFile.open(QIODevice::ReadOnly));
+    QCOMPARE(QJsonDocument::fromJson(restoredFile.readAll()).object(), cachedRecords["RSN5"].toObject());
+    restoredFile.close();
+
+    // The records are split into searches of at most 99 records, in order
+    QVector<QStringList> batches;
+    QStringList recordsToDownload = missingRecords;
+    while(!recordsToDownload.isEmpty())
+        batches.push_back(PeerNgaWest2Client::takeRecordBatch(recordsToDownload));
+
+    QCOMPARE(batches.size(), 3);
+    QCOMPARE(batches.at(0).size(), 99);
+    QCOMPARE(batches.at(1).size(), 99);
+    QCOMPARE(batches.at(2).size(), 50);
+    QCOMPARE(batches.at(0) + batches.at(1) + batches.at(2), missingRecords);
+
+    // Download the batches with two clients at the same time from the stand-in server
+    PeerServerStandIn server;
+    QVERIFY(server.listen());
+
+    QEventLoop loop;
+    QTimer timeout;
+    timeout.setSingleShot(true);
+    connect(&timeout, &QTimer::timeout, &loop, &QEventLoop::quit);
+
+    QVector<QStringList> pendingBatches = batches;
+    QVector<QStringList> downloadedBatches;
+    int numSignedIn = 0;
+
+    PeerNgaWest2Client client1;
+    PeerNgaWest2Client client2;
+
+    for(auto client : {&client1, &client2})
+    {
+        client->setServerUrl(server.getUrl());
+
+        connect(client, &PeerNgaWest2Client::loginFinished, &loop, [&, client](bool result)
+        {
+            if(!result)
+            {
+                loop.quit();
+                return;
+            }
+
+            ++numSignedIn;
+
+            if(!pendingBatches.isEmpty())
+                client->selectRecords(pendingBatches.takeFirst());
+        });
+
+        connect(client, &PeerNgaWest2Client::recordsDownloaded, &loop, [&, client](QString recordsPath)
+        {
+            QFile file(recordsPath);
+            if(file.open(QIODevice::ReadOnly))
+                downloadedBatches.push_back(QString(file.readAll()).split(","));
+
+            if(!pendingBatches.isEmpty())
+                client->selectRecords(pendingBatches.takeFirst());
+            else if(downloadedBatches.size() == batches.size())
+                loop.quit();
+        });
+
+        client->signIn("user", "password");
+    }
+
+    timeout.start(30000);
+    loop.exec();
+
+    QCOMPARE(numSignedIn, 2);
+    QCOMPARE(downloadedBatches.size(), batches.size());
+    QCOMPARE(server.searches.size(), batches.size());
+
+    // The clients finish in any order, but every batch is searched and downloaded once
+    for(auto&& it : batches)
+    {
+        QCOMPARE(server.searches.count(it), 1);
+        QCOMPARE(downloadedBatches.count(it), 1);
+    }
+
+    // Once the converted records are stored, nothing has to be downloaded again
+    QJsonObject convertedRecords;
+    for(auto&& it : missingRecords)
+        convertedRecords["RSN" + it] = QJsonObject({{"name", "RSN" + it}, {"dT", 0.01}});
+
+    QCOMPARE(NGAW2RecordCache::storeRecords(convertedRecords, err), 0);
+    QVERIFY2(err.isEmpty(), err.toLocal8Bit());
+
+    QTemporaryDir secondRunDir;
+    QVERIFY(secondRunDir.isValid());
+
+    missingRecords.clear();
+    QCOMPARE(NGAW2RecordCache::restoreRecords(RSNs, secondRunDir.path(), missingRecords, err), RSNs.size());
+    QVERIFY(missingRecords.isEmpty());
+
+    cacheDir.removeRecursively();
+    QStandardPaths::setTestModeEnabled(false);
+}
+
+
+void R2DUnitTests::testAssetFilterEngine()
+{
+    // The text field holds numbers as text, text that is not a number, and nulls
+    QgsVectorLayer layer("Point?crs=EPSG:4326&field=ID:integer&field=YearBuilt:integer&field=StructureType:string(20)&field=Area:double", "Filter test", "memory");
+    QVERIFY(layer.isValid());
+
+    const QVariant nullInt(QVariant::Int);
+    const QVariant nullString(QVariant::String);
+    const QVariant nullDouble(QVariant::Double);
+
+    const QVector<QgsAttributes> rows = {
+        {1, 1950, "10", 100.5},
+        {2, 1980, "9", nullDouble},
+        {3, nullInt, "abc", 250.0},
+        {4, 2000, nullString, 75.0},
+        {5, 1965, "10.0", 100.5},
+        {6, 2010, "-3", 0.0},
+        {7, 1990, "W1", -20.0},
+        {8, 1980, "", nullDouble}
+    };
+
+    QgsFeatureList features;
+    for(auto&& it : rows)
+    {
+        QgsFeature feature(layer.fields());
+        feature.setAttributes(it);
+        features.append(feature);
+    }
+
+    QVERIFY(layer.dataProvider()->addFeatures(features));
+
+    const QStringList filters = {
+        "YearBuilt > 1960",
+        "1960 < YearBuilt",
+        "1980 >= YearBuilt",
+        "YearBuilt <> 1980",
+        "Area <= -1",
+        "-20 = Area",
+        "StructureType = 10",
+        "StructureType = '10'",
+        "'10' = StructureType",
+        "10 < StructureType",
+        "StructureType > 5",
+        "StructureType < 'b'",
+        "StructureType IN ('10', 'W1')",
+        "StructureType IN (9, 10)",
+        "StructureType NOT IN ('10', 'abc')",
+        "StructureType NOT IN (10)",
+        "YearBuilt NOT IN (1950, 1980)",
+        "Area IS NULL",
+        "Area IS NOT NULL",
+        "StructureType IS NULL",
+        "NOT (YearBuilt < 1970)",
+        "NOT (StructureType NOT IN ('W1'))",
+        "YearBuilt > 1960 AND Area >= 100",
+        "YearBuilt IS NULL OR StructureType = 'W1'",
+        "NOT (Area > 50 OR YearBuilt = 1980)"
+    };
+
+    AssetFilterEngine engine(&layer);
+
+    for(auto&& filter : filters)
+    {
+        QBitArray rowsPassed;
+        QString err;
+        auto res = engine.filter(filter, rowsPassed, err);
+
+        QVERIFY2(res == 0, ("The filter is not evaluated by the engine: " + filter + " " + err).toLocal8Bit());
+
+        // The rows that pass the same filter in the QGIS expression engine, a null result does not pass
+        QgsExpression expression(filter);
+        QgsExpressionContext context;
+        context.setFields(layer.fields());
+        QVERIFY(expression.prepare(&context));
+
+        QBitArray expectedRows(rows.size());
+
+        auto featIt = layer.getFeatures();
+        QgsFeature feat;
+        int row = 0;
+        while(featIt.nextFeature(feat))
+        {
+            context.setFeature(feat);
+            auto value = expression.evaluate(&context);
+
+            QVERIFY2(!expression.hasEvalError(), (filter + ": " + expression.evalErrorString()).toLocal8Bit());
+
+            expectedRows.setBit(row, !value.isNull() && value.toBool());
+            ++row;
+        }
+
+        QVERIFY2(rowsPassed == expectedRows, ("The rows that pass the filter differ from QGIS: " + filter).toLocal8Bit());
+    }
+
+    // The IDs are given in the order of the features
+    QVector<int> filterIds;
+    QString err;
+    QCOMPARE(engine.filter("StructureType IN (9, 10)", filterIds, err), 0);
+    QCOMPARE(filterIds, QVector<int>({1, 2, 5}));
+}
+
 
 QTEST_MAIN(R2DUnitTests)
 #include "R2DUnitTests.moc"
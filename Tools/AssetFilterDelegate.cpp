@@ -38,13 +38,22 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 #include "AssetFilterDelegate.h"
 
+#include <QDebug>
 #include <QRegExpValidator>
 
 #include <qgsvectorlayer.h>
 
-AssetFilterDelegate::AssetFilterDelegate(QgsVectorLayer *layer) : mainLayer(layer)
+AssetFilterDelegate::AssetFilterDelegate(QgsVectorLayer *layer) : mainLayer(layer), filterEngine(layer)
 {
     qb = std::make_unique<QgsQueryBuilder>(layer);
+
+    // The columns of the filter engine are read again after the attributes change
+    if(layer != nullptr)
+    {
+        connect(layer, &QgsVectorLayer::updatedFields, this, [this](){ filterEngine.clear(); });
+        connect(layer, &QgsVectorLayer::attributeValueChanged, this, [this](){ filterEngine.clear(); });
+        connect(layer, &QgsVectorLayer::dataChanged, this, [this](){ filterEngine.clear(); });
+    }
 }
 
 
@@ -72,6 +81,18 @@ int AssetFilterDelegate::setFilterString(const QString& filter, QVector<int>& fi
     if(filter.isEmpty())
         return 1;
 
+    QString err;
+    auto res = filterEngine.filter(filter, filterIds, err);
+
+    if(res == 0)
+        return 0;
+
+    if(res == -1)
+    {
+        qDebug()<<err;
+        return -1;
+    }
+
     auto fieldIndex = mainLayer->dataProvider()->fieldNameIndex("ID");
 
     if(fieldIndex == -1)
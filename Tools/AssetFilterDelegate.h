@@ -40,6 +40,8 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 class QgsVectorLayer;
 
+#include "AssetFilterEngine.h"
+
 #include <qgsquerybuilder.h>
 
 #include <QObject>
@@ -70,6 +72,9 @@ private:
 
     QgsVectorLayer* mainLayer = nullptr;
 
+    // Evaluates the filters over the attribute columns, filters it does not support are evaluated by QGIS
+    AssetFilterEngine filterEngine;
+
 };
 
 #endif // AssetFilterDelegate_H
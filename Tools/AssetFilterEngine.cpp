@@ -0,0 +1,689 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+#include "AssetFilterEngine.h"
+
+#include <qgsexpression.h>
+#include <qgsfeaturerequest.h>
+#include <qgsvectorlayer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Marks the IDs that are not integers
+const int invalidId = std::numeric_limits<int>::min();
+
+
+AssetFilterEngine::AssetFilterEngine(QgsVectorLayer* layer) : layer(layer)
+{
+
+}
+
+
+int AssetFilterEngine::filter(const QString& filter, QVector<int>& filterIds, QString& err)
+{
+    QBitArray rows;
+    auto res = this->filter(filter, rows, err);
+
+    if(res != 0)
+        return res;
+
+    filterIds.reserve(rows.count(true));
+
+    for(int i = 0; i<numRows; ++i)
+    {
+        if(!rows.testBit(i))
+            continue;
+
+        if(ids.at(i) == invalidId)
+        {
+            err = "The ID of an asset that passes the filter is not an integer";
+            filterIds.clear();
+            return -1;
+        }
+
+        filterIds.push_back(ids.at(i));
+    }
+
+    return 0;
+}
+
+
+int AssetFilterEngine::filter(const QString& filter, QBitArray& rows, QString& err)
+{
+    if(layer == nullptr)
+    {
+        err = "No layer to filter";
+        return -1;
+    }
+
+    // Compile the filter once, re-applying the same filter only evaluates it
+    if(compiledRoot == nullptr || filter != compiledFilter)
+    {
+        QgsExpression expression(filter);
+
+        // Leave filters that do not parse to QGIS so that the behavior does not change
+        if(expression.hasParserError())
+            return 1;
+
+        QSet<int> fieldIndices;
+        auto root = this->compile(expression.rootNode(), fieldIndices);
+
+        if(root == nullptr)
+            return 1;
+
+        compiledFilter = filter;
+        compiledRoot = root;
+        compiledFields = fieldIndices;
+    }
+
+    if(!this->loadColumns(compiledFields, err))
+        return -1;
+
+    Selection selection;
+    if(!this->evaluate(*compiledRoot, selection))
+        return 1;
+
+    rows = selection.isTrue;
+
+    return 0;
+}
+
+
+void AssetFilterEngine::clear(void)
+{
+    numRows = 0;
+    ids.clear();
+    columns.clear();
+
+    compiledFilter.clear();
+    compiledRoot.reset();
+    compiledFields.clear();
+}
+
+
+std::shared_ptr<AssetFilterEngine::FilterNode> AssetFilterEngine::compile(const QgsExpressionNode* node, QSet<int>& fieldIndices) const
+{
+    if(node == nullptr)
+        return nullptr;
+
+    auto fields = layer->fields();
+
+    // Returns the index of the field if the node refers to a field that can be compared here
+    auto getFieldIndex = [&fields](const QgsExpressionNode* node) -> int
+    {
+        if(node->nodeType() != QgsExpressionNode::ntColumnRef)
+            return -1;
+
+        auto index = fields.lookupField(static_cast<const QgsExpressionNodeColumnRef*>(node)->name());
+
+        if(index == -1)
+            return -1;
+
+        switch (fields.at(index).type())
+        {
+        case QVariant::String:
+        case QVariant::Int:
+        case QVariant::UInt:
+        case QVariant::LongLong:
+        case QVariant::ULongLong:
+        case QVariant::Double:
+            return index;
+        default:
+            return -1;
+        }
+    };
+
+    switch (node->nodeType())
+    {
+    case QgsExpressionNode::ntBinaryOperator:
+    {
+        auto binaryNode = static_cast<const QgsExpressionNodeBinaryOperator*>(node);
+        auto op = binaryNode->op();
+
+        if(op == QgsExpressionNodeBinaryOperator::boAnd || op == QgsExpressionNodeBinaryOperator::boOr)
+        {
+            auto left = this->compile(binaryNode->opLeft(), fieldIndices);
+            auto right = this->compile(binaryNode->opRight(), fieldIndices);
+
+            if(left == nullptr || right == nullptr)
+                return nullptr;
+
+            auto filterNode = std::make_shared<FilterNode>();
+            filterNode->type = (op == QgsExpressionNodeBinaryOperator::boAnd) ? FilterNode::Type::And : FilterNode::Type::Or;
+            filterNode->children = {left, right};
+
+            return filterNode;
+        }
+
+        // Only IS NULL and IS NOT NULL
+        if(op == QgsExpressionNodeBinaryOperator::boIs || op == QgsExpressionNodeBinaryOperator::boIsNot)
+        {
+            auto fieldIndex = getFieldIndex(binaryNode->opLeft());
+
+            QVariant value;
+            if(fieldIndex == -1 || !this->getLiteral(binaryNode->opRight(), value) || !value.isNull())
+                return nullptr;
+
+            auto filterNode = std::make_shared<FilterNode>();
+            filterNode->type = FilterNode::Type::IsNull;
+            filterNode->negate = (op == QgsExpressionNodeBinaryOperator::boIsNot);
+            filterNode->fieldIndex = fieldIndex;
+
+            fieldIndices.insert(fieldIndex);
+
+            return filterNode;
+        }
+
+        if(op != QgsExpressionNodeBinaryOperator::boEQ && op != QgsExpressionNodeBinaryOperator::boNE &&
+                op != QgsExpressionNodeBinaryOperator::boLT && op != QgsExpressionNodeBinaryOperator::boLE &&
+                op != QgsExpressionNodeBinaryOperator::boGT && op != QgsExpressionNodeBinaryOperator::boGE)
+            return nullptr;
+
+        // The field can be on either side of the comparison, flip the operator if the field is on the right
+        QVariant value;
+        auto fieldIndex = getFieldIndex(binaryNode->opLeft());
+
+        if(fieldIndex != -1)
+        {
+            if(!this->getLiteral(binaryNode->opRight(), value))
+                return nullptr;
+        }
+        else
+        {
+            fieldIndex = getFieldIndex(binaryNode->opRight());
+
+            if(fieldIndex == -1 || !this->getLiteral(binaryNode->opLeft(), value))
+                return nullptr;
+
+            if(op == QgsExpressionNodeBinaryOperator::boLT)
+                op = QgsExpressionNodeBinaryOperator::boGT;
+            else if(op == QgsExpressionNodeBinaryOperator::boLE)
+                op = QgsExpressionNodeBinaryOperator::boGE;
+            else if(op == QgsExpressionNodeBinaryOperator::boGT)
+                op = QgsExpressionNodeBinaryOperator::boLT;
+            else if(op == QgsExpressionNodeBinaryOperator::boGE)
+                op = QgsExpressionNodeBinaryOperator::boLE;
+        }
+
+        auto filterNode = std::make_shared<FilterNode>();
+        filterNode->type = FilterNode::Type::Compare;
+        filterNode->op = op;
+        filterNode->fieldIndex = fieldIndex;
+        filterNode->literals = {value};
+
+        fieldIndices.insert(fieldIndex);
+
+        return filterNode;
+    }
+    case QgsExpressionNode::ntUnaryOperator:
+    {
+        auto unaryNode = static_cast<const QgsExpressionNodeUnaryOperator*>(node);
+
+        if(unaryNode->op() != QgsExpressionNodeUnaryOperator::uoNot)
+            return nullptr;
+
+        auto child = this->compile(unaryNode->operand(), fieldIndices);
+
+        if(child == nullptr)
+            return nullptr;
+
+        auto filterNode = std::make_shared<FilterNode>();
+        filterNode->type = FilterNode::Type::Not;
+        filterNode->children = {child};
+
+        return filterNode;
+    }
+    case QgsExpressionNode::ntInOperator:
+    {
+        auto inNode = static_cast<const QgsExpressionNodeInOperator*>(node);
+
+        auto fieldIndex = getFieldIndex(inNode->node());
+
+        if(fieldIndex == -1 || inNode->list() == nullptr)
+            return nullptr;
+
+        auto filterNode = std::make_shared<FilterNode>();
+        filterNode->type = FilterNode::Type::In;
+        filterNode->negate = inNode->isNotIn();
+        filterNode->fieldIndex = fieldIndex;
+
+        for(auto&& it : inNode->list()->list())
+        {
+            // A null in the list makes the result null for the values that are not in the list, leave that to QGIS
+            QVariant value;
+            if(!this->getLiteral(it, value) || value.isNull())
+                return nullptr;
+
+            filterNode->literals.push_back(value);
+        }
+
+        fieldIndices.insert(fieldIndex);
+
+        return filterNode;
+    }
+    default:
+        return nullptr;
+    }
+}
+
+
+bool AssetFilterEngine::getLiteral(const QgsExpressionNode* node, QVariant& value) const
+{
+    if(node->nodeType() == QgsExpressionNode::ntLiteral)
+    {
+        value = static_cast<const QgsExpressionNodeLiteral*>(node)->value();
+        return true;
+    }
+
+    // Negative numbers are parsed as a minus operator and a literal
+    if(node->nodeType() == QgsExpressionNode::ntUnaryOperator)
+    {
+        auto unaryNode = static_cast<const QgsExpressionNodeUnaryOperator*>(node);
+
+        if(unaryNode->op() != QgsExpressionNodeUnaryOperator::uoMinus || unaryNode->operand()->nodeType() != QgsExpressionNode::ntLiteral)
+            return false;
+
+        auto operand = static_cast<const QgsExpressionNodeLiteral*>(unaryNode->operand())->value();
+
+        bool OK = false;
+        auto number = operand.toDouble(&OK);
+
+        if(!OK || operand.type() == QVariant::String)
+            return false;
+
+        value = QVariant(-number);
+        return true;
+    }
+
+    return false;
+}
+
+
+bool AssetFilterEngine::loadColumns(const QSet<int>& fieldIndices, QString& err)
+{
+    QgsAttributeList missingFields;
+    for(auto&& it : fieldIndices)
+    {
+        if(!columns.contains(it))
+            missingFields.push_back(it);
+    }
+
+    auto loadIds = ids.isEmpty();
+
+    if(missingFields.isEmpty() && !loadIds)
+        return true;
+
+    auto fields = layer->fields();
+
+    auto idIndex = fields.lookupField("ID");
+
+    if(idIndex == -1)
+    {
+        err = "Could not find the ID field in the layer " + layer->name();
+        return false;
+    }
+
+    QgsAttributeList attributes = missingFields;
+    if(loadIds)
+        attributes.push_back(idIndex);
+
+    // Only the attributes that the filter uses are read
+    QgsFeatureRequest request;
+    request.setFlags(QgsFeatureRequest::NoGeometry);
+    request.setSubsetOfAttributes(attributes);
+
+    auto expectedRows = std::max(static_cast<int>(layer->featureCount()), 0);
+
+    QVector<int> newIds;
+    if(loadIds)
+        newIds.reserve(expectedRows);
+
+    QVector<Column> newColumns(missingFields.size());
+    for(int j = 0; j<missingFields.size(); ++j)
+    {
+        auto& column = newColumns[j];
+        column.isTextField = (fields.at(missingFields.at(j)).type() == QVariant::String);
+        column.numbers.reserve(expectedRows);
+        column.notNull.resize(expectedRows);
+
+        if(column.isTextField)
+            column.strings.reserve(expectedRows);
+    }
+
+    auto featIt = layer->getFeatures(request);
+
+    int row = 0;
+    QgsFeature feat;
+    while (featIt.nextFeature(feat))
+    {
+        if(loadIds)
+        {
+            bool OK = false;
+            auto id = feat.attribute(idIndex).toInt(&OK);
+            newIds.push_back(OK ? id : invalidId);
+        }
+
+        for(int j = 0; j<missingFields.size(); ++j)
+        {
+            auto& column = newColumns[j];
+
+            auto value = feat.attribute(missingFields.at(j));
+
+            if(row >= column.notNull.size())
+                column.notNull.resize(std::max(2*column.notNull.size(), row+1));
+
+            if(value.isNull())
+            {
+                column.numbers.push_back(std::numeric_limits<double>::quiet_NaN());
+
+                if(column.isTextField)
+                    column.strings.push_back(QString());
+
+                continue;
+            }
+
+            column.notNull.setBit(row);
+
+            bool OK = false;
+            auto number = value.toDouble(&OK);
+
+            if(OK)
+            {
+                column.numbers.push_back(number);
+            }
+            else
+            {
+                column.numbers.push_back(std::numeric_limits<double>::quiet_NaN());
+                column.allNumeric = false;
+            }
+
+            if(column.isTextField)
+                column.strings.push_back(value.toString());
+        }
+
+        ++row;
+    }
+
+    // The layer changed since the other columns were read, read all of the columns again
+    if(!loadIds && row != numRows)
+    {
+        ids.clear();
+        columns.clear();
+        return this->loadColumns(fieldIndices, err);
+    }
+
+    if(loadIds)
+    {
+        ids = newIds;
+        numRows = row;
+    }
+
+    for(int j = 0; j<missingFields.size(); ++j)
+    {
+        newColumns[j].notNull.resize(numRows);
+        columns.insert(missingFields.at(j), newColumns.at(j));
+    }
+
+    return true;
+}
+
+
+bool AssetFilterEngine::evaluate(const FilterNode& node, Selection& result)
+{
+    switch (node.type)
+    {
+    case FilterNode::Type::And:
+    case FilterNode::Type::Or:
+    {
+        Selection left;
+        Selection right;
+
+        if(!this->evaluate(*node.children.at(0), left) || !this->evaluate(*node.children.at(1), right))
+            return false;
+
+        // Three-valued logic, a false operand makes an AND false and a true operand makes an OR true
+        if(node.type == FilterNode::Type::And)
+        {
+            result.isTrue = left.isTrue & right.isTrue;
+            result.isFalse = left.isFalse | right.isFalse;
+        }
+        else
+        {
+            result.isTrue = left.isTrue | right.isTrue;
+            result.isFalse = left.isFalse & right.isFalse;
+        }
+
+        return true;
+    }
+    case FilterNode::Type::Not:
+    {
+        Selection child;
+
+        if(!this->evaluate(*node.children.at(0), child))
+            return false;
+
+        result.isTrue = child.isFalse;
+        result.isFalse = child.isTrue;
+
+        return true;
+    }
+    case FilterNode::Type::Compare:
+    {
+        return this->evaluateCompare(columns[node.fieldIndex], node.op, node.literals.first(), false, result);
+    }
+    case FilterNode::Type::In:
+    {
+        auto& column = columns[node.fieldIndex];
+
+        result.isTrue = QBitArray(numRows);
+
+        for(auto&& it : node.literals)
+        {
+            Selection equal;
+
+            if(!this->evaluateCompare(column, QgsExpressionNodeBinaryOperator::boEQ, it, true, equal))
+                return false;
+
+            result.isTrue |= equal.isTrue;
+        }
+
+        result.isFalse = column.notNull & ~result.isTrue;
+
+        if(node.negate)
+            std::swap(result.isTrue, result.isFalse);
+
+        return true;
+    }
+    case FilterNode::Type::IsNull:
+    {
+        auto& column = columns[node.fieldIndex];
+
+        result.isTrue = ~column.notNull;
+        result.isFalse = column.notNull;
+
+        if(node.negate)
+            std::swap(result.isTrue, result.isFalse);
+
+        return true;
+    }
+    }
+
+    return false;
+}
+
+
+bool AssetFilterEngine::evaluateCompare(Column& column, const QgsExpressionNodeBinaryOperator::BinaryOperator op, const QVariant& literal, const bool inOperator, Selection& result)
+{
+    result.isTrue = QBitArray(numRows);
+    result.isFalse = QBitArray(numRows);
+
+    // A comparison with null is null
+    if(literal.isNull())
+        return true;
+
+    bool literalIsNumber = false;
+    auto literalNumber = literal.toDouble(&literalIsNumber);
+    auto literalString = literal.toString();
+
+    // As in QGIS, the values are compared as numbers if both are numbers and they are not both text
+    // The IN operator compares the values as numbers if both are numbers
+    auto compareNumbers = literalIsNumber && (inOperator || literal.type() != QVariant::String || !column.isTextField);
+
+    // Numeric fields would have to be compared as text
+    if(!column.isTextField && !compareNumbers)
+        return false;
+
+    if(compareNumbers && column.allNumeric)
+    {
+        this->evaluateSortedRange(column, op, literalNumber, result);
+        return true;
+    }
+
+    for(int i = 0; i<numRows; ++i)
+    {
+        if(!column.notNull.testBit(i))
+            continue;
+
+        auto number = column.numbers.at(i);
+
+        double diff = 0.0;
+
+        if(compareNumbers && !std::isnan(number))
+            diff = number - literalNumber;
+        else if(column.isTextField)
+            diff = QString::compare(column.strings.at(i), literalString);
+        else
+            continue;
+
+        if(compare(op, diff))
+            result.isTrue.setBit(i);
+        else
+            result.isFalse.setBit(i);
+    }
+
+    return true;
+}
+
+
+void AssetFilterEngine::evaluateSortedRange(Column& column, const QgsExpressionNodeBinaryOperator::BinaryOperator op, const double value, Selection& result)
+{
+    auto values = column.numbers.constData();
+
+    if(column.sortedRows.isEmpty())
+    {
+        column.sortedRows.reserve(numRows);
+
+        for(int i = 0; i<numRows; ++i)
+        {
+            if(column.notNull.testBit(i))
+                column.sortedRows.push_back(i);
+        }
+
+        std::sort(column.sortedRows.begin(), column.sortedRows.end(), [values](const int a, const int b){ return values[a] < values[b]; });
+    }
+
+    auto begin = column.sortedRows.cbegin();
+    auto end = column.sortedRows.cend();
+
+    auto lower = std::lower_bound(begin, end, value, [values](const int row, const double val){ return values[row] < val; });
+    auto upper = std::upper_bound(begin, end, value, [values](const double val, const int row){ return val < values[row]; });
+
+    // The rows in the range [first, last) are true for all operators except not equal, where they are false
+    auto first = begin;
+    auto last = end;
+    auto rangeIsTrue = true;
+
+    switch (op)
+    {
+    case QgsExpressionNodeBinaryOperator::boEQ:
+        first = lower;
+        last = upper;
+        break;
+    case QgsExpressionNodeBinaryOperator::boNE:
+        first = lower;
+        last = upper;
+        rangeIsTrue = false;
+        break;
+    case QgsExpressionNodeBinaryOperator::boLT:
+        last = lower;
+        break;
+    case QgsExpressionNodeBinaryOperator::boLE:
+        last = upper;
+        break;
+    case QgsExpressionNodeBinaryOperator::boGT:
+        first = upper;
+        break;
+    case QgsExpressionNodeBinaryOperator::boGE:
+        first = lower;
+        break;
+    default:
+        return;
+    }
+
+    auto& rangeBits = rangeIsTrue ? result.isTrue : result.isFalse;
+
+    for(auto it = first; it != last; ++it)
+        rangeBits.setBit(*it);
+
+    if(rangeIsTrue)
+        result.isFalse = column.notNull & ~result.isTrue;
+    else
+        result.isTrue = column.notNull & ~result.isFalse;
+}
+
+
+bool AssetFilterEngine::compare(const QgsExpressionNodeBinaryOperator::BinaryOperator op, const double diff)
+{
+    switch (op)
+    {
+    case QgsExpressionNodeBinaryOperator::boEQ:
+        return diff == 0.0;
+    case QgsExpressionNodeBinaryOperator::boNE:
+        return diff != 0.0;
+    case QgsExpressionNodeBinaryOperator::boLT:
+        return diff < 0.0;
+    case QgsExpressionNodeBinaryOperator::boLE:
+        return diff <= 0.0;
+    case QgsExpressionNodeBinaryOperator::boGT:
+        return diff > 0.0;
+    case QgsExpressionNodeBinaryOperator::boGE:
+        return diff >= 0.0;
+    default:
+        return false;
+    }
+}
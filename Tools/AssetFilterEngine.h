@@ -0,0 +1,137 @@
+#ifndef ASSETFILTERENGINE_H
+#define ASSETFILTERENGINE_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Evaluates asset filter expressions over columns of the attribute values instead of fetching the features that match
+// The filter is parsed with the QGIS expression parser and compiled into a tree of comparisons, the columns that the filter refers to are read from the layer once
+// Range comparisons on numeric columns use a sorted index of the rows, the result of each node is a bitmap of the rows
+// Comparisons follow the rules of the QGIS expression engine, filters with functions or operators that are not supported here are left to the QGIS expression engine
+
+#include <qgsexpressionnodeimpl.h>
+
+#include <QBitArray>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+
+#include <memory>
+
+class QgsVectorLayer;
+
+class AssetFilterEngine
+{
+public:
+    AssetFilterEngine(QgsVectorLayer* layer);
+
+    // Returns the IDs of the assets that pass the filter in order of the features in the layer
+    // Returns 0 on success, 1 if the filter is not supported and needs to be evaluated by the QGIS expression engine, and -1 on error
+    int filter(const QString& filter, QVector<int>& filterIds, QString& err);
+
+    // Returns a bitmap of the rows, i.e., features in the layer, that pass the filter, same return values as above
+    int filter(const QString& filter, QBitArray& rows, QString& err);
+
+    // Drops the columns that were read from the layer, call when the attribute values change
+    void clear(void);
+
+private:
+
+    struct FilterNode
+    {
+        enum class Type {And, Or, Not, Compare, In, IsNull};
+
+        Type type;
+
+        // The comparison operator, i.e., boEQ, boNE, boLT, boLE, boGT, or boGE
+        QgsExpressionNodeBinaryOperator::BinaryOperator op = QgsExpressionNodeBinaryOperator::boEQ;
+
+        // NOT IN and IS NOT
+        bool negate = false;
+
+        int fieldIndex = -1;
+        QVector<QVariant> literals;
+
+        QVector<std::shared_ptr<FilterNode>> children;
+    };
+
+    struct Column
+    {
+        // String values are kept for text fields, numbers hold NaN for values that are not numbers
+        bool isTextField = false;
+        bool allNumeric = true;
+
+        QVector<QString> strings;
+        QVector<double> numbers;
+        QBitArray notNull;
+
+        // Rows with a numeric value sorted by value, created when first needed
+        QVector<int> sortedRows;
+    };
+
+    // The rows where a node is true and where it is false, rows where neither is set are null
+    struct Selection
+    {
+        QBitArray isTrue;
+        QBitArray isFalse;
+    };
+
+    // Returns a null pointer if the expression node is not supported
+    std::shared_ptr<FilterNode> compile(const QgsExpressionNode* node, QSet<int>& fieldIndices) const;
+    bool getLiteral(const QgsExpressionNode* node, QVariant& value) const;
+
+    bool loadColumns(const QSet<int>& fieldIndices, QString& err);
+
+    bool evaluate(const FilterNode& node, Selection& result);
+    bool evaluateCompare(Column& column, const QgsExpressionNodeBinaryOperator::BinaryOperator op, const QVariant& literal, const bool inOperator, Selection& result);
+    void evaluateSortedRange(Column& column, const QgsExpressionNodeBinaryOperator::BinaryOperator op, const double value, Selection& result);
+
+    static bool compare(const QgsExpressionNodeBinaryOperator::BinaryOperator op, const double diff);
+
+    QgsVectorLayer* layer = nullptr;
+
+    int numRows = 0;
+    QVector<int> ids;
+    QHash<int, Column> columns;
+
+    // The last compiled filter, the same filter is applied again when the assets are reloaded or the filter is re-applied
+    QString compiledFilter;
+    std::shared_ptr<FilterNode> compiledRoot;
+    QSet<int> compiledFields;
+};
+
+#endif // ASSETFILTERENGINE_H
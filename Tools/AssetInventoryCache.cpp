@@ -0,0 +1,269 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+#include "AssetInventoryCache.h"
+#include "GmCommon.h"
+
+#include <qgsgeometry.h>
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+// Increment when the layout of the cache file changes
+const quint32 inventoryCacheMagicNumber = 0x41494E56;
+const qint32 inventoryCacheVersion = 1;
+
+
+AssetInventoryCache::AssetInventoryCache()
+{
+
+}
+
+
+bool AssetInventoryCache::readCache(const QString& pathToInventory)
+{
+    this->clear();
+
+    this->pathToInventory = pathToInventory;
+    key = getKey(pathToInventory);
+
+    if(key.isEmpty())
+        return false;
+
+    QFile file(getPathToCache(pathToInventory));
+    if(!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_12);
+
+    quint32 magicNumber = 0;
+    qint32 version = 0;
+    QByteArray cacheKey;
+
+    stream >> magicNumber >> version;
+
+    if(magicNumber == inventoryCacheMagicNumber && version == inventoryCacheVersion)
+    {
+        stream >> cacheKey;
+
+        if(cacheKey == key)
+            stream >> headings >> rows >> geometries;
+    }
+
+    if(stream.status() != QDataStream::Ok || cacheKey != key || rows.isEmpty() || (!geometries.isEmpty() && geometries.size() != rows.size()))
+    {
+        headings.clear();
+        rows.clear();
+        geometries.clear();
+        return false;
+    }
+
+    this->createIdToFidMap();
+
+    return true;
+}
+
+
+bool AssetInventoryCache::writeCache(QString& err)
+{
+    if(!modified)
+        return true;
+
+    if(key.isEmpty())
+    {
+        err = "Could not read the inventory file "+pathToInventory;
+        return false;
+    }
+
+    auto pathToCache = getPathToCache(pathToInventory);
+
+    QDir().mkpath(QFileInfo(pathToCache).absolutePath());
+
+    // Write to a temporary file first so that a cache that is being read is never partially written
+    QSaveFile file(pathToCache);
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        err = "Could not write the asset inventory cache "+pathToCache;
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_12);
+
+    stream << inventoryCacheMagicNumber << inventoryCacheVersion << key << headings << rows << geometries;
+
+    if(stream.status() != QDataStream::Ok || !file.commit())
+    {
+        err = "Could not write the asset inventory cache "+pathToCache;
+        return false;
+    }
+
+    modified = false;
+
+    return true;
+}
+
+
+void AssetInventoryCache::setInventory(const QString& pathToInventory, const QStringList& headings, const QVector<QStringList>& rows)
+{
+    if(this->pathToInventory != pathToInventory || key.isEmpty())
+    {
+        this->pathToInventory = pathToInventory;
+        key = getKey(pathToInventory);
+    }
+
+    this->headings = headings;
+    this->rows = rows;
+    geometries.clear();
+
+    this->createIdToFidMap();
+
+    modified = true;
+}
+
+
+const QStringList& AssetInventoryCache::getHeadings(void) const
+{
+    return headings;
+}
+
+
+const QVector<QStringList>& AssetInventoryCache::getRows(void) const
+{
+    return rows;
+}
+
+
+bool AssetInventoryCache::hasGeometries(void) const
+{
+    return !rows.isEmpty() && geometries.size() == rows.size();
+}
+
+
+QgsGeometry AssetInventoryCache::getGeometry(const int row) const
+{
+    QgsGeometry geom;
+
+    if(row < 0 || row >= geometries.size())
+        return geom;
+
+    geom.fromWkb(geometries.at(row));
+
+    return geom;
+}
+
+
+void AssetInventoryCache::setGeometries(const QVector<QgsGeometry>& geometries)
+{
+    if(geometries.size() != rows.size())
+        return;
+
+    this->geometries.resize(geometries.size());
+
+    for(int i = 0; i<geometries.size(); ++i)
+        this->geometries[i] = geometries.at(i).asWkb();
+
+    modified = true;
+}
+
+
+const QHash<qint64, qint64>& AssetInventoryCache::getIdToFidMap(void) const
+{
+    return idToFidMap;
+}
+
+
+void AssetInventoryCache::clear(void)
+{
+    pathToInventory.clear();
+    key.clear();
+    headings.clear();
+    rows.clear();
+    geometries.clear();
+    idToFidMap.clear();
+    modified = false;
+}
+
+
+QString AssetInventoryCache::getPathToCache(const QString& pathToInventory)
+{
+    auto pathHash = QCryptographicHash::hash(QFileInfo(pathToInventory).absoluteFilePath().toUtf8(), QCryptographicHash::Sha1);
+
+    return GmCommon::getCacheLocation() + QDir::separator() + "AssetInventories" + QDir::separator() + QString(pathHash.toHex()) + ".bin";
+}
+
+
+QByteArray AssetInventoryCache::getKey(const QString& pathToInventory)
+{
+    QFileInfo fileInfo(pathToInventory);
+
+    QFile file(pathToInventory);
+    if(!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+
+    QCryptographicHash fileHash(QCryptographicHash::Sha1);
+    fileHash.addData(fileInfo.absoluteFilePath().toUtf8());
+    fileHash.addData(QByteArray::number(fileInfo.lastModified().toMSecsSinceEpoch()));
+    fileHash.addData(&file);
+
+    return fileHash.result();
+}
+
+
+void AssetInventoryCache::createIdToFidMap(void)
+{
+    idToFidMap.clear();
+    idToFidMap.reserve(rows.size());
+
+    // The features of a memory layer are numbered from one in the order they are added
+    for(int i = 0; i<rows.size(); ++i)
+    {
+        if(rows.at(i).isEmpty())
+            continue;
+
+        bool OK;
+        auto id = rows.at(i).first().toLongLong(&OK);
+
+        if(OK)
+            idToFidMap.insert(id, i+1);
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef ASSETINVENTORYCACHE_H
+#define ASSETINVENTORYCACHE_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Binary cache of an asset inventory file so that re-opening a project does not parse the inventory and build the asset geometries again
+// The cache is keyed by the path, modification time and contents of the inventory file and lives in the cache location of the application
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class QgsGeometry;
+
+class AssetInventoryCache
+{
+public:
+    AssetInventoryCache();
+
+    // Reads the cache of the inventory file, returns false if there is no cache for the current version of the file
+    bool readCache(const QString& pathToInventory);
+
+    // Writes the cache if any of its contents were set since it was read
+    bool writeCache(QString& err);
+
+    // Sets the parsed inventory, the first column holds the asset IDs
+    void setInventory(const QString& pathToInventory, const QStringList& headings, const QVector<QStringList>& rows);
+
+    const QStringList& getHeadings(void) const;
+    const QVector<QStringList>& getRows(void) const;
+
+    // The geometry of each row in the inventory, stored as WKB
+    bool hasGeometries(void) const;
+    QgsGeometry getGeometry(const int row) const;
+    void setGeometries(const QVector<QgsGeometry>& geometries);
+
+    // Map of the asset ID to the feature ID in a layer created from the rows in order
+    const QHash<qint64, qint64>& getIdToFidMap(void) const;
+
+    void clear(void);
+
+    // There is one cache per inventory file, it is replaced when the inventory file changes
+    static QString getPathToCache(const QString& pathToInventory);
+
+private:
+
+    // Hashes the path, modification time and contents of the inventory file
+    static QByteArray getKey(const QString& pathToInventory);
+
+    void createIdToFidMap(void);
+
+    QString pathToInventory;
+    QByteArray key;
+    QStringList headings;
+    QVector<QStringList> rows;
+    QVector<QByteArray> geometries;
+    QHash<qint64, qint64> idToFidMap;
+
+    bool modified = false;
+};
+
+#endif // ASSETINVENTORYCACHE_H
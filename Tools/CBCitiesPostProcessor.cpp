@@ -44,6 +44,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "REmpiricalProbabilityDistribution.h"
 #include "TablePrinter.h"
 #include "TableNumberItem.h"
+#include "TaskRunner.h"
 #include "VisualizationWidget.h"
 #include "WorkflowAppR2D.h"
 #include "Utils/ProgramOutputDialog.h"
@@ -74,6 +75,9 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QTextCursor>
 #include <QTextTable>
 #include <QValueAxis>
+#include <QtConcurrent/QtConcurrent>
+
+#include <numeric>
 
 #include "QGISVisualizationWidget.h"
 
@@ -231,23 +235,29 @@ void CBCitiesPostProcessor::importResults(const QString& pathToResults)
 
     QString DVResultsSheet = "DV.csv";
 
+    // Parse the results into typed columns in the thread pool
+    const auto pathToFile = pathToAssets + QDir::separator() + DVResultsSheet;
+    DVResults = TaskRunner::getInstance()->runAndWait<DVResultsTable>([this, pathToFile, &errMsg](TaskContext&)
+    {
+        DVResultsTable table;
+        this->loadDVResults(pathToFile, table, errMsg);
+        return table;
+    });
 
-    CSVReaderWriter csvTool;
-
-
-    DVdata = csvTool.parseCSVFile(pathToAssets + QDir::separator() + DVResultsSheet,errMsg);
     if(!errMsg.isEmpty())
         throw errMsg;
 
-
-    if(!DVdata.empty())
-        this->processDVResults(DVdata);
-    else
+    if(DVResults.numRows() == 0)
     {
         errMsg = "The DV results are empty";
         throw errMsg;
     }
 
+    QVector<int> allRows(DVResults.numRows());
+    std::iota(allRows.begin(), allRows.end(), 0);
+
+    this->processDVResults(allRows);
+
     // Enable the selection tool
     mapViewSubWidget->enableSelectionTool();
 
@@ -267,26 +277,135 @@ void CBCitiesPostProcessor::showEvent(QShowEvent *e)
 
 
 
-int CBCitiesPostProcessor::processDVResults(const QVector<QStringList>& DVResults)
+int CBCitiesPostProcessor::loadDVResults(const QString& pathToFile, DVResultsTable& table, QString& errMsg)
 {
-    if(DVResults.size() < numHeaderRows)
+    CSVReaderWriter csvTool;
+
+    auto data = csvTool.parseCSVFile(pathToFile,errMsg);
+    if(!errMsg.isEmpty())
+        return -1;
+
+    if(data.size() < numHeaderRows)
     {
-        QString msg = "No results to import!";
-        throw msg;
+        errMsg = "No results to import!";
+        return -1;
     }
 
-    auto numHeaderColumns = DVResults.at(0).size();
+    table.headings = data.at(0);
+
+    auto numColumns = table.headings.size();
+    auto numRows = data.size()-numHeaderRows;
 
-    QStringList headerStrings;
+    auto indexMeanRR = table.headings.indexOf("RepairRate");
 
-    for(int i = 0; i<numHeaderColumns; ++i)
+    if(indexMeanRR == -1)
     {
-        QString headerStr = DVResults.at(0).at(i);
+        errMsg = "Error getting the header index for RepairRate!";
+        return -1;
+    }
+
+    // Convert the columns in parallel, each column is converted once and the strings are not kept
+    table.ids.resize(numRows);
+    table.columns.resize(numColumns);
+
+    QVector<int> columnIndices(numColumns+1);
+    std::iota(columnIndices.begin(), columnIndices.end(), -1);
+
+    QVector<QString> errors(numColumns+1);
+
+    // Get the raw pointers before going parallel so that the vectors are not detached in the worker threads
+    auto idsData = table.ids.data();
+    auto columnsData = table.columns.data();
+    auto errData = errors.data();
+
+    const auto headerRows = numHeaderRows;
+
+    QtConcurrent::blockingMap(columnIndices, [&](const int col)
+    {
+        // The IDs are in the first column
+        if(col == -1)
+        {
+            for(int i = 0; i<numRows; ++i)
+            {
+                const auto& row = data.at(i+headerRows);
+
+                // Assume a zero value if the string is empty, as in objectToInt
+                if(row.isEmpty() || row.at(0).isEmpty())
+                {
+                    idsData[i] = 0;
+                    continue;
+                }
+
+                bool OK = false;
+                idsData[i] = row.at(0).toInt(&OK);
+
+                if(!OK)
+                {
+                    errData[0] = "Could not convert the ID "+row.at(0)+" to an integer";
+                    return;
+                }
+            }
+
+            return;
+        }
+
+        auto& column = columnsData[col];
+        column.resize(numRows);
+
+        for(int i = 0; i<numRows; ++i)
+        {
+            const auto& row = data.at(i+headerRows);
+
+            if(col >= row.size() || row.at(col).isEmpty())
+            {
+                column[i] = 0.0;
+                continue;
+            }
+
+            bool OK = false;
+            column[i] = row.at(col).toDouble(&OK);
+
+            // Only the repair rate has to be a number, the other values are zero if they are not
+            if(!OK && col == indexMeanRR)
+            {
+                errData[col+1] = "Could not convert the repair rate "+row.at(col)+" to a double";
+                return;
+            }
+        }
+    });
 
-        headerStrings.append(headerStr);
+    for(auto&& it : errors)
+    {
+        if(!it.isEmpty())
+        {
+            errMsg = it;
+            return -1;
+        }
+    }
+
+    // The first row of an ID is used if it appears more than once
+    table.rowOfId.reserve(numRows);
+    for(int i = 0; i<numRows; ++i)
+    {
+        if(!table.rowOfId.contains(table.ids.at(i)))
+            table.rowOfId.insert(table.ids.at(i), i);
+    }
+
+    return 0;
+}
+
+
+int CBCitiesPostProcessor::processDVResults(const QVector<int>& rows)
+{
+    if(rows.isEmpty())
+    {
+        QString msg = "No results to import!";
+        throw msg;
     }
 
-    // Decipher the results file
+    const auto& headerStrings = DVResults.headings;
+
+    auto numHeaderColumns = headerStrings.size();
 
     // Structural - seismic
     auto indexMeanRR = headerStrings.indexOf("RepairRate");
@@ -302,7 +421,7 @@ int CBCitiesPostProcessor::processDVResults(const QVector<QStringList>& DVResult
 
     resultsTableWidget->setColumnCount(tableHeadings.size());
     resultsTableWidget->setHorizontalHeaderLabels(tableHeadings);
-    resultsTableWidget->setRowCount(DVResults.size()-numHeaderRows);
+    resultsTableWidget->setRowCount(rows.size());
 
     REmpiricalProbabilityDistribution theProbDist;
 
@@ -324,40 +443,27 @@ int CBCitiesPostProcessor::processDVResults(const QVector<QStringList>& DVResult
     auto selFeatLayer = theAssetDB->getSelectedLayer();
     mapViewSubWidget->setCurrentLayer(selFeatLayer);
 
-    // Vector to hold the attributes
-    QVector< QgsAttributes > fieldAttributes(DVResults.size()-numHeaderRows, QgsAttributes(numHeaderColumns));
+    // The columns of the rows that are shown, one for each heading
+    QVector<QVector<double>> fieldColumns(numHeaderColumns, QVector<double>(rows.size()));
 
+    const auto& repairRates = DVResults.columns.at(indexMeanRR);
 
-    for(int i = numHeaderRows, count = 0; i<DVResults.size(); ++i, ++count)
+    for(int count = 0; count<rows.size(); ++count)
     {
-        auto inputRow = DVResults.at(i);
-
-        // This assumes that the output from pelicun will not change
-        auto IDStr = inputRow.at(0);
+        auto row = rows.at(count);
 
-        // ID
-        auto meanRR = inputRow.at(indexMeanRR);  // Mean failure probability
-
-        auto repairRate = objectToDouble(meanRR);
+        auto repairRate = repairRates.at(row);
 
         theProbDist.addSample(repairRate);
 
-        auto IDItem = new TableNumberItem(IDStr);
-        auto failureProbItem = new TableNumberItem(meanRR);
+        auto IDItem = new TableNumberItem(QString::number(DVResults.ids.at(row)));
+        auto failureProbItem = new TableNumberItem(QString::number(repairRate));
 
         resultsTableWidget->setItem(count,0, IDItem);
         resultsTableWidget->setItem(count,1, failureProbItem);
 
-        auto& rowData = fieldAttributes[count];
-
-        // Populate the attributes vector with the results
-        for(int k = 0; k<inputRow.size(); ++k)
-        {
-            // Add the result to the database
-            auto value = inputRow.at(k);
-
-            rowData[k] = QVariant(value.toDouble());
-        }
+        for(int k = 0; k<numHeaderColumns; ++k)
+            fieldColumns[k][count] = DVResults.columns.at(k).at(row);
     }
 
     // Test to remove start
@@ -368,7 +474,7 @@ int CBCitiesPostProcessor::processDVResults(const QVector<QStringList>& DVResult
     theAssetDB->startEditing();
 
     QString errMsg;
-    auto res = theAssetDB->addNewComponentAttributes(headerStrings,fieldAttributes,errMsg);
+    auto res = theAssetDB->updateComponentAttributes(headerStrings,fieldColumns,errMsg);
     if(!res)
         throw errMsg;
 
@@ -491,56 +597,30 @@ void CBCitiesPostProcessor::processResultsSubset(const std::set<int>& selectedCo
     if(selectedComponentIDs.empty())
         return;
 
-    if(DVdata.size() < numHeaderRows)
+    if(DVResults.numRows() == 0)
     {
         QString msg = "No results to import!";
         throw msg;
     }
 
-    if(DVdata.at(numHeaderRows).isEmpty() || DVdata.last().isEmpty())
-    {
-        QString msg = "No values in the cells";
-        throw msg;
-    }
-
-    auto firstID = objectToInt(DVdata.at(numHeaderRows).at(0));
-
-    auto lastID = objectToInt(DVdata.last().at(0));
-
-    QVector<QStringList> DVsubset(&DVdata[0],&DVdata[numHeaderRows]);
+    // Find the rows of the selected components from the index
+    QVector<int> rows;
+    rows.reserve(static_cast<int>(selectedComponentIDs.size()));
 
     for(auto&& id : selectedComponentIDs)
     {
-        // Check that the ID falls within the bounds of the data
-        if(id<firstID || id>lastID)
-        {
-            QString msg = "ID " + QString::number(id) + " is out of bounds of the results";
-            throw msg;
-        }
-
-        auto found = false;
-        for(int i = numHeaderRows; i<DVdata.size(); ++i)
-        {
-            auto inputRow = DVdata.at(i);
-
-            auto buildingID = objectToInt(inputRow.at(0));
+        auto row = DVResults.rowOfId.value(id, -1);
 
-            if(id == buildingID)
-            {
-                DVsubset << inputRow;
-                found = true;
-                break;
-            }
-        }
-
-        if(!found)
+        if(row == -1)
         {
             QString msg = "ID " + QString::number(id) + " cannot be found in the results";
             throw msg;
         }
+
+        rows.push_back(row);
     }
 
-    this->processDVResults(DVsubset);
+    this->processDVResults(rows);
 }
 
 
@@ -571,7 +651,7 @@ void CBCitiesPostProcessor::setCurrentlyViewable(bool status){
 
 void CBCitiesPostProcessor::clear(void)
 {
-    DVdata.clear();
+    DVResults = DVResultsTable();
 
     outputFilePath.clear();
 
@@ -43,8 +43,10 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 #include "SimCenterMapcanvasWidget.h"
 
+#include <QHash>
 #include <QString>
 #include <QMainWindow>
+#include <QVector>
 
 #include <memory>
 #include <set>
@@ -67,6 +69,20 @@ class QBarSet;
 class QChart;
 }
 
+// The DV results in typed columns, one for each heading, the row of an asset is found from its ID
+struct DVResultsTable
+{
+    QStringList headings;
+    QVector<int> ids;
+    QVector<QVector<double>> columns;
+    QHash<int, int> rowOfId;
+
+    int numRows(void) const
+    {
+        return ids.size();
+    }
+};
+
 class CBCitiesPostProcessor : public QMainWindow
 {
     Q_OBJECT
@@ -133,9 +149,13 @@ protected:
 
 private:
 
-    int processDVResults(const QVector<QStringList>& DVResults);
+    // Shows the results of the given rows of the DV results table
+    int processDVResults(const QVector<int>& rows);
+
+    // Parses the DV results file into the table, returns -1 on error
+    int loadDVResults(const QString& pathToFile, DVResultsTable& table, QString& errMsg);
 
-    QVector<QStringList> DVdata;
+    DVResultsTable DVResults;
 
     QString outputFilePath;
 
@@ -42,6 +42,9 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QTextStream>
 #include <QStringList>
 #include <QFile>
+#include <QtConcurrent/QtConcurrent>
+
+#include <algorithm>
 
 CSVReaderWriter::CSVReaderWriter()
 {
@@ -49,7 +52,7 @@ CSVReaderWriter::CSVReaderWriter()
 }
 
 
-int CSVReaderWriter::saveCSVFile(const QVector<QStringList>& data, const QString& pathToFile, QString& err)
+int CSVReaderWriter::saveCSVFile(const QVector<QStringList>& data, const QString& pathToFile, QString& err, const bool append)
 {
 
     // Check the data for consistency
@@ -79,7 +82,9 @@ int CSVReaderWriter::saveCSVFile(const QVector<QStringList>& data, const QString
 
     QFile file(pathToFile);
 
-    if (!file.open(QIODevice::WriteOnly))
+    auto openMode = append ? QIODevice::WriteOnly | QIODevice::Append : QIODevice::WriteOnly;
+
+    if (!file.open(openMode))
     {
         err = "Cannot create the file: " + pathToFile + "\n" +"Check your directory and try again.";
         return -1;
@@ -147,14 +152,30 @@ QVector<QStringList> CSVReaderWriter::parseCSVFile(const QString &pathToFile, QS
         return returnVec;
     }
 
-    returnVec.reserve(numRows);
+    returnVec.resize(numRows);
+
+    // Get the raw pointer before going parallel so that the vector is not detached in the worker threads
+    QStringList* rows = returnVec.data();
+
+    // The rows do not depend on each other so large files are parsed in chunks in parallel
+    const int chunkSize = 2048;
 
-    for(auto&& it: rowLines)
+    QVector<int> chunkBegins;
+    for(int i = 0; i<numRows; i += chunkSize)
+        chunkBegins.push_back(i);
+
+    auto parseChunk = [&](const int begin)
     {
-        auto lineStr = this->parseLineCSV(it);
+        const auto end = std::min(begin+chunkSize, numRows);
 
-        returnVec.push_back(lineStr);
-    }
+        for(int i = begin; i<end; ++i)
+            rows[i] = this->parseLineCSV(rowLines.at(i));
+    };
+
+    if(chunkBegins.size() == 1)
+        parseChunk(0);
+    else
+        QtConcurrent::blockingMap(chunkBegins, parseChunk);
 
     return returnVec;
 }
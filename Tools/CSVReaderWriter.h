@@ -48,8 +48,8 @@ class CSVReaderWriter
 public:
     CSVReaderWriter();
 
-    // Saves data in the format of a CSV file
-    int saveCSVFile(const QVector<QStringList>& data, const QString& pathToFile, QString& err);
+    // Saves data in the format of a CSV file, if append is true the rows are added to the end of an existing file
+    int saveCSVFile(const QVector<QStringList>& data, const QString& pathToFile, QString& err, const bool append = false);
 
     // Parses a CSV file and returns the file as a vector of string lists
     // Each item in the vector (string list) corresponds to a row of the csv file that is parsed
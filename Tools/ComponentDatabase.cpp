@@ -42,6 +42,8 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <qgsfeature.h>
 #include <qgsfeaturerequest.h>
 
+#include <algorithm>
+
 ComponentDatabase::ComponentDatabase(QString type) : offset(0), componentType(type)
 {
     messageHandler = ProgramOutputDialog::getInstance();
@@ -64,7 +66,11 @@ void ComponentDatabase::clear(void)
 {
     mainLayer = nullptr;
     selectedFeaturesSet.clear();
+    selectedFidMap.clear();
+    this->rollBackEditTransaction();
     offset = 0;
+    idToFidMap.clear();
+    fidToIdMap.clear();
     selectedLayer = nullptr;
 }
 
@@ -74,7 +80,7 @@ QgsFeature ComponentDatabase::getFeature(const qint64 id)
     if(mainLayer == nullptr)
         return QgsFeature();
 
-    auto fid = id+offset;
+    auto fid = this->getFid(id);
 
     if(FID_IS_NULL(fid))
         return QgsFeature();
@@ -131,24 +137,36 @@ bool ComponentDatabase::addFeaturesToSelectedLayer(const std::set<int> ids)
     selectedFeaturesSet.reserve(ids.size());
 
     for(auto&& id : ids)
-        selectedFeaturesSet.insert(id+offset);
+        selectedFeaturesSet.insert(this->getFid(id));
 
     auto featIt = mainLayer->getFeatures(selectedFeaturesSet);
 
     QgsFeatureList featList;
     featList.reserve(ids.size());
 
+    QVector<QgsFeatureId> mainFids;
+    mainFids.reserve(ids.size());
+
     QgsFeature feat;
     while (featIt.nextFeature(feat))
     {
-        auto id = feat.id();
+        mainFids.push_back(feat.id());
         featList.push_back(feat);
     }
 
     if(featList.size() != ids.size())
         return false;
 
-    auto res = selectedLayer->dataProvider()->addFeatures(featList, QgsFeatureSink::FastInsert);
+    // No fast insert here, the provider needs to update the passed features with their new ids
+    auto res = selectedLayer->dataProvider()->addFeatures(featList);
+
+    if(res)
+    {
+        selectedFidMap.reserve(featList.size());
+
+        for(int i = 0; i<featList.size(); ++i)
+            selectedFidMap.insert(mainFids.at(i),featList.at(i).id());
+    }
 
     selectedLayer->updateExtents();
 
@@ -158,12 +176,12 @@ bool ComponentDatabase::addFeaturesToSelectedLayer(const std::set<int> ids)
 
 bool ComponentDatabase::addFeatureToSelectedLayer(const int id)
 {
-    auto fid = id+offset;
+    auto fid = this->getFid(id);
 
     if(selectedFeaturesSet.contains(fid))
         return true;
 
-    auto feature = this->getFeature(fid);
+    auto feature = this->getFeature(id);
     if(feature.isValid() == false)
     {
         messageHandler->appendErrorMessage("Error getting the feature from the database");
@@ -178,7 +196,7 @@ bool ComponentDatabase::addFeatureToSelectedLayer(QgsFeature& feature)
 {
     auto fid = feature.id();
 
-    auto res = selectedLayer->dataProvider()->addFeature(feature, QgsFeatureSink::FastInsert);
+    auto res = selectedLayer->dataProvider()->addFeature(feature);
 
     // auto res = selectedLayer->addFeature(feature/*, QgsFeatureSink::FastInsert*/);
 
@@ -189,6 +207,7 @@ bool ComponentDatabase::addFeatureToSelectedLayer(QgsFeature& feature)
     }
 
     selectedFeaturesSet.insert(fid);
+    selectedFidMap.insert(fid,feature.id());
 
     return true;
 }
@@ -197,6 +216,28 @@ bool ComponentDatabase::addFeatureToSelectedLayer(QgsFeature& feature)
 void ComponentDatabase::setOffset(int value)
 {
     offset = value;
+    idToFidMap.clear();
+    fidToIdMap.clear();
+}
+
+
+void ComponentDatabase::setIdToFidMap(const QHash<qint64, qint64>& value)
+{
+    idToFidMap = value;
+
+    fidToIdMap.clear();
+    fidToIdMap.reserve(value.size());
+    for(auto it = value.constBegin(); it != value.constEnd(); ++it)
+        fidToIdMap.insert(it.value(), it.key());
+}
+
+
+QgsFeatureId ComponentDatabase::getFid(const qint64 id) const
+{
+    if(idToFidMap.isEmpty())
+        return id+offset;
+
+    return idToFidMap.value(id, FID_NULL);
 }
 
 
@@ -204,6 +245,22 @@ bool ComponentDatabase::removeFeaturesFromSelectedLayer(QgsFeatureIds& featureId
 {
     auto res = selectedLayer->dataProvider()->deleteFeatures(featureIds);
 
+    if(!res)
+        return res;
+
+    // The given ids are the ids in the selected layer, remove the corresponding main layer ids
+    auto it = selectedFidMap.begin();
+    while(it != selectedFidMap.end())
+    {
+        if(featureIds.contains(it.value()))
+        {
+            selectedFeaturesSet.remove(it.key());
+            it = selectedFidMap.erase(it);
+        }
+        else
+            ++it;
+    }
+
     return res;
 }
 
@@ -212,15 +269,20 @@ bool ComponentDatabase::clearSelectedLayer(void)
 {
     auto res = selectedLayer->dataProvider()->truncate();
 
+    selectedFeaturesSet.clear();
+    selectedFidMap.clear();
+    selectedLayerChanges.clear();
+
     return res;
 }
 
 
-bool ComponentDatabase::addNewComponentAttributes(const QStringList& fieldNames, const QVector<QgsAttributes>& values, QString& error)
+template <typename ValueAccessor>
+bool ComponentDatabase::changeSelectedAttributeValues(const QStringList& fieldNames, const QVector<QVariant::Type>& fieldTypes, const int numRows, ValueAccessor valueAt, QString& error)
 {
     if(selectedLayer == nullptr)
     {
-        error = "Error, could not find the 'selected assets layer' containing the assets that were selected for analysis. Could not add new fields";
+        error = "Error, could not find the 'selected assets layer' containing the assets that were selected for analysis. Could not update the fields: "+fieldNames.join(", ");
         return false;
     }
 
@@ -228,106 +290,141 @@ bool ComponentDatabase::addNewComponentAttributes(const QStringList& fieldNames,
 
     auto numFeatSelLayer = selectedLayer->featureCount();
 
-    if(values.size() != numSelectedFeatures || numSelectedFeatures != numFeatSelLayer)
+    if(numRows != numSelectedFeatures || numSelectedFeatures != numFeatSelLayer)
     {
-        error = "Error, the number of assets in the imported data ("+QString::number(values.size())+ ") should be equal to the number of assets in the 'selected assets layer' (" + QString::number(numSelectedFeatures)+ "). /n Failed to batch add new attributes. Please ensure all assets are loaded and added to the selected features layer in the input file stage.";
+        error = "Error, the number of assets in the imported data ("+QString::number(numRows)+ ") should be equal to the number of assets in the 'selected assets layer' (" + QString::number(numSelectedFeatures)+ "). /n Failed to batch update the fields: "+fieldNames.join(", ")+". Please ensure all assets are loaded and added to the selected features layer in the input file stage.";
         return false;
     }
 
+    auto selectedFids = this->getSelectedFidsInOrder();
 
-    if(values.empty())
+    if(selectedFids.size() != numRows)
     {
-        error = "Error, empty values.";
+        error = "Error, inconsist sizes of values to update and number of selected features. Please contact developers. Could not update the fields in "+selectedLayer->name();
         return false;
     }
 
+    auto pr = selectedLayer->dataProvider();
 
-    auto numNewFields = fieldNames.size();
-    auto firstRow = values.first();
-
-    if(firstRow.size() != numNewFields)
+    // Add the fields that are not in the layer yet
+    QList<QgsField> newFields;
+    QSet<QString> newFieldNames;
+    for(int i = 0; i<fieldNames.size(); ++i)
     {
-        error = "Error, the number of values must match the number of fields";
-        return false;
+        const auto& name = fieldNames.at(i);
+
+        if(pr->fieldNameIndex(name) == -1 && !newFieldNames.contains(name))
+        {
+            newFields.append(QgsField(name, fieldTypes.at(i)));
+            newFieldNames.insert(name);
+        }
     }
 
+    if(!newFields.isEmpty())
+    {
+        if(!pr->addAttributes(newFields))
+        {
+            error = "Error adding attributes to the layer " + selectedLayer->name();
+            return false;
+        }
 
-    QgsFields existingFields = selectedLayer->dataProvider()->fields();
+        selectedLayer->updateFields(); // tell the vector layer to fetch changes from the provider
+    }
 
-    for(int i = 0; i <numNewFields; ++i)
-        existingFields.append(QgsField(fieldNames[i], firstRow.at(i).type()));
+    QVector<int> fieldIndices;
+    fieldIndices.reserve(fieldNames.size());
+    for(auto&& name : fieldNames)
+    {
+        auto index = pr->fieldNameIndex(name);
 
+        if(index == -1)
+        {
+            error = "Error, failed to find the field "+name+" in the layer "+selectedLayer->name();
+            return false;
+        }
 
-    QgsFeatureRequest featRequest (selectedFeaturesSet);
+        fieldIndices.push_back(index);
+    }
 
-    // All this just to get the feature request to return everything with ascending ids
-    QgsFeatureRequest::OrderByClause orderByClause(QString("id"),true);
-    QList<QgsFeatureRequest::OrderByClause> obcList = {orderByClause};
-    QgsFeatureRequest::OrderBy orderBy(obcList);
-    featRequest.setOrderBy(orderBy);
+    auto numCols = fieldIndices.size();
 
-    auto featIt = mainLayer->getFeatures(featRequest);
+    QgsChangedAttributesMap changes;
+    for(int row = 0; row<numRows; ++row)
+    {
+        QgsAttributeMap atrbMap;
+        for(int col = 0; col<numCols; ++col)
+            atrbMap.insert(fieldIndices.at(col), valueAt(col,row));
 
-    QgsFeatureList featList;
-    featList.reserve(values.size());
+        changes.insert(selectedFids.at(row), atrbMap);
+    }
 
-    int count = 0;
-    QgsFeature feat;
-    while (featIt.nextFeature(feat))
-    {
-        auto existingAtrb = feat.attributes();
+    auto res = pr->changeAttributeValues(changes);
 
-        // auto id = feat.id();
-        feat.setFields(existingFields, true);
+    if(!res)
+    {
+        error = "Error, failed to change the attribute values in the 'Selected Asset Layer' data provider. Please contact developers. Could not update the fields in "+selectedLayer->name();
+        return false;
+    }
 
-        auto newAtrb = values[count];
+    selectedLayer->triggerRepaint();
 
-        existingAtrb.append(newAtrb);
+    return true;
+}
 
-        // The number of provided attributes need to exactly match the number of the feature's fields.
-        feat.setAttributes(existingAtrb);
 
-        featList.push_back(feat);
-        ++count;
-    }
+QVector<QgsFeatureId> ComponentDatabase::getSelectedFidsInOrder(void) const
+{
+    // The imported rows are in order of the component ids, without an id map the ids are the feature ids shifted by the offset so they are in the same order
+    QVector<QPair<qint64, QgsFeatureId>> idsAndFids;
+    idsAndFids.reserve(selectedFidMap.size());
 
-    if(values.size() != featList.size())
+    for(auto it = selectedFidMap.constBegin(); it != selectedFidMap.constEnd(); ++it)
     {
-        error = "Error, inconsist sizes of values to update and number of updated features. Please contact developers. Could not add fields to "+selectedLayer->name();
-        return false;
+        auto id = fidToIdMap.isEmpty() ? it.key() - offset : fidToIdMap.value(it.key(), it.key());
+        idsAndFids.push_back(qMakePair(id, it.value()));
     }
 
-    auto res = selectedLayer->dataProvider()->truncate();
+    std::sort(idsAndFids.begin(), idsAndFids.end());
 
-    if(!res)
-    {
-        error = "Error, failed to remove existing features in the 'Selected Asset Layer' data provider. Please contact developers. Could not add fields to "+selectedLayer->name();
-        return false;
-    }
+    QVector<QgsFeatureId> selectedFids;
+    selectedFids.reserve(idsAndFids.size());
 
-    res = selectedLayer->dataProvider()->addAttributes(existingFields.toList());
+    for(auto&& it : idsAndFids)
+        selectedFids.push_back(it.second);
 
-    if(!res)
+    return selectedFids;
+}
+
+
+bool ComponentDatabase::addNewComponentAttributes(const QStringList& fieldNames, const QVector<QgsAttributes>& values, QString& error)
+{
+    if(values.empty())
     {
-         error = "Error adding attributes to the layer" + selectedLayer->name();
-         return false;
+        error = "Error, empty values.";
+        return false;
     }
 
-    selectedLayer->updateFields(); // tell the vector layer to fetch changes from the provider
-
-    res = selectedLayer->dataProvider()->addFeatures(featList);
+    auto numNewFields = fieldNames.size();
+    const auto& firstRow = values.first();
 
-    if(!res)
+    if(firstRow.size() != numNewFields)
     {
-        error = "Error, failed to add features to the 'Selected Asset Layer' data provider. Please contact developers. Could not add fields to "+selectedLayer->name();
+        error = "Error, the number of values must match the number of fields";
         return false;
     }
 
-    selectedLayer->updateExtents();
+    QVector<QVariant::Type> fieldTypes;
+    fieldTypes.reserve(numNewFields);
+    for(int i = 0; i <numNewFields; ++i)
+        fieldTypes.push_back(firstRow.at(i).type());
 
-    return res;
-}
+    auto valueAt = [&values](const int col, const int row)
+    {
+        return values.at(row).at(col);
+    };
 
+    return this->changeSelectedAttributeValues(fieldNames, fieldTypes, values.size(), valueAt, error);
+}
 
 
 bool ComponentDatabase::updateComponentAttributes(const QString& fieldName, const QVector<QVariant>& values, QString& error)
@@ -338,110 +435,238 @@ bool ComponentDatabase::updateComponentAttributes(const QString& fieldName, cons
         return false;
     }
 
-    auto numSelectedFeatures = selectedFeaturesSet.size();
-
-    auto numFeatSelLayer = selectedLayer->featureCount();
+    auto field = selectedLayer->dataProvider()->fieldNameIndex(fieldName);
 
-    if(values.size() != numSelectedFeatures || numSelectedFeatures != numFeatSelLayer)
+    if(field == -1)
     {
-        error = "Error, the number of assets in the imported data ("+QString::number(values.size())+ ") should be equal to the number of assets in the 'selected assets layer' (" + QString::number(numSelectedFeatures)+ "). /n Failed to batch update attribute: "+fieldName+". Please ensure all assets are loaded and added to the selected features layer in the input file stage.";
+        error = "Error, failed to find the field "+fieldName+" in the imported results";
         return false;
     }
 
-    auto field = selectedLayer->dataProvider()->fieldNameIndex(fieldName);
+    return this->updateComponentAttributes(QStringList{fieldName}, QVector<QVector<QVariant>>{values}, error);
+}
 
-    if(field == -1)
+
+bool ComponentDatabase::updateComponentAttributes(const QStringList& fieldNames, const QVector<QVector<QVariant>>& columns, QString& error)
+{
+    if(columns.size() != fieldNames.size() || columns.isEmpty())
     {
-        error = "Error, failed to find the field "+fieldName+" in the imported results";
+        error = "Error, the number of value columns must match the number of fields";
         return false;
     }
 
-    QgsFeatureRequest featRequest (selectedFeaturesSet);
+    auto numRows = columns.first().size();
 
-    // All this just to get the feature request to return everything with ascending ids
-    QgsFeatureRequest::OrderByClause orderByClause(QString("id"),true);
-    QList<QgsFeatureRequest::OrderByClause> obcList = {orderByClause};
-    QgsFeatureRequest::OrderBy orderBy(obcList);
-    featRequest.setOrderBy(orderBy);
+    QVector<QVariant::Type> fieldTypes;
+    fieldTypes.reserve(columns.size());
 
-    auto featIt = mainLayer->getFeatures(featRequest);
-
-    QgsFeatureList featList;
-    featList.reserve(values.size());
+    for(auto&& column : columns)
+    {
+        if(column.size() != numRows)
+        {
+            error = "Error, all of the value columns must have the same length";
+            return false;
+        }
+
+        // Use the type of the first value that is not null
+        auto type = QVariant::String;
+        for(auto&& val : column)
+        {
+            if(!val.isNull())
+            {
+                type = val.type();
+                break;
+            }
+        }
+
+        fieldTypes.push_back(type);
+    }
 
-    int count = 0;
-    QgsFeature feat;
-    while (featIt.nextFeature(feat))
+    auto valueAt = [&columns](const int col, const int row)
     {
-        // auto id = feat.id();
-        auto attrb = values[count];
+        return columns.at(col).at(row);
+    };
 
-        feat.setAttribute(field,attrb);
+    return this->changeSelectedAttributeValues(fieldNames, fieldTypes, numRows, valueAt, error);
+}
 
-        featList.push_back(feat);
-        ++count;
-    }
 
-    if(values.size() != featList.size())
+bool ComponentDatabase::updateComponentAttributes(const QStringList& fieldNames, const QVector<QVector<double>>& columns, QString& error)
+{
+    if(columns.size() != fieldNames.size() || columns.isEmpty())
     {
-        error = "Error, inconsist sizes of values to update and number of updated features. Please contact developers. Could not batch update field: "+fieldName;
+        error = "Error, the number of value columns must match the number of fields";
         return false;
     }
 
-    auto res = selectedLayer->dataProvider()->truncate();
+    auto numRows = columns.first().size();
 
-    if(!res)
+    for(auto&& column : columns)
     {
-        error = "Error, failed to remove existing features in the 'Selected Asset Layer' data provider. Please contact developers. Could not batch update field: "+fieldName;
-        return false;
+        if(column.size() != numRows)
+        {
+            error = "Error, all of the value columns must have the same length";
+            return false;
+        }
     }
 
-    res = selectedLayer->dataProvider()->addFeatures(featList);
+    QVector<QVariant::Type> fieldTypes(columns.size(), QVariant::Double);
 
-    if(!res)
+    auto valueAt = [&columns](const int col, const int row)
     {
-        error = "Error, failed to add features to the 'Selected Asset Layer' data provider. Please contact developers. Could not batch update field: "+fieldName;
+        return QVariant(columns.at(col).at(row));
+    };
+
+    return this->changeSelectedAttributeValues(fieldNames, fieldTypes, numRows, valueAt, error);
+}
+
+
+bool ComponentDatabase::startEditTransaction(void)
+{
+    if(mainLayer == nullptr)
         return false;
+
+    if(inEditTransaction)
+        return true;
+
+    mainLayerChanges.clear();
+    selectedLayerChanges.clear();
+
+    inEditTransaction = true;
+
+    return true;
+}
+
+
+bool ComponentDatabase::commitEditTransaction(QString& error)
+{
+    if(!inEditTransaction)
+        return true;
+
+    inEditTransaction = false;
+
+    if(!mainLayerChanges.isEmpty())
+    {
+        auto res = true;
+
+        // A layer that is being edited gets the changes in its edit buffer so that its source is only changed when the edits are saved
+        if(mainLayer->isEditable())
+        {
+            mainLayer->beginEditCommand("Update asset attributes");
+
+            for(auto it = mainLayerChanges.cbegin(); it != mainLayerChanges.cend(); ++it)
+                for(auto fieldIt = it.value().cbegin(); fieldIt != it.value().cend(); ++fieldIt)
+                    res = mainLayer->changeAttributeValue(it.key(),fieldIt.key(),fieldIt.value()) && res;
+
+            mainLayer->endEditCommand();
+        }
+        else
+        {
+            res = mainLayer->dataProvider()->changeAttributeValues(mainLayerChanges);
+        }
+
+        mainLayerChanges.clear();
+
+        if(!res)
+        {
+            selectedLayerChanges.clear();
+            error = "Error, failed to commit the attribute changes to the layer "+mainLayer->name();
+            return false;
+        }
+
+        mainLayer->triggerRepaint();
     }
 
-    selectedLayer->updateExtents();
+    if(!selectedLayerChanges.isEmpty() && selectedLayer != nullptr)
+    {
+        auto res = selectedLayer->dataProvider()->changeAttributeValues(selectedLayerChanges);
 
-    return res;
+        selectedLayerChanges.clear();
+
+        if(!res)
+        {
+            error = "Error, failed to commit the attribute changes to the layer "+selectedLayer->name();
+            return false;
+        }
+
+        selectedLayer->triggerRepaint();
+    }
+
+    return true;
+}
+
+
+void ComponentDatabase::rollBackEditTransaction(void)
+{
+    mainLayerChanges.clear();
+    selectedLayerChanges.clear();
+    inEditTransaction = false;
+}
+
+
+bool ComponentDatabase::isInEditTransaction(void) const
+{
+    return inEditTransaction;
 }
 
 
 bool ComponentDatabase::updateComponentAttribute(const qint64 id, const QString& attribute, const QVariant& value)
 {
+    if(mainLayer == nullptr)
+        return false;
 
-    auto fid = id+offset;
+    return this->updateFeatureAttribute(this->getFid(id),attribute,value,true);
+}
 
-    auto field = selectedLayer->dataProvider()->fieldNameIndex(attribute);
 
-    if(FID_IS_NULL(fid) || field == -1)
+bool ComponentDatabase::updateSelectedComponentAttribute(const QgsFeatureId fid, const QString& attribute, const QVariant& value)
+{
+    if(mainLayer == nullptr)
         return false;
 
-    mainLayer->startEditing();
+    return this->updateFeatureAttribute(fid,attribute,value,false);
+}
+
 
-    auto res = mainLayer->changeAttributeValue(fid,field,value);
+bool ComponentDatabase::updateFeatureAttribute(const QgsFeatureId fid, const QString& attribute, const QVariant& value, const bool updateMainLayer)
+{
+    auto field = mainLayer->dataProvider()->fieldNameIndex(attribute);
 
-    mainLayer->commitChanges(true);
+    if(FID_IS_NULL(fid) || field == -1)
+        return false;
 
-    if(!res)
-        return res;
+    // A single change without an open transaction gets its own transaction
+    auto implicitTransaction = !inEditTransaction;
 
-    // Update the selected layer if there is one...
+    if(implicitTransaction)
+        this->startEditTransaction();
+
+    if(updateMainLayer)
+        mainLayerChanges[fid].insert(field,value);
+
+    // Update the selected layer if the feature is in there
     if(selectedLayer != nullptr)
     {
-        auto fidSel = selectedFeaturesSet.values().indexOf(id);
+        auto it = selectedFidMap.constFind(fid);
+
+        if(it != selectedFidMap.constEnd())
+        {
+            auto fieldSel = selectedLayer->dataProvider()->fieldNameIndex(attribute);
+
+            if(fieldSel != -1)
+                selectedLayerChanges[it.value()].insert(fieldSel,value);
+        }
+    }
 
-        // Still return true if feature is not in the set
-        if(fidSel == -1)
-            return true;
+    if(implicitTransaction)
+    {
+        QString error;
+        auto res = this->commitEditTransaction(error);
 
-        auto res2 = selectedLayer->changeAttributeValue(fidSel,field,value);
+        if(!res)
+            messageHandler->appendErrorMessage(error);
 
-        if(!res2)
-            return res2;
+        return res;
     }
 
     return true;
@@ -451,11 +676,23 @@ bool ComponentDatabase::updateComponentAttribute(const qint64 id, const QString&
 QVariant ComponentDatabase::getAttributeValue(const qint64 id, const QString& attribute, const QVariant defaultVal)
 {
     QVariant val(defaultVal);
-    auto fid = id+offset;
+    auto fid = this->getFid(id);
 
     if(FID_IS_NULL(fid))
         return val;
 
+    // Check the uncommitted changes first
+    if(inEditTransaction)
+    {
+        auto it = mainLayerChanges.constFind(fid);
+        if(it != mainLayerChanges.constEnd())
+        {
+            auto field = mainLayer->dataProvider()->fieldNameIndex(attribute);
+            if(it.value().contains(field))
+                return it.value().value(field);
+        }
+    }
+
     auto feature = mainLayer->getFeature(fid);
 
     if(feature.isValid())
@@ -38,6 +38,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 // Written by: Stevan Gavrilovic
 
+#include <QHash>
 #include <QMap>
 #include <QVariant>
 
@@ -71,14 +72,28 @@ public:
     bool removeFeaturesFromSelectedLayer(QgsFeatureIds& featureIds);
     bool clearSelectedLayer(void);
 
-    // Slow, only use for sparse updates
+    // Edit transaction for attribute changes. Changes made with updateComponentAttribute between startEditTransaction and commitEditTransaction
+    // are buffered per layer and written to each layer's data provider in a single call on commit
+    bool startEditTransaction(void);
+    bool commitEditTransaction(QString& error);
+    void rollBackEditTransaction(void);
+    bool isInEditTransaction(void) const;
+
+    // Updates a single attribute. If an edit transaction is open the change is buffered, otherwise the change is committed immediately
     bool updateComponentAttribute(const qint64 id, const QString& attribute, const QVariant& value);
 
+    // Updates only the copy in the selected layer of a feature of the main layer, for a value that was already changed in the main layer, e.g., in its edit buffer
+    bool updateSelectedComponentAttribute(const QgsFeatureId fid, const QString& attribute, const QVariant& value);
+
     // Fast, use for batch updates
     bool updateComponentAttributes(const QString& fieldName, const QVector<QVariant>& values, QString& error);
 
+    // Fast, use for batch updates of many fields in one pass. Each column holds the values of one field for all of the selected components, in order of ascending component id.
+    // The values are changed in place in the selected layer, fields that do not exist yet are added with the type of the column.
+    bool updateComponentAttributes(const QStringList& fieldNames, const QVector<QVector<QVariant>>& columns, QString& error);
+    bool updateComponentAttributes(const QStringList& fieldNames, const QVector<QVector<double>>& columns, QString& error);
+
     // The field names passed as a vector and values passed as a matrix where each row is a component and each column is the fied value
-    // The number of provided attributes need to exactly match the number of the feature's fields.
     bool addNewComponentAttributes(const QStringList& fieldNames, const QVector<QgsAttributes>& values, QString& error);
 
     QVariant getAttributeValue(const qint64 id, const QString& attribute, const QVariant defaultVal = QVariant());
@@ -97,20 +112,50 @@ public:
 
     void setOffset(int value);
 
+    // Maps the component ids to the feature ids in the main layer, used instead of the offset when the ids are not contiguous
+    // Setting the offset clears the map
+    void setIdToFidMap(const QHash<qint64, qint64>& value);
+
 private:
     ProgramOutputDialog* messageHandler;
 
     bool addFeatureToSelectedLayer(QgsFeature& feature);
 
+    // Returns the feature id in the main layer of the component id
+    QgsFeatureId getFid(const qint64 id) const;
+
+    // Buffers the change of the feature of the main layer, and of its copy in the selected layer, in the open edit transaction or commits it right away
+    bool updateFeatureAttribute(const QgsFeatureId fid, const QString& attribute, const QVariant& value, const bool updateMainLayer);
+
+    // Changes the attribute values of the selected layer in place with a single provider call, valueAt(column,row) returns the value of field 'column' for the component in 'row'
+    template <typename ValueAccessor>
+    bool changeSelectedAttributeValues(const QStringList& fieldNames, const QVector<QVariant::Type>& fieldTypes, const int numRows, ValueAccessor valueAt, QString& error);
+
+    // Returns the selected layer feature ids in order of ascending component id
+    QVector<QgsFeatureId> getSelectedFidsInOrder(void) const;
+
     // Selected feature set
     QSet<long long> selectedFeaturesSet;
 
+    // Maps the feature id in the main layer to the feature id of its copy in the selected layer
+    QHash<QgsFeatureId, QgsFeatureId> selectedFidMap;
+
+    // Pending attribute changes of the open edit transaction, keyed by the feature id in the respective layer
+    QgsChangedAttributesMap mainLayerChanges;
+    QgsChangedAttributesMap selectedLayerChanges;
+    bool inEditTransaction = false;
+
     // Set of layers that this component may have features in
     QgsVectorLayer* mainLayer = nullptr;
     QgsVectorLayer* selectedLayer = nullptr;
 
     int offset;
 
+    QHash<qint64, qint64> idToFidMap;
+
+    // Inverse of the id map, used to order the selected features by their component id
+    QHash<qint64, qint64> fidToIdMap;
+
     QString componentType;
 };
 
@@ -0,0 +1,113 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "ComponentTableEditor.h"
+#include "ComponentDatabase.h"
+#include "ComponentTableModel.h"
+
+
+bool ComponentTableEditor::applyCellChange(ComponentTableModel* model, ComponentDatabase* db, const int row, const int col, QString& err)
+{
+    auto attrib = model->headerData(col, Qt::Horizontal).toString();
+
+    auto attribVal = model->item(row,col);
+
+    auto layer = model->getLayer();
+
+    QString msg;
+
+    if(layer != nullptr && layer == db->getMainLayer())
+    {
+        // The table already put the value in the edit buffer of the main layer, only the copy in the selected layer is left
+        if(!db->updateSelectedComponentAttribute(model->getRowFid(row),attrib,attribVal))
+            msg = "Error could not update the asset in the row "+QString::number(row+1)+" after cell change";
+    }
+    else
+    {
+        auto ID = model->item(row,0).toInt();
+
+        if(!db->updateComponentAttribute(ID,attrib,attribVal))
+            msg = "Error could not update asset "+QString::number(ID)+" after cell change";
+    }
+
+    if(msg.isEmpty())
+        return true;
+
+    // The first error of a bulk edit is reported when the edit is finished
+    if(db->isInEditTransaction())
+    {
+        if(bulkEditError.isEmpty())
+            bulkEditError = msg;
+
+        return true;
+    }
+
+    err = msg;
+
+    return false;
+}
+
+
+void ComponentTableEditor::startBulkEdit(ComponentDatabase* db)
+{
+    bulkEditError.clear();
+
+    // The cell changes of the edit are committed to the database at once
+    db->startEditTransaction();
+}
+
+
+bool ComponentTableEditor::finishBulkEdit(ComponentTableModel* model, ComponentDatabase* db, const QString& tableErr, QString& err)
+{
+    if(!tableErr.isEmpty() || !bulkEditError.isEmpty())
+    {
+        db->rollBackEditTransaction();
+
+        // The table put back its cells if it failed, otherwise put them back here to keep the table and the database in step
+        if(tableErr.isEmpty())
+            model->revertBulkEdit();
+
+        err = (tableErr.isEmpty() ? bulkEditError : tableErr) + "\nNone of the values were set";
+
+        bulkEditError.clear();
+
+        return false;
+    }
+
+    return db->commitEditTransaction(err);
+}
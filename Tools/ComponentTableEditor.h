@@ -0,0 +1,69 @@
+#ifndef COMPONENTTABLEEDITOR_H
+#define COMPONENTTABLEEDITOR_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+
+// Written by: Stevan Gavrilovic
+
+// Applies the cell edits of a component table to the component database, shared by the widgets that show a component table
+// The cells set together in a bulk edit, e.g., pasted from a spreadsheet, are applied in one edit transaction of the database
+
+#include <QString>
+
+class ComponentDatabase;
+class ComponentTableModel;
+
+class ComponentTableEditor
+{
+public:
+
+    // Applies the changed cell to the database, returns false with the error if the change could not be applied
+    // The error of a cell in a bulk edit is kept until the edit is finished
+    bool applyCellChange(ComponentTableModel* model, ComponentDatabase* db, const int row, const int col, QString& err);
+
+    void startBulkEdit(ComponentDatabase* db);
+
+    // Commits the bulk edit to the database, or rolls it back together with the cells of the table if the table or the database failed
+    bool finishBulkEdit(ComponentTableModel* model, ComponentDatabase* db, const QString& tableErr, QString& err);
+
+private:
+
+    // The first error of the cell changes in a bulk edit of the table
+    QString bulkEditError;
+};
+
+#endif // COMPONENTTABLEEDITOR_H
@@ -0,0 +1,457 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+#include "FaultRuptureSet.h"
+#include "CSVReaderWriter.h"
+#include "GmCommon.h"
+#include "TaskRunner.h"
+
+#include <qgsgeometry.h>
+#include <qgslinestring.h>
+#include <qgsmultilinestring.h>
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <numeric>
+
+// Increment when the layout of the cache file changes
+const quint32 ruptureCacheMagicNumber = 0x46525054;
+const qint32 ruptureCacheVersion = 2;
+
+// The heading of the column with the fault traces
+const QString traceHeading = "FaultTrace";
+
+
+FaultRuptureSet::FaultRuptureSet()
+{
+
+}
+
+
+bool FaultRuptureSet::load(const QString& pathToFile, QString& err, TaskContext* context)
+{
+    this->clear();
+
+    if(context)
+        context->setStatus("Reading the fault ruptures");
+
+    // Hash the contents of the file to find the cached ruptures
+    QFile file(pathToFile);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        err = "Could not open the fault rupture file " + pathToFile;
+        return false;
+    }
+
+    QCryptographicHash fileHash(QCryptographicHash::Sha1);
+    fileHash.addData(&file);
+    file.close();
+
+    auto pathToCache = getPathToCache(fileHash.result());
+
+    if(this->readCache(pathToCache))
+        return true;
+
+    this->clear();
+
+    if(!this->parseFile(pathToFile, err, context))
+    {
+        this->clear();
+        return false;
+    }
+
+    // The ruptures are usable without the cache, the next load parses the file again
+    this->writeCache(pathToCache, err);
+
+    return true;
+}
+
+
+void FaultRuptureSet::clear(void)
+{
+    columns.clear();
+    traces.clear();
+}
+
+
+int FaultRuptureSet::size(void) const
+{
+    return traces.size();
+}
+
+
+const QVector<OQAttributeColumn>& FaultRuptureSet::getColumns(void) const
+{
+    return columns;
+}
+
+
+QList<QgsField> FaultRuptureSet::getFields(void) const
+{
+    QList<QgsField> fields;
+    fields.push_back(QgsField("AssetType", QVariant::String));
+    fields.push_back(QgsField("TabName", QVariant::String));
+
+    for(auto&& it : columns)
+        fields.push_back(QgsField(it.name, it.type()));
+
+    return fields;
+}
+
+
+bool FaultRuptureSet::createFeatures(QgsFeatureList& features, QString& err) const
+{
+    const int numRuptures = traces.size();
+    const int numColumns = columns.size();
+
+    for(auto&& it : columns)
+    {
+        if(it.size() != numRuptures)
+        {
+            err = "Error, the number of values in the column " + it.name + " does not equal the number of ruptures";
+            return false;
+        }
+    }
+
+    QVector<QgsFeature> ruptureFeatures(numRuptures);
+
+    // Get the raw pointer before going parallel so that the vector is not detached in the worker threads
+    QgsFeature* featureData = ruptureFeatures.data();
+
+    QVector<int> chunkBegins;
+    const int chunkSize = 4096;
+    for(int i = 0; i<numRuptures; i += chunkSize)
+        chunkBegins.push_back(i);
+
+    QtConcurrent::blockingMap(chunkBegins, [&](const int begin)
+    {
+        const auto end = std::min(begin+chunkSize, numRuptures);
+
+        for(int i = begin; i<end; ++i)
+        {
+            QgsAttributes featAttributes(2+numColumns);
+
+            featAttributes[0] = "FaultRuptureTrace";     // "AssetType"
+            featAttributes[1] = "Fault Rupture Trace";  // "TabName"
+
+            for(int j = 0; j<numColumns; ++j)
+                featAttributes[2+j] = columns.at(j).value(i);
+
+            QgsGeometry geom;
+            geom.fromWkb(traces.at(i));
+
+            QgsFeature& feature = featureData[i];
+            feature.setGeometry(geom);
+            feature.setAttributes(featAttributes);
+        }
+    });
+
+    features = ruptureFeatures.toList();
+
+    return true;
+}
+
+
+bool FaultRuptureSet::parseTrace(const QString& trace, QByteArray& wkb)
+{
+    auto multiLine = std::make_unique<QgsMultiLineString>();
+
+    // The points of the part that is being parsed
+    QVector<double> x;
+    QVector<double> y;
+
+    // The points are the innermost bracketed lists, the values after the longitude and latitude are skipped
+    // Every list of points is a part, so [[-122,38],[-123,38.1]] is a single part and [[[-122,38],[-123,38.1]],[[-121,37],[-121.5,37.2]]] has two parts
+    double tuple[2] = {0.0, 0.0};
+    int numInTuple = 0;
+    bool inTuple = false;
+    int tokenBegin = 0;
+
+    const auto length = trace.size();
+    const QChar* chars = trace.constData();
+
+    for(int i = 0; i<length; ++i)
+    {
+        const auto c = chars[i];
+
+        if(c == QLatin1Char('['))
+        {
+            inTuple = true;
+            numInTuple = 0;
+            tokenBegin = i+1;
+            continue;
+        }
+
+        if(c != QLatin1Char(',') && c != QLatin1Char(']'))
+            continue;
+
+        if(inTuple)
+        {
+            auto token = trace.midRef(tokenBegin, i-tokenBegin).trimmed();
+
+            if(!token.isEmpty())
+            {
+                bool OK = false;
+                auto val = token.toDouble(&OK);
+
+                if(!OK)
+                    return false;
+
+                if(numInTuple < 2)
+                    tuple[numInTuple] = val;
+
+                ++numInTuple;
+            }
+
+            if(c == QLatin1Char(']'))
+            {
+                if(numInTuple < 2)
+                    return false;
+
+                x.push_back(tuple[0]);
+                y.push_back(tuple[1]);
+
+                inTuple = false;
+            }
+        }
+        else if(c == QLatin1Char(']') && !x.isEmpty())
+        {
+            // The list of points is closed, a part needs at least two points
+            if(x.size() < 2)
+                return false;
+
+            multiLine->addGeometry(new QgsLineString(x, y));
+
+            x.clear();
+            y.clear();
+        }
+
+        tokenBegin = i+1;
+    }
+
+    // Points that are not closed by a list are not a valid trace
+    if(!x.isEmpty() || multiLine->numGeometries() == 0)
+        return false;
+
+    QgsGeometry geom(multiLine.release());
+
+    wkb = geom.asWkb();
+
+    return !wkb.isEmpty();
+}
+
+
+bool FaultRuptureSet::parseFile(const QString& pathToFile, QString& err, TaskContext* context)
+{
+    CSVReaderWriter csvTool;
+
+    QVector<QStringList> data = csvTool.parseCSVFile(pathToFile, err);
+
+    if(!err.isEmpty())
+        return false;
+
+    if(data.size() < 2)
+    {
+        err = "The fault rupture file " + pathToFile + " is empty";
+        return false;
+    }
+
+    const auto headings = data.first();
+    const auto traceIdx = headings.indexOf(traceHeading);
+
+    if(traceIdx == -1)
+    {
+        err = "Could not find the fault trace geometry in " + pathToFile + ". The fault trace heading should be '" + traceHeading + "'";
+        return false;
+    }
+
+    const int numRows = data.size()-1;
+    const int numParams = headings.size();
+
+    for(int i = 1; i<data.size(); ++i)
+    {
+        if(data.at(i).size() != numParams)
+        {
+            err = "The number of columns in the row " + QString::number(i) + " of the fault rupture file should be " + QString::number(numParams);
+            return false;
+        }
+    }
+
+    // Parse the traces in parallel, the first row that fails is reported
+    traces.resize(numRows);
+
+    // Get the raw pointer before going parallel so that the vector is not detached in the worker threads
+    auto traceData = traces.data();
+
+    std::atomic<int> firstBadRow(std::numeric_limits<int>::max());
+
+    TaskContext localContext;
+    auto& parseContext = context ? *context : localContext;
+
+    parseContext.setStatus("Parsing the fault traces");
+    parseContext.setTotal(numRows);
+    parseContext.setProgress(0);
+
+    TaskRunner::parallelFor(parseContext, numRows, [&](int i)
+    {
+        if(parseTrace(data.at(i+1).at(traceIdx), traceData[i]))
+            return;
+
+        auto current = firstBadRow.load();
+        while(i < current && !firstBadRow.compare_exchange_weak(current, i))
+        {
+        }
+    }, 1024);
+
+    if(parseContext.isCanceled())
+    {
+        err = "Loading the fault ruptures was canceled";
+        return false;
+    }
+
+    if(firstBadRow.load() != std::numeric_limits<int>::max())
+    {
+        err = "Error getting the fault trace geometry of the rupture in row " + QString::number(firstBadRow.load()+1);
+        return false;
+    }
+
+    // Fill the parameter columns in parallel, one column per task
+    QVector<int> paramIndices;
+    for(int j = 0; j<numParams; ++j)
+    {
+        if(j != traceIdx)
+            paramIndices.push_back(j);
+    }
+
+    columns.resize(paramIndices.size());
+
+    // Get the raw pointer before going parallel so that the vector is not detached in the worker threads
+    auto columnData = columns.data();
+
+    QVector<int> columnIndices(paramIndices.size());
+    std::iota(columnIndices.begin(), columnIndices.end(), 0);
+
+    QtConcurrent::blockingMap(columnIndices, [&](const int c)
+    {
+        const auto j = paramIndices.at(c);
+
+        auto& column = columnData[c];
+        column.name = headings.at(j);
+
+        // The event names stay text even if they look like numbers
+        if(column.name == "EventName")
+            column.isNumeric = false;
+
+        for(int i = 1; i<=numRows; ++i)
+            column.append(data.at(i).at(j));
+    });
+
+    return true;
+}
+
+
+bool FaultRuptureSet::readCache(const QString& pathToCache)
+{
+    QFile file(pathToCache);
+    if(!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_12);
+
+    quint32 magicNumber = 0;
+    qint32 version = 0;
+
+    stream >> magicNumber >> version;
+
+    if(magicNumber != ruptureCacheMagicNumber || version != ruptureCacheVersion)
+        return false;
+
+    stream >> columns >> traces;
+
+    if(stream.status() != QDataStream::Ok || traces.isEmpty())
+        return false;
+
+    for(auto&& it : columns)
+    {
+        if(it.size() != traces.size())
+            return false;
+    }
+
+    return true;
+}
+
+
+bool FaultRuptureSet::writeCache(const QString& pathToCache, QString& err) const
+{
+    QDir().mkpath(QFileInfo(pathToCache).absolutePath());
+
+    // Write to a temporary file so that a partial cache is never read back
+    QSaveFile file(pathToCache);
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        err = "Could not write the fault rupture cache "+pathToCache+": "+file.errorString();
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_12);
+
+    stream << ruptureCacheMagicNumber << ruptureCacheVersion << columns << traces;
+
+    if(stream.status() != QDataStream::Ok || !file.commit())
+    {
+        err = "Could not write the fault rupture cache "+pathToCache+": "+file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+
+QString FaultRuptureSet::getPathToCache(const QByteArray& fileHash)
+{
+    return GmCommon::getCacheLocation() + QDir::separator() + "FaultRuptures" + QDir::separator() + QString(fileHash.toHex()) + ".bin";
+}
@@ -0,0 +1,90 @@
+#ifndef FAULTRUPTURESET_H
+#define FAULTRUPTURESET_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Reads a file of user defined fault ruptures into columns
+// The fault traces are parsed in parallel chunks into WKB line strings, and the rupture parameters are stored as numbers when all of the values in a column are numeric
+// The parsed ruptures are cached in a binary file keyed by the SHA-1 of the rupture file, so that loading the same file again skips the parsing
+
+#include "OQAttributeColumn.h"
+
+#include <qgsfeature.h>
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+class TaskContext;
+
+class FaultRuptureSet
+{
+public:
+    FaultRuptureSet();
+
+    // Loads the ruptures from the cache if there is one for the contents of the file, otherwise the file is parsed and the cache is written
+    // If the ruptures are loaded but the cache could not be written, true is returned and err holds the reason
+    bool load(const QString& pathToFile, QString& err, TaskContext* context = nullptr);
+
+    void clear(void);
+
+    int size(void) const;
+
+    // The columns of the file except for the fault traces, which are the geometries of the ruptures
+    const QVector<OQAttributeColumn>& getColumns(void) const;
+
+    // The fields of a rupture layer, the asset type and tab name come first
+    QList<QgsField> getFields(void) const;
+
+    // Creates a line string feature for every rupture in parallel
+    bool createFeatures(QgsFeatureList& features, QString& err) const;
+
+    // Parses a trace such as [[-122,38,0],[-123,38.1,0]] into a WKB multi line string with one part per list of points, the first two values of every point are the longitude and latitude
+    static bool parseTrace(const QString& trace, QByteArray& wkb);
+
+private:
+    bool parseFile(const QString& pathToFile, QString& err, TaskContext* context);
+
+    bool readCache(const QString& pathToCache);
+    bool writeCache(const QString& pathToCache, QString& err) const;
+
+    static QString getPathToCache(const QByteArray& fileHash);
+
+    QVector<OQAttributeColumn> columns;
+    QVector<QByteArray> traces;
+};
+
+#endif // FAULTRUPTURESET_H
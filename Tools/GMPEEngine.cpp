@@ -0,0 +1,560 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+#include "GMPEEngine.h"
+#include "SimCenterPreferences.h"
+
+#include <QDir>
+#include <QtConcurrent/QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+
+namespace
+{
+
+const double pi = 3.14159265358979323846;
+
+// Mean radius of the earth in km
+const double earthRadius = 6371.0;
+
+// In place Cholesky decomposition of a symmetric positive definite matrix stored row major, the lower triangle is overwritten with the factor
+bool choleskyDecompose(double* A, const int n)
+{
+    for(int j = 0; j<n; ++j)
+    {
+        double sum = A[j*n+j];
+        for(int k = 0; k<j; ++k)
+            sum -= A[j*n+k]*A[j*n+k];
+
+        if(sum <= 0.0)
+            return false;
+
+        A[j*n+j] = std::sqrt(sum);
+
+        for(int i = j+1; i<n; ++i)
+        {
+            double s = A[i*n+j];
+            for(int k = 0; k<j; ++k)
+                s -= A[i*n+k]*A[j*n+k];
+
+            A[i*n+j] = s/A[j*n+j];
+        }
+    }
+
+    return true;
+}
+
+
+// Solves L*L^T*x = b given the factor from choleskyDecompose, x is overwritten on b
+void choleskySolve(const double* L, const int n, double* b)
+{
+    for(int i = 0; i<n; ++i)
+    {
+        double s = b[i];
+        for(int k = 0; k<i; ++k)
+            s -= L[i*n+k]*b[k];
+
+        b[i] = s/L[i*n+i];
+    }
+
+    for(int i = n-1; i>=0; --i)
+    {
+        double s = b[i];
+        for(int k = i+1; k<n; ++k)
+            s -= L[k*n+i]*b[k];
+
+        b[i] = s/L[i*n+i];
+    }
+}
+
+
+// Factors a correlation matrix, a small nugget is added to the diagonal if it is not positive definite
+void factorCorrelationMatrix(QVector<double>& A, const int n)
+{
+    const auto original = A;
+
+    double nugget = 1.0e-10;
+    while(!choleskyDecompose(A.data(),n) && nugget < 1.0)
+    {
+        A = original;
+        for(int i = 0; i<n; ++i)
+            A[i*n+i] += nugget;
+
+        nugget *= 10.0;
+    }
+}
+
+}
+
+
+double GMField::getTotalSigma(const int siteIndex, const int imIndex) const
+{
+    auto i = this->index(siteIndex,imIndex);
+
+    return std::sqrt(tau.at(i)*tau.at(i) + phi.at(i)*phi.at(i));
+}
+
+
+GMPEEngine::GMPEEngine()
+{
+
+}
+
+
+bool GMPEEngine::setModel(const QString& type, const QString& dataDirectory, QString& err)
+{
+    auto newModel = GroundMotionModel::create(type);
+
+    if(newModel == nullptr)
+    {
+        err = "The ground motion model "+type+" is not supported";
+        return false;
+    }
+
+    if(!newModel->loadCoefficients(dataDirectory, err))
+        return false;
+
+    model = std::move(newModel);
+
+    return true;
+}
+
+
+QString GMPEEngine::getDefaultDataDirectory(void)
+{
+    return SimCenterPreferences::getInstance()->getAppDir() + QDir::separator()
+            + "applications" + QDir::separator() + "performRegionalEventSimulation" + QDir::separator()
+            + "regionalGroundMotion" + QDir::separator() + "gmpe" + QDir::separator() + "data";
+}
+
+
+bool GMPEEngine::computeField(const GMRupture& rupture, GMSiteArrays& sites, const QVector<double>& periods, GMField& field, QString& err) const
+{
+    if(model == nullptr)
+    {
+        err = "The ground motion model is not set";
+        return false;
+    }
+
+    const auto numSites = sites.size();
+
+    if(numSites == 0 || sites.longitude.size() != numSites || sites.vs30.size() != numSites)
+    {
+        err = "The site arrays are empty or do not have the same size";
+        return false;
+    }
+
+    if(periods.isEmpty())
+    {
+        err = "No intensity measures were requested";
+        return false;
+    }
+
+    const auto& table = model->getCoefficientTable();
+
+    // Periods that are not in the table are interpolated in log-period between the tabulated periods that bracket them
+    const auto numIMs = periods.size();
+    QVector<double> lowerPeriods(numIMs), upperPeriods(numIMs), weights(numIMs, 0.0);
+    for(int j = 0; j<numIMs; ++j)
+    {
+        const auto period = periods.at(j);
+
+        if(!table.getBracketingPeriods(period, lowerPeriods[j], upperPeriods[j]))
+        {
+            err = "The period "+QString::number(period)+" s is outside of the range of the model "+model->getName();
+            return false;
+        }
+
+        const auto lower = lowerPeriods.at(j);
+        const auto upper = upperPeriods.at(j);
+
+        if(upper == lower)
+            weights[j] = 0.0;
+        else if(lower <= 0.0)
+            weights[j] = (period-lower)/(upper-lower);
+        else
+            weights[j] = std::log(period/lower)/std::log(upper/lower);
+    }
+
+    field.numSites = numSites;
+    field.periods = periods;
+    field.lnMedian.resize(numIMs*numSites);
+    field.tau.resize(numIMs*numSites);
+    field.phi.resize(numIMs*numSites);
+
+    sites.rjb.resize(numSites);
+    sites.rrup.resize(numSites);
+
+    // Get the raw pointers before going parallel so that the vectors are not detached in the worker threads
+    double* lnMedian = field.lnMedian.data();
+    double* tau = field.tau.data();
+    double* phi = field.phi.data();
+
+    QVector<int> chunkBegins;
+    for(int i = 0; i<numSites; i += chunkSize)
+        chunkBegins.push_back(i);
+
+    const auto* theModel = model.get();
+
+    auto evaluateChunk = [&](const int begin)
+    {
+        const auto end = std::min(begin+chunkSize, numSites);
+        const auto n = end-begin;
+
+        computeDistances(rupture, sites, begin, end);
+
+        QVector<double> upperValues(3*n);
+
+        for(int j = 0; j<numIMs; ++j)
+        {
+            auto offset = j*numSites + begin;
+
+            theModel->evaluate(rupture, sites, lowerPeriods.at(j), begin, end, lnMedian+offset, tau+offset, phi+offset);
+
+            const auto w = weights.at(j);
+
+            if(w == 0.0)
+                continue;
+
+            double* upperMedian = upperValues.data();
+            double* upperTau = upperMedian + n;
+            double* upperPhi = upperTau + n;
+
+            theModel->evaluate(rupture, sites, upperPeriods.at(j), begin, end, upperMedian, upperTau, upperPhi);
+
+            for(int k = 0; k<n; ++k)
+            {
+                lnMedian[offset+k] += w*(upperMedian[k]-lnMedian[offset+k]);
+                tau[offset+k] += w*(upperTau[k]-tau[offset+k]);
+                phi[offset+k] += w*(upperPhi[k]-phi[offset+k]);
+            }
+        }
+    };
+
+    QtConcurrent::blockingMap(chunkBegins, evaluateChunk);
+
+    return true;
+}
+
+
+bool GMPEEngine::sampleField(const GMField& field, const GMSiteArrays& sites, const QString& interEventModel, const QString& intraEventModel, const int numRealizations,
+                             const unsigned int seed, QVector<double>& lnSamples, QString& err) const
+{
+    if(interEventModel.compare("Baker & Jayaram (2008)") != 0)
+    {
+        err = "The inter-event correlation model "+interEventModel+" is not supported, only Baker & Jayaram (2008) can be sampled in the application";
+        return false;
+    }
+
+    if(intraEventModel.compare("Jayaram & Baker (2009)") != 0)
+    {
+        err = "The intra-event correlation model "+intraEventModel+" is not supported, only Jayaram & Baker (2009) can be sampled in the application";
+        return false;
+    }
+
+    const auto numSites = field.numSites;
+    const auto numIMs = field.periods.size();
+
+    if(numSites == 0 || numSites != sites.size() || numRealizations < 1)
+    {
+        err = "The field does not match the sites or the number of realizations is less than one";
+        return false;
+    }
+
+    // Correlation of the inter-event residuals between the intensity measures
+    QVector<double> interCorrelation(numIMs*numIMs);
+    for(int j = 0; j<numIMs; ++j)
+        for(int k = 0; k<numIMs; ++k)
+            interCorrelation[j*numIMs+k] = getBakerJayaramCorrelation(field.periods.at(j), field.periods.at(k));
+
+    factorCorrelationMatrix(interCorrelation, numIMs);
+
+    std::mt19937 generator(seed);
+    std::normal_distribution<double> normalDist(0.0,1.0);
+
+    // Normalized inter-event residuals, one set per realization
+    QVector<double> interEps(numRealizations*numIMs, 0.0);
+    QVector<double> z(numIMs);
+    for(int r = 0; r<numRealizations; ++r)
+    {
+        for(auto&& it : z)
+            it = normalDist(generator);
+
+        for(int j = 0; j<numIMs; ++j)
+            for(int k = 0; k<=j; ++k)
+                interEps[r*numIMs+j] += interCorrelation.at(j*numIMs+k)*z.at(k);
+    }
+
+    lnSamples.resize(numRealizations*numIMs*numSites);
+    double* samples = lnSamples.data();
+
+    // Every intra-event field is independent so they are sampled in parallel, each with its own seed to keep the results repeatable
+    QVector<int> tasks(numRealizations*numIMs);
+    std::iota(tasks.begin(), tasks.end(), 0);
+
+    auto sampleTask = [&](const int task)
+    {
+        const auto j = task % numIMs;
+
+        double* result = samples + task*numSites;
+
+        this->sampleSpatialField(sites, getJayaramBakerRange(field.periods.at(j)), seed + 1 + static_cast<unsigned int>(task), result);
+
+        const auto eta = interEps.at(task);
+        const auto offset = j*numSites;
+
+        for(int i = 0; i<numSites; ++i)
+            result[i] = field.lnMedian.at(offset+i) + field.tau.at(offset+i)*eta + field.phi.at(offset+i)*result[i];
+    };
+
+    QtConcurrent::blockingMap(tasks, sampleTask);
+
+    return true;
+}
+
+
+void GMPEEngine::computeDistances(const GMRupture& rupture, GMSiteArrays& sites, const int begin, const int end)
+{
+    const auto degToRad = pi/180.0;
+
+    const auto lat0 = rupture.latitude*degToRad;
+    const auto lon0 = rupture.longitude*degToRad;
+    const auto cosLat0 = std::cos(lat0);
+
+    const auto ztor = GroundMotionModel::getZtor(rupture);
+    const auto ztor2 = ztor*ztor;
+
+    const double* lat = sites.latitude.constData();
+    const double* lon = sites.longitude.constData();
+    double* rjb = sites.rjb.data();
+    double* rrup = sites.rrup.data();
+
+    for(int i = begin; i<end; ++i)
+    {
+        // Haversine distance to the epicenter
+        const auto lat1 = lat[i]*degToRad;
+        const auto sinDLat = std::sin(0.5*(lat1-lat0));
+        const auto sinDLon = std::sin(0.5*(lon[i]*degToRad-lon0));
+        const auto a = sinDLat*sinDLat + cosLat0*std::cos(lat1)*sinDLon*sinDLon;
+
+        const auto dist = 2.0*earthRadius*std::asin(std::min(1.0,std::sqrt(a)));
+
+        rjb[i] = dist;
+        rrup[i] = std::sqrt(dist*dist + ztor2);
+    }
+}
+
+
+double GMPEEngine::getBakerJayaramCorrelation(const double period1, const double period2)
+{
+    const auto T1 = std::max(period1,0.01);
+    const auto T2 = std::max(period2,0.01);
+
+    const auto Tmin = std::min(T1,T2);
+    const auto Tmax = std::max(T1,T2);
+
+    if(Tmin == Tmax)
+        return 1.0;
+
+    const auto C1 = 1.0 - std::cos(pi/2.0 - 0.366*std::log(Tmax/std::max(Tmin,0.109)));
+
+    double C2 = 0.0;
+    if(Tmax < 0.2)
+        C2 = 1.0 - 0.105*(1.0 - 1.0/(1.0 + std::exp(100.0*Tmax - 5.0)))*(Tmax-Tmin)/(Tmax-0.0099);
+
+    const auto C3 = Tmax < 0.109 ? C2 : C1;
+
+    const auto C4 = C1 + 0.5*(std::sqrt(C3) - C3)*(1.0 + std::cos(pi*Tmin/0.109));
+
+    if(Tmax < 0.109)
+        return C2;
+    else if(Tmin > 0.109)
+        return C1;
+    else if(Tmax < 0.2)
+        return std::min(C2,C4);
+
+    return C4;
+}
+
+
+double GMPEEngine::getJayaramBakerRange(const double period)
+{
+    // Case 1 of Jayaram & Baker (2009), the range grows faster below 1 s
+    return period < 1.0 ? 8.5 + 17.2*period : 22.0 + 3.7*period;
+}
+
+
+void GMPEEngine::sampleSpatialField(const GMSiteArrays& sites, const double range, const unsigned int seed, double* result) const
+{
+    const auto numSites = sites.size();
+
+    std::mt19937 generator(seed);
+    std::normal_distribution<double> normalDist(0.0,1.0);
+
+    // Project the sites onto a local plane in km
+    const auto meanLat = std::accumulate(sites.latitude.begin(), sites.latitude.end(), 0.0)/numSites;
+    const auto kmPerDegree = earthRadius*pi/180.0;
+    const auto kmPerDegreeLon = kmPerDegree*std::cos(meanLat*pi/180.0);
+
+    QVector<double> x(numSites), y(numSites);
+    for(int i = 0; i<numSites; ++i)
+    {
+        x[i] = sites.longitude.at(i)*kmPerDegreeLon;
+        y[i] = sites.latitude.at(i)*kmPerDegree;
+    }
+
+    const auto minX = *std::min_element(x.begin(), x.end());
+    const auto maxX = *std::max_element(x.begin(), x.end());
+    const auto minY = *std::min_element(y.begin(), y.end());
+    const auto maxY = *std::max_element(y.begin(), y.end());
+
+    // Beyond the range the correlation is less than 5%, so sites that are further away are not used for conditioning
+    const auto searchRadius = range;
+    const auto searchRadius2 = searchRadius*searchRadius;
+
+    // Size the cells of the spatial hash so that every cell holds about as many sites as there are neighbours
+    const auto area = std::max((maxX-minX)*(maxY-minY), 1.0e-6);
+    const auto cellSize = std::min(std::max(std::sqrt(area*numNeighbours/numSites), 1.0e-3), searchRadius);
+
+    const int numCellsX = static_cast<int>((maxX-minX)/cellSize) + 1;
+    const int numCellsY = static_cast<int>((maxY-minY)/cellSize) + 1;
+    const int maxRing = static_cast<int>(std::ceil(searchRadius/cellSize));
+
+    // The sites that have already been simulated, by cell
+    QVector<QVector<int>> cells(numCellsX*numCellsY);
+
+    QVector<int> path(numSites);
+    std::iota(path.begin(), path.end(), 0);
+    std::shuffle(path.begin(), path.end(), generator);
+
+    QVector<QPair<double,int>> candidates;
+    QVector<double> C(numNeighbours*numNeighbours);
+    QVector<double> c(numNeighbours);
+    QVector<double> w(numNeighbours);
+
+    for(auto&& site : path)
+    {
+        const auto cx = static_cast<int>((x.at(site)-minX)/cellSize);
+        const auto cy = static_cast<int>((y.at(site)-minY)/cellSize);
+
+        candidates.clear();
+
+        for(int ring = 0; ring<=maxRing; ++ring)
+        {
+            for(int i = cx-ring; i<=cx+ring; ++i)
+            {
+                if(i < 0 || i >= numCellsX)
+                    continue;
+
+                for(int j = cy-ring; j<=cy+ring; ++j)
+                {
+                    // Only visit the cells on the border of the ring
+                    if(j < 0 || j >= numCellsY || (std::abs(i-cx) != ring && std::abs(j-cy) != ring))
+                        continue;
+
+                    for(auto&& other : cells.at(i*numCellsY+j))
+                    {
+                        const auto dx = x.at(other)-x.at(site);
+                        const auto dy = y.at(other)-y.at(site);
+                        const auto d2 = dx*dx + dy*dy;
+
+                        if(d2 <= searchRadius2)
+                            candidates.push_back(qMakePair(d2,other));
+                    }
+                }
+            }
+
+            // The sites in the next ring are at least ring*cellSize away
+            if(candidates.size() >= numNeighbours)
+            {
+                std::nth_element(candidates.begin(), candidates.begin()+numNeighbours-1, candidates.end());
+
+                const auto reach = ring*cellSize;
+                if(candidates.at(numNeighbours-1).first <= reach*reach)
+                    break;
+            }
+        }
+
+        const int n = std::min(numNeighbours, candidates.size());
+
+        double mean = 0.0;
+        double variance = 1.0;
+
+        if(n > 0)
+        {
+            std::partial_sort(candidates.begin(), candidates.begin()+n, candidates.end());
+
+            // Simple kriging with the exponential correlation model
+            for(int a = 0; a<n; ++a)
+            {
+                const auto siteA = candidates.at(a).second;
+
+                c[a] = std::exp(-3.0*std::sqrt(candidates.at(a).first)/range);
+
+                for(int b = 0; b<=a; ++b)
+                {
+                    const auto siteB = candidates.at(b).second;
+                    const auto h = std::hypot(x.at(siteA)-x.at(siteB), y.at(siteA)-y.at(siteB));
+
+                    C[a*n+b] = C[b*n+a] = std::exp(-3.0*h/range);
+                }
+            }
+
+            QVector<double> L = C.mid(0,n*n);
+            factorCorrelationMatrix(L, n);
+
+            for(int a = 0; a<n; ++a)
+                w[a] = c.at(a);
+
+            choleskySolve(L.constData(), n, w.data());
+
+            for(int a = 0; a<n; ++a)
+            {
+                mean += w.at(a)*result[candidates.at(a).second];
+                variance -= w.at(a)*c.at(a);
+            }
+
+            variance = std::max(variance, 0.0);
+        }
+
+        result[site] = mean + std::sqrt(variance)*normalDist(generator);
+
+        cells[cx*numCellsY+cy].push_back(site);
+    }
+}
@@ -0,0 +1,111 @@
+#ifndef GMPEENGINE_H
+#define GMPEENGINE_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+
+// Evaluates the ground motion models in GroundMotionModels.h over large sets of sites without calling the backend hazard simulation
+// The sites are split into fixed size chunks that are evaluated in parallel, and every chunk computes the distances and all of the requested intensity measures in one pass.
+// The correlated residuals are sampled with the Baker & Jayaram (2008) inter-event correlation between periods and the Jayaram & Baker (2009) intra-event spatial correlation.
+
+#include "GroundMotionModels.h"
+
+#include <QString>
+#include <QVector>
+
+#include <memory>
+
+// The median and standard deviations of a field, the arrays are stored intensity measure major, i.e., the value for site i and intensity measure j is at j*numSites + i
+struct GMField
+{
+    int numSites = 0;
+
+    // Period of every intensity measure, 0.0 is PGA
+    QVector<double> periods;
+
+    QVector<double> lnMedian;
+    QVector<double> tau;
+    QVector<double> phi;
+
+    int index(const int siteIndex, const int imIndex) const { return imIndex*numSites + siteIndex; }
+
+    double getTotalSigma(const int siteIndex, const int imIndex) const;
+};
+
+
+class GMPEEngine
+{
+public:
+    GMPEEngine();
+
+    // Creates the model given a type from GMPE::validTypes() and loads its coefficients from the data directory
+    bool setModel(const QString& type, const QString& dataDirectory, QString& err);
+
+    // The directory with the coefficient tables that are shipped with the backend applications
+    static QString getDefaultDataDirectory(void);
+
+    // Computes the median and standard deviations at the sites, the distance arrays of the sites are filled in
+    bool computeField(const GMRupture& rupture, GMSiteArrays& sites, const QVector<double>& periods, GMField& field, QString& err) const;
+
+    // Samples correlated realizations of the natural log of the intensity measures
+    // The samples are stored realization major, i.e., the value for realization r, intensity measure j and site i is at (r*numIMs + j)*numSites + i
+    bool sampleField(const GMField& field, const GMSiteArrays& sites, const QString& interEventModel, const QString& intraEventModel, const int numRealizations,
+                     const unsigned int seed, QVector<double>& lnSamples, QString& err) const;
+
+    // Epicentral distances of the sites from the point source, in km
+    static void computeDistances(const GMRupture& rupture, GMSiteArrays& sites, const int begin, const int end);
+
+    // Baker & Jayaram (2008) correlation of the epsilons at two periods, PGA is treated as a period of 0.01 s
+    static double getBakerJayaramCorrelation(const double period1, const double period2);
+
+    // Jayaram & Baker (2009) range of the exponential intra-event correlation in km, for sites without clustering of the Vs30 values
+    static double getJayaramBakerRange(const double period);
+
+private:
+
+    // Samples a standard normal field with an exponential spatial correlation by sequential Gaussian simulation along a random path
+    void sampleSpatialField(const GMSiteArrays& sites, const double range, const unsigned int seed, double* result) const;
+
+    std::unique_ptr<GroundMotionModel> model;
+
+    // The number of sites that are evaluated together
+    const int chunkSize = 4096;
+
+    // The number of previously simulated neighbours used to condition every site in the sequential simulation
+    const int numNeighbours = 16;
+};
+
+#endif // GMPEENGINE_H
@@ -0,0 +1,978 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+#include "GroundMotionModels.h"
+#include "CSVReaderWriter.h"
+
+#include <QDir>
+#include <QFileInfo>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace
+{
+
+// Relative tolerance when matching periods against the table
+const double periodTolerance = 1.0e-6;
+
+bool isSamePeriod(const double a, const double b)
+{
+    return std::abs(a-b) <= periodTolerance*std::max(1.0,std::max(std::abs(a),std::abs(b)));
+}
+
+
+// Linear interpolation of a magnitude dependent standard deviation between the two magnitudes
+double interpolateOnMagnitude(const double M, const double M1, const double val1, const double M2, const double val2)
+{
+    if(M <= M1)
+        return val1;
+
+    if(M >= M2)
+        return val2;
+
+    return val1 + (val2-val1)*(M-M1)/(M2-M1);
+}
+
+
+const double degToRad = 0.017453292519943295;
+
+}
+
+
+void GMSiteArrays::resize(const int numSites)
+{
+    latitude.resize(numSites);
+    longitude.resize(numSites);
+    vs30.resize(numSites);
+    rjb.resize(numSites);
+    rrup.resize(numSites);
+}
+
+
+GMPECoefficientTable::GMPECoefficientTable()
+{
+
+}
+
+
+bool GMPECoefficientTable::loadFromCSV(const QString& pathToFile, QString& err)
+{
+    coefficientNames.clear();
+    periods.clear();
+    rows.clear();
+
+    CSVReaderWriter csvTool;
+
+    auto data = csvTool.parseCSVFile(pathToFile, err);
+
+    if(!err.isEmpty())
+        return false;
+
+    if(data.size() < 2)
+    {
+        err = "The coefficient table "+pathToFile+" is empty";
+        return false;
+    }
+
+    auto findPeriodColumn = [](const QStringList& header)
+    {
+        for(auto&& periodName : {"period", "period(s)", "t", "t(s)", "per"})
+        {
+            auto col = header.indexOf(periodName);
+            if(col != -1)
+                return col;
+        }
+
+        return -1;
+    };
+
+    for(auto&& name : data.first())
+        coefficientNames.append(name.trimmed().toLower());
+
+    auto periodCol = findPeriodColumn(coefficientNames);
+
+    // Some tables have one column per period and one row per coefficient, transpose them so that there is one row per period
+    if(periodCol == -1)
+    {
+        QVector<QStringList> transposed(data.first().size());
+        for(auto&& row : data)
+        {
+            for(int j = 0; j<transposed.size(); ++j)
+                transposed[j].append(j < row.size() ? row.at(j) : QString());
+        }
+
+        transposed[0][0] = "period";
+        data = transposed;
+
+        coefficientNames.clear();
+        for(auto&& name : data.first())
+            coefficientNames.append(name.trimmed().toLower());
+
+        periodCol = 0;
+    }
+
+    const auto NaN = std::numeric_limits<double>::quiet_NaN();
+
+    for(int i = 1; i<data.size(); ++i)
+    {
+        const auto& row = data.at(i);
+
+        if(row.size() <= periodCol)
+            continue;
+
+        auto periodStr = row.at(periodCol).trimmed();
+
+        bool OK = false;
+        auto period = periodStr.toDouble(&OK);
+
+        if(!OK)
+        {
+            // Only PGA is kept from the rows that are not spectral accelerations
+            if(periodStr.compare("PGA",Qt::CaseInsensitive) != 0)
+                continue;
+
+            period = 0.0;
+        }
+        else if(period < 0.0)
+            continue;
+
+        QVector<double> values(coefficientNames.size(), NaN);
+        for(int j = 0; j<row.size() && j<coefficientNames.size(); ++j)
+        {
+            auto val = row.at(j).toDouble(&OK);
+            if(OK)
+                values[j] = val;
+        }
+
+        periods.push_back(period);
+        rows.push_back(values);
+    }
+
+    if(periods.isEmpty())
+    {
+        err = "Could not find any periods in the coefficient table "+pathToFile;
+        return false;
+    }
+
+    // Sort the rows by period
+    QVector<int> order(periods.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](int a, int b){ return periods.at(a) < periods.at(b); });
+
+    QVector<double> sortedPeriods;
+    QVector<QVector<double>> sortedRows;
+    for(auto&& i : order)
+    {
+        sortedPeriods.push_back(periods.at(i));
+        sortedRows.push_back(rows.at(i));
+    }
+
+    periods = sortedPeriods;
+    rows = sortedRows;
+
+    return true;
+}
+
+
+bool GMPECoefficientTable::isEmpty(void) const
+{
+    return periods.isEmpty();
+}
+
+
+const QVector<double>& GMPECoefficientTable::getPeriods(void) const
+{
+    return periods;
+}
+
+
+bool GMPECoefficientTable::hasPeriod(const double period) const
+{
+    return this->getRowOfPeriod(period) != -1;
+}
+
+
+bool GMPECoefficientTable::getBracketingPeriods(const double period, double& lowerPeriod, double& upperPeriod) const
+{
+    if(periods.isEmpty() || period < periods.first() || period > periods.last())
+        return false;
+
+    auto it = std::lower_bound(periods.begin(), periods.end(), period);
+
+    upperPeriod = *it;
+
+    if(isSamePeriod(upperPeriod, period) || it == periods.begin())
+        lowerPeriod = upperPeriod;
+    else
+        lowerPeriod = *(it-1);
+
+    return true;
+}
+
+
+double GMPECoefficientTable::value(const QStringList& names, const double period, const double defaultValue) const
+{
+    auto row = this->getRowOfPeriod(period);
+
+    if(row == -1)
+        return defaultValue;
+
+    for(auto&& name : names)
+    {
+        auto col = coefficientNames.indexOf(name.toLower());
+
+        if(col == -1)
+            continue;
+
+        auto val = rows.at(row).at(col);
+
+        if(std::isnan(val))
+            continue;
+
+        return val;
+    }
+
+    return defaultValue;
+}
+
+
+int GMPECoefficientTable::getRowOfPeriod(const double period) const
+{
+    for(int i = 0; i<periods.size(); ++i)
+    {
+        if(isSamePeriod(periods.at(i), period))
+            return i;
+    }
+
+    return -1;
+}
+
+
+GroundMotionModel::~GroundMotionModel()
+{
+
+}
+
+
+std::unique_ptr<GroundMotionModel> GroundMotionModel::create(const QString& type)
+{
+    if(type.compare("Abrahamson, Silva & Kamai (2014)", Qt::CaseInsensitive) == 0)
+        return std::make_unique<ASK14Model>();
+    else if(type.compare("Boore, Stewart, Seyhan & Atkinson (2014)", Qt::CaseInsensitive) == 0)
+        return std::make_unique<BSSA14Model>();
+    else if(type.compare("Campbell & Bozorgnia (2014)", Qt::CaseInsensitive) == 0)
+        return std::make_unique<CB14Model>();
+    else if(type.compare("Chiou & Youngs (2014)", Qt::CaseInsensitive) == 0)
+        return std::make_unique<CY14Model>();
+
+    return nullptr;
+}
+
+
+bool GroundMotionModel::loadCoefficients(const QString& dataDirectory, QString& err)
+{
+    auto pathToFile = dataDirectory + QDir::separator() + this->getCoefficientFileName();
+
+    if(!QFileInfo::exists(pathToFile))
+    {
+        err = "Could not find the coefficient table for the model "+this->getName()+" at "+pathToFile;
+        return false;
+    }
+
+    return table.loadFromCSV(pathToFile, err);
+}
+
+
+const GMPECoefficientTable& GroundMotionModel::getCoefficientTable(void) const
+{
+    return table;
+}
+
+
+double GroundMotionModel::getZtor(const GMRupture& rupture)
+{
+    if(rupture.ztor >= 0.0)
+        return rupture.ztor;
+
+    // Rupture width from Wells and Coppersmith (1994), all rupture types, centered on the hypocenter
+    auto width = std::pow(10.0, -1.01 + 0.32*rupture.magnitude);
+
+    return std::max(rupture.hypoDepth - 0.5*width*std::sin(rupture.dip*degToRad), 0.0);
+}
+
+
+// Boore, Stewart, Seyhan & Atkinson (2014)
+// The basin depth term is not included, i.e., the sites are assumed to have the default depth to Vs = 1 km/s for their Vs30
+namespace
+{
+
+struct BSSA14Coefficients
+{
+    double e1, e2, e3, e4, e5, e6, Mh;
+    double c1, c2, c3, h, Dc3, Mref, Rref;
+    double c, Vc, Vref, f1, f3, f4, f5;
+    double R1, R2, DfR, DfV, V1, V2, phi1, phi2, tau1, tau2;
+
+    void load(const GMPECoefficientTable& table, const double period)
+    {
+        e1 = table.value({"e1"}, period);
+        e2 = table.value({"e2"}, period);
+        e3 = table.value({"e3"}, period);
+        e4 = table.value({"e4"}, period);
+        e5 = table.value({"e5"}, period);
+        e6 = table.value({"e6"}, period);
+        Mh = table.value({"Mh"}, period);
+        c1 = table.value({"c1"}, period);
+        c2 = table.value({"c2"}, period);
+        c3 = table.value({"c3"}, period);
+        h = table.value({"h"}, period);
+        Dc3 = table.value({"Dc3CaTw","Dc3"}, period, 0.0);
+        Mref = table.value({"Mref"}, period, 4.5);
+        Rref = table.value({"Rref"}, period, 1.0);
+        c = table.value({"clin","c"}, period);
+        Vc = table.value({"Vc"}, period);
+        Vref = table.value({"Vref"}, period, 760.0);
+        f1 = table.value({"f1"}, period, 0.0);
+        f3 = table.value({"f3"}, period, 0.1);
+        f4 = table.value({"f4"}, period);
+        f5 = table.value({"f5"}, period);
+        R1 = table.value({"R1"}, period);
+        R2 = table.value({"R2"}, period);
+        DfR = table.value({"DfR","dphiR"}, period);
+        DfV = table.value({"DfV","dphiV"}, period);
+        V1 = table.value({"V1"}, period);
+        V2 = table.value({"V2"}, period);
+        phi1 = table.value({"phi1","f1_sigma"}, period);
+        phi2 = table.value({"phi2"}, period);
+        tau1 = table.value({"tau1"}, period);
+        tau2 = table.value({"tau2"}, period);
+    }
+
+    // Source function, U = 0 since the mechanism is always specified
+    double getSourceTerm(const double M, const double SS, const double NS, const double RS) const
+    {
+        auto FE = e1*SS + e2*NS + e3*RS;
+
+        if(M <= Mh)
+            FE += e4*(M-Mh) + e5*(M-Mh)*(M-Mh);
+        else
+            FE += e6*(M-Mh);
+
+        return FE;
+    }
+};
+
+}
+
+
+QString BSSA14Model::getName(void) const
+{
+    return "Boore, Stewart, Seyhan & Atkinson (2014)";
+}
+
+
+QString BSSA14Model::getCoefficientFileName(void) const
+{
+    return "BSSA14.csv";
+}
+
+
+void BSSA14Model::evaluate(const GMRupture& rupture, const GMSiteArrays& sites, const double period, const int begin, const int end, double* lnMedian, double* tau, double* phi) const
+{
+    BSSA14Coefficients cf;
+    cf.load(table, period);
+
+    BSSA14Coefficients cfPGA;
+    cfPGA.load(table, 0.0);
+
+    const auto M = rupture.magnitude;
+    const auto rake = rupture.rake;
+
+    const double NS = (rake > -150.0 && rake < -30.0) ? 1.0 : 0.0;
+    const double RS = (rake > 30.0 && rake < 150.0) ? 1.0 : 0.0;
+    const double SS = (NS == 0.0 && RS == 0.0) ? 1.0 : 0.0;
+
+    // Terms that only depend on the rupture
+    const auto FE = cf.getSourceTerm(M,SS,NS,RS);
+    const auto FEPGA = cfPGA.getSourceTerm(M,SS,NS,RS);
+
+    const auto geomSpreading = cf.c1 + cf.c2*(M-cf.Mref);
+    const auto geomSpreadingPGA = cfPGA.c1 + cfPGA.c2*(M-cfPGA.Mref);
+
+    const auto h2 = cf.h*cf.h;
+    const auto h2PGA = cfPGA.h*cfPGA.h;
+
+    const auto f2Offset = std::exp(cf.f5*(760.0-360.0));
+
+    const auto tauM = interpolateOnMagnitude(M,4.5,cf.tau1,5.5,cf.tau2);
+    const auto phiM = interpolateOnMagnitude(M,4.5,cf.phi1,5.5,cf.phi2);
+
+    const double* rjb = sites.rjb.constData();
+    const double* vs30 = sites.vs30.constData();
+
+    for(int i = begin; i<end; ++i)
+    {
+        // Path function
+        const auto R = std::sqrt(rjb[i]*rjb[i] + h2);
+        const auto FP = geomSpreading*std::log(R/cf.Rref) + (cf.c3 + cf.Dc3)*(R-cf.Rref);
+
+        // Median PGA on the reference rock (Vs30 = 760 m/s) for the nonlinear site term
+        const auto RPGA = std::sqrt(rjb[i]*rjb[i] + h2PGA);
+        const auto PGAr = std::exp(FEPGA + geomSpreadingPGA*std::log(RPGA/cfPGA.Rref) + (cfPGA.c3 + cfPGA.Dc3)*(RPGA-cfPGA.Rref));
+
+        // Site function
+        const auto vs = vs30[i];
+        const auto Flin = cf.c*std::log(std::min(vs,cf.Vc)/cf.Vref);
+        const auto f2 = cf.f4*(std::exp(cf.f5*(std::min(vs,760.0)-360.0)) - f2Offset);
+        const auto Fnl = cf.f1 + f2*std::log((PGAr + cf.f3)/cf.f3);
+
+        lnMedian[i-begin] = FE + FP + Flin + Fnl;
+
+        // Distance and Vs30 dependence of the within-event standard deviation
+        auto phiMR = phiM;
+        if(rjb[i] > cf.R2)
+            phiMR += cf.DfR;
+        else if(rjb[i] > cf.R1)
+            phiMR += cf.DfR*std::log(rjb[i]/cf.R1)/std::log(cf.R2/cf.R1);
+
+        if(vs <= cf.V1)
+            phiMR -= cf.DfV;
+        else if(vs < cf.V2)
+            phiMR -= cf.DfV*std::log(cf.V2/vs)/std::log(cf.V2/cf.V1);
+
+        tau[i-begin] = tauM;
+        phi[i-begin] = phiMR;
+    }
+}
+
+
+// Chiou & Youngs (2014)
+// The hanging wall, directivity (DPP) and basin depth terms are not included, and the Vs30 is treated as inferred
+namespace
+{
+
+struct CY14Coefficients
+{
+    double c1, c1a, c1b, c1c, c1d, cn, cM, c2, c3, c4, c4a, cRB, c5, cHM, c6, c7, c7b, c11, c11b, cg1, cg2, cg3;
+    double phi1, phi2, phi3, phi4, tau1, tau2, sigma1, sigma2, sigma3;
+
+    void load(const GMPECoefficientTable& table, const double period)
+    {
+        c1 = table.value({"c1"}, period);
+        c1a = table.value({"c1a"}, period);
+        c1b = table.value({"c1b"}, period);
+        c1c = table.value({"c1c"}, period);
+        c1d = table.value({"c1d"}, period);
+        cn = table.value({"cn"}, period);
+        cM = table.value({"cM"}, period);
+        c2 = table.value({"c2"}, period, 1.06);
+        c3 = table.value({"c3"}, period);
+        c4 = table.value({"c4"}, period, -2.1);
+        c4a = table.value({"c4a"}, period, -0.5);
+        cRB = table.value({"cRB"}, period, 50.0);
+        c5 = table.value({"c5"}, period);
+        cHM = table.value({"cHM"}, period);
+        c6 = table.value({"c6"}, period);
+        c7 = table.value({"c7"}, period);
+        c7b = table.value({"c7b"}, period);
+        c11 = table.value({"c11"}, period, 0.0);
+        c11b = table.value({"c11b"}, period);
+        cg1 = table.value({"cgamma1","cg1","c_gamma1"}, period);
+        cg2 = table.value({"cgamma2","cg2","c_gamma2"}, period);
+        cg3 = table.value({"cgamma3","cg3","c_gamma3"}, period);
+        phi1 = table.value({"phi1"}, period);
+        phi2 = table.value({"phi2"}, period);
+        phi3 = table.value({"phi3"}, period);
+        phi4 = table.value({"phi4"}, period);
+        tau1 = table.value({"tau1"}, period);
+        tau2 = table.value({"tau2"}, period);
+        sigma1 = table.value({"sigma1"}, period);
+        sigma2 = table.value({"sigma2"}, period);
+        sigma3 = table.value({"sigma3"}, period);
+    }
+};
+
+}
+
+
+QString CY14Model::getName(void) const
+{
+    return "Chiou & Youngs (2014)";
+}
+
+
+QString CY14Model::getCoefficientFileName(void) const
+{
+    return "CY14.csv";
+}
+
+
+void CY14Model::evaluate(const GMRupture& rupture, const GMSiteArrays& sites, const double period, const int begin, const int end, double* lnMedian, double* tau, double* phi) const
+{
+    CY14Coefficients cf;
+    cf.load(table, period);
+
+    const auto M = rupture.magnitude;
+    const auto rake = rupture.rake;
+
+    const double FRV = (rake >= 30.0 && rake <= 150.0) ? 1.0 : 0.0;
+    const double FNM = (rake >= -120.0 && rake <= -60.0) ? 1.0 : 0.0;
+
+    // Depth to top of rupture relative to its magnitude dependent mean
+    const auto ztor = getZtor(rupture);
+    double meanZtor = 0.0;
+    if(FRV == 1.0)
+        meanZtor = std::pow(std::max(2.704 - 1.226*std::max(M-5.849,0.0),0.0),2.0);
+    else
+        meanZtor = std::pow(std::max(2.673 - 1.136*std::max(M-4.970,0.0),0.0),2.0);
+
+    const auto dZtor = ztor - meanZtor;
+
+    const auto cosDip = std::cos(rupture.dip*degToRad);
+    const auto coshM = std::cosh(2.0*std::max(M-4.5,0.0));
+
+    // Terms that only depend on the rupture
+    const auto eventTerm = cf.c1
+            + (cf.c1a + cf.c1c/coshM)*FRV
+            + (cf.c1b + cf.c1d/coshM)*FNM
+            + (cf.c7 + cf.c7b/coshM)*dZtor
+            + (cf.c11 + cf.c11b/coshM)*cosDip*cosDip
+            + cf.c2*(M-6.0)
+            + (cf.c2-cf.c3)/cf.cn*std::log(1.0 + std::exp(cf.cn*(cf.cM-M)));
+
+    const auto nearSaturation = cf.c5*std::cosh(cf.c6*std::max(M-cf.cHM,0.0));
+    const auto anelastic = cf.cg1 + cf.cg2/std::cosh(std::max(M-cf.cg3,0.0));
+    const auto cRB2 = cf.cRB*cf.cRB;
+
+    const auto nlOffset = std::exp(cf.phi3*(1130.0-360.0));
+
+    const auto Mclip = std::min(std::max(M,5.0),6.5) - 5.0;
+    const auto tauM = cf.tau1 + (cf.tau2-cf.tau1)/1.5*Mclip;
+    const auto sigmaM = cf.sigma1 + (cf.sigma2-cf.sigma1)/1.5*Mclip;
+
+    const double* rrup = sites.rrup.constData();
+    const double* vs30 = sites.vs30.constData();
+
+    for(int i = begin; i<end; ++i)
+    {
+        const auto R = rrup[i];
+
+        // Reference motion for Vs30 = 1130 m/s
+        const auto lnYref = eventTerm
+                + cf.c4*std::log(R + nearSaturation)
+                + (cf.c4a-cf.c4)*std::log(std::sqrt(R*R + cRB2))
+                + anelastic*R;
+
+        const auto yRef = std::exp(lnYref);
+
+        // Site response
+        const auto vs = vs30[i];
+        const auto nlB = cf.phi2*(std::exp(cf.phi3*(std::min(vs,1130.0)-360.0)) - nlOffset);
+
+        lnMedian[i-begin] = lnYref + cf.phi1*std::min(std::log(vs/1130.0),0.0) + nlB*std::log((yRef + cf.phi4)/cf.phi4);
+
+        // Nonlinear site effects on the standard deviations, inferred Vs30
+        const auto NL0 = nlB*yRef/(yRef + cf.phi4);
+
+        tau[i-begin] = (1.0 + NL0)*tauM;
+        phi[i-begin] = sigmaM*std::sqrt(cf.sigma3 + (1.0 + NL0)*(1.0 + NL0));
+    }
+}
+
+
+// Abrahamson, Silva & Kamai (2014)
+// The hanging wall, basin depth, regional and aftershock terms are not included. In the nonlinear standard deviation terms, the partial derivative of the site amplification
+// is computed at the period that is evaluated.
+namespace
+{
+
+struct ASK14Coefficients
+{
+    double M1, M2, a1, a2, a3, a4, a5, a6, a7, a8, a10, a11, a12, a15, a17, b, c, n, c4, Vlin, s1, s2, s3, s4;
+
+    void load(const GMPECoefficientTable& table, const double period)
+    {
+        M1 = table.value({"M1"}, period, 6.75);
+        M2 = table.value({"M2"}, period, 5.0);
+        a1 = table.value({"a1"}, period);
+        a2 = table.value({"a2"}, period);
+        a3 = table.value({"a3"}, period, 0.275);
+        a4 = table.value({"a4"}, period, -0.1);
+        a5 = table.value({"a5"}, period, -0.41);
+        a6 = table.value({"a6"}, period);
+        a7 = table.value({"a7"}, period, 0.0);
+        a8 = table.value({"a8"}, period);
+        a10 = table.value({"a10"}, period);
+        a11 = table.value({"a11"}, period);
+        a12 = table.value({"a12"}, period);
+        a15 = table.value({"a15"}, period);
+        a17 = table.value({"a17"}, period);
+        b = table.value({"b"}, period);
+        c = table.value({"c"}, period);
+        n = table.value({"n"}, period, 1.5);
+        c4 = table.value({"c4"}, period, 4.5);
+        Vlin = table.value({"Vlin"}, period);
+
+        // Within-event standard deviations for estimated Vs30
+        s1 = table.value({"s1e","s1_est","s1"}, period);
+        s2 = table.value({"s2e","s2_est","s2"}, period);
+        s3 = table.value({"s3"}, period);
+        s4 = table.value({"s4"}, period);
+    }
+};
+
+}
+
+
+QString ASK14Model::getName(void) const
+{
+    return "Abrahamson, Silva & Kamai (2014)";
+}
+
+
+QString ASK14Model::getCoefficientFileName(void) const
+{
+    return "ASK14.csv";
+}
+
+
+void ASK14Model::evaluate(const GMRupture& rupture, const GMSiteArrays& sites, const double period, const int begin, const int end, double* lnMedian, double* tau, double* phi) const
+{
+    ASK14Coefficients cf;
+    cf.load(table, period);
+
+    const auto M = rupture.magnitude;
+    const auto rake = rupture.rake;
+
+    const double FRV = (rake >= 30.0 && rake <= 150.0) ? 1.0 : 0.0;
+    const double FN = (rake >= -150.0 && rake <= -30.0) ? 1.0 : 0.0;
+
+    // Magnitude scaling and the magnitude dependent slope of the geometric spreading
+    double magTerm = 0.0;
+    double spreading = 0.0;
+    if(M > cf.M1)
+    {
+        magTerm = cf.a1 + cf.a5*(M-cf.M1) + cf.a8*(8.5-M)*(8.5-M);
+        spreading = cf.a2 + cf.a3*(M-cf.M1);
+    }
+    else if(M >= cf.M2)
+    {
+        magTerm = cf.a1 + cf.a4*(M-cf.M1) + cf.a8*(8.5-M)*(8.5-M);
+        spreading = cf.a2 + cf.a3*(M-cf.M1);
+    }
+    else
+    {
+        magTerm = cf.a1 + cf.a4*(cf.M2-cf.M1) + cf.a8*(8.5-cf.M2)*(8.5-cf.M2) + cf.a6*(M-cf.M2) + cf.a7*(M-cf.M2)*(M-cf.M2);
+        spreading = cf.a2 + cf.a3*(cf.M2-cf.M1);
+    }
+
+    // Finite fault term
+    double c4M = 1.0;
+    if(M > 5.0)
+        c4M = cf.c4;
+    else if(M > 4.0)
+        c4M = cf.c4 - (cf.c4-1.0)*(5.0-M);
+
+    const auto c4M2 = c4M*c4M;
+
+    // Style of faulting
+    double f7 = 0.0;
+    double f8 = 0.0;
+    if(M > 5.0)
+    {
+        f7 = cf.a11;
+        f8 = cf.a12;
+    }
+    else if(M >= 4.0)
+    {
+        f7 = cf.a11*(M-4.0);
+        f8 = cf.a12*(M-4.0);
+    }
+
+    // Depth to top of rupture
+    const auto f6 = cf.a15*std::min(getZtor(rupture),20.0)/20.0;
+
+    const auto eventTerm = magTerm + FRV*f7 + FN*f8 + f6;
+
+    // Period dependent corner velocity of the site term
+    double V1 = 1500.0;
+    if(period >= 3.0)
+        V1 = 800.0;
+    else if(period > 0.5)
+        V1 = std::exp(-0.35*std::log(period/0.5) + std::log(1500.0));
+
+    const auto linearSiteCoef = cf.a10 + cf.b*cf.n;
+    const auto f5Rock = linearSiteCoef*std::log(std::min(1180.0,V1)/cf.Vlin);
+
+    const auto phiA = interpolateOnMagnitude(M,4.0,cf.s1,6.0,cf.s2);
+    const auto tauA = interpolateOnMagnitude(M,5.0,cf.s3,7.0,cf.s4);
+
+    const double phiAmp = 0.4;
+    const auto phiB = std::sqrt(std::max(phiA*phiA - phiAmp*phiAmp,0.0));
+
+    const double* rrup = sites.rrup.constData();
+    const double* vs30 = sites.vs30.constData();
+
+    for(int i = begin; i<end; ++i)
+    {
+        const auto R = std::sqrt(rrup[i]*rrup[i] + c4M2);
+
+        const auto f1 = eventTerm + spreading*std::log(R) + cf.a17*rrup[i];
+
+        // Median on rock for the nonlinear site term
+        const auto Sa1180 = std::exp(f1 + f5Rock);
+
+        const auto vs = vs30[i];
+        const auto vsStar = std::min(vs,V1);
+
+        double f5 = 0.0;
+        double dAmp = 0.0;
+        if(vs >= cf.Vlin)
+        {
+            f5 = linearSiteCoef*std::log(vsStar/cf.Vlin);
+        }
+        else
+        {
+            const auto vsRatioN = std::pow(vsStar/cf.Vlin,cf.n);
+            f5 = cf.a10*std::log(vsStar/cf.Vlin) - cf.b*std::log(Sa1180 + cf.c) + cf.b*std::log(Sa1180 + cf.c*vsRatioN);
+
+            dAmp = -cf.b*Sa1180/(Sa1180 + cf.c) + cf.b*Sa1180/(Sa1180 + cf.c*std::pow(vs/cf.Vlin,cf.n));
+        }
+
+        lnMedian[i-begin] = f1 + f5;
+
+        tau[i-begin] = tauA*(1.0 + dAmp);
+        phi[i-begin] = std::sqrt(phiB*phiB*(1.0 + dAmp)*(1.0 + dAmp) + phiAmp*phiAmp);
+    }
+}
+
+
+// Campbell & Bozorgnia (2014)
+// The hanging wall term is not included, and the sediment depth is the default California Z2.5 for the Vs30 of the site
+namespace
+{
+
+struct CB14Coefficients
+{
+    double c0, c1, c2, c3, c4, c5, c6, c7, c8, c9, c11, c14, c16, c17, c18, c19, c20, Dc20, k1, k2, k3, c, n;
+    double tau1, tau2, phi1, phi2, phiLnAF, rho;
+
+    void load(const GMPECoefficientTable& table, const double period)
+    {
+        c0 = table.value({"c0"}, period);
+        c1 = table.value({"c1"}, period);
+        c2 = table.value({"c2"}, period);
+        c3 = table.value({"c3"}, period);
+        c4 = table.value({"c4"}, period);
+        c5 = table.value({"c5"}, period);
+        c6 = table.value({"c6"}, period);
+        c7 = table.value({"c7"}, period);
+        c8 = table.value({"c8"}, period, 0.0);
+        c9 = table.value({"c9"}, period);
+        c11 = table.value({"c11"}, period);
+        c14 = table.value({"c14"}, period);
+        c16 = table.value({"c16"}, period);
+        c17 = table.value({"c17"}, period);
+        c18 = table.value({"c18"}, period);
+        c19 = table.value({"c19"}, period);
+        c20 = table.value({"c20"}, period);
+        Dc20 = table.value({"Dc20_CA","Dc20CA","Dc20"}, period, 0.0);
+        k1 = table.value({"k1"}, period);
+        k2 = table.value({"k2"}, period);
+        k3 = table.value({"k3"}, period);
+        c = table.value({"c"}, period, 1.88);
+        n = table.value({"n"}, period, 1.18);
+        tau1 = table.value({"tau1","tlny1"}, period);
+        tau2 = table.value({"tau2","tlny2"}, period);
+        phi1 = table.value({"phi1","flny1"}, period);
+        phi2 = table.value({"phi2","flny2"}, period);
+        phiLnAF = table.value({"flnAF","philnAF","phi_lnAF"}, period, 0.3);
+        rho = table.value({"rholny","rholnPGAlnY","rho"}, period, 1.0);
+    }
+
+    double getMagnitudeTerm(const double M) const
+    {
+        auto fmag = c0 + c1*M;
+
+        if(M > 4.5)
+            fmag += c2*(std::min(M,5.5)-4.5);
+        if(M > 5.5)
+            fmag += c3*(std::min(M,6.5)-5.5);
+        if(M > 6.5)
+            fmag += c4*(M-6.5);
+
+        return fmag;
+    }
+
+    double getEventTerm(const double M, const double FRV, const double FNM, const double zhyp, const double dip) const
+    {
+        auto fltM = std::min(std::max(M-4.5,0.0),1.0);
+        auto fflt = (c8*FRV + c9*FNM)*fltM;
+
+        auto hypH = std::min(std::max(zhyp-7.0,0.0),13.0);
+        double hypM = c17;
+        if(M > 6.5)
+            hypM = c18;
+        else if(M > 5.5)
+            hypM = c17 + (c18-c17)*(M-5.5);
+
+        double fdip = 0.0;
+        if(M <= 4.5)
+            fdip = c19*dip;
+        else if(M <= 5.5)
+            fdip = c19*(5.5-M)*dip;
+
+        return this->getMagnitudeTerm(M) + fflt + hypH*hypM + fdip;
+    }
+
+    // Distance attenuation for the given rupture distance
+    double getPathTerm(const double M, const double rrup) const
+    {
+        auto fdis = (c5 + c6*M)*std::log(std::sqrt(rrup*rrup + c7*c7));
+        auto fatn = rrup > 80.0 ? (c20 + Dc20)*(rrup-80.0) : 0.0;
+
+        return fdis + fatn;
+    }
+
+    double getSedimentTerm(const double z25) const
+    {
+        if(z25 <= 1.0)
+            return c14*(z25-1.0);
+        else if(z25 > 3.0)
+            return c16*k3*std::exp(-0.75)*(1.0 - std::exp(-0.25*(z25-3.0)));
+
+        return 0.0;
+    }
+
+    double getSiteTerm(const double vs, const double A1100) const
+    {
+        if(vs <= k1)
+            return c11*std::log(vs/k1) + k2*(std::log(A1100 + c*std::pow(vs/k1,n)) - std::log(A1100 + c));
+
+        return (c11 + k2*n)*std::log(vs/k1);
+    }
+
+    double getNonlinearDerivative(const double vs, const double A1100) const
+    {
+        if(vs >= k1)
+            return 0.0;
+
+        return k2*A1100*(1.0/(A1100 + c*std::pow(vs/k1,n)) - 1.0/(A1100 + c));
+    }
+};
+
+// Default California depth to Vs = 2.5 km/s in km
+double getDefaultZ25(const double vs30)
+{
+    return std::exp(7.089 - 1.144*std::log(vs30));
+}
+
+}
+
+
+QString CB14Model::getName(void) const
+{
+    return "Campbell & Bozorgnia (2014)";
+}
+
+
+QString CB14Model::getCoefficientFileName(void) const
+{
+    return "CB14.csv";
+}
+
+
+void CB14Model::evaluate(const GMRupture& rupture, const GMSiteArrays& sites, const double period, const int begin, const int end, double* lnMedian, double* tau, double* phi) const
+{
+    CB14Coefficients cf;
+    cf.load(table, period);
+
+    CB14Coefficients cfPGA;
+    cfPGA.load(table, 0.0);
+
+    const auto M = rupture.magnitude;
+    const auto rake = rupture.rake;
+
+    const double FRV = (rake > 30.0 && rake < 150.0) ? 1.0 : 0.0;
+    const double FNM = (rake > -150.0 && rake < -30.0) ? 1.0 : 0.0;
+
+    const auto eventTerm = cf.getEventTerm(M,FRV,FNM,rupture.hypoDepth,rupture.dip);
+    const auto eventTermPGA = cfPGA.getEventTerm(M,FRV,FNM,rupture.hypoDepth,rupture.dip);
+
+    // Site and sediment terms of PGA on the reference rock with Vs30 = 1100 m/s
+    const auto rockTermPGA = (cfPGA.c11 + cfPGA.k2*cfPGA.n)*std::log(1100.0/cfPGA.k1) + cfPGA.getSedimentTerm(getDefaultZ25(1100.0));
+
+    const auto tauLnY = interpolateOnMagnitude(M,4.5,cf.tau1,5.5,cf.tau2);
+    const auto phiLnY = interpolateOnMagnitude(M,4.5,cf.phi1,5.5,cf.phi2);
+    const auto tauLnPGA = interpolateOnMagnitude(M,4.5,cfPGA.tau1,5.5,cfPGA.tau2);
+    const auto phiLnPGA = interpolateOnMagnitude(M,4.5,cfPGA.phi1,5.5,cfPGA.phi2);
+
+    const auto phiLnYB = std::sqrt(std::max(phiLnY*phiLnY - cf.phiLnAF*cf.phiLnAF,0.0));
+    const auto phiLnPGAB = std::sqrt(std::max(phiLnPGA*phiLnPGA - cfPGA.phiLnAF*cfPGA.phiLnAF,0.0));
+
+    // Short period spectral accelerations are not allowed to be less than PGA
+    const bool floorAtPGA = period > 0.0 && period < 0.25;
+
+    const double* rrup = sites.rrup.constData();
+    const double* vs30 = sites.vs30.constData();
+
+    for(int i = begin; i<end; ++i)
+    {
+        const auto vs = vs30[i];
+        const auto z25 = getDefaultZ25(vs);
+
+        const auto basePGA = eventTermPGA + cfPGA.getPathTerm(M,rrup[i]);
+        const auto A1100 = std::exp(basePGA + rockTermPGA);
+
+        auto lnY = eventTerm + cf.getPathTerm(M,rrup[i]) + cf.getSiteTerm(vs,A1100) + cf.getSedimentTerm(z25);
+
+        if(floorAtPGA)
+        {
+            const auto lnPGA = basePGA + cfPGA.getSiteTerm(vs,A1100) + cfPGA.getSedimentTerm(z25);
+            lnY = std::max(lnY,lnPGA);
+        }
+
+        lnMedian[i-begin] = lnY;
+
+        const auto alpha = cf.getNonlinearDerivative(vs,A1100);
+
+        tau[i-begin] = std::sqrt(tauLnY*tauLnY + alpha*alpha*tauLnPGA*tauLnPGA + 2.0*alpha*cf.rho*tauLnY*tauLnPGA);
+        phi[i-begin] = std::sqrt(phiLnYB*phiLnYB + cf.phiLnAF*cf.phiLnAF + alpha*alpha*phiLnPGAB*phiLnPGAB + 2.0*alpha*cf.rho*phiLnYB*phiLnPGAB);
+    }
+}
@@ -0,0 +1,179 @@
+#ifndef GROUNDMOTIONMODELS_H
+#define GROUNDMOTIONMODELS_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Native implementations of the NGA-West2 ground motion models listed in GMPE::validTypes() for PGA and spectral accelerations
+// The models are evaluated over a range of sites given in structure-of-arrays form. All of the terms that depend only on the rupture are computed once per call,
+// so that the per-site loops only contain the distance and site terms.
+// The model coefficients are not hard coded, they are read from the published coefficient tables that are shipped with the backend applications.
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <memory>
+
+// The rupture parameters that are shared by all of the sites
+struct GMRupture
+{
+    double magnitude = 7.0;
+    double latitude = 0.0;
+    double longitude = 0.0;
+    double hypoDepth = 10.0; // km
+    double ztor = -1.0;      // km, depth to the top of the rupture, estimated from the magnitude, dip and hypocenter depth if negative
+    double rake = 0.0;       // degrees
+    double dip = 90.0;       // degrees
+};
+
+
+// Site parameters in structure-of-arrays form, every array holds one entry per site
+struct GMSiteArrays
+{
+    QVector<double> latitude;
+    QVector<double> longitude;
+    QVector<double> vs30;    // m/s
+
+    // The distance measures are filled in by the engine
+    QVector<double> rjb;     // km, Joyner-Boore distance
+    QVector<double> rrup;    // km, rupture distance
+
+    int size() const { return latitude.size(); }
+
+    void resize(const int numSites);
+};
+
+
+// The coefficient table of a ground motion model, one row per period. PGA is stored with a period of 0, PGV and other rows that are not spectral accelerations are skipped.
+class GMPECoefficientTable
+{
+public:
+    GMPECoefficientTable();
+
+    bool loadFromCSV(const QString& pathToFile, QString& err);
+
+    bool isEmpty(void) const;
+
+    const QVector<double>& getPeriods(void) const;
+
+    // Returns true if the period is in the table
+    bool hasPeriod(const double period) const;
+
+    // Finds the tabulated periods that bracket the given period, returns false if the period is outside of the range of the table
+    bool getBracketingPeriods(const double period, double& lowerPeriod, double& upperPeriod) const;
+
+    // Returns the coefficient at a tabulated period, the first name in the list that exists in the table is used
+    // The default value is returned if none of the names are in the table
+    double value(const QStringList& names, const double period, const double defaultValue = 0.0) const;
+
+private:
+    int getRowOfPeriod(const double period) const;
+
+    QStringList coefficientNames;
+    QVector<double> periods;
+    QVector<QVector<double>> rows;
+};
+
+
+class GroundMotionModel
+{
+public:
+    virtual ~GroundMotionModel();
+
+    // Creates the model given a type from GMPE::validTypes(), returns a nullptr if the type is not supported
+    static std::unique_ptr<GroundMotionModel> create(const QString& type);
+
+    virtual QString getName(void) const = 0;
+
+    // The name of the coefficient table file that is read from the data directory
+    virtual QString getCoefficientFileName(void) const = 0;
+
+    bool loadCoefficients(const QString& dataDirectory, QString& err);
+
+    const GMPECoefficientTable& getCoefficientTable(void) const;
+
+    // Evaluates the model at a tabulated period for the sites in the range [begin, end)
+    // The outputs are the natural log of the median in units of g, and the inter-event (tau) and intra-event (phi) standard deviations in natural log units
+    virtual void evaluate(const GMRupture& rupture, const GMSiteArrays& sites, const double period, const int begin, const int end, double* lnMedian, double* tau, double* phi) const = 0;
+
+    // Depth to the top of rupture, estimated with the Wells and Coppersmith (1994) rupture width if it is not provided
+    static double getZtor(const GMRupture& rupture);
+
+protected:
+    GMPECoefficientTable table;
+};
+
+
+// Boore, Stewart, Seyhan & Atkinson (2014)
+class BSSA14Model : public GroundMotionModel
+{
+public:
+    QString getName(void) const override;
+    QString getCoefficientFileName(void) const override;
+    void evaluate(const GMRupture& rupture, const GMSiteArrays& sites, const double period, const int begin, const int end, double* lnMedian, double* tau, double* phi) const override;
+};
+
+
+// Chiou & Youngs (2014)
+class CY14Model : public GroundMotionModel
+{
+public:
+    QString getName(void) const override;
+    QString getCoefficientFileName(void) const override;
+    void evaluate(const GMRupture& rupture, const GMSiteArrays& sites, const double period, const int begin, const int end, double* lnMedian, double* tau, double* phi) const override;
+};
+
+
+// Abrahamson, Silva & Kamai (2014)
+class ASK14Model : public GroundMotionModel
+{
+public:
+    QString getName(void) const override;
+    QString getCoefficientFileName(void) const override;
+    void evaluate(const GMRupture& rupture, const GMSiteArrays& sites, const double period, const int begin, const int end, double* lnMedian, double* tau, double* phi) const override;
+};
+
+
+// Campbell & Bozorgnia (2014)
+class CB14Model : public GroundMotionModel
+{
+public:
+    QString getName(void) const override;
+    QString getCoefficientFileName(void) const override;
+    void evaluate(const GMRupture& rupture, const GMSiteArrays& sites, const double period, const int begin, const int end, double* lnMedian, double* tau, double* phi) const override;
+};
+
+#endif // GROUNDMOTIONMODELS_H
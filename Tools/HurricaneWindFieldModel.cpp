@@ -0,0 +1,330 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+#include "HurricaneWindFieldModel.h"
+
+#include <QtConcurrent/QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace
+{
+
+const double degToRad = 0.017453292519943295;
+
+// Mean radius of the earth in m
+const double earthRadius = 6371000.0;
+
+// Angular velocity of the earth in rad/s
+const double earthRotation = 7.292e-5;
+
+// Reduction from the gradient wind to the mean wind at 10 m over open terrain
+const double gradientToSurface = 0.7;
+
+// Roughness length of open terrain in m
+const double openTerrainRoughness = 0.03;
+
+}
+
+
+void HurricaneSiteArrays::resize(const int numSites)
+{
+    latitude.resize(numSites);
+    longitude.resize(numSites);
+    roughness.resize(numSites);
+}
+
+
+HurricaneWindFieldModel::HurricaneWindFieldModel()
+{
+
+}
+
+
+void HurricaneWindFieldModel::setStormParameters(const HurricaneStormParameters& params)
+{
+    storm = params;
+
+    this->discretizeTrack();
+}
+
+
+bool HurricaneWindFieldModel::setTrack(const QVector<double>& latitudes, const QVector<double>& longitudes, QString& err)
+{
+    if(latitudes.size() != longitudes.size() || latitudes.size() < 2)
+    {
+        err = "The hurricane track needs at least two points";
+        return false;
+    }
+
+    trackLatitudes = latitudes;
+    trackLongitudes = longitudes;
+
+    originLatitude = std::accumulate(latitudes.begin(), latitudes.end(), 0.0)/latitudes.size();
+    originLongitude = std::accumulate(longitudes.begin(), longitudes.end(), 0.0)/longitudes.size();
+
+    this->discretizeTrack();
+
+    return true;
+}
+
+
+void HurricaneWindFieldModel::moveTrackToLandfall(QVector<double>& latitudes, QVector<double>& longitudes,
+                                                  const double refLatitude, const double refLongitude, const double refAngle,
+                                                  const double latitude, const double longitude, const double angle)
+{
+    const auto rotation = (angle-refAngle)*degToRad;
+    const auto cosRotation = std::cos(rotation);
+    const auto sinRotation = std::sin(rotation);
+
+    const auto cosRefLatitude = std::cos(refLatitude*degToRad);
+    const auto cosLatitude = std::cos(latitude*degToRad);
+
+    for(int i = 0; i<latitudes.size(); ++i)
+    {
+        // Offsets from the reference landfall in degrees of latitude, with x to the east and y to the north
+        const auto x = (longitudes.at(i)-refLongitude)*cosRefLatitude;
+        const auto y = latitudes.at(i)-refLatitude;
+
+        // A positive change of the angle turns the track clockwise
+        const auto xRotated = x*cosRotation + y*sinRotation;
+        const auto yRotated = -x*sinRotation + y*cosRotation;
+
+        latitudes[i] = latitude + yRotated;
+        longitudes[i] = longitude + xRotated/cosLatitude;
+    }
+}
+
+
+void HurricaneWindFieldModel::setReferenceHeight(const double height)
+{
+    referenceHeight = height;
+}
+
+
+void HurricaneWindFieldModel::setGustDuration(const double duration)
+{
+    gustDuration = duration;
+}
+
+
+int HurricaneWindFieldModel::getNumTimeSteps(void) const
+{
+    return timeSteps.size();
+}
+
+
+double HurricaneWindFieldModel::getRoughnessLength(const QString& exposureCategory)
+{
+    if(exposureCategory.compare("A", Qt::CaseInsensitive) == 0)
+        return 2.0;
+    else if(exposureCategory.compare("B", Qt::CaseInsensitive) == 0)
+        return 0.3;
+    else if(exposureCategory.compare("D", Qt::CaseInsensitive) == 0)
+        return 0.005;
+
+    return 0.02;
+}
+
+
+void HurricaneWindFieldModel::toLocalCoordinates(const double latitude, const double longitude, double& x, double& y) const
+{
+    x = earthRadius*(longitude-originLongitude)*degToRad*std::cos(originLatitude*degToRad);
+    y = earthRadius*(latitude-originLatitude)*degToRad;
+}
+
+
+void HurricaneWindFieldModel::discretizeTrack(void)
+{
+    timeSteps.clear();
+
+    const auto numPoints = trackLatitudes.size();
+
+    if(numPoints < 2)
+        return;
+
+    // The storm moves a quarter of the radius to maximum winds between time steps so that the peak winds are not missed between the track points
+    const auto stepLength = std::max(0.25*storm.radiusMaxWinds, 1000.0);
+
+    for(int k = 0; k<numPoints-1; ++k)
+    {
+        double x0, y0, x1, y1;
+        this->toLocalCoordinates(trackLatitudes.at(k), trackLongitudes.at(k), x0, y0);
+        this->toLocalCoordinates(trackLatitudes.at(k+1), trackLongitudes.at(k+1), x1, y1);
+
+        const auto length = std::hypot(x1-x0, y1-y0);
+
+        if(length <= 0.0)
+            continue;
+
+        const auto numSubSteps = std::max(1, static_cast<int>(std::ceil(length/stepLength)));
+
+        // Include the end point on the last segment
+        const auto lastSubStep = (k == numPoints-2) ? numSubSteps : numSubSteps-1;
+
+        for(int j = 0; j<=lastSubStep; ++j)
+        {
+            const auto s = static_cast<double>(j)/numSubSteps;
+
+            const auto latitude = trackLatitudes.at(k) + s*(trackLatitudes.at(k+1)-trackLatitudes.at(k));
+
+            TimeStep step;
+            step.x = x0 + s*(x1-x0);
+            step.y = y0 + s*(y1-y0);
+            step.headingX = (x1-x0)/length;
+            step.headingY = (y1-y0)/length;
+            step.coriolis = 2.0*earthRotation*std::sin(latitude*degToRad);
+
+            if(storm.hollandB > 0.0)
+                step.hollandB = storm.hollandB;
+            else
+                step.hollandB = std::min(std::max(1.881 - 0.00557*storm.radiusMaxWinds/1000.0 - 0.01295*std::abs(latitude), 0.8), 2.5);
+
+            timeSteps.push_back(step);
+        }
+    }
+}
+
+
+double HurricaneWindFieldModel::getSurfaceFactor(const double roughness) const
+{
+    const auto z0 = std::max(roughness, 1.0e-4);
+    const auto z = std::max(referenceHeight, 2.0*z0);
+
+    // Transition from open terrain to the roughness of the site, and the log-law profile up to the reference height
+    const auto terrainFactor = std::pow(z0/openTerrainRoughness, 0.0706)*std::log(z/z0)/std::log(10.0/openTerrainRoughness);
+
+    // Gust factor for the given averaging time
+    const auto turbulenceIntensity = 1.0/std::log(z/z0);
+    const auto gustFactor = gustDuration < 3600.0 ? 1.0 + 0.42*turbulenceIntensity*std::log(3600.0/gustDuration) : 1.0;
+
+    return gradientToSurface*terrainFactor*gustFactor;
+}
+
+
+bool HurricaneWindFieldModel::computePeakWindSpeeds(const HurricaneSiteArrays& sites, QVector<double>& peakWindSpeeds, QString& err) const
+{
+    const auto numSites = sites.size();
+
+    if(numSites == 0 || sites.longitude.size() != numSites || sites.roughness.size() != numSites)
+    {
+        err = "The site arrays are empty or do not have the same size";
+        return false;
+    }
+
+    if(timeSteps.isEmpty())
+    {
+        err = "The hurricane track is not set";
+        return false;
+    }
+
+    if(storm.pressureDeficit <= 0.0 || storm.radiusMaxWinds <= 0.0)
+    {
+        err = "The pressure deficit and the radius to maximum winds must be greater than zero";
+        return false;
+    }
+
+    // Site coordinates and surface factors
+    QVector<double> siteX(numSites), siteY(numSites), siteFactor(numSites);
+    for(int i = 0; i<numSites; ++i)
+    {
+        this->toLocalCoordinates(sites.latitude.at(i), sites.longitude.at(i), siteX[i], siteY[i]);
+        siteFactor[i] = this->getSurfaceFactor(sites.roughness.at(i));
+    }
+
+    peakWindSpeeds.fill(0.0, numSites);
+
+    const double* x = siteX.constData();
+    const double* y = siteY.constData();
+    const double* factor = siteFactor.constData();
+    double* peak = peakWindSpeeds.data();
+
+    const auto Rmax = storm.radiusMaxWinds;
+    const auto Rmax2 = Rmax*Rmax;
+    const auto pressureTerm = storm.pressureDeficit/storm.airDensity;
+    const auto Vt = storm.translationSpeed;
+
+    // Winds further than this from the storm center are below the peaks closer to the track
+    const auto cutoff = std::max(20.0*Rmax, 500000.0);
+    const auto cutoff2 = cutoff*cutoff;
+
+    QVector<int> chunkBegins;
+    for(int i = 0; i<numSites; i += chunkSize)
+        chunkBegins.push_back(i);
+
+    auto evaluateChunk = [&](const int begin)
+    {
+        const auto end = std::min(begin+chunkSize, numSites);
+
+        for(auto&& step : timeSteps)
+        {
+            const auto B = step.hollandB;
+            const auto halfF = 0.5*step.coriolis;
+
+            // Counterclockwise rotation in the northern hemisphere and clockwise in the southern hemisphere
+            const auto rotation = step.coriolis >= 0.0 ? 1.0 : -1.0;
+
+            for(int i = begin; i<end; ++i)
+            {
+                const auto dx = x[i]-step.x;
+                const auto dy = y[i]-step.y;
+                const auto r2 = std::max(dx*dx + dy*dy, 1.0);
+                const auto r = std::sqrt(r2);
+
+                // Holland (1980) gradient wind
+                const auto a = std::exp(B*std::log(Rmax/r));
+                const auto rf = r*halfF;
+                const auto Vg = std::sqrt(B*pressureTerm*a*std::exp(-a) + rf*rf) - std::abs(rf);
+
+                // Add the translation of the storm, which decays away from the radius to maximum winds
+                const auto Vtr = Vt*Rmax*r/(Rmax2 + r2);
+
+                const auto ux = -rotation*Vg*dy/r + Vtr*step.headingX;
+                const auto uy = rotation*Vg*dx/r + Vtr*step.headingY;
+
+                const auto inside = r2 <= cutoff2 ? 1.0 : 0.0;
+
+                peak[i] = std::max(peak[i], inside*factor[i]*std::sqrt(ux*ux + uy*uy));
+            }
+        }
+    };
+
+    QtConcurrent::blockingMap(chunkBegins, evaluateChunk);
+
+    return true;
+}
@@ -0,0 +1,140 @@
+#ifndef HURRICANEWINDFIELDMODEL_H
+#define HURRICANEWINDFIELDMODEL_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+
+// Parametric hurricane wind field that is evaluated in the application, used to preview the peak wind speeds over a grid without running the backend simulation
+// The gradient wind follows the Holland (1980) pressure profile, the storm translation is added with the Jelesnianski (1965) decay so that the winds are stronger on the right side
+// of the track in the northern hemisphere, and the gradient winds are brought down to the reference height with a log-law for the terrain roughness of every site.
+// The storm keeps its landfall intensity along the whole track, i.e., there is no filling model over land.
+
+#include <QString>
+#include <QVector>
+
+// The storm parameters, in SI units
+struct HurricaneStormParameters
+{
+    double pressureDeficit = 5000.0;     // Pa, ambient minus central pressure
+    double radiusMaxWinds = 40000.0;     // m
+    double translationSpeed = 5.0;       // m/s
+    double hollandB = -1.0;              // estimated from the radius and latitude with Vickery & Wadhera (2008) if negative
+    double airDensity = 1.15;            // kg/m^3
+};
+
+
+// Site parameters in structure-of-arrays form, every array holds one entry per site
+struct HurricaneSiteArrays
+{
+    QVector<double> latitude;
+    QVector<double> longitude;
+    QVector<double> roughness;   // m, roughness length of the terrain around the site
+
+    int size() const { return latitude.size(); }
+
+    void resize(const int numSites);
+};
+
+
+class HurricaneWindFieldModel
+{
+public:
+    HurricaneWindFieldModel();
+
+    void setStormParameters(const HurricaneStormParameters& params);
+
+    // The track is given by the latitude and longitude of the storm center in the order that the storm travels along it
+    bool setTrack(const QVector<double>& latitudes, const QVector<double>& longitudes, QString& err);
+
+    // Moves a track so that its landfall point goes from the reference location to the given location, and turns it about the landfall by the change of the landing angle
+    // The angles are storm directions in degrees clockwise from north, as in the landfall parameters of the hurricane simulation
+    static void moveTrackToLandfall(QVector<double>& latitudes, QVector<double>& longitudes,
+                                    const double refLatitude, const double refLongitude, const double refAngle,
+                                    const double latitude, const double longitude, const double angle);
+
+    // The height above ground at which the wind speeds are computed, in m
+    void setReferenceHeight(const double height);
+
+    // The averaging time of the peak gust in s, a gust duration of 3600 s or more gives the mean wind speed
+    void setGustDuration(const double duration);
+
+    // Computes the peak wind speed in m/s at every site over all of the time steps along the track
+    bool computePeakWindSpeeds(const HurricaneSiteArrays& sites, QVector<double>& peakWindSpeeds, QString& err) const;
+
+    int getNumTimeSteps(void) const;
+
+    // Roughness length in m of the ASCE 7 exposure categories
+    static double getRoughnessLength(const QString& exposureCategory);
+
+private:
+
+    // The position of the storm center in local coordinates and the quantities that only depend on the time step
+    struct TimeStep
+    {
+        double x;
+        double y;
+        double headingX;
+        double headingY;
+        double coriolis;
+        double hollandB;
+    };
+
+    void discretizeTrack(void);
+
+    // Factor that converts the gradient wind to the wind at the reference height for a given roughness length, including the gust factor
+    double getSurfaceFactor(const double roughness) const;
+
+    // Local plane coordinates in m
+    void toLocalCoordinates(const double latitude, const double longitude, double& x, double& y) const;
+
+    HurricaneStormParameters storm;
+
+    QVector<double> trackLatitudes;
+    QVector<double> trackLongitudes;
+
+    QVector<TimeStep> timeSteps;
+
+    double originLatitude = 0.0;
+    double originLongitude = 0.0;
+
+    double referenceHeight = 10.0;
+    double gustDuration = 3.0;
+
+    // The number of sites that are evaluated together
+    const int chunkSize = 2048;
+};
+
+#endif // HURRICANEWINDFIELDMODEL_H
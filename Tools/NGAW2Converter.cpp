@@ -233,7 +233,7 @@ int NGAW2Converter::convertToSimCenterEvent(const QString& pathToOutputDirectory
 
         if(createdRecords)
         {
-            createdRecords->insert("name",recordJsonObj);
+            createdRecords->insert(name,recordJsonObj);
         }
     }
 
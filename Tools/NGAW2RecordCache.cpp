@@ -0,0 +1,172 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+#include "NGAW2RecordCache.h"
+#include "GmCommon.h"
+
+#include <QCborValue>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QVector>
+#include <QtConcurrent/QtConcurrent>
+
+// Increment when the layout of the cached records changes
+const QString recordCacheVersion = "v1";
+
+
+int NGAW2RecordCache::restoreRecords(const QStringList& RSNs, const QString& pathToOutputDirectory, QStringList& missingRecords, QString& err)
+{
+    QVector<int> indices(RSNs.size());
+    QVector<int> restored(RSNs.size(), 0);
+    QVector<QString> errors(RSNs.size());
+
+    for(int i = 0; i<RSNs.size(); ++i)
+        indices[i] = i;
+
+    // Get the raw pointers before going parallel so that the vectors are not detached in the worker threads
+    auto restoredData = restored.data();
+    auto errorsData = errors.data();
+
+    QtConcurrent::blockingMap(indices, [&](const int i)
+    {
+        QFile cacheFile(getPathToRecord(RSNs.at(i)));
+        if(!cacheFile.open(QIODevice::ReadOnly))
+            return;
+
+        auto record = QCborValue::fromCbor(cacheFile.readAll());
+        cacheFile.close();
+
+        if(!record.isMap())
+            return;
+
+        QFile outputFile(QDir(pathToOutputDirectory).filePath("RSN" + RSNs.at(i) + ".json"));
+        if(!outputFile.open(QFile::WriteOnly | QFile::Text))
+        {
+            errorsData[i] = "Error creating the output json file " + outputFile.fileName();
+            return;
+        }
+
+        outputFile.write(QJsonDocument(record.toJsonValue().toObject()).toJson());
+        outputFile.close();
+
+        restoredData[i] = 1;
+    });
+
+    int numRestored = 0;
+
+    // Report the first error in order so that the message does not depend on the thread timing
+    for(int i = 0; i<RSNs.size(); ++i)
+    {
+        if(restored.at(i) == 1)
+        {
+            ++numRestored;
+            continue;
+        }
+
+        missingRecords.append(RSNs.at(i));
+
+        if(err.isEmpty() && !errors.at(i).isEmpty())
+            err = errors.at(i);
+    }
+
+    return numRestored;
+}
+
+
+int NGAW2RecordCache::storeRecords(const QJsonObject& records, QString& err)
+{
+    auto names = records.keys();
+
+    if(names.isEmpty())
+        return 0;
+
+    auto pathToRecord = getPathToRecord(names.first().mid(3));
+
+    if(!QDir().mkpath(QFileInfo(pathToRecord).absolutePath()))
+    {
+        err = "Could not create the ground motion record cache directory " + QFileInfo(pathToRecord).absolutePath();
+        return -1;
+    }
+
+    QVector<int> indices(names.size());
+    QVector<QString> errors(names.size());
+
+    for(int i = 0; i<names.size(); ++i)
+        indices[i] = i;
+
+    auto errorsData = errors.data();
+
+    QtConcurrent::blockingMap(indices, [&](const int i)
+    {
+        auto name = names.at(i);
+
+        if(!name.startsWith("RSN"))
+            return;
+
+        // Write to a temporary file first so that a record that is being read is never partially written
+        QSaveFile cacheFile(getPathToRecord(name.mid(3)));
+        if(!cacheFile.open(QIODevice::WriteOnly))
+        {
+            errorsData[i] = "Could not write the cached ground motion record " + cacheFile.fileName();
+            return;
+        }
+
+        cacheFile.write(QCborValue::fromJsonValue(records.value(name)).toCbor());
+
+        if(!cacheFile.commit())
+            errorsData[i] = "Could not write the cached ground motion record " + cacheFile.fileName();
+    });
+
+    for(auto&& it : errors)
+    {
+        if(!it.isEmpty())
+        {
+            err = it;
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+
+QString NGAW2RecordCache::getPathToRecord(const QString& RSN)
+{
+    return GmCommon::getCacheLocation() + QDir::separator() + "NGAWest2Records" + QDir::separator() + recordCacheVersion + QDir::separator() + "RSN" + RSN + ".cbor";
+}
@@ -0,0 +1,253 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+#include "NetworkInventoryLoader.h"
+#include "QGISVisualizationWidget.h"
+#include "TaskRunner.h"
+
+#include <qgscsexception.h>
+#include <qgsfeatureiterator.h>
+#include <qgsvectorlayer.h>
+
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QtConcurrent/QtConcurrent>
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+// Number of features reprojected by a thread at once
+const int chunkSize = 1024;
+
+QMutex transformCacheMutex;
+QHash<QString, QgsCoordinateTransform> transformCache;
+
+}
+
+
+bool NetworkInventoryLoader::read(const QString& pathToFile, const QgsCoordinateReferenceSystem& sourceCrs, const QgsCoordinateTransformContext& transformContext, NetworkInventory& inventory, QString& err, TaskContext& context)
+{
+    // The layer only lives in this thread, it is not added to the project
+    QgsVectorLayer layer(pathToFile, "inventory", "ogr");
+
+    if(!layer.isValid())
+    {
+        err = "Could not read the GIS file " + pathToFile;
+        return false;
+    }
+
+    inventory.fields = layer.fields();
+    inventory.geometryType = layer.geometryType();
+    inventory.sourceCrs = sourceCrs.isValid() ? sourceCrs : layer.crs();
+
+    const auto numFeatures = layer.featureCount();
+
+    context.setTotal(numFeatures);
+    context.setProgress(0);
+    context.setStatus("Reading the features of " + QFileInfo(pathToFile).fileName());
+
+    QVector<QgsFeature> features;
+    features.reserve(numFeatures);
+
+    auto featIt = layer.getFeatures();
+
+    QgsFeature feat;
+    while(featIt.nextFeature(feat))
+    {
+        features.push_back(feat);
+
+        if(features.size() % chunkSize == 0)
+        {
+            if(context.isCanceled())
+            {
+                err = "Reading the GIS file " + pathToFile + " was canceled";
+                return false;
+            }
+
+            context.setProgress(features.size());
+        }
+    }
+
+    const auto numRead = features.size();
+
+    QgsCoordinateReferenceSystem targetCrs("EPSG:4326");
+    bool needReproject = (inventory.sourceCrs.toWkt() != targetCrs.toWkt());
+
+    if(needReproject)
+    {
+        context.setProgress(0);
+        context.setStatus("Reprojecting the features of " + QFileInfo(pathToFile).fileName());
+
+        const auto transform = getTransformToWGS84(inventory.sourceCrs, transformContext);
+
+        QVector<int> chunkBegins;
+        for(int i = 0; i<numRead; i += chunkSize)
+            chunkBegins.push_back(i);
+
+        QVector<QString> chunkErrors(chunkBegins.size());
+
+        // Get the raw pointers before going parallel so that the vectors are not detached in the worker threads
+        auto featData = features.data();
+        auto errData = chunkErrors.data();
+
+        QtConcurrent::blockingMap(chunkBegins, [&](const int begin)
+        {
+            if(context.isCanceled())
+                return;
+
+            auto end = std::min(begin + chunkSize, numRead);
+
+            // Each chunk works on its own copy of the transform
+            auto chunkTransform = transform;
+
+            for(int i = begin; i<end; ++i)
+            {
+                auto& feature = featData[i];
+
+                if(!feature.hasGeometry())
+                    continue;
+
+                QgsGeometry geom = feature.geometry();
+
+                try
+                {
+                    geom.transform(chunkTransform);
+                }
+                catch (QgsCsException&)
+                {
+                    errData[begin/chunkSize] = "Could not reproject the feature " + QString::number(feature.id()) + " of the file " + pathToFile;
+                    return;
+                }
+
+                feature.setGeometry(geom);
+            }
+
+            context.addProgress(end - begin);
+        });
+
+        if(context.isCanceled())
+        {
+            err = "Reprojecting the features of the GIS file " + pathToFile + " was canceled";
+            return false;
+        }
+
+        // Report the first error in order so that the message does not depend on the thread timing
+        for(auto&& it : chunkErrors)
+        {
+            if(!it.isEmpty())
+            {
+                err = it;
+                return false;
+            }
+        }
+    }
+
+    context.setProgress(numRead);
+
+    inventory.features = features.toList();
+
+    return true;
+}
+
+
+QgsVectorLayer* NetworkInventoryLoader::createLayer(QGISVisualizationWidget* visWidget, NetworkInventory& inventory, const QString& layerName, QString& err)
+{
+    QString typeStr;
+    if(inventory.geometryType == QgsWkbTypes::PointGeometry)
+        typeStr = "point";
+    else if(inventory.geometryType == QgsWkbTypes::LineGeometry)
+        typeStr = "multilinestring";
+    else if(inventory.geometryType == QgsWkbTypes::PolygonGeometry)
+        typeStr = "polygon";
+    else
+    {
+        err = "Type of geometry is not supported";
+        return nullptr;
+    }
+
+    auto layer = visWidget->addVectorLayer(typeStr, layerName);
+
+    if(layer == nullptr)
+    {
+        err = "Error creating the layer " + layerName;
+        return nullptr;
+    }
+
+    auto dProvider = layer->dataProvider();
+
+    if(!dProvider->addAttributes(inventory.fields.toList()))
+    {
+        err = "Error adding attribute fields to the layer " + layerName;
+        visWidget->removeLayer(layer);
+        return nullptr;
+    }
+
+    layer->updateFields(); // tell the vector layer to fetch changes from the provider
+
+    auto features = std::move(inventory.features);
+    inventory.features.clear();
+
+    if(!dProvider->addFeatures(features))
+    {
+        err = "Error adding the features to the layer " + layerName;
+        visWidget->removeLayer(layer);
+        return nullptr;
+    }
+
+    layer->updateExtents();
+
+    return layer;
+}
+
+
+QgsCoordinateTransform NetworkInventoryLoader::getTransformToWGS84(const QgsCoordinateReferenceSystem& sourceCrs, const QgsCoordinateTransformContext& transformContext)
+{
+    auto key = sourceCrs.toWkt();
+
+    QMutexLocker locker(&transformCacheMutex);
+
+    auto it = transformCache.constFind(key);
+    if(it != transformCache.constEnd())
+        return it.value();
+
+    QgsCoordinateTransform transform(sourceCrs, QgsCoordinateReferenceSystem("EPSG:4326"), transformContext);
+    transformCache.insert(key, transform);
+
+    return transform;
+}
@@ -0,0 +1,83 @@
+#ifndef NETWORKINVENTORYLOADER_H
+#define NETWORKINVENTORYLOADER_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Reads the GIS file of a network inventory (pipelines, nodes, roadways, bridges, tunnels) once and reprojects it to WGS84 in parallel chunks
+// The result is held in a single memory layer per asset class that is shared by the visualization, the table and the staging, so the source is not read and reprojected again by each of them
+
+#include <qgscoordinatereferencesystem.h>
+#include <qgscoordinatetransform.h>
+#include <qgscoordinatetransformcontext.h>
+#include <qgsfeature.h>
+#include <qgsfields.h>
+#include <qgswkbtypes.h>
+
+#include <QString>
+
+class QgsVectorLayer;
+class QGISVisualizationWidget;
+class TaskContext;
+
+struct NetworkInventory
+{
+    QgsFields fields;
+    QgsWkbTypes::GeometryType geometryType = QgsWkbTypes::UnknownGeometry;
+
+    // The CRS that the geometries were reprojected from
+    QgsCoordinateReferenceSystem sourceCrs;
+
+    QgsFeatureList features;
+};
+
+
+class NetworkInventoryLoader
+{
+public:
+    // Reads the features of the file and reprojects them from sourceCrs, or from the CRS of the file if sourceCrs is not valid
+    // Safe to call in a worker thread, the transform context has to be taken from the project on the GUI thread
+    static bool read(const QString& pathToFile, const QgsCoordinateReferenceSystem& sourceCrs, const QgsCoordinateTransformContext& transformContext, NetworkInventory& inventory, QString& err, TaskContext& context);
+
+    // Creates the memory layer holding the inventory in the visualization widget, returns nullptr on error
+    // The features are moved into the layer, so the inventory has no features afterwards
+    // Must be called on the GUI thread
+    static QgsVectorLayer* createLayer(QGISVisualizationWidget* visWidget, NetworkInventory& inventory, const QString& layerName, QString& err);
+
+    // Returns a copy of the cached transform from the CRS to WGS84, creating a transform is expensive so it is only done once per CRS
+    static QgsCoordinateTransform getTransformToWGS84(const QgsCoordinateReferenceSystem& sourceCrs, const QgsCoordinateTransformContext& transformContext);
+};
+
+#endif // NETWORKINVENTORYLOADER_H
@@ -0,0 +1,128 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+#include "OQAttributeColumn.h"
+
+#include <QDataStream>
+#include <QLocale>
+
+#include <cmath>
+#include <limits>
+
+
+void OQAttributeColumn::append(const QString& value)
+{
+    if(isNumeric)
+    {
+        if(value.isEmpty())
+        {
+            numbers.push_back(std::numeric_limits<double>::quiet_NaN());
+            return;
+        }
+
+        bool OK = false;
+        auto num = value.toDouble(&OK);
+
+        if(OK)
+        {
+            numbers.push_back(num);
+            return;
+        }
+
+        // The column is not numeric after all, convert the values read so far to text
+        isNumeric = false;
+
+        strings.reserve(numbers.size()+1);
+        for(auto&& it : numbers)
+            strings.append(std::isnan(it) ? QString() : QString::number(it, 'g', QLocale::FloatingPointShortest));
+
+        numbers.clear();
+    }
+
+    strings.append(value);
+}
+
+
+int OQAttributeColumn::size(void) const
+{
+    return isNumeric ? numbers.size() : strings.size();
+}
+
+
+QVariant OQAttributeColumn::value(const int row) const
+{
+    if(!isNumeric)
+        return strings.at(row);
+
+    auto num = numbers.at(row);
+
+    if(std::isnan(num))
+        return QVariant(QVariant::Double);
+
+    return num;
+}
+
+
+QVariant::Type OQAttributeColumn::type(void) const
+{
+    return isNumeric ? QVariant::Double : QVariant::String;
+}
+
+
+QDataStream& operator<<(QDataStream& stream, const OQAttributeColumn& column)
+{
+    stream << column.name << column.isNumeric;
+
+    if(column.isNumeric)
+        stream << column.numbers;
+    else
+        stream << column.strings;
+
+    return stream;
+}
+
+
+QDataStream& operator>>(QDataStream& stream, OQAttributeColumn& column)
+{
+    stream >> column.name >> column.isNumeric;
+
+    if(column.isNumeric)
+        stream >> column.numbers;
+    else
+        stream >> column.strings;
+
+    return stream;
+}
@@ -0,0 +1,674 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+#include "OpenQuakeSourceModel.h"
+#include "GmCommon.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+#include <QtConcurrent/QtConcurrent>
+
+#include <numeric>
+
+namespace
+{
+
+// Increment when the layout of the cache file changes
+const quint32 cacheMagicNumber = 0x4F51534D;
+const qint32 cacheVersion = 1;
+
+
+// Where the geometry of a source type is found, the path is given in local names relative to the source element
+struct OQGeometrySpec
+{
+    OQSourceTable::GeometryType geometryType;
+    QStringList path;
+
+    // The number of values per point in the position list, the first two are longitude and latitude
+    int stride;
+
+    // Points with a zero longitude or latitude are an error for point sources and skipped for the others
+    bool zeroIsError;
+};
+
+
+const OQGeometrySpec& getGeometrySpec(const QString& sourceType)
+{
+    static const QHash<QString, OQGeometrySpec> specs =
+    {
+        {"pointSource", {OQSourceTable::Point, {"pointGeometry","Point","pos"}, 2, true}},
+        {"characteristicFaultSource", {OQSourceTable::Line, {"surface","complexFaultGeometry","faultTopEdge","LineString","posList"}, 3, false}},
+        {"complexFaultSource", {OQSourceTable::Line, {"complexFaultGeometry","faultTopEdge","LineString","posList"}, 3, false}},
+        {"simpleFaultSource", {OQSourceTable::Line, {"simpleFaultGeometry","LineString","posList"}, 2, false}},
+        {"areaSource", {OQSourceTable::Polygon, {"areaGeometry","Polygon","exterior","LinearRing","posList"}, 2, false}}
+    };
+
+    return specs.find(sourceType).value();
+}
+
+
+// The attributes that are kept as text even if they look like numbers, the ids are matched as strings when the sources are exported
+bool isTextAttribute(const QString& name)
+{
+    return name == "id" || name == "name";
+}
+
+
+// Parses a whitespace separated list of coordinates without creating a list of strings
+bool parseCoordinates(const QString& text, const OQGeometrySpec& spec, QVector<double>& coordinates, QString& err)
+{
+    double tuple[3] = {0.0, 0.0, 0.0};
+    int numInTuple = 0;
+
+    auto addPoint = [&]() -> bool
+    {
+        const auto longitude = tuple[0];
+        const auto latitude = tuple[1];
+
+        numInTuple = 0;
+
+        if(longitude == 0.0 || latitude == 0.0)
+        {
+            if(spec.zeroIsError)
+            {
+                err = "Error, zero lat lon values";
+                return false;
+            }
+
+            return true;
+        }
+
+        coordinates.push_back(longitude);
+        coordinates.push_back(latitude);
+
+        return true;
+    };
+
+    const auto length = text.size();
+    const QChar* chars = text.constData();
+
+    int pos = 0;
+    while(pos < length)
+    {
+        while(pos < length && chars[pos].isSpace())
+            ++pos;
+
+        const auto start = pos;
+
+        while(pos < length && !chars[pos].isSpace())
+            ++pos;
+
+        if(pos == start)
+            break;
+
+        bool OK = false;
+        auto val = text.midRef(start, pos-start).toDouble(&OK);
+
+        if(!OK)
+        {
+            err = "Error converting the coordinate "+text.mid(start, pos-start)+" to double";
+            return false;
+        }
+
+        tuple[numInTuple] = val;
+        ++numInTuple;
+
+        if(numInTuple == spec.stride && !addPoint())
+            return false;
+    }
+
+    // A trailing point without a depth
+    if(numInTuple >= 2 && !addPoint())
+        return false;
+
+    return true;
+}
+
+
+// A source element as it is streamed from the file, its attributes and geometry are parsed into the table of its type afterwards
+struct OQRawSource
+{
+    QXmlStreamAttributes attributes;
+    QString geometry;
+    bool hasGeometry = false;
+};
+
+
+// Reads the source element that the reader is at, the reader is left at the end of the element
+bool readRawSource(QXmlStreamReader& reader, const OQGeometrySpec& spec, OQRawSource& source, QString& err)
+{
+    source.attributes = reader.attributes();
+
+    // Get the text of the geometry, the rest of the source element is skipped
+    QStringList path;
+
+    while(!reader.atEnd())
+    {
+        reader.readNext();
+
+        if(reader.isStartElement())
+        {
+            path.push_back(reader.name().toString());
+
+            if(!source.hasGeometry && path == spec.path)
+            {
+                source.geometry = reader.readElementText();
+                source.hasGeometry = true;
+                path.pop_back();
+            }
+        }
+        else if(reader.isEndElement())
+        {
+            // The end of the source element
+            if(path.isEmpty())
+                break;
+
+            path.pop_back();
+        }
+    }
+
+    if(reader.hasError())
+    {
+        err = "Error parsing the source model: "+reader.errorString()+" at line "+QString::number(reader.lineNumber());
+        return false;
+    }
+
+    return true;
+}
+
+
+// Adds a source to the table of its type, a column is added the first time an attribute is found
+bool addSource(const OQRawSource& source, const OQGeometrySpec& spec, OQSourceTable& table, QHash<QString, int>& columnIndexes, QString& err)
+{
+    const int numSources = table.size();
+
+    QVector<bool> columnFilled(table.columns.size(), false);
+
+    QString sourceId;
+
+    for(auto&& attribute : source.attributes)
+    {
+        auto name = attribute.qualifiedName().toString();
+        auto value = attribute.value().toString();
+
+        if(name == "id")
+            sourceId = value;
+
+        auto it = columnIndexes.find(name);
+        if(it == columnIndexes.end())
+        {
+            OQAttributeColumn column;
+            column.name = name;
+            column.isNumeric = !isTextAttribute(name);
+
+            for(int i = 0; i<numSources; ++i)
+                column.append(QString());
+
+            it = columnIndexes.insert(name, table.columns.size());
+            table.columns.push_back(column);
+            columnFilled.push_back(false);
+        }
+
+        table.columns[it.value()].append(value);
+        columnFilled[it.value()] = true;
+    }
+
+    for(int i = 0; i<columnFilled.size(); ++i)
+    {
+        if(!columnFilled.at(i))
+            table.columns[i].append(QString());
+    }
+
+    if(!source.hasGeometry)
+    {
+        err = "Could not get geometry for the source "+sourceId;
+        return false;
+    }
+
+    if(!parseCoordinates(source.geometry, spec, table.coordinates, err))
+    {
+        err += " for the source "+sourceId;
+        return false;
+    }
+
+    table.offsets.push_back(table.coordinates.size()/2);
+
+    return true;
+}
+
+}
+
+
+int OQSourceTable::size(void) const
+{
+    return offsets.size()-1;
+}
+
+
+int OQSourceTable::getNumPoints(const int source) const
+{
+    return offsets.at(source+1)-offsets.at(source);
+}
+
+
+double OQSourceTable::getLongitude(const int source, const int point) const
+{
+    return coordinates.at(2*(offsets.at(source)+point));
+}
+
+
+double OQSourceTable::getLatitude(const int source, const int point) const
+{
+    return coordinates.at(2*(offsets.at(source)+point)+1);
+}
+
+
+QDataStream& operator<<(QDataStream& stream, const OQSourceTable& table)
+{
+    stream << table.sourceType << static_cast<qint32>(table.geometryType) << table.columns << table.coordinates << table.offsets;
+
+    return stream;
+}
+
+
+QDataStream& operator>>(QDataStream& stream, OQSourceTable& table)
+{
+    qint32 geometryType = 0;
+
+    stream >> table.sourceType >> geometryType >> table.columns >> table.coordinates >> table.offsets;
+
+    table.geometryType = static_cast<OQSourceTable::GeometryType>(geometryType);
+
+    return stream;
+}
+
+
+OpenQuakeSourceModel::OpenQuakeSourceModel()
+{
+
+}
+
+
+bool OpenQuakeSourceModel::load(const QString& pathToFile, QString& err)
+{
+    this->clear();
+
+    auto pathToCache = getPathToCache(pathToFile);
+
+    if(this->readCache(pathToCache))
+    {
+        this->pathToFile = pathToFile;
+        return true;
+    }
+
+    this->clear();
+
+    if(!this->parseXML(pathToFile, err))
+    {
+        this->clear();
+        return false;
+    }
+
+    this->pathToFile = pathToFile;
+
+    // The model is usable without the cache, the next load parses the file again
+    this->writeCache(pathToCache, err);
+
+    return true;
+}
+
+
+void OpenQuakeSourceModel::clear(void)
+{
+    pathToFile.clear();
+    sourceModelName.clear();
+    numSourcesInFile = 0;
+    sourceTables.clear();
+}
+
+
+bool OpenQuakeSourceModel::isEmpty(void) const
+{
+    return sourceTables.isEmpty();
+}
+
+
+QString OpenQuakeSourceModel::getName(void) const
+{
+    return sourceModelName;
+}
+
+
+QString OpenQuakeSourceModel::getPathToFile(void) const
+{
+    return pathToFile;
+}
+
+
+int OpenQuakeSourceModel::getNumSourcesInFile(void) const
+{
+    return numSourcesInFile;
+}
+
+
+const QVector<OQSourceTable>& OpenQuakeSourceModel::getSourceTables(void) const
+{
+    return sourceTables;
+}
+
+
+const QStringList& OpenQuakeSourceModel::supportedSourceTypes(void)
+{
+    static QStringList sourceTypes = QStringList()
+            << "pointSource"
+            << "characteristicFaultSource"
+            << "complexFaultSource"
+            << "simpleFaultSource"
+            << "areaSource";
+
+    return sourceTypes;
+}
+
+
+bool OpenQuakeSourceModel::parseXML(const QString& pathToFile, QString& err)
+{
+    QFile file(pathToFile);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        err = "Error while loading file "+pathToFile;
+        return false;
+    }
+
+    auto sourceTypes = supportedSourceTypes();
+
+    QVector<OQSourceTable> tables(sourceTypes.size());
+    QVector<QVector<OQRawSource>> rawSources(sourceTypes.size());
+    QHash<QString, int> tableIndexes;
+
+    for(int i = 0; i<sourceTypes.size(); ++i)
+    {
+        tables[i].sourceType = sourceTypes.at(i);
+        tables[i].geometryType = getGeometrySpec(sourceTypes.at(i)).geometryType;
+        tables[i].offsets = {0};
+
+        tableIndexes.insert(sourceTypes.at(i), i);
+    }
+
+    bool hasSourceModel = false;
+    int numSources = 0;
+
+    // Stream the file once and collect the source elements by type, the xml can only be tokenized in order
+    QXmlStreamReader reader(&file);
+
+    while(!reader.atEnd())
+    {
+        reader.readNext();
+
+        if(!reader.isStartElement())
+            continue;
+
+        if(!hasSourceModel && reader.name() == QLatin1String("sourceModel"))
+        {
+            hasSourceModel = true;
+            sourceModelName = reader.attributes().value("name").toString();
+        }
+        else if(reader.name().endsWith(QLatin1String("Source")))
+        {
+            ++numSources;
+
+            auto sourceType = reader.name().toString();
+
+            auto it = tableIndexes.constFind(sourceType);
+
+            // The source types that are not supported are only counted
+            if(it == tableIndexes.constEnd())
+            {
+                reader.skipCurrentElement();
+                continue;
+            }
+
+            OQRawSource source;
+            if(!readRawSource(reader, getGeometrySpec(sourceType), source, err))
+                return false;
+
+            rawSources[it.value()].push_back(source);
+        }
+    }
+
+    if(reader.hasError())
+    {
+        err = "Error parsing the source model: "+reader.errorString()+" at line "+QString::number(reader.lineNumber());
+        return false;
+    }
+
+    if(!hasSourceModel)
+    {
+        err = "Could not find sourceModel tag in .xml file";
+        return false;
+    }
+
+    if(numSources == 0)
+    {
+        err = "Number of sources in the source model is zero";
+        return false;
+    }
+
+    file.close();
+
+    // Parse the sources of each type on the thread pool, the types do not share any columns
+    // Get the raw pointers before going parallel so that the vectors are not detached in the worker threads
+    auto tablesData = tables.data();
+    auto rawSourcesData = rawSources.data();
+
+    QVector<QString> errors(sourceTypes.size());
+    auto errorsData = errors.data();
+
+    QVector<int> typeIndices(sourceTypes.size());
+    std::iota(typeIndices.begin(), typeIndices.end(), 0);
+
+    QtConcurrent::blockingMap(typeIndices, [&](const int i)
+    {
+        const auto& spec = getGeometrySpec(tablesData[i].sourceType);
+
+        QHash<QString, int> columnIndexes;
+
+        for(auto&& source : rawSourcesData[i])
+        {
+            if(!addSource(source, spec, tablesData[i], columnIndexes, errorsData[i]))
+                break;
+        }
+
+        // The raw sources are not needed anymore
+        rawSourcesData[i] = QVector<OQRawSource>();
+    });
+
+    // Report the first error in order so that the message does not depend on the thread timing
+    for(int i = 0; i<errors.size(); ++i)
+    {
+        if(!errors.at(i).isEmpty())
+        {
+            err = "Failed to import the sources of type "+sourceTypes.at(i)+": "+errors.at(i);
+            return false;
+        }
+    }
+
+    for(auto&& table : tables)
+    {
+        if(table.size() > 0)
+            sourceTables.push_back(table);
+    }
+
+    numSourcesInFile = numSources;
+
+    return true;
+}
+
+
+bool OpenQuakeSourceModel::exportSources(const QSet<QString>& sourceIds, const QString& outputPath, QString& err) const
+{
+    QFile inputFile(pathToFile);
+    if (!inputFile.open(QIODevice::ReadOnly))
+    {
+        err = "Error while loading file "+pathToFile;
+        return false;
+    }
+
+    QFile outputFile(outputPath);
+    if(!outputFile.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        err = "Failed to open file for writing.";
+        return false;
+    }
+
+    QXmlStreamReader reader(&inputFile);
+    QXmlStreamWriter writer(&outputFile);
+
+    int numExported = 0;
+
+    // Copy the document token by token and skip the sources that are not selected
+    while(!reader.atEnd())
+    {
+        reader.readNext();
+
+        if(reader.hasError())
+            break;
+
+        if(reader.isStartElement() && reader.name().endsWith(QLatin1String("Source")))
+        {
+            auto id = reader.attributes().value("id").toString();
+
+            if(!sourceIds.contains(id))
+            {
+                reader.skipCurrentElement();
+                continue;
+            }
+
+            ++numExported;
+        }
+
+        writer.writeCurrentToken(reader);
+    }
+
+    outputFile.close();
+
+    if(reader.hasError())
+    {
+        err = "Error parsing the source model: "+reader.errorString()+" at line "+QString::number(reader.lineNumber());
+        return false;
+    }
+
+    if(numExported != sourceIds.size())
+    {
+        err = "Failed to find all of the selected nodes. Export failed!";
+        return false;
+    }
+
+    return true;
+}
+
+
+bool OpenQuakeSourceModel::readCache(const QString& pathToCache)
+{
+    QFile file(pathToCache);
+    if(!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_12);
+
+    quint32 magicNumber = 0;
+    qint32 version = 0;
+
+    stream >> magicNumber >> version;
+
+    if(magicNumber != cacheMagicNumber || version != cacheVersion)
+        return false;
+
+    qint32 numSources = 0;
+
+    stream >> sourceModelName >> numSources >> sourceTables;
+
+    numSourcesInFile = numSources;
+
+    return stream.status() == QDataStream::Ok && !sourceTables.isEmpty();
+}
+
+
+bool OpenQuakeSourceModel::writeCache(const QString& pathToCache, QString& err) const
+{
+    QDir().mkpath(QFileInfo(pathToCache).absolutePath());
+
+    // Write to a temporary file so that a partial cache is never read back
+    QSaveFile file(pathToCache);
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        err = "Could not write the source model cache "+pathToCache+": "+file.errorString();
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_12);
+
+    stream << cacheMagicNumber << cacheVersion << sourceModelName << static_cast<qint32>(numSourcesInFile) << sourceTables;
+
+    if(stream.status() != QDataStream::Ok || !file.commit())
+    {
+        err = "Could not write the source model cache "+pathToCache+": "+file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+
+QString OpenQuakeSourceModel::getPathToCache(const QString& pathToFile)
+{
+    QFileInfo fileInfo(pathToFile);
+
+    auto key = fileInfo.absoluteFilePath() + "|" + QString::number(fileInfo.size()) + "|" + QString::number(fileInfo.lastModified().toMSecsSinceEpoch());
+
+    auto hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Md5).toHex();
+
+    return GmCommon::getCacheLocation() + QDir::separator() + "OpenQuakeSourceModels" + QDir::separator() + QString(hash) + ".bin";
+}
@@ -0,0 +1,124 @@
+#ifndef OPENQUAKESOURCEMODEL_H
+#define OPENQUAKESOURCEMODEL_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+
+// Streaming reader for OpenQuake source model .xml files
+// The file is streamed once with a QXmlStreamReader to collect the source elements, then the attributes and geometries of each source type are parsed into columns on the thread pool.
+// The parsed model is cached in a binary file that is keyed by the path, size and modification time of the source model, so that reloading the same file skips the parsing.
+
+#include "OQAttributeColumn.h"
+
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+
+class QDataStream;
+
+// The sources of one type in columnar form
+struct OQSourceTable
+{
+    enum GeometryType { Point, Line, Polygon };
+
+    // The xml tag of the source type, e.g., pointSource
+    QString sourceType;
+    GeometryType geometryType = Point;
+
+    QVector<OQAttributeColumn> columns;
+
+    // The longitude, latitude pairs of all of the sources, the points of source i are in [offsets[i], offsets[i+1])
+    QVector<double> coordinates;
+    QVector<int> offsets;
+
+    int size(void) const;
+
+    int getNumPoints(const int source) const;
+
+    double getLongitude(const int source, const int point) const;
+    double getLatitude(const int source, const int point) const;
+};
+
+QDataStream& operator<<(QDataStream& stream, const OQSourceTable& table);
+QDataStream& operator>>(QDataStream& stream, OQSourceTable& table);
+
+
+class OpenQuakeSourceModel
+{
+public:
+    OpenQuakeSourceModel();
+
+    // Loads the source model from the binary cache if it is up to date, otherwise the .xml file is parsed and the cache is written
+    // If the model is loaded but the cache could not be written, true is returned and err holds the reason
+    bool load(const QString& pathToFile, QString& err);
+
+    void clear(void);
+
+    bool isEmpty(void) const;
+
+    QString getName(void) const;
+
+    QString getPathToFile(void) const;
+
+    // The number of source elements in the file, including the source types that are not supported
+    int getNumSourcesInFile(void) const;
+
+    // One table per supported source type that is in the file
+    const QVector<OQSourceTable>& getSourceTables(void) const;
+
+    // Writes a copy of the source model that only contains the sources with the given ids, the rest of the document is streamed through unchanged
+    bool exportSources(const QSet<QString>& sourceIds, const QString& outputPath, QString& err) const;
+
+    // The source types that are supported, in the order they are loaded
+    static const QStringList& supportedSourceTypes(void);
+
+private:
+    bool parseXML(const QString& pathToFile, QString& err);
+
+    bool readCache(const QString& pathToCache);
+    bool writeCache(const QString& pathToCache, QString& err) const;
+
+    static QString getPathToCache(const QString& pathToFile);
+
+    QString pathToFile;
+    QString sourceModelName;
+    int numSourcesInFile = 0;
+    QVector<OQSourceTable> sourceTables;
+};
+
+#endif // OPENQUAKESOURCEMODEL_H
@@ -71,9 +71,8 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QStringList>
 #include <QTabWidget>
 #include <QTableWidget>
-#include <QTextCursor>
-#include <QTextTable>
 #include <QValueAxis>
+#include <QtConcurrent/QtConcurrent>
 
 #include "QGISVisualizationWidget.h"
 
@@ -913,302 +912,177 @@ int PelicunPostProcessor::assemblePDF(QImage screenShot)
     QPrinter printer(QPrinter::HighResolution);
     printer.setOutputFormat(QPrinter::PdfFormat);
     printer.setPaperSize(QPrinter::Letter);
-    printer.setPageMargins(25.4, 25.4, 25.4, 25.4, QPrinter::Millimeter);
     printer.setFullPage(true);
-    qreal leftMargin, topMargin;
-    printer.getPageMargins(&leftMargin,&topMargin,nullptr,nullptr,QPrinter::Point);
     printer.setOutputFileName(outputFilePath);
 
-    // Create a new document
-    QTextDocument* document = new QTextDocument();
-    QTextCursor cursor(document);
-    document->setDocumentMargin(25.4);
-    document->setDefaultFont(QFont("Helvetica"));
+    // Crop and scale the map screenshot in the background while the charts are rendered, the charts are widgets so they have to be rendered in the main thread
+    QRect viewPortRect(0, mapViewMainWidget->height() - mapViewSubWidget->height(), mapViewSubWidget->width(), mapViewSubWidget->height());
 
-    // Define font styles
-    QTextCharFormat normalFormat;
-    normalFormat.setFontPointSize(12);
-    normalFormat.setFontWeight(QFont::Normal);
+    auto mapFuture = QtConcurrent::run([screenShot, viewPortRect]()
+    {
+        return ReportWriter::scaleImage(screenShot.copy(viewPortRect), 6.5*72.0, 300.0);
+    });
 
-    QTextCharFormat titleFormat;
-    titleFormat.setFontWeight(QFont::Bold);
-    titleFormat.setFontCapitalization(QFont::AllUppercase);
-    titleFormat.setFontPointSize(normalFormat.fontPointSize() * 2.0);
+    auto renderChart = [](QtCharts::QChartView* chartView)
+    {
+        auto origSize = chartView->size();
+        chartView->resize(QSize(640,480));
 
-    QTextCharFormat captionFormat;
-    captionFormat.setFontWeight(QFont::Light);
-    captionFormat.setFontPointSize(normalFormat.fontPointSize());
-    captionFormat.setFontItalic(true);
+        auto rect = chartView->viewport()->rect();
+        QPixmap pixmap(rect.size());
+        QPainter painter(&pixmap);
+        painter.setRenderHints(QPainter::Antialiasing | QPainter::SmoothPixmapTransform);
+        chartView->render(&painter, pixmap.rect(), rect);
+        painter.end();
 
-    QTextCharFormat disclaimerFormat;
-    disclaimerFormat.setFontWeight(QFont::Light);
-    disclaimerFormat.setFontPointSize(normalFormat.fontPointSize() / 1.5);
+        chartView->resize(origSize);
 
-    QTextCharFormat boldFormat;
-    boldFormat.setFontWeight(QFont::Bold);
+        return pixmap.toImage();
+    };
 
-    QFontMetrics normMetrics(normalFormat.font());
-    auto lineSpacing = normMetrics.lineSpacing();
+    casualtiesChartView->setVisible(true);
+    auto figure2 = renderChart(casualtiesChartView);
+    auto figure3 = renderChart(lossesChartView);
 
-    // Define alignment formats
-    QTextBlockFormat alignCenter;
-    alignCenter.setLineHeight(lineSpacing, QTextBlockFormat::LineDistanceHeight) ;
-    alignCenter.setAlignment(Qt::AlignCenter);
+    QImage figure4;
+    if(lossesRFDiagram->property("ToPlot").toBool())
+        figure4 = renderChart(lossesRFDiagram);
 
-    QTextBlockFormat alignLeft;
-    alignLeft.setAlignment(Qt::AlignLeft);
-    alignLeft.setLineHeight(lineSpacing, QTextBlockFormat::LineDistanceHeight) ;
+    // Define font styles
+    QFont normalFont("Helvetica");
+    normalFont.setPointSizeF(12);
 
-    cursor.movePosition(QTextCursor::Start);
+    QFont titleFont(normalFont);
+    titleFont.setBold(true);
+    titleFont.setCapitalization(QFont::AllUppercase);
+    titleFont.setPointSizeF(normalFont.pointSizeF() * 2.0);
 
-    cursor.insertBlock(alignCenter);
+    QFont captionFont(normalFont);
+    captionFont.setWeight(QFont::Light);
+    captionFont.setItalic(true);
 
-    // Insert the simcenter logo at the top
-    QImage simCenterLogo(":resources/SimCenter@1x.png");
-    document->addResource(QTextDocument::ImageResource, QUrl("Logo"), simCenterLogo);
-    QTextImageFormat imageFormatSimCenterLogo;
-    imageFormatSimCenterLogo.setName("Logo");
-    imageFormatSimCenterLogo.setWidth(250);
-    imageFormatSimCenterLogo.setQuality(600);
+    QFont disclaimerFont(normalFont);
+    disclaimerFont.setWeight(QFont::Light);
+    disclaimerFont.setPointSizeF(normalFont.pointSizeF() / 1.5);
 
-    cursor.insertImage(imageFormatSimCenterLogo);
+    QFont boldFont(normalFont);
+    boldFont.setBold(true);
 
-    cursor.insertText("\nRegional Resilience Determination (R2D) Tool\n",titleFormat);
+    // The pages are painted as the content is added
+    ReportWriter report;
 
-    cursor.insertText("Results Summary\n",boldFormat);
+    QString errMsg;
+    if(!report.begin(&printer, 25.4, errMsg))
+    {
+        ProgramOutputDialog::getInstance()->appendErrorMessage(errMsg);
+        return -1;
+    }
 
-    alignLeft.setLineHeight(1, QTextBlockFormat::SingleHeight) ;
+    // Insert the simcenter logo at the top
+    QImage simCenterLogo(":resources/SimCenter@1x.png");
+    report.addImage(simCenterLogo, 187.5);
 
-    cursor.setBlockFormat(alignLeft);
+    report.addSpacing(12.0);
+    report.addText("Regional Resilience Determination (R2D) Tool",titleFont,Qt::AlignCenter);
+    report.addText("Results Summary",boldFont,Qt::AlignCenter);
+    report.addSpacing(12.0);
 
     QString disclaimerText = "Disclaimer: The presented simulation results are not representative of any individual building’s response. To understand the response of any individual building, "
                                 "please consult with a professional structural engineer. The presented tool does not assert the known condition of the building. Just as it cannot be used to predict the negative outcome of an individual "
                                 "building, prediction of safety or an undamaged state is not assured for an individual building. Any opinions, findings, and conclusions or recommendations expressed in this material are "
-                                "those of the author(s) and do not necessarily reflect the views of the National Science Foundation.\n";
-    cursor.insertText(disclaimerText,disclaimerFormat);
+                                "those of the author(s) and do not necessarily reflect the views of the National Science Foundation.";
+    report.addText(disclaimerText,disclaimerFont);
 
-    alignLeft.setLineHeight(lineSpacing, QTextBlockFormat::LineDistanceHeight);
+    report.addSpacing(12.0);
+    report.addText("Employing Pelicun loss methodology to calculate seismic losses.",normalFont);
 
-    cursor.setBlockFormat(alignLeft);
-
-    cursor.insertText("\nEmploying Pelicun loss methodology to calculate seismic losses.\n",normalFormat);
-
-    QString currentDT = "Timestamp: " + QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss") + "\n";
-    cursor.insertText(currentDT,normalFormat);
+    QString currentDT = "Timestamp: " + QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss");
+    report.addText(currentDT,normalFont);
 
     auto workflowApp = WorkflowAppR2D::getInstance();
     auto analysisName = workflowApp->getGeneralInformationWidget()->getAnalysisName();
 
-    QString analysisNameLabel = "Analysis name: " + analysisName + "\n";
-    cursor.insertText(analysisNameLabel,normalFormat);
+    QString analysisNameLabel = "Analysis name: " + analysisName;
+    report.addText(analysisNameLabel,normalFont);
 
-    cursor.insertText("Estimated Regional Totals\n",boldFormat);
+    report.addText("Estimated Regional Totals",boldFont);
 
-    QTextTableFormat tableFormat;
-    tableFormat.setPadding(5.0);
-    tableFormat.setCellPadding(5.0);
-    tableFormat.setBorder(0.0);
-    tableFormat.setAlignment(Qt::AlignVCenter);
+    QVector<QStringList> totals;
+    totals << QStringList{totalCasLabel->text(), totalCasValueLabel->text(), totalFatalitiesLabel->text(), totalFatalitiesValueLabel->text()};
+    totals << QStringList{totalLossLabel->text(), totalLossValueLabel->text(), totalRepairTimeLabel->text(), totalRepairTimeValueLabel->text()};
+    totals << QStringList{structLossLabel->text(), structLossValueLabel->text(), nonStructLossLabel->text(), nonStructLossValueLabel->text()};
 
-    tableFormat.setBackground(QColor("#f0f0f0"));
-    QVector<QTextLength> constraints;
-    constraints << QTextLength(QTextLength::PercentageLength, 25);
-    constraints << QTextLength(QTextLength::PercentageLength, 25);
-    constraints << QTextLength(QTextLength::PercentageLength, 25);
-    constraints << QTextLength(QTextLength::PercentageLength, 25);
-    tableFormat.setColumnWidthConstraints(constraints);
+    report.addGrid(totals,normalFont,QColor("#f0f0f0"));
 
-    // rows, columns, tableFormat
-    QTextTable *table = cursor.insertTable(3, 4, tableFormat);
+    report.addSpacing(24.0);
 
-    {
-        QTextTableCell cell = table->cellAt(0, 0);
-        cell.setFormat(normalFormat);
-        QTextCursor cellCursor = cell.firstCursorPosition();
-        cellCursor.insertText(totalCasLabel->text());
-    }
+    report.addImage(mapFuture.result(),report.getContentWidth(),"Regional map visualization.",captionFont);
 
-    {
-        QTextTableCell cell = table->cellAt(0, 1);
-        cell.setFormat(normalFormat);
-        QTextCursor cellCursor = cell.firstCursorPosition();
-        cellCursor.insertText(totalCasValueLabel->text());
-    }
+    report.addSpacing(12.0);
+    report.addImage(figure2,300.0,"Estimated casualties.",captionFont);
 
-    {
-        QTextTableCell cell = table->cellAt(0, 2);
-        cell.setFormat(normalFormat);
-        QTextCursor cellCursor = cell.firstCursorPosition();
-        cellCursor.insertText(totalFatalitiesLabel->text());
-    }
+    report.addSpacing(12.0);
+    report.addImage(figure3,300.0,"Estimated economic losses.",captionFont);
 
+    if(!figure4.isNull())
     {
-        QTextTableCell cell = table->cellAt(0, 3);
-        cell.setFormat(normalFormat);
-        QTextCursor cellCursor = cell.firstCursorPosition();
-        cellCursor.insertText(totalFatalitiesValueLabel->text());
+        report.addSpacing(12.0);
+        report.addImage(figure4,300.0,"Relative frequency diagram of expected losses.",captionFont);
     }
 
-    {
-        QTextTableCell cell = table->cellAt(1, 0);
-        cell.setFormat(normalFormat);
-        QTextCursor cellCursor = cell.firstCursorPosition();
-        cellCursor.insertText(totalLossLabel->text());
-    }
+    report.addSpacing(12.0);
+    report.addText("Individual Asset Results - Sorted According to the " + sortComboBox->currentText(),boldFont);
 
-    {
-        QTextTableCell cell = table->cellAt(1, 1);
-        cell.setFormat(normalFormat);
-        QTextCursor cellCursor = cell.firstCursorPosition();
-        cellCursor.insertText(totalLossValueLabel->text());
-    }
+    // Limit the size of the report for large regions, the table is sorted so the first rows are the top assets
+    // Only the repair costs and the fatalities add up over the remaining assets, the times, probabilities and ratios are left blank in the last row
+    ReportTableOptions tableOptions;
+    tableOptions.maxRows = maxReportTableRows;
+    tableOptions.sumColumns = {1, 4};
 
+    auto numAssets = pelicunResultsTableWidget->rowCount();
+    if(maxReportTableRows >= 0 && numAssets > maxReportTableRows)
     {
-        QTextTableCell cell = table->cellAt(1, 2);
-        cell.setFormat(normalFormat);
-        QTextCursor cellCursor = cell.firstCursorPosition();
-        cellCursor.insertText(totalRepairTimeLabel->text());
+        auto msg = "Showing the first " + QString::number(maxReportTableRows) + " of " + QString::number(numAssets) + " assets. The last row contains the total repair cost and fatalities of the remaining assets.";
+        report.addText(msg,captionFont);
+        ProgramOutputDialog::getInstance()->appendInfoMessage("The asset table of the report is truncated. " + msg);
     }
 
-    {
-        QTextTableCell cell = table->cellAt(1, 3);
-        cell.setFormat(normalFormat);
-        QTextCursor cellCursor = cell.firstCursorPosition();
-        cellCursor.insertText(totalRepairTimeValueLabel->text());
-    }
+    TablePrinter prettyTablePrinter;
+    prettyTablePrinter.printToReport(&report, pelicunResultsTableWidget, tableOptions);
 
+    if(!IMdata.isEmpty())
     {
-        QTextTableCell cell = table->cellAt(2, 0);
-        cell.setFormat(normalFormat);
-        QTextCursor cellCursor = cell.firstCursorPosition();
-        cellCursor.insertText(structLossLabel->text());
-    }
+        report.addSpacing(12.0);
+        report.addText("Individual Site Responses",boldFont);
 
-    {
-        QTextTableCell cell = table->cellAt(2, 1);
-        cell.setFormat(normalFormat);
-        QTextCursor cellCursor = cell.firstCursorPosition();
-        cellCursor.insertText(structLossValueLabel->text());
-    }
+        // The intensity measures do not add up, so the last row only counts the remaining sites
+        ReportTableOptions siteTableOptions;
+        siteTableOptions.maxRows = maxReportTableRows;
 
-    {
-        QTextTableCell cell = table->cellAt(2, 2);
-        cell.setFormat(normalFormat);
-        QTextCursor cellCursor = cell.firstCursorPosition();
-        cellCursor.insertText(nonStructLossLabel->text());
-    }
+        auto numSites = siteResponseTableWidget->rowCount();
+        if(maxReportTableRows >= 0 && numSites > maxReportTableRows)
+        {
+            auto msg = "Showing the first " + QString::number(maxReportTableRows) + " of " + QString::number(numSites) + " sites.";
+            report.addText(msg,captionFont);
+            ProgramOutputDialog::getInstance()->appendInfoMessage("The site response table of the report is truncated. " + msg);
+        }
 
-    {
-        QTextTableCell cell = table->cellAt(2, 3);
-        cell.setFormat(normalFormat);
-        QTextCursor cellCursor = cell.firstCursorPosition();
-        cellCursor.insertText(nonStructLossValueLabel->text());
+        prettyTablePrinter.printToReport(&report, siteResponseTableWidget, siteTableOptions);
     }
 
-    cursor.movePosition( QTextCursor::End );
-
-    cursor.insertText("\n\n",normalFormat);
-
-    // Ratio of the page width that is printable
-    auto useablePageWidth = printer.pageRect(QPrinter::Point).width()-(1.5*leftMargin);
-
-    QRect viewPortRect(0, mapViewMainWidget->height() - mapViewSubWidget->height(), mapViewSubWidget->width(), mapViewSubWidget->height());
-    QImage cropped = screenShot.copy(viewPortRect);
-    document->addResource(QTextDocument::ImageResource,QUrl("Figure1"),cropped);
-    QTextImageFormat imageFormatFig1;
-    imageFormatFig1.setName("Figure1");
-    imageFormatFig1.setQuality(600);
-    imageFormatFig1.setWidth(useablePageWidth);
-
-    cursor.setBlockFormat(alignCenter);
-
-    cursor.insertImage(imageFormatFig1);
-
-    cursor.insertText("Regional map visualization.\n",captionFormat);
-
-    auto origSize = casualtiesChartView->size();
-
-    casualtiesChartView->resize(QSize(640,480));
-
-    casualtiesChartView->setVisible(true);
-    auto rectFig2 = casualtiesChartView->viewport()->rect();
-    QPixmap pixmapFig2(rectFig2.size());
-    QPainter painterFig2(&pixmapFig2);
-    painterFig2.setRenderHints(QPainter::Antialiasing | QPainter::SmoothPixmapTransform);
-    casualtiesChartView->render(&painterFig2, pixmapFig2.rect(), rectFig2);
-    auto figure2 = pixmapFig2.toImage();
-
-    casualtiesChartView->resize(origSize);
-
-    QTextImageFormat imageFormatFig2;
-    imageFormatFig2.setName("Figure2");
-    imageFormatFig2.setQuality(600);
-    imageFormatFig2.setWidth(400);
-
-    document->addResource(QTextDocument::ImageResource,QUrl("Figure2"),figure2);
-
-    cursor.insertImage(imageFormatFig2,QTextFrameFormat::InFlow);
-
-    cursor.insertText("\nEstimated casualties.\n",captionFormat);
-
-    auto origSize2 = lossesChartView->size();
-    lossesChartView->resize(QSize(640,480));
-    auto rectFig3 = lossesChartView->viewport()->rect();
-    QPixmap pixmapFig3(rectFig3.size());
-    QPainter painterFig3(&pixmapFig3);
-    painterFig3.setRenderHints(QPainter::Antialiasing | QPainter::SmoothPixmapTransform);
-    lossesChartView->render(&painterFig3, pixmapFig3.rect(), rectFig3);
-    auto figure3 = pixmapFig3.toImage();
-    lossesChartView->resize(origSize2);
-
-    QTextImageFormat imageFormatFig3;
-    imageFormatFig3.setName("Figure3");
-    imageFormatFig3.setQuality(600);
-    imageFormatFig3.setWidth(400);
-
-    document->addResource(QTextDocument::ImageResource,QUrl("Figure3"),figure3);
-    cursor.insertImage(imageFormatFig3,QTextFrameFormat::InFlow);
-
-    cursor.insertText("\nEstimated economic losses.\n",captionFormat);
-
-    if(lossesRFDiagram->property("ToPlot").toBool())
+    if(!report.end())
     {
-        auto origSize3 = lossesRFDiagram->size();
-        lossesRFDiagram->resize(QSize(640,480));
-        auto rectFig4 = lossesRFDiagram->viewport()->rect();
-        QPixmap pixmapFig4(rectFig4.size());
-        QPainter painterFig4(&pixmapFig4);
-        painterFig4.setRenderHints(QPainter::Antialiasing | QPainter::SmoothPixmapTransform);
-        lossesRFDiagram->render(&painterFig4, pixmapFig4.rect(), rectFig4);
-        auto figure4 = pixmapFig4.toImage();
-        lossesRFDiagram->resize(origSize3);
-
-        QTextImageFormat imageFormatFig4;
-        imageFormatFig4.setName("Figure4");
-        imageFormatFig4.setQuality(600);
-        imageFormatFig4.setWidth(400);
-
-        document->addResource(QTextDocument::ImageResource,QUrl("Figure4"),figure4);
-        cursor.insertImage(imageFormatFig4,QTextFrameFormat::InFlow);
-
-        cursor.insertText("\nRelative frequency diagram of expected losses.\n",captionFormat);
+        ProgramOutputDialog::getInstance()->appendErrorMessage("Error writing the report to the file "+outputFilePath);
+        return -1;
     }
 
-    cursor.insertText("Individual Asset Results - Sorted According to the " + sortComboBox->currentText() + "\n",boldFormat);
-
-    TablePrinter prettyTablePrinter;
-    prettyTablePrinter.printToTable(&cursor, pelicunResultsTableWidget,"Asset Results");
-
-    if(!IMdata.isEmpty())
-    {
-        cursor.insertText("Individual Site Responses\n",boldFormat);
-        TablePrinter prettyTablePrinter;
-        prettyTablePrinter.printToTable(&cursor, siteResponseTableWidget,"Site Response Results");
-    }
+    return 0;
+}
 
-    document->print(&printer);
 
-    return 0;
+void PelicunPostProcessor::setMaxReportTableRows(const int value)
+{
+    maxReportTableRows = value;
 }
 
 
@@ -78,6 +78,9 @@ public:
 
     int printToPDF(const QString& outputPath);
 
+    // Maximum number of rows of each results table in the report, the rows after are summed into one row, -1 prints all of the rows
+    void setMaxReportTableRows(const int value);
+
     // Function to convert a QString and QVariant to double
     // Throws an error exception if conversion fails
     template <typename T>
@@ -144,6 +147,8 @@ private:
 
     QString outputFilePath;
 
+    int maxReportTableRows = 5000;
+
     QMenu* viewMenu;
 
     QLabel* totalCasLabel;
@@ -39,6 +39,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "QGISHurricanePreprocessor.h"
 #include "CSVReaderWriter.h"
 #include "QGISVisualizationWidget.h"
+#include "TaskRunner.h"
 
 #include <qgsfield.h>
 #include <qgsfeature.h>
@@ -50,6 +51,15 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QApplication>
 #include <QProgressBar>
 #include <QList>
+#include <QMutex>
+
+// The hurricanes and their track features read from the database in the background
+struct HurricaneDatabaseResult
+{
+    QVector<HurricaneObject> hurricanes;
+    QgsFeatureList features;
+    QString err;
+};
 
 QGISHurricanePreprocessor::QGISHurricanePreprocessor(QProgressBar* pBar, QGISVisualizationWidget* visWidget, QObject* parent) : theProgressBar(pBar), theVisualizationWidget(visWidget), theParent(parent)
 {
@@ -63,19 +73,158 @@ QGISHurricanePreprocessor::QGISHurricanePreprocessor(QProgressBar* pBar, QGISVis
 
 QgsVectorLayer* QGISHurricanePreprocessor::loadHurricaneDatabaseData(const QString &eventFile, QString &err)
 {
+    auto numAtrb = this->getHurricaneFields().size();
+
+    theProgressBar->setMinimum(0);
+    theProgressBar->setMaximum(0);
+    theProgressBar->reset();
+
+    // Parse the database and build the tracks in the thread pool and wait for the result
+    auto database = TaskRunner::getInstance()->runAndWait<HurricaneDatabaseResult>([this, eventFile, numAtrb](TaskContext& context){
+            HurricaneDatabaseResult result;
+            this->parseHurricaneDatabase(eventFile, numAtrb, result.hurricanes, result.features, result.err, context);
+            return result;
+        }, [this](const TaskProgress& progress){
+            this->updateProgressBar(progress);
+        });
+
+    if(!database.err.isEmpty())
+    {
+        err = database.err;
+        return nullptr;
+    }
+
+    return this->createHurricanesLayer(database.hurricanes, database.features, err);
+}
+
+
+std::shared_ptr<TaskContext> QGISHurricanePreprocessor::loadHurricaneDatabaseData(const QString &eventFile, QObject* receiver, std::function<void(QgsVectorLayer*, const QString&)> onLoaded)
+{
+    auto numAtrb = this->getHurricaneFields().size();
+
+    theProgressBar->setMinimum(0);
+    theProgressBar->setMaximum(0);
+    theProgressBar->reset();
+
+    // The hurricanes are only handed over to the preprocessor in the GUI thread, so the worker does not touch the members
+    auto parseDatabase = [this, eventFile, numAtrb](TaskContext& context){
+        HurricaneDatabaseResult result;
+        this->parseHurricaneDatabase(eventFile, numAtrb, result.hurricanes, result.features, result.err, context);
+        return result;
+    };
+
+    auto createLayer = [this, onLoaded](const HurricaneDatabaseResult& database){
+        if(!database.err.isEmpty())
+        {
+            onLoaded(nullptr, database.err);
+            return;
+        }
+
+        QString err;
+        auto layer = this->createHurricanesLayer(database.hurricanes, database.features, err);
+
+        onLoaded(layer, err);
+    };
+
+    return TaskRunner::getInstance()->run<HurricaneDatabaseResult>(receiver, parseDatabase, createLayer, [this](const TaskProgress& progress){
+        this->updateProgressBar(progress);
+    });
+}
+
+
+QgsVectorLayer* QGISHurricanePreprocessor::createHurricanesLayer(const QVector<HurricaneObject>& hurricaneList, QgsFeatureList featList, QString &err)
+{
+    hurricanes = hurricaneList;
+
+    auto attrib = this->getHurricaneFields();
+
+    // The unique IDs come from the visualization widget so they are assigned here in the GUI thread
+    auto indexUID = attrib.size()-1;
+    for(auto&& feature : featList)
+        feature.setAttribute(indexUID, theVisualizationWidget->createUniqueID());
+
+    // Create the buildings group layer that will hold the sublayers
+    allHurricanesLayer = theVisualizationWidget->addVectorLayer("linestring","All Hurricanes");
+
+    if(allHurricanesLayer == nullptr)
+    {
+        err = "Error adding item to the map";
+        return nullptr;
+    }
+
+    auto pr = allHurricanesLayer->dataProvider();
+
+    auto res = pr->addAttributes(attrib);
+    if(!res)
+    {
+        err = "Error adding attributes";
+        theVisualizationWidget->removeLayer(allHurricanesLayer);
+        allHurricanesLayer = nullptr;
+        return nullptr;
+    }
+
+    allHurricanesLayer->updateFields(); // tell the vector layer to fetch changes from the provider
+
+    pr->addFeatures(featList);
+
+    allHurricanesLayer->updateExtents();
+
+    auto lineSymbol = new QgsLineSymbol();
+
+    lineSymbol->setWidth(0.75);
+
+    theVisualizationWidget->createSimpleRenderer(lineSymbol,allHurricanesLayer);
+
+    theVisualizationWidget->zoomToLayer(allHurricanesLayer);
+
+    return allHurricanesLayer;
+}
+
+
+QList<QgsField> QGISHurricanePreprocessor::getHurricaneFields(void)
+{
+    // Create the hurricane track fields
+    QList<QgsField> attrib;
+    attrib.append(QgsField("NAME", QVariant::String));
+    attrib.append(QgsField("SID", QVariant::String));
+    attrib.append(QgsField("SEASON", QVariant::String));
+    attrib.append(QgsField("TabName", QVariant::String));
+    attrib.append(QgsField("AssetType", QVariant::String));
+    attrib.append(QgsField("UID", QVariant::String));
+
+    return attrib;
+}
+
+
+void QGISHurricanePreprocessor::updateProgressBar(const TaskProgress& progress)
+{
+    if(progress.total > 0)
+    {
+        theProgressBar->setMaximum(progress.total);
+        theProgressBar->setValue(progress.done);
+    }
+}
+
+
+bool QGISHurricanePreprocessor::parseHurricaneDatabase(const QString &eventFile, const int numAtrb, QVector<HurricaneObject>& hurricaneList, QgsFeatureList& featList, QString &err, TaskContext& context)
+{
+    hurricaneList.clear();
+
+    context.setStatus("Reading the hurricane database");
+
     CSVReaderWriter csvTool;
 
     QVector<QStringList> data = csvTool.parseCSVFile(eventFile, err);
 
     if(!err.isEmpty())
     {
-        return nullptr;
+        return false;
     }
 
     if(data.empty())
     {
         err = "Hurricane data is empty";
-        return nullptr;
+        return false;
     }
 
     // Get the header information to populate the fields
@@ -88,7 +237,7 @@ QgsVectorLayer* QGISHurricanePreprocessor::loadHurricaneDatabaseData(const QStri
     data.pop_front();
 
 
-    // Split the hurricanes up as they come in one long list
+    // Split the hurricaneList up as they come in one long list
     QVectorIterator<QStringList> i(data);
     QString SID;
 
@@ -101,7 +250,7 @@ QgsVectorLayer* QGISHurricanePreprocessor::loadHurricaneDatabaseData(const QStri
     if(indexLandfall == -1 || indexSID == -1)
     {
         err = "Could not find the required column indexes in the data file";
-        return nullptr;
+        return false;
     }
 
     // While iterating through the hurricane points, save the data at first landfall
@@ -113,10 +262,10 @@ QgsVectorLayer* QGISHurricanePreprocessor::loadHurricaneDatabaseData(const QStri
         if(row.size() != numCol)
         {
             err = "Error, inconsistency in the data in the row and number of columns";
-            return nullptr;
+            return false;
         }
 
-        // Not all hurricanes will make landfall
+        // Not all hurricaneList will make landfall
         if(!landfallFound)
         {
             auto distToLand = row.at(indexLandfall);
@@ -136,7 +285,7 @@ QgsVectorLayer* QGISHurricanePreprocessor::loadHurricaneDatabaseData(const QStri
         {
             if(!hurricane.empty())
             {
-                hurricanes.push_back(hurricane);
+                hurricaneList.push_back(hurricane);
                 hurricane.clear();
                 landfallFound = false;
             }
@@ -149,14 +298,9 @@ QgsVectorLayer* QGISHurricanePreprocessor::loadHurricaneDatabaseData(const QStri
 
     // Push back the last hurricane
     if(!hurricane.empty())
-        hurricanes.push_back(hurricane);
+        hurricaneList.push_back(hurricane);
 
-    auto numHurricanes = hurricanes.size();
-
-    theProgressBar->setMinimum(0);
-    theProgressBar->setMaximum(numHurricanes);
-    theProgressBar->reset();
-    QApplication::processEvents();
+    auto numHurricanes = hurricaneList.size();
 
     // Name and storm ID
     auto indexName = headerData.indexOf("NAME");
@@ -166,32 +310,25 @@ QgsVectorLayer* QGISHurricanePreprocessor::loadHurricaneDatabaseData(const QStri
     if(indexName == -1 || indexSID == -1 || indexSeason == -1)
     {
         err = "Error adding a vector layer";
-        return nullptr;
+        return false;
     }
 
-    // Create the hurricane track fields
-    QList<QgsField> attrib;
-    attrib.append(QgsField("NAME", QVariant::String));
-    attrib.append(QgsField("SID", QVariant::String));
-    attrib.append(QgsField("SEASON", QVariant::String));
-    attrib.append(QgsField("TabName", QVariant::String));
-    attrib.append(QgsField("AssetType", QVariant::String));
-    attrib.append(QgsField("UID", QVariant::String));
-
+    context.setTotal(numHurricanes);
+    context.setStatus("Creating the hurricane tracks");
 
-    auto numAtrb = attrib.size();
+    QVector<QgsFeature> trackFeatures(numHurricanes);
 
-    QgsFeatureList featList;
+    // Get the raw pointers before going parallel so that the vectors are not detached in the worker threads
+    HurricaneObject* hurricaneData = hurricaneList.data();
+    QgsFeature* features = trackFeatures.data();
 
-    featList.reserve(numHurricanes);
+    QMutex errMutex;
+    int errIndex = numHurricanes;
 
-    for(int i = 0; i<numHurricanes; ++i)
+    TaskRunner::parallelFor(context, numHurricanes, [&](int i)
     {
-        theProgressBar->setValue(i);
-        QApplication::processEvents();
-
         // Get the hurricane
-        HurricaneObject& hurricane = hurricanes[i];
+        HurricaneObject& hurricane = hurricaneData[i];
 
         auto name = hurricane.front().at(indexName);
         auto SID = hurricane.front().at(indexSID);
@@ -202,65 +339,46 @@ QgsVectorLayer* QGISHurricanePreprocessor::loadHurricaneDatabaseData(const QStri
         hurricane.season = season;
         auto nameID = name+"-"+season;
 
-        // Create a unique ID for this track
-        auto uid = theVisualizationWidget->createUniqueID();
-
+        // The unique ID is set after the tracks are created
         QgsAttributes featureAttributes(numAtrb);
         featureAttributes[0] = name;
         featureAttributes[1] = SID;
         featureAttributes[2] = season;
         featureAttributes[3] = nameID;
         featureAttributes[4] = "HURRICANE";
-        featureAttributes[5] = uid;
+        featureAttributes[5] = QString();
 
-        QgsFeature feature;
-
-        auto polyline = this->getTrackGeometry(&hurricane, err);
+        QString trackErr;
+        auto polyline = this->getTrackGeometry(&hurricane, trackErr);
 
         if(polyline.isEmpty() || polyline.isNull())
-            return nullptr;
-
-        feature.setGeometry(polyline);
-
-        feature.setAttributes(featureAttributes);
+        {
+            // Keep the error of the first hurricane that failed so that the message does not depend on the thread timing
+            QMutexLocker locker(&errMutex);
+            if(i < errIndex)
+            {
+                errIndex = i;
+                err = trackErr;
+            }
+            return;
+        }
 
-        featList.push_back(feature);
-    }
+        features[i].setGeometry(polyline);
+        features[i].setAttributes(featureAttributes);
+    });
 
-    // Create the buildings group layer that will hold the sublayers
-    allHurricanesLayer = theVisualizationWidget->addVectorLayer("linestring","All Hurricanes");
+    if(errIndex != numHurricanes)
+        return false;
 
-    if(allHurricanesLayer == nullptr)
+    if(context.isCanceled())
     {
-        err = "Error adding item to the map";
-        return nullptr;
+        err = "Loading the hurricane database was canceled";
+        return false;
     }
 
-    auto pr = allHurricanesLayer->dataProvider();
+    featList = trackFeatures.toList();
 
-    auto res = pr->addAttributes(attrib);
-    if(!res)
-    {
-        err = "Error adding attributes";
-        theVisualizationWidget->removeLayer(allHurricanesLayer);
-        return nullptr;
-    }
-
-    allHurricanesLayer->updateFields(); // tell the vector layer to fetch changes from the provider
-
-    pr->addFeatures(featList);
-
-    allHurricanesLayer->updateExtents();
-
-    auto lineSymbol = new QgsLineSymbol();
-
-    lineSymbol->setWidth(0.75);
-
-    theVisualizationWidget->createSimpleRenderer(lineSymbol,allHurricanesLayer);
-
-    theVisualizationWidget->zoomToLayer(allHurricanesLayer);
-
-    return allHurricanesLayer;
+    return true;
 }
 
 
@@ -42,15 +42,21 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 class QGISVisualizationWidget;
 
+#include <qgsfeature.h>
 #include <qgsgeometry.h>
 
 class QgsVectorLayer;
+class TaskContext;
+struct TaskProgress;
 
 #include <QString>
 #include <QStringList>
 #include <QVector>
 #include <QVariant>
 
+#include <functional>
+#include <memory>
+
 class QObject;
 class QProgressBar;
 
@@ -59,8 +65,13 @@ class QGISHurricanePreprocessor
 public:
     QGISHurricanePreprocessor(QProgressBar* pBar, QGISVisualizationWidget* visWidget, QObject* parent);
 
+    // Reads the database in the thread pool and waits for it, then creates the layer of all of the hurricanes
     QgsVectorLayer* loadHurricaneDatabaseData(const QString &eventFile, QString &err);
 
+    // Reads the database in the thread pool without waiting, the layer is created in the GUI thread when the database is read
+    // onLoaded gets the layer, or nullptr and the error, it is not called if the receiver is destroyed or the task is canceled
+    std::shared_ptr<TaskContext> loadHurricaneDatabaseData(const QString &eventFile, QObject* receiver, std::function<void(QgsVectorLayer*, const QString&)> onLoaded);
+
     void clear(void);
 
     // Gets the hurricane of the given storm id
@@ -81,6 +92,17 @@ public:
 private:
 
     QgsGeometry getTrackGeometry(HurricaneObject* hurricane, QString& err);
+
+    // Reads the database and creates one track feature per hurricane, the features do not have a UID yet
+    // Does not touch the GUI or the members so that it can run in a worker thread
+    bool parseHurricaneDatabase(const QString &eventFile, const int numAtrb, QVector<HurricaneObject>& hurricaneList, QgsFeatureList& featList, QString &err, TaskContext& context);
+
+    // Keeps the hurricanes and creates the layer of their tracks, in the GUI thread
+    QgsVectorLayer* createHurricanesLayer(const QVector<HurricaneObject>& hurricaneList, QgsFeatureList featList, QString &err);
+
+    static QList<QgsField> getHurricaneFields(void);
+
+    void updateProgressBar(const TaskProgress& progress);
     QgsVectorLayer* allHurricanesLayer;
     QProgressBar* theProgressBar;
     QGISVisualizationWidget* theVisualizationWidget;
@@ -0,0 +1,396 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+#include "ReportWriter.h"
+
+#include <QAbstractItemModel>
+#include <QFontMetricsF>
+#include <QPrinter>
+
+#include <algorithm>
+
+namespace
+{
+// Number of rows that are measured to size the table columns
+const int numSampleRows = 200;
+
+// Padding of the table cells in points
+const double cellPadding = 2.5;
+}
+
+
+ReportWriter::ReportWriter()
+{
+
+}
+
+
+ReportWriter::~ReportWriter()
+{
+    if(painter.isActive())
+        painter.end();
+}
+
+
+bool ReportWriter::begin(QPrinter* thePrinter, const double marginMM, QString& err)
+{
+    printer = thePrinter;
+
+    if(printer == nullptr)
+    {
+        err = "Error, the printer is empty";
+        return false;
+    }
+
+    if(!painter.begin(printer))
+    {
+        err = "Error, could not start printing to the file "+printer->outputFileName();
+        return false;
+    }
+
+    painter.setRenderHints(QPainter::Antialiasing | QPainter::SmoothPixmapTransform | QPainter::TextAntialiasing);
+
+    const auto margin = marginMM/25.4*printer->resolution();
+
+    contentRect = QRectF(QPointF(0.0,0.0),printer->paperRect(QPrinter::DevicePixel).size()).adjusted(margin,margin,-margin,-margin);
+
+    y = contentRect.top();
+
+    return true;
+}
+
+
+bool ReportWriter::end(void)
+{
+    if(!painter.isActive())
+        return false;
+
+    return painter.end();
+}
+
+
+double ReportWriter::toDevice(const double points) const
+{
+    return points*printer->resolution()/72.0;
+}
+
+
+double ReportWriter::getContentWidth(void) const
+{
+    return contentRect.width()*72.0/printer->resolution();
+}
+
+
+void ReportWriter::newPage(void)
+{
+    printer->newPage();
+
+    y = contentRect.top();
+}
+
+
+void ReportWriter::ensureSpace(const double height)
+{
+    // Do not start a new page if the page is still empty, the content is taller than a page
+    if(y + height > contentRect.bottom() && y > contentRect.top())
+        this->newPage();
+}
+
+
+void ReportWriter::addSpacing(const double points)
+{
+    y += this->toDevice(points);
+
+    if(y > contentRect.bottom())
+        this->newPage();
+}
+
+
+void ReportWriter::addText(const QString& text, const QFont& font, const Qt::Alignment alignment)
+{
+    painter.setFont(font);
+
+    const auto flags = static_cast<int>(alignment) | Qt::TextWordWrap;
+
+    auto rect = painter.boundingRect(QRectF(contentRect.left(), y, contentRect.width(), contentRect.height()), flags, text);
+
+    this->ensureSpace(rect.height());
+
+    QRectF textRect(contentRect.left(), y, contentRect.width(), rect.height());
+
+    painter.drawText(textRect, flags, text);
+
+    y += rect.height();
+}
+
+
+void ReportWriter::addImage(const QImage& image, const double widthPoints, const QString& caption, const QFont& captionFont)
+{
+    if(image.isNull())
+        return;
+
+    auto width = std::min(this->toDevice(widthPoints),contentRect.width());
+    auto height = width*image.height()/image.width();
+
+    auto captionHeight = 0.0;
+    if(!caption.isEmpty())
+    {
+        painter.setFont(captionFont);
+        captionHeight = painter.boundingRect(QRectF(contentRect.left(), 0.0, contentRect.width(), contentRect.height()), Qt::AlignCenter | Qt::TextWordWrap, caption).height();
+    }
+
+    // Keep the caption on the same page as the image
+    this->ensureSpace(height + captionHeight);
+
+    // Shrink the image if it is taller than the page
+    if(height + captionHeight > contentRect.bottom() - y)
+    {
+        auto scale = (contentRect.bottom() - y - captionHeight)/height;
+        height *= scale;
+        width *= scale;
+    }
+
+    QRectF target(contentRect.left() + 0.5*(contentRect.width()-width), y, width, height);
+
+    painter.drawImage(target, image);
+
+    y += height;
+
+    if(!caption.isEmpty())
+        this->addText(caption, captionFont, Qt::AlignCenter);
+}
+
+
+void ReportWriter::addGrid(const QVector<QStringList>& cells, const QFont& font, const QColor& background)
+{
+    int numCols = 0;
+    for(auto&& row : cells)
+        numCols = std::max(numCols,row.size());
+
+    if(numCols == 0)
+        return;
+
+    painter.setFont(font);
+
+    const auto pad = this->toDevice(2.0*cellPadding);
+    const auto colWidth = contentRect.width()/numCols;
+    const auto flags = Qt::AlignLeft | Qt::AlignVCenter | Qt::TextWordWrap;
+
+    for(auto&& row : cells)
+    {
+        auto rowHeight = 0.0;
+        for(auto&& cell : row)
+            rowHeight = std::max(rowHeight,painter.boundingRect(QRectF(0.0, 0.0, colWidth-2.0*pad, contentRect.height()), flags, cell).height());
+
+        rowHeight += 2.0*pad;
+
+        this->ensureSpace(rowHeight);
+
+        painter.fillRect(QRectF(contentRect.left(), y, contentRect.width(), rowHeight), background);
+
+        for(int j = 0; j<row.size(); ++j)
+            painter.drawText(QRectF(contentRect.left() + j*colWidth + pad, y + pad, colWidth-2.0*pad, rowHeight-2.0*pad), flags, row.at(j));
+
+        y += rowHeight;
+    }
+}
+
+
+int ReportWriter::addTable(const QAbstractItemModel* model, const QVector<int>& columns, const ReportTableOptions& options)
+{
+    if(model == nullptr || columns.isEmpty())
+        return 0;
+
+    const auto numRows = model->rowCount();
+    const auto numCols = columns.size();
+
+    const auto numPrintedRows = (options.maxRows < 0) ? numRows : std::min(options.maxRows,numRows);
+    const auto numRemainingRows = numRows - numPrintedRows;
+
+    QFont font("Helvetica");
+    font.setPointSizeF(options.fontPointSize);
+
+    QFont headerFont(font);
+    headerFont.setBold(true);
+
+    QFontMetricsF fm(font, printer);
+    QFontMetricsF headerFm(headerFont, printer);
+
+    const auto pad = this->toDevice(cellPadding);
+    const auto rowHeight = headerFm.height() + 2.0*pad;
+
+    auto cellText = [&](const int row, const int col)
+    {
+        return model->data(model->index(row, col)).toString().simplified();
+    };
+
+    // Size the columns from the header and a sample of the rows, then scale them to the width of the page
+    QStringList headers;
+    QVector<double> colWidths(numCols);
+    for(int j = 0; j<numCols; ++j)
+    {
+        headers.push_back(model->headerData(columns.at(j), Qt::Horizontal).toString());
+        colWidths[j] = headerFm.horizontalAdvance(headers.back());
+    }
+
+    for(int i = 0; i<std::min(numSampleRows,numPrintedRows); ++i)
+        for(int j = 0; j<numCols; ++j)
+            colWidths[j] = std::max(colWidths.at(j),fm.horizontalAdvance(cellText(i,columns.at(j))));
+
+    auto totalWidth = 0.0;
+    for(auto&& it : colWidths)
+        totalWidth += it + 2.0*pad;
+
+    const auto scale = contentRect.width()/totalWidth;
+    for(auto&& it : colWidths)
+        it = (it + 2.0*pad)*scale;
+
+    auto drawRow = [&](const QStringList& values, const QFontMetricsF& metrics, const QColor& background)
+    {
+        if(background.isValid())
+            painter.fillRect(QRectF(contentRect.left(), y, contentRect.width(), rowHeight), background);
+
+        auto x = contentRect.left();
+        for(int j = 0; j<numCols; ++j)
+        {
+            const auto w = colWidths.at(j);
+            QRectF cellRect(x, y, w, rowHeight);
+
+            painter.drawRect(cellRect);
+            painter.drawText(cellRect.adjusted(pad,0.0,-pad,0.0), Qt::AlignLeft | Qt::AlignVCenter, metrics.elidedText(values.value(j), Qt::ElideRight, w-2.0*pad));
+
+            x += w;
+        }
+
+        y += rowHeight;
+    };
+
+    auto drawHeader = [&]()
+    {
+        painter.setFont(headerFont);
+        drawRow(headers, headerFm, QColor("#f0f0f0"));
+        painter.setFont(font);
+    };
+
+    painter.setPen(QPen(Qt::gray, 0));
+
+    // Start on a new page if there is not enough room for the header and a few rows
+    this->ensureSpace(4.0*rowHeight);
+
+    drawHeader();
+
+    QStringList values;
+    for(int i = 0; i<numPrintedRows; ++i)
+    {
+        if(y + rowHeight > contentRect.bottom())
+        {
+            this->newPage();
+            painter.setPen(QPen(Qt::gray, 0));
+            drawHeader();
+        }
+
+        values.clear();
+        for(int j = 0; j<numCols; ++j)
+            values.push_back(cellText(i,columns.at(j)));
+
+        drawRow(values, fm, QColor());
+    }
+
+    if(numRemainingRows > 0 && options.aggregateRemainder)
+    {
+        // Sum the additive columns of the rows that are not printed, a column is only summed if all of its non-empty values are numbers
+        QVector<double> sums(numCols,0.0);
+        QVector<bool> isNumeric(numCols,false);
+
+        for(int j = 1; j<numCols; ++j)
+            isNumeric[j] = options.sumColumns.contains(columns.at(j));
+
+        for(int i = numPrintedRows; i<numRows; ++i)
+        {
+            for(int j = 1; j<numCols; ++j)
+            {
+                if(!isNumeric.at(j))
+                    continue;
+
+                auto val = model->data(model->index(i, columns.at(j)));
+                if(val.isNull() || val.toString().isEmpty())
+                    continue;
+
+                bool OK = false;
+                auto num = val.toDouble(&OK);
+
+                if(OK)
+                    sums[j] += num;
+                else
+                    isNumeric[j] = false;
+            }
+        }
+
+        values.clear();
+        values.push_back("Remaining "+QString::number(numRemainingRows));
+        for(int j = 1; j<numCols; ++j)
+            values.push_back(isNumeric.at(j) ? QString::number(sums.at(j),'g',8) : QString());
+
+        if(y + rowHeight > contentRect.bottom())
+        {
+            this->newPage();
+            painter.setPen(QPen(Qt::gray, 0));
+            drawHeader();
+        }
+
+        painter.setFont(headerFont);
+        drawRow(values, headerFm, QColor("#f7f7f7"));
+    }
+
+    painter.setPen(QPen(Qt::black, 0));
+
+    return numPrintedRows;
+}
+
+
+QImage ReportWriter::scaleImage(const QImage& image, const double widthPoints, const double dotsPerInch)
+{
+    if(image.isNull())
+        return image;
+
+    const auto width = static_cast<int>(widthPoints/72.0*dotsPerInch);
+
+    // Do not make small images larger, the printer scales them when they are drawn
+    if(width >= image.width())
+        return image;
+
+    return image.scaledToWidth(width, Qt::SmoothTransformation);
+}
@@ -0,0 +1,117 @@
+#ifndef REPORTWRITER_H
+#define REPORTWRITER_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Renders a report page by page directly to a printer, the content is painted as it is added so only the current page is held in memory
+// Tables are printed from the model in chunks of rows that fit on a page, and large tables can be limited to the first rows plus one aggregated row
+
+#include <QFont>
+#include <QImage>
+#include <QPainter>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class QPrinter;
+class QAbstractItemModel;
+
+struct ReportTableOptions
+{
+    // Maximum number of rows that are printed, -1 prints all of the rows
+    int maxRows = -1;
+
+    // If the rows are limited, add one row with the number of rows that are left out and the sums of sumColumns over them
+    bool aggregateRemainder = true;
+
+    // The model columns that are additive, e.g., losses, the other columns of the remainder row are left blank because a sum of coordinates or ratios means nothing
+    QVector<int> sumColumns;
+
+    double fontPointSize = 8.0;
+};
+
+
+class ReportWriter
+{
+public:
+    ReportWriter();
+    ~ReportWriter();
+
+    // Starts painting on the printer, the margin is in millimeters
+    bool begin(QPrinter* thePrinter, const double marginMM, QString& err);
+
+    // Finishes the last page and closes the output
+    bool end(void);
+
+    void addText(const QString& text, const QFont& font, const Qt::Alignment alignment = Qt::AlignLeft);
+
+    void addSpacing(const double points);
+
+    // Adds an image with the given width in points, the image goes on the next page if it does not fit on the current page
+    void addImage(const QImage& image, const double widthPoints, const QString& caption = QString(), const QFont& captionFont = QFont());
+
+    // Adds a small table of text cells with equal column widths, e.g., a summary of totals
+    void addGrid(const QVector<QStringList>& cells, const QFont& font, const QColor& background);
+
+    // Prints the given columns of the model, the header row is repeated on every page
+    // Returns the number of rows that were printed, not counting the aggregated row
+    int addTable(const QAbstractItemModel* model, const QVector<int>& columns, const ReportTableOptions& options);
+
+    void newPage(void);
+
+    // Width in points of the area inside of the margins
+    double getContentWidth(void) const;
+
+    // Scales an image so that it has the given resolution when printed at the width in points, this can be called from a background thread
+    static QImage scaleImage(const QImage& image, const double widthPoints, const double dotsPerInch);
+
+private:
+
+    // Starts a new page if the height in device units does not fit on the rest of the current page
+    void ensureSpace(const double height);
+
+    double toDevice(const double points) const;
+
+    QPrinter* printer = nullptr;
+    QPainter painter;
+
+    QRectF contentRect;
+
+    // Current vertical position on the page in device units
+    double y = 0.0;
+};
+
+#endif // REPORTWRITER_H
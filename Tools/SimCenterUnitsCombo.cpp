@@ -43,6 +43,85 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QStandardItem>
 #include <QMetaEnum>
 
+namespace {
+
+// Standard gravity in m/s^2
+const double gravity = 9.80665;
+
+}
+
+
+double SimCenter::Unit::getScaleToSI(const Type unit)
+{
+    switch(unit) {
+    case mm : return 1.0e-3;
+    case cm : return 1.0e-2;
+    case m : return 1.0;
+    case km : return 1.0e3;
+    case inch : return 0.0254;
+    case ft : return 0.3048;
+    case mi : return 1609.344;
+
+    case N : return 1.0;
+    case kN : return 1.0e3;
+    case lb : return 4.4482216152605;
+    case kips : return 4448.2216152605;
+
+    case Pa : return 1.0;
+    case MPa : return 1.0e6;
+    case GPa : return 1.0e9;
+    case bar : return 1.0e5;
+    case atm : return 101325.0;
+
+    case sec : return 1.0;
+    case min : return 60.0;
+    case hr : return 3600.0;
+    case day : return 86400.0;
+
+    case cmps : return 0.01;
+    case mps : return 1.0;
+    case kph : return 1.0/3.6;
+    case fps : return 0.3048;
+    case mph : return 0.44704;
+    case kts : return 1852.0/3600.0;
+
+    case cmps2 : return 0.01;
+    case mps2 : return 1.0;
+    case inchps2 : return 0.0254;
+    case ftps2 : return 0.3048;
+    case g : return gravity;
+    case lng : return gravity;
+    case pctg : return 0.01*gravity;
+
+    default : return 1.0;
+    }
+}
+
+
+bool SimCenter::Unit::isLogarithmic(const Type unit)
+{
+    return unit == lng;
+}
+
+
+SimCenter::Unit::Type SimCenter::Unit::fromString(const QString& unitString)
+{
+    bool OK = false;
+    auto value = QMetaEnum::fromType<Type>().keyToValue(unitString.toStdString().c_str(), &OK);
+
+    if(!OK)
+        return UNDEFINED;
+
+    return static_cast<Type>(value);
+}
+
+
+QString SimCenter::Unit::toString(const Type unit)
+{
+    return QString(QMetaEnum::fromType<Type>().valueToKey(unit));
+}
+
+
 SimCenterUnitsCombo::SimCenterUnitsCombo(SimCenter::Unit::Type unitType, QString comboName,  QWidget* parent) : QComboBox(parent), type(unitType), name(comboName)
 {
     this->setObjectName(comboName);
@@ -159,7 +238,7 @@ void SimCenterUnitsCombo::populateComboText(const SimCenter::Unit::Type unitType
         this->addItem("Seconds", SimCenter::Unit::Type::sec);
         this->addItem("Minutes", SimCenter::Unit::Type::min);
         this->addItem("Hours", SimCenter::Unit::Type::hr);
-        this->addItem("Days", SimCenter::Unit::Type::hr);
+        this->addItem("Days", SimCenter::Unit::Type::day);
 
         break;
     case SimCenter::Unit::Type::VELOCITY :
@@ -221,7 +300,7 @@ void SimCenterUnitsCombo::populateComboText(const SimCenter::Unit::Type unitType
         this->addChildItem("Seconds", SimCenter::Unit::Type::sec);
         this->addChildItem("Minutes", SimCenter::Unit::Type::min);
         this->addChildItem("Hours", SimCenter::Unit::Type::hr);
-        this->addChildItem("Days", SimCenter::Unit::Type::hr);
+        this->addChildItem("Days", SimCenter::Unit::Type::day);
 
         this->insertSeparator(this->count());
         this->addParentItem("Velocity");
@@ -70,6 +70,18 @@ public:
 
     Q_ENUM(Type)
 
+    // The factor that converts a value in the unit to SI units, i.e., m, N, Pa, sec, m/s and m/s^2
+    // The factor is 1.0 for the undefined and dimensionless units, for ln(g) it converts the exponential of the value
+    static double getScaleToSI(const Type unit);
+
+    // Returns true if the values are the natural logarithm of the unit, i.e., ln(g)
+    static bool isLogarithmic(const Type unit);
+
+    // Converts between the enum and the unit strings that are used in the json files, e.g., "g" or "mps"
+    // An unknown string returns UNDEFINED
+    static Type fromString(const QString& unitString);
+    static QString toString(const Type unit);
+
     Type type;
 
 };
@@ -0,0 +1,616 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+#include "SiteResponseEngine.h"
+#include "TaskRunner.h"
+
+#include <QSaveFile>
+#include <QTextStream>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+
+namespace
+{
+
+const double pi = 3.14159265358979323846;
+
+// Acceleration of gravity in m/s^2
+const double gravity = 9.80665;
+
+// Atmospheric pressure in kPa
+const double atmosphericPressure = 101.325;
+
+// Coefficient of lateral earth pressure at rest, used for the mean effective stress at the middle of a layer
+const double restCoefficient = 0.5;
+
+// The soil is split into sublayers of at most this thickness in m, and into at most maxNumSublayers
+const double maxSublayerThickness = 5.0;
+const int maxNumSublayers = 40;
+
+// Darendeli (2001) parameters for a non-plastic, normally consolidated soil at 1 Hz and 10 loading cycles
+const double darendeliCurvature = 0.919;
+const double darendeliScaling = 0.6329 - 0.0057*std::log(10.0);
+
+using Complex = std::complex<double>;
+
+
+// In place radix-2 FFT, the size of the data must be a power of two
+void fft(QVector<Complex>& data, const bool inverse)
+{
+    const int n = data.size();
+    auto a = data.data();
+
+    // Bit reversal permutation
+    for(int i = 1, j = 0; i<n; ++i)
+    {
+        int bit = n >> 1;
+        for(; j & bit; bit >>= 1)
+            j ^= bit;
+
+        j ^= bit;
+
+        if(i < j)
+            std::swap(a[i], a[j]);
+    }
+
+    for(int len = 2; len<=n; len <<= 1)
+    {
+        const auto angle = (inverse ? 2.0 : -2.0)*pi/len;
+        const Complex rootOfUnity(std::cos(angle), std::sin(angle));
+
+        for(int i = 0; i<n; i += len)
+        {
+            Complex w(1.0, 0.0);
+            for(int j = 0; j<len/2; ++j)
+            {
+                const auto u = a[i+j];
+                const auto v = a[i+j+len/2]*w;
+
+                a[i+j] = u+v;
+                a[i+j+len/2] = u-v;
+
+                w *= rootOfUnity;
+            }
+        }
+    }
+
+    if(inverse)
+    {
+        for(int i = 0; i<n; ++i)
+            a[i] /= static_cast<double>(n);
+    }
+}
+
+
+// Inverse transform of the spectrum of a real signal given by its non-negative frequencies, the real signal is left in the buffer
+void inverseRealFFT(const Complex* halfSpectrum, QVector<Complex>& buffer)
+{
+    const int n = buffer.size();
+
+    buffer[0] = halfSpectrum[0];
+    buffer[n/2] = halfSpectrum[n/2];
+
+    for(int k = 1; k<n/2; ++k)
+    {
+        buffer[k] = halfSpectrum[k];
+        buffer[n-k] = std::conj(halfSpectrum[k]);
+    }
+
+    fft(buffer, true);
+}
+
+
+double getPeakAbsoluteValue(const QVector<Complex>& buffer)
+{
+    double peak = 0.0;
+    for(auto&& it : buffer)
+        peak = std::max(peak, std::abs(it.real()));
+
+    return peak;
+}
+
+
+// Darendeli (2001) damping in percent at the shear strain gamma, all of the strains are in percent
+double getDarendeliDamping(const double gamma, const double referenceStrain, const double modulusRatio, const double minDamping)
+{
+    if(gamma < 1.0e-6)
+        return minDamping;
+
+    // Masing damping of the hyperbolic curve with a curvature of one, adjusted to the curvature of the modulus reduction curve
+    const auto dampingA1 = 100.0/pi*(4.0*(gamma - referenceStrain*std::log((gamma + referenceStrain)/referenceStrain))/(gamma*gamma/(gamma + referenceStrain)) - 2.0);
+
+    const auto a = darendeliCurvature;
+    const auto c1 = -1.1143*a*a + 1.8618*a + 0.2523;
+    const auto c2 = 0.0805*a*a - 0.0710*a - 0.0095;
+    const auto c3 = -0.0005*a*a + 0.0002*a + 0.0003;
+
+    const auto masingDamping = c1*dampingA1 + c2*dampingA1*dampingA1 + c3*dampingA1*dampingA1*dampingA1;
+
+    return darendeliScaling*std::pow(modulusRatio, 0.1)*masingDamping + minDamping;
+}
+
+}
+
+
+SiteResponseEngine::SiteResponseEngine()
+{
+    periods = {0.01, 0.02, 0.03, 0.05, 0.075, 0.1, 0.15, 0.2, 0.25, 0.3, 0.4, 0.5, 0.75, 1.0, 1.5, 2.0, 3.0, 4.0, 5.0, 7.5, 10.0};
+}
+
+
+void SiteResponseEngine::setPeriods(const QVector<double>& value)
+{
+    periods = value;
+}
+
+
+QVector<double> SiteResponseEngine::getPeriods(void) const
+{
+    return periods;
+}
+
+
+void SiteResponseEngine::setMaxIterations(const int value)
+{
+    maxIterations = value;
+}
+
+
+void SiteResponseEngine::setTolerance(const double value)
+{
+    tolerance = value;
+}
+
+
+bool SiteResponseEngine::createColumn(const double vs30, const double depthToRock, const double density, SiteResponseColumn& column, QString& err)
+{
+    if(!(vs30 > 0.0))
+    {
+        err = "The Vs30 of the site " + column.siteID + " must be positive";
+        return false;
+    }
+
+    if(depthToRock < 0.0)
+    {
+        err = "The depth to rock of the site " + column.siteID + " cannot be negative";
+        return false;
+    }
+
+    if(!(density > 0.0))
+    {
+        err = "The density of the site " + column.siteID + " must be positive";
+        return false;
+    }
+
+    const auto soilDensity = density > 100.0 ? 0.001*density : density;
+
+    column.thickness.clear();
+    column.shearWaveVelocity.clear();
+    column.density.clear();
+
+    // A stiffer soil than the bedrock is run as if the bedrock had the same stiffness
+    column.bedrockShearWaveVelocity = std::max(column.bedrockShearWaveVelocity, vs30);
+
+    if(depthToRock == 0.0)
+        return true;
+
+    const auto numSublayers = std::min(static_cast<int>(std::ceil(depthToRock/maxSublayerThickness)), maxNumSublayers);
+
+    column.thickness.fill(depthToRock/numSublayers, numSublayers);
+    column.shearWaveVelocity.fill(vs30, numSublayers);
+    column.density.fill(soilDensity, numSublayers);
+
+    return true;
+}
+
+
+int SiteResponseEngine::getPaddedSize(const int numSteps, const double dT) const
+{
+    auto maxPeriod = 0.0;
+    for(auto&& it : periods)
+        maxPeriod = std::max(maxPeriod, it);
+
+    const auto minSize = std::max(2*numSteps, numSteps + static_cast<int>(std::ceil(4.0*maxPeriod/dT)));
+
+    int n = 2;
+    while(n < minSize)
+        n <<= 1;
+
+    return n;
+}
+
+
+bool SiteResponseEngine::computeSurfaceMotion(const SiteResponseColumn& column, const SiteResponseMotion& motion, QVector<double>& surfaceAcceleration,
+                                              double& maxStrain, int& numIterations, QString& err) const
+{
+    const auto numSteps = motion.acceleration.size();
+    const auto numLayers = column.numLayers();
+
+    maxStrain = 0.0;
+    numIterations = 0;
+
+    if(numSteps < 2 || !(motion.dT > 0.0))
+    {
+        err = "The motion " + motion.name + " is empty or its time step is not positive";
+        return false;
+    }
+
+    // The motion on a site without soil is the outcrop motion
+    if(numLayers == 0)
+    {
+        surfaceAcceleration = motion.acceleration;
+        return true;
+    }
+
+    const auto n = this->getPaddedSize(numSteps, motion.dT);
+    const auto numFreqs = n/2 + 1;
+    const auto dOmega = 2.0*pi/(n*motion.dT);
+
+    // The spectrum of the input motion in m/s^2
+    QVector<Complex> inputSpectrum(n);
+    for(int i = 0; i<numSteps; ++i)
+        inputSpectrum[i] = gravity*motion.acceleration.at(i);
+
+    fft(inputSpectrum, false);
+
+    // The reference strain and small strain damping of every layer depend on the mean effective stress at its middle, the soil is taken to be dry
+    QVector<double> referenceStrain(numLayers);
+    QVector<double> minDamping(numLayers);
+
+    double verticalStress = 0.0;
+    for(int m = 0; m<numLayers; ++m)
+    {
+        const auto unitWeight = gravity*column.density.at(m);
+        const auto midStress = verticalStress + 0.5*unitWeight*column.thickness.at(m);
+
+        verticalStress += unitWeight*column.thickness.at(m);
+
+        const auto meanStress = std::max(midStress*(1.0 + 2.0*restCoefficient)/3.0, 1.0)/atmosphericPressure;
+
+        referenceStrain[m] = 0.0352*std::pow(meanStress, 0.3483);
+        minDamping[m] = 0.8005*std::pow(meanStress, -0.2889);
+    }
+
+    // Start from the small strain properties, the damping is a ratio
+    QVector<double> modulusRatio(numLayers, 1.0);
+    QVector<double> damping(numLayers);
+    for(int m = 0; m<numLayers; ++m)
+        damping[m] = 0.01*minDamping.at(m);
+
+    // The strain at the middle of every layer, stored layer major
+    QVector<Complex> strainSpectra(numLayers*numFreqs);
+    QVector<Complex> surfaceSpectrum(numFreqs);
+    QVector<Complex> complexVelocity(numLayers+1);
+    QVector<Complex> buffer(n);
+
+    const Complex I(0.0, 1.0);
+
+    const auto bedrockVelocity = column.bedrockShearWaveVelocity*std::sqrt(Complex(1.0, 2.0*column.bedrockDamping));
+
+    for(int iter = 0; iter<maxIterations; ++iter)
+    {
+        ++numIterations;
+
+        for(int m = 0; m<numLayers; ++m)
+            complexVelocity[m] = column.shearWaveVelocity.at(m)*std::sqrt(modulusRatio.at(m)*Complex(1.0, 2.0*damping.at(m)));
+
+        complexVelocity[numLayers] = bedrockVelocity;
+
+        surfaceSpectrum[0] = inputSpectrum[0];
+        for(int m = 0; m<numLayers; ++m)
+            strainSpectra[m*numFreqs] = 0.0;
+
+        for(int k = 1; k<numFreqs; ++k)
+        {
+            const auto omega = k*dOmega;
+
+            // The amplitudes of the up and down going waves, the free surface has equal amplitudes
+            Complex A(1.0, 0.0);
+            Complex B(1.0, 0.0);
+
+            for(int m = 0; m<numLayers; ++m)
+            {
+                const auto waveNumber = omega/complexVelocity.at(m);
+                const auto halfLayer = std::exp(I*waveNumber*0.5*column.thickness.at(m));
+
+                strainSpectra[m*numFreqs+k] = I*waveNumber*(A*halfLayer - B/halfLayer);
+
+                const auto nextDensity = m+1 < numLayers ? column.density.at(m+1) : column.bedrockDensity;
+                const auto impedanceRatio = column.density.at(m)*complexVelocity.at(m)/(nextDensity*complexVelocity.at(m+1));
+
+                const auto fullLayer = halfLayer*halfLayer;
+
+                const auto nextA = 0.5*A*(1.0 + impedanceRatio)*fullLayer + 0.5*B*(1.0 - impedanceRatio)/fullLayer;
+                const auto nextB = 0.5*A*(1.0 - impedanceRatio)*fullLayer + 0.5*B*(1.0 + impedanceRatio)/fullLayer;
+
+                A = nextA;
+                B = nextB;
+            }
+
+            // The damping makes the amplitudes blow up at high frequencies in deep columns, where the response is negligible
+            if(!std::isfinite(std::abs(A)))
+            {
+                surfaceSpectrum[k] = 0.0;
+                for(int m = 0; m<numLayers; ++m)
+                    strainSpectra[m*numFreqs+k] = 0.0;
+
+                continue;
+            }
+
+            // The outcrop motion of the bedrock is 2A and the surface motion is 2, the displacements are the accelerations divided by -omega^2
+            surfaceSpectrum[k] = inputSpectrum.at(k)/A;
+
+            const auto scale = -inputSpectrum.at(k)/(2.0*omega*omega*A);
+
+            for(int m = 0; m<numLayers; ++m)
+                strainSpectra[m*numFreqs+k] *= scale;
+        }
+
+        // Update the properties with the effective strains
+        double maxChange = 0.0;
+        maxStrain = 0.0;
+
+        for(int m = 0; m<numLayers; ++m)
+        {
+            inverseRealFFT(strainSpectra.constData() + m*numFreqs, buffer);
+
+            const auto peakStrain = 100.0*getPeakAbsoluteValue(buffer);
+            maxStrain = std::max(maxStrain, peakStrain);
+
+            const auto effectiveStrain = strainRatio*peakStrain;
+
+            const auto newRatio = 1.0/(1.0 + std::pow(effectiveStrain/referenceStrain.at(m), darendeliCurvature));
+            const auto newDamping = 0.01*getDarendeliDamping(effectiveStrain, referenceStrain.at(m), newRatio, minDamping.at(m));
+
+            maxChange = std::max(maxChange, std::abs(newRatio - modulusRatio.at(m))/modulusRatio.at(m));
+
+            modulusRatio[m] = newRatio;
+            damping[m] = newDamping;
+        }
+
+        if(maxChange < tolerance)
+            break;
+    }
+
+    inverseRealFFT(surfaceSpectrum.constData(), buffer);
+
+    surfaceAcceleration.resize(numSteps);
+    for(int i = 0; i<numSteps; ++i)
+        surfaceAcceleration[i] = buffer.at(i).real()/gravity;
+
+    return true;
+}
+
+
+void SiteResponseEngine::computeIntensityMeasures(const QVector<double>& acceleration, const double dT, double& pga, double& pgv, double* psa) const
+{
+    const auto numSteps = acceleration.size();
+
+    pga = 0.0;
+    pgv = 0.0;
+
+    double velocity = 0.0;
+    for(int i = 0; i<numSteps; ++i)
+    {
+        pga = std::max(pga, std::abs(acceleration.at(i)));
+
+        if(i > 0)
+            velocity += 0.5*(acceleration.at(i-1) + acceleration.at(i))*dT;
+
+        pgv = std::max(pgv, std::abs(velocity));
+    }
+
+    // The velocity in cm/s
+    pgv *= 100.0*gravity;
+
+    if(numSteps < 2 || periods.isEmpty())
+        return;
+
+    // The oscillator responses are found in the frequency domain, the padding leaves room for the free vibration after the motion
+    const auto n = this->getPaddedSize(numSteps, dT);
+    const auto numFreqs = n/2 + 1;
+    const auto dOmega = 2.0*pi/(n*dT);
+
+    QVector<Complex> spectrum(n);
+    for(int i = 0; i<numSteps; ++i)
+        spectrum[i] = acceleration.at(i);
+
+    fft(spectrum, false);
+
+    QVector<Complex> responseSpectrum(numFreqs);
+    QVector<Complex> buffer(n);
+
+    for(int j = 0; j<periods.size(); ++j)
+    {
+        const auto naturalFrequency = 2.0*pi/periods.at(j);
+
+        for(int k = 0; k<numFreqs; ++k)
+        {
+            const auto omega = k*dOmega;
+
+            responseSpectrum[k] = -spectrum.at(k)/Complex(naturalFrequency*naturalFrequency - omega*omega, 2.0*spectralDamping*naturalFrequency*omega);
+        }
+
+        inverseRealFFT(responseSpectrum.constData(), buffer);
+
+        psa[j] = naturalFrequency*naturalFrequency*getPeakAbsoluteValue(buffer);
+    }
+}
+
+
+bool SiteResponseEngine::run(const QVector<SiteResponseColumn>& columns, const QVector<SiteResponseMotion>& motions, const QVector<QVector<int>>& motionsOfSite,
+                             SiteResponseResults& results, QString& err, TaskContext* context) const
+{
+    if(motionsOfSite.size() != columns.size())
+    {
+        err = "The number of sites does not match the number of motion lists";
+        return false;
+    }
+
+    results = SiteResponseResults();
+    results.periods = periods;
+
+    // Every pair of site and motion is a record
+    for(int s = 0; s<columns.size(); ++s)
+    {
+        for(auto&& m : motionsOfSite.at(s))
+        {
+            if(m < 0 || m >= motions.size())
+            {
+                err = "The motion index " + QString::number(m) + " of the site " + columns.at(s).siteID + " is out of range";
+                return false;
+            }
+
+            results.siteIndex.push_back(s);
+            results.motionIndex.push_back(m);
+        }
+    }
+
+    const auto numRecords = results.numRecords();
+    const auto numPeriods = periods.size();
+
+    results.pga.resize(numRecords);
+    results.pgv.resize(numRecords);
+    results.maxStrain.resize(numRecords);
+    results.numIterations.resize(numRecords);
+    results.psa.resize(numRecords*numPeriods);
+
+    QVector<QString> errors(numRecords);
+
+    // Get the raw pointers before going parallel so that the vectors are not detached in the worker threads
+    auto pgaData = results.pga.data();
+    auto pgvData = results.pgv.data();
+    auto strainData = results.maxStrain.data();
+    auto iterData = results.numIterations.data();
+    auto psaData = results.psa.data();
+    auto errData = errors.data();
+
+    const auto& siteIndex = results.siteIndex;
+    const auto& motionIndex = results.motionIndex;
+
+    TaskContext localContext;
+    auto& runContext = context ? *context : localContext;
+
+    runContext.setTotal(numRecords);
+    runContext.setProgress(0);
+
+    TaskRunner::parallelFor(runContext, numRecords, [&](int r)
+    {
+        const auto& motion = motions.at(motionIndex.at(r));
+
+        QVector<double> surfaceAcceleration;
+        if(!this->computeSurfaceMotion(columns.at(siteIndex.at(r)), motion, surfaceAcceleration, strainData[r], iterData[r], errData[r]))
+            return;
+
+        this->computeIntensityMeasures(surfaceAcceleration, motion.dT, pgaData[r], pgvData[r], psaData + r*numPeriods);
+    }, 1);
+
+    if(runContext.isCanceled())
+    {
+        err = "The site response analysis was canceled";
+        return false;
+    }
+
+    // Report the first error in order so that the message does not depend on the thread timing
+    for(auto&& it : errors)
+    {
+        if(!it.isEmpty())
+        {
+            err = it;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+QStringList SiteResponseEngine::getIntensityMeasureNames(const QVector<double>& periods)
+{
+    QStringList names = {"PGA", "PGV"};
+
+    for(auto&& it : periods)
+        names.push_back("SA(" + QString::number(it) + ")");
+
+    return names;
+}
+
+
+bool SiteResponseEngine::writeResults(const QString& pathToFile, const QVector<SiteResponseColumn>& columns, const QVector<SiteResponseMotion>& motions,
+                                      const SiteResponseResults& results, QString& err)
+{
+    QSaveFile file(pathToFile);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        err = "Could not open the file " + pathToFile + " for writing";
+        return false;
+    }
+
+    const auto numPeriods = results.periods.size();
+
+    // The PGA and spectral accelerations are in g, the PGV in cm/s and the strain in percent
+    QStringList headings = {"ID", "Latitude", "Longitude", "Motion"};
+    headings.append(getIntensityMeasureNames(results.periods));
+    headings.append({"MaxShearStrain", "Iterations"});
+
+    QTextStream out(&file);
+    out << headings.join(',') << '\n';
+
+    for(int r = 0; r<results.numRecords(); ++r)
+    {
+        const auto& column = columns.at(results.siteIndex.at(r));
+
+        out << column.siteID << ',' << QString::number(column.latitude, 'g', 10) << ',' << QString::number(column.longitude, 'g', 10) << ','
+            << motions.at(results.motionIndex.at(r)).name << ',' << results.pga.at(r) << ',' << results.pgv.at(r);
+
+        for(int j = 0; j<numPeriods; ++j)
+            out << ',' << results.psa.at(r*numPeriods + j);
+
+        out << ',' << results.maxStrain.at(r) << ',' << results.numIterations.at(r) << '\n';
+    }
+
+    out.flush();
+
+    if(!file.commit())
+    {
+        err = "Could not write the file " + pathToFile;
+        return false;
+    }
+
+    return true;
+}
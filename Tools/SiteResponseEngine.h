@@ -0,0 +1,148 @@
+#ifndef SITERESPONSEENGINE_H
+#define SITERESPONSEENGINE_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Equivalent-linear 1D site response in the frequency domain, in the manner of SHAKE (Schnabel et al., 1972)
+// The soil columns of all of the sites are run against their input motions in parallel, without writing an OpenSees model or starting a process for every site
+// A column is a stack of visco-elastic layers over an elastic half-space. The strain compatible modulus and damping of every layer are found by iterating on its effective shear strain with the Darendeli (2001) curves.
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class TaskContext;
+
+// The layers of a soil column from the surface down, in m, m/s and t/m^3
+struct SiteResponseColumn
+{
+    QString siteID;
+    double latitude = 0.0;
+    double longitude = 0.0;
+
+    QVector<double> thickness;
+    QVector<double> shearWaveVelocity;
+    QVector<double> density;
+
+    double bedrockShearWaveVelocity = 760.0;
+    double bedrockDensity = 2.4;
+    double bedrockDamping = 0.01;
+
+    int numLayers(void) const { return thickness.size(); }
+};
+
+
+// An acceleration time history in g, the input motions are outcrop motions on the bedrock
+struct SiteResponseMotion
+{
+    QString name;
+    double dT = 0.0;
+    QVector<double> acceleration;
+};
+
+
+// The surface intensity measures of every pair of site and motion, the spectral accelerations are stored record major, i.e., the value for record r and period j is at r*numPeriods + j
+struct SiteResponseResults
+{
+    QVector<double> periods;
+
+    QVector<int> siteIndex;
+    QVector<int> motionIndex;
+
+    QVector<double> pga;
+    QVector<double> pgv;
+    QVector<double> maxStrain;
+    QVector<int> numIterations;
+    QVector<double> psa;
+
+    int numRecords(void) const { return siteIndex.size(); }
+};
+
+
+class SiteResponseEngine
+{
+public:
+    SiteResponseEngine();
+
+    // Periods of the surface response spectra, in s
+    void setPeriods(const QVector<double>& value);
+    QVector<double> getPeriods(void) const;
+
+    void setMaxIterations(const int value);
+    void setTolerance(const double value);
+
+    // Creates a uniform column with the shear wave velocity vs30 down to the bedrock, the soil is split into sublayers so that the strains can vary with depth
+    // The density is in t/m^3, values above 100 are taken to be in kg/m^3
+    static bool createColumn(const double vs30, const double depthToRock, const double density, SiteResponseColumn& column, QString& err);
+
+    // Runs the motions of every site through its column, motionsOfSite holds the indices of the motions that are applied to each site
+    bool run(const QVector<SiteResponseColumn>& columns, const QVector<SiteResponseMotion>& motions, const QVector<QVector<int>>& motionsOfSite,
+             SiteResponseResults& results, QString& err, TaskContext* context = nullptr) const;
+
+    // Runs one motion through a column and returns the surface acceleration in g, the effective strains are iterated until the moduli change by less than the tolerance
+    bool computeSurfaceMotion(const SiteResponseColumn& column, const SiteResponseMotion& motion, QVector<double>& surfaceAcceleration,
+                              double& maxStrain, int& numIterations, QString& err) const;
+
+    // Computes the PGA in g, PGV in cm/s and the pseudo spectral accelerations in g with 5% damping, psa must have room for one value per period
+    void computeIntensityMeasures(const QVector<double>& acceleration, const double dT, double& pga, double& pgv, double* psa) const;
+
+    // Writes the results as a single table with one row for every pair of site and motion and one column for every intensity measure
+    static bool writeResults(const QString& pathToFile, const QVector<SiteResponseColumn>& columns, const QVector<SiteResponseMotion>& motions,
+                             const SiteResponseResults& results, QString& err);
+
+    // The headings of the intensity measure columns in the results file
+    static QStringList getIntensityMeasureNames(const QVector<double>& periods);
+
+private:
+
+    // Number of samples after the zero padding, enough for the motion to die out at the longest period without wrapping around
+    int getPaddedSize(const int numSteps, const double dT) const;
+
+    QVector<double> periods;
+
+    int maxIterations = 15;
+
+    // Largest relative change of the shear moduli between two iterations at which the iterations stop
+    double tolerance = 0.02;
+
+    // Ratio of the effective to the maximum shear strain
+    const double strainRatio = 0.65;
+
+    // Damping of the response spectra
+    const double spectralDamping = 0.05;
+};
+
+#endif // SITERESPONSEENGINE_H
@@ -0,0 +1,336 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+#include "SpatialJoinEngine.h"
+
+#include <qgsfeatureiterator.h>
+#include <qgsgeometry.h>
+#include <qgsexception.h>
+
+#include <QtConcurrent/QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+// Number of points joined by one task
+const int chunkSize = 4096;
+}
+
+
+SpatialJoinPolygonIndex::SpatialJoinPolygonIndex()
+{
+
+}
+
+
+void SpatialJoinPolygonIndex::clear(void)
+{
+    polygonFields.clear();
+    polygonAttributes.clear();
+    boxes.clear();
+    polygonRingOffsets.clear();
+    ringVertexOffsets.clear();
+    vertexX.clear();
+    vertexY.clear();
+    cellOffsets.clear();
+    cellItems.clear();
+    numCellsX = 0;
+    numCellsY = 0;
+}
+
+
+bool SpatialJoinPolygonIndex::build(QgsFeatureSource* source, const QgsCoordinateTransform& ct, QString& err)
+{
+    this->clear();
+
+    if(source == nullptr)
+    {
+        err = "Error, the polygon source is empty";
+        return false;
+    }
+
+    polygonFields = source->fields();
+
+    auto numFeatures = source->featureCount();
+    if(numFeatures > 0)
+    {
+        polygonAttributes.reserve(numFeatures);
+        boxes.reserve(4*numFeatures);
+        polygonRingOffsets.reserve(numFeatures+1);
+    }
+
+    polygonRingOffsets.push_back(0);
+    ringVertexOffsets.push_back(0);
+
+    auto addRing = [&](const QgsPolylineXY& ring, double& xmin, double& ymin, double& xmax, double& ymax)
+    {
+        for(auto&& pnt : ring)
+        {
+            vertexX.push_back(pnt.x());
+            vertexY.push_back(pnt.y());
+
+            xmin = std::min(xmin,pnt.x());
+            ymin = std::min(ymin,pnt.y());
+            xmax = std::max(xmax,pnt.x());
+            ymax = std::max(ymax,pnt.y());
+        }
+
+        ringVertexOffsets.push_back(vertexX.size());
+    };
+
+    auto features = source->getFeatures();
+
+    QgsFeature feat;
+    while (features.nextFeature(feat))
+    {
+        auto geom = feat.geometry();
+
+        if(geom.isEmpty() || geom.type() != QgsWkbTypes::PolygonGeometry)
+            continue;
+
+        if(QgsWkbTypes::isCurvedType(geom.wkbType()))
+            geom.convertToStraightSegment();
+
+        try
+        {
+            if(ct.isValid() && !ct.isShortCircuited())
+                geom.transform(ct);
+        }
+        catch (QgsCsException& e)
+        {
+            err = "Error transforming the polygon "+QString::number(feat.id())+" to the asset coordinate system: "+e.what();
+            this->clear();
+            return false;
+        }
+
+        QgsMultiPolygonXY parts;
+        if(geom.isMultipart())
+            parts = geom.asMultiPolygon();
+        else
+            parts.push_back(geom.asPolygon());
+
+        double xmin = std::numeric_limits<double>::max();
+        double ymin = std::numeric_limits<double>::max();
+        double xmax = std::numeric_limits<double>::lowest();
+        double ymax = std::numeric_limits<double>::lowest();
+
+        // The holes are stored as regular rings, the even-odd rule in polygonContains takes care of them
+        for(auto&& part : parts)
+            for(auto&& ring : part)
+                addRing(ring, xmin, ymin, xmax, ymax);
+
+        if(ringVertexOffsets.size()-1 == polygonRingOffsets.last())
+            continue;
+
+        polygonRingOffsets.push_back(ringVertexOffsets.size()-1);
+
+        boxes.push_back(xmin);
+        boxes.push_back(ymin);
+        boxes.push_back(xmax);
+        boxes.push_back(ymax);
+
+        polygonAttributes.push_back(feat.attributes());
+    }
+
+    const auto numPolygons = polygonAttributes.size();
+
+    if(numPolygons == 0)
+        return true;
+
+    // Size the grid so that there is about one polygon per cell
+    double xmin = std::numeric_limits<double>::max();
+    double ymin = std::numeric_limits<double>::max();
+    double xmax = std::numeric_limits<double>::lowest();
+    double ymax = std::numeric_limits<double>::lowest();
+
+    for(int i = 0; i<numPolygons; ++i)
+    {
+        xmin = std::min(xmin,boxes.at(4*i));
+        ymin = std::min(ymin,boxes.at(4*i+1));
+        xmax = std::max(xmax,boxes.at(4*i+2));
+        ymax = std::max(ymax,boxes.at(4*i+3));
+    }
+
+    const auto width = std::max(xmax-xmin,1.0e-9);
+    const auto height = std::max(ymax-ymin,1.0e-9);
+
+    numCellsX = std::max(1,std::min(4096,static_cast<int>(std::ceil(std::sqrt(numPolygons*width/height)))));
+    numCellsY = std::max(1,std::min(4096,static_cast<int>(std::ceil(static_cast<double>(numPolygons)/numCellsX))));
+
+    gridMinX = xmin;
+    gridMinY = ymin;
+    cellSizeX = width/numCellsX;
+    cellSizeY = height/numCellsY;
+
+    // Two passes, first count the polygons in every cell and then fill the cells
+    auto cellRange = [&](const int i, int& cx0, int& cy0, int& cx1, int& cy1)
+    {
+        cx0 = std::min(numCellsX-1,static_cast<int>((boxes.at(4*i)-gridMinX)/cellSizeX));
+        cy0 = std::min(numCellsY-1,static_cast<int>((boxes.at(4*i+1)-gridMinY)/cellSizeY));
+        cx1 = std::min(numCellsX-1,static_cast<int>((boxes.at(4*i+2)-gridMinX)/cellSizeX));
+        cy1 = std::min(numCellsY-1,static_cast<int>((boxes.at(4*i+3)-gridMinY)/cellSizeY));
+    };
+
+    cellOffsets.fill(0,numCellsX*numCellsY+1);
+
+    for(int i = 0; i<numPolygons; ++i)
+    {
+        int cx0, cy0, cx1, cy1;
+        cellRange(i, cx0, cy0, cx1, cy1);
+
+        for(int cy = cy0; cy<=cy1; ++cy)
+            for(int cx = cx0; cx<=cx1; ++cx)
+                ++cellOffsets[cy*numCellsX + cx + 1];
+    }
+
+    for(int c = 0; c<numCellsX*numCellsY; ++c)
+        cellOffsets[c+1] += cellOffsets[c];
+
+    cellItems.resize(cellOffsets.last());
+
+    auto cellFill = cellOffsets;
+
+    for(int i = 0; i<numPolygons; ++i)
+    {
+        int cx0, cy0, cx1, cy1;
+        cellRange(i, cx0, cy0, cx1, cy1);
+
+        for(int cy = cy0; cy<=cy1; ++cy)
+            for(int cx = cx0; cx<=cx1; ++cx)
+                cellItems[cellFill[cy*numCellsX + cx]++] = i;
+    }
+
+    return true;
+}
+
+
+int SpatialJoinPolygonIndex::getCellIndex(const double x, const double y) const
+{
+    if(numCellsX == 0 || numCellsY == 0)
+        return -1;
+
+    const auto cx = static_cast<int>(std::floor((x-gridMinX)/cellSizeX));
+    const auto cy = static_cast<int>(std::floor((y-gridMinY)/cellSizeY));
+
+    // Points on the upper edges of the extent belong to the last cell
+    if(cx < 0 || cy < 0 || cx > numCellsX || cy > numCellsY)
+        return -1;
+
+    return std::min(cy,numCellsY-1)*numCellsX + std::min(cx,numCellsX-1);
+}
+
+
+bool SpatialJoinPolygonIndex::polygonContains(const int polygonIndex, const double x, const double y) const
+{
+    const double* box = boxes.constData() + 4*polygonIndex;
+
+    if(x < box[0] || y < box[1] || x > box[2] || y > box[3])
+        return false;
+
+    const double* vx = vertexX.constData();
+    const double* vy = vertexY.constData();
+
+    bool inside = false;
+
+    for(int r = polygonRingOffsets.at(polygonIndex); r<polygonRingOffsets.at(polygonIndex+1); ++r)
+    {
+        const auto begin = ringVertexOffsets.at(r);
+        const auto end = ringVertexOffsets.at(r+1);
+
+        // Crossing number test, the rings are closed so the last vertex equals the first one
+        for(int i = begin, j = end-1; i<end; j = i++)
+        {
+            if(((vy[i] > y) != (vy[j] > y)) && (x < (vx[j]-vx[i])*(y-vy[i])/(vy[j]-vy[i]) + vx[i]))
+                inside = !inside;
+        }
+    }
+
+    return inside;
+}
+
+
+int SpatialJoinPolygonIndex::findPolygon(const double x, const double y) const
+{
+    const auto cell = this->getCellIndex(x,y);
+
+    if(cell < 0)
+        return -1;
+
+    // Return the lowest polygon index if the polygons overlap, so that the result does not depend on the order of the cell items
+    int found = -1;
+    for(int k = cellOffsets.at(cell); k<cellOffsets.at(cell+1); ++k)
+    {
+        const auto i = cellItems.at(k);
+
+        if((found == -1 || i < found) && this->polygonContains(i,x,y))
+            found = i;
+    }
+
+    return found;
+}
+
+
+QVector<int> SpatialJoinPolygonIndex::join(const SpatialJoinPoints& points) const
+{
+    const auto numPoints = points.size();
+
+    QVector<int> result(numPoints,-1);
+
+    if(numPoints == 0 || this->numPolygons() == 0)
+        return result;
+
+    // Get the raw pointer before going parallel so that the vector is not detached in the worker threads
+    int* res = result.data();
+
+    QVector<int> chunkBegins;
+    for(int i = 0; i<numPoints; i += chunkSize)
+        chunkBegins.push_back(i);
+
+    auto joinChunk = [&](const int begin)
+    {
+        const auto end = std::min(begin+chunkSize, numPoints);
+
+        for(int i = begin; i<end; ++i)
+            res[i] = this->findPolygon(points.x.at(i),points.y.at(i));
+    };
+
+    QtConcurrent::blockingMap(chunkBegins, joinChunk);
+
+    return result;
+}
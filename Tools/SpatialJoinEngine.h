@@ -0,0 +1,114 @@
+#ifndef SPATIALJOINENGINE_H
+#define SPATIALJOINENGINE_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Point in polygon joins of asset centroids against polygon layers, e.g., census blocks and ACS block groups
+// The polygon layer is read once into an immutable snapshot of flat ring coordinates with a uniform grid index over the polygon bounding boxes.
+// After the snapshot is built it is never modified, so any number of joins can run against it concurrently without locking.
+
+#include <qgsfields.h>
+#include <qgsfeature.h>
+#include <qgsfeaturesource.h>
+#include <qgscoordinatetransform.h>
+
+#include <QString>
+#include <QVector>
+
+// Flat arrays of the points to join, e.g., the asset centroids
+struct SpatialJoinPoints
+{
+    QVector<QgsFeatureId> fids;
+    QVector<double> x;
+    QVector<double> y;
+
+    int size(void) const { return fids.size(); }
+};
+
+
+class SpatialJoinPolygonIndex
+{
+public:
+    SpatialJoinPolygonIndex();
+
+    // Reads all of the polygons from the source and transforms them with the given transform, the source should be a feature source snapshot that is safe to iterate in a worker thread
+    bool build(QgsFeatureSource* source, const QgsCoordinateTransform& ct, QString& err);
+
+    // Returns the index of the polygon containing every point, or -1 if the point is not inside any polygon
+    // The points are split into chunks that are joined in parallel
+    QVector<int> join(const SpatialJoinPoints& points) const;
+
+    // Returns the index of the first polygon containing the point, or -1
+    int findPolygon(const double x, const double y) const;
+
+    const QgsFields& fields(void) const { return polygonFields; }
+
+    const QgsAttributes& attributes(const int polygonIndex) const { return polygonAttributes.at(polygonIndex); }
+
+    int numPolygons(void) const { return polygonAttributes.size(); }
+
+    void clear(void);
+
+private:
+
+    bool polygonContains(const int polygonIndex, const double x, const double y) const;
+
+    int getCellIndex(const double x, const double y) const;
+
+    QgsFields polygonFields;
+    QVector<QgsAttributes> polygonAttributes;
+
+    // Bounding box of every polygon as xmin, ymin, xmax, ymax
+    QVector<double> boxes;
+
+    // The rings of polygon i are rings polygonRingOffsets[i] to polygonRingOffsets[i+1]-1, and the vertices of ring j are ringVertexOffsets[j] to ringVertexOffsets[j+1]-1
+    QVector<int> polygonRingOffsets;
+    QVector<int> ringVertexOffsets;
+    QVector<double> vertexX;
+    QVector<double> vertexY;
+
+    // Uniform grid over the extent of the polygons, the candidates of cell c are cellItems[cellOffsets[c]] to cellItems[cellOffsets[c+1]-1]
+    double gridMinX = 0.0;
+    double gridMinY = 0.0;
+    double cellSizeX = 1.0;
+    double cellSizeY = 1.0;
+    int numCellsX = 0;
+    int numCellsY = 0;
+    QVector<int> cellOffsets;
+    QVector<int> cellItems;
+};
+
+#endif // SPATIALJOINENGINE_H
@@ -0,0 +1,164 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+#include "StagingQueue.h"
+#include "TaskRunner.h"
+
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrent>
+
+#include <algorithm>
+
+StagingQueue* StagingQueue::activeQueue = nullptr;
+
+
+StagingQueue::StagingQueue() : active(false)
+{
+    if(activeQueue == nullptr)
+    {
+        activeQueue = this;
+        active = true;
+    }
+}
+
+
+StagingQueue::~StagingQueue()
+{
+    if(active)
+        activeQueue = nullptr;
+}
+
+
+bool StagingQueue::isActive(void) const
+{
+    return active;
+}
+
+
+void StagingQueue::beginGroup(const QString& name)
+{
+    JobGroup group;
+    group.name = name;
+
+    groups.push_back(group);
+}
+
+
+int StagingQueue::getNumJobs(void) const
+{
+    int numJobs = 0;
+    for(auto&& group : groups)
+        numJobs += group.jobs.size();
+
+    return numJobs;
+}
+
+
+bool StagingQueue::run(TaskContext& context, QStringList& errors, const int maxConcurrentGroups)
+{
+    context.setTotal(this->getNumJobs());
+
+    // Each group writes its error into its own slot so that the groups do not have to be synchronized
+    QVector<QString> groupErrors(groups.size());
+
+    // Get the raw pointers before going parallel so that the vectors are not detached in the worker threads
+    const auto groupsData = groups.constData();
+    auto groupErrorsData = groupErrors.data();
+
+    // A local pool limits the number of groups that run at once without holding back the other tasks
+    QThreadPool pool;
+    pool.setMaxThreadCount(std::max(1, maxConcurrentGroups));
+
+    QVector<QFuture<void>> futures;
+    futures.reserve(groups.size());
+
+    for(int i = 0; i<groups.size(); ++i)
+    {
+        futures.push_back(QtConcurrent::run(&pool, [&context, groupsData, groupErrorsData, i]()
+        {
+            const auto& group = groupsData[i];
+
+            for(auto&& job : group.jobs)
+            {
+                if(context.isCanceled())
+                {
+                    groupErrorsData[i] = "The staging was canceled";
+                    return;
+                }
+
+                context.setStatus("Staging the files of " + group.name);
+
+                QString err;
+                auto res = job(err);
+
+                context.addProgress();
+
+                if(!res)
+                {
+                    groupErrorsData[i] = err.isEmpty() ? QString("Unknown error") : err;
+                    return;
+                }
+            }
+        }));
+    }
+
+    for(auto&& future : futures)
+        future.waitForFinished();
+
+    // Report the errors in order so that the messages do not depend on the thread timing
+    for(int i = 0; i<groups.size(); ++i)
+    {
+        if(!groupErrors.at(i).isEmpty())
+            errors.append("Error staging the files of " + groups.at(i).name + ": " + groupErrors.at(i));
+    }
+
+    return errors.isEmpty();
+}
+
+
+bool StagingQueue::runOrDefer(const std::function<bool(QString&)>& job, QString& err)
+{
+    if(activeQueue == nullptr)
+        return job(err);
+
+    // Jobs added before a group is started get a group of their own
+    if(activeQueue->groups.isEmpty())
+        activeQueue->beginGroup("Components");
+
+    activeQueue->groups.last().jobs.push_back(job);
+
+    return true;
+}
@@ -0,0 +1,91 @@
+#ifndef STAGINGQUEUE_H
+#define STAGINGQUEUE_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Collects the file copies and exports of the components while they stage their input files on the GUI thread, so that the work of independent components can run concurrently afterwards
+// A job must only use the data that it was given when it was added, it must not touch widgets or layers owned by the GUI
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <functional>
+
+class TaskContext;
+
+class StagingQueue
+{
+public:
+    // The queue collects the jobs if there is no other queue doing so, a nested queue passes the jobs on to the outer one
+    StagingQueue();
+    ~StagingQueue();
+
+    // Returns true if this queue is the one that collects the jobs
+    bool isActive(void) const;
+
+    // Starts a new group of jobs, the jobs in a group run one after the other in the order that they were added and the groups run concurrently
+    void beginGroup(const QString& name);
+
+    int getNumJobs(void) const;
+
+    // Runs the groups with at most maxConcurrentGroups running at a time, returns false if any of the jobs failed
+    // A group stops at its first error, the errors are given in the order of the groups
+    bool run(TaskContext& context, QStringList& errors, const int maxConcurrentGroups = defaultMaxConcurrentGroups);
+
+    // Runs the job right away if there is no queue collecting the jobs, otherwise adds it to the current group of that queue and returns true
+    static bool runOrDefer(const std::function<bool(QString&)>& job, QString& err);
+
+    // The jobs are limited by the disk and not by the processor, so only a few of them run at once
+    static const int defaultMaxConcurrentGroups = 4;
+
+private:
+
+    struct JobGroup
+    {
+        QString name;
+        QVector<std::function<bool(QString&)>> jobs;
+    };
+
+    QVector<JobGroup> groups;
+
+    bool active;
+
+    // The queue collecting the jobs, it is only accessed on the GUI thread
+    static StagingQueue* activeQueue;
+};
+
+#endif // STAGINGQUEUE_H
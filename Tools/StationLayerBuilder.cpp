@@ -0,0 +1,479 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+#include "StationLayerBuilder.h"
+#include "QGISVisualizationWidget.h"
+#include "TaskRunner.h"
+
+#include <qgsvectorlayer.h>
+
+#include <QDir>
+#include <QtConcurrent/QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+
+StationLayerBuilder::StationLayerBuilder(const QString& assetType, const QString& tabName) : assetType(assetType), tabName(tabName)
+{
+
+}
+
+
+void StationLayerBuilder::setLocations(const QVector<double>& latitudes, const QVector<double>& longitudes)
+{
+    this->latitudes = latitudes;
+    this->longitudes = longitudes;
+}
+
+
+void StationLayerBuilder::addTextColumn(const QString& name, const QStringList& values)
+{
+    StationColumn column;
+    column.name = name;
+    column.type = QVariant::String;
+    column.text = values;
+
+    columns.push_back(column);
+}
+
+
+void StationLayerBuilder::addNumberColumn(const QString& name, const QVector<double>& values)
+{
+    StationColumn column;
+    column.name = name;
+    column.type = QVariant::Double;
+    column.numbers = values;
+
+    columns.push_back(column);
+}
+
+
+bool StationLayerBuilder::addStationDataColumns(const QStringList& headings, const QVector<QVector<QStringList>>& stationData, QString& err, const int maxToDisplay)
+{
+    const int numStations = stationData.size();
+    const int numHeadings = headings.size();
+
+    if(numStations != latitudes.size())
+    {
+        err = "Error, the number of stations with data does not equal the number of station locations";
+        return false;
+    }
+
+    QVector<double> means(numStations*numHeadings, 0.0);
+    QVector<char> isNumber(numStations*numHeadings, 1);
+    QVector<char> isValid(numStations, 1);
+
+    // Get the raw pointers before going parallel so that the vectors are not detached in the worker threads
+    const QVector<QStringList>* stations = stationData.constData();
+    double* meanData = means.data();
+    char* isNumberData = isNumber.data();
+    char* isValidData = isValid.data();
+
+    QVector<int> chunkBegins;
+    const int chunkSize = 1024;
+    for(int i = 0; i<numStations; i += chunkSize)
+        chunkBegins.push_back(i);
+
+    // Convert the values to numbers, a heading is a number column if all of its values are numbers
+    QtConcurrent::blockingMap(chunkBegins, [&](const int begin)
+    {
+        const auto end = std::min(begin+chunkSize, numStations);
+
+        for(int i = begin; i<end; ++i)
+        {
+            const auto& rows = stations[i];
+
+            if(rows.isEmpty())
+            {
+                isValidData[i] = 0;
+                continue;
+            }
+
+            double* stationMeans = meanData + i*numHeadings;
+            char* stationIsNumber = isNumberData + i*numHeadings;
+
+            for(auto&& row : rows)
+            {
+                if(row.size() != numHeadings)
+                {
+                    isValidData[i] = 0;
+                    break;
+                }
+
+                for(int j = 0; j<numHeadings; ++j)
+                {
+                    bool OK = false;
+                    auto val = row.at(j).toDouble(&OK);
+
+                    if(OK)
+                        stationMeans[j] += val;
+                    else
+                        stationIsNumber[j] = 0;
+                }
+            }
+
+            for(int j = 0; j<numHeadings; ++j)
+                stationMeans[j] /= rows.size();
+        }
+    });
+
+    for(int i = 0; i<numStations; ++i)
+    {
+        if(!isValid.at(i))
+        {
+            err = "Error, the station "+QString::number(i)+" does not have a value for every heading";
+            return false;
+        }
+    }
+
+    bool hasMultipleRows = false;
+    for(auto&& rows : stationData)
+    {
+        if(rows.size() > 1)
+        {
+            hasMultipleRows = true;
+            break;
+        }
+    }
+
+    for(int j = 0; j<numHeadings; ++j)
+    {
+        bool numberColumn = true;
+        for(int i = 0; i<numStations && numberColumn; ++i)
+            numberColumn = isNumber.at(i*numHeadings+j);
+
+        if(numberColumn)
+        {
+            QVector<double> values(numStations);
+            for(int i = 0; i<numStations; ++i)
+                values[i] = means.at(i*numHeadings+j);
+
+            // With a single row per station the value is the one in the file, otherwise the column is labelled as the mean of the rows
+            if(!hasMultipleRows)
+            {
+                this->addNumberColumn(headings.at(j), values);
+                continue;
+            }
+
+            this->addNumberColumn(headings.at(j)+" Mean", values);
+        }
+
+        // List the values of the first rows of each station
+        QVector<QString> summaries(numStations);
+        QString* summaryData = summaries.data();
+
+        QtConcurrent::blockingMap(chunkBegins, [&](const int begin)
+        {
+            const auto end = std::min(begin+chunkSize, numStations);
+
+            for(int i = begin; i<end; ++i)
+            {
+                const auto& rows = stations[i];
+
+                const auto numToDisplay = std::min(maxToDisplay, rows.size());
+
+                QString str;
+                for(int k = 0; k<numToDisplay; ++k)
+                {
+                    if(k != 0)
+                        str += ", ";
+
+                    str += rows.at(k).at(j);
+                }
+
+                if(numToDisplay < rows.size())
+                    str += "...";
+
+                summaryData[i] = str;
+            }
+        });
+
+        auto columnName = numberColumn ? headings.at(j)+" Values" : headings.at(j);
+
+        this->addTextColumn(columnName, summaries.toList());
+    }
+
+    return true;
+}
+
+
+bool StationLayerBuilder::addStationFiles(const QVector<QStringList>& eventGridRows,
+                                          const QString& stationDir,
+                                          const int latIndex,
+                                          const int lonIndex,
+                                          const QStringList& stationHeadings,
+                                          const std::function<QVector<QStringList>(const QString&, const double, const double)>& readStation,
+                                          QString& err,
+                                          TaskContext* context,
+                                          QVector<QVector<QStringList>>* stationDataOut)
+{
+    const int numStations = eventGridRows.size();
+
+    // Use a context of our own if the caller does not need the progress
+    TaskContext localContext;
+    if(context == nullptr)
+        context = &localContext;
+
+    context->setTotal(numStations);
+    context->setStatus("Reading the station files");
+
+    QStringList stationNames;
+    stationNames.reserve(numStations);
+    for(auto&& row : eventGridRows)
+        stationNames.append(row.value(0));
+
+    QVector<double> stationLatitudes(numStations);
+    QVector<double> stationLongitudes(numStations);
+    QVector<QVector<QStringList>> stationData(numStations);
+    QVector<QString> errors(numStations);
+
+    // Get the raw pointers before going parallel so that the vectors are not detached in the worker threads
+    const QStringList* rows = eventGridRows.constData();
+    double* latData = stationLatitudes.data();
+    double* lonData = stationLongitudes.data();
+    QVector<QStringList>* stationDataPtr = stationData.data();
+    QString* errorData = errors.data();
+
+    TaskRunner::parallelFor(*context, numStations, [&](int i)
+    {
+        const auto& rowStr = rows[i];
+
+        auto stationName = rowStr.value(0);
+
+        if(rowStr.size() <= std::max(latIndex, lonIndex))
+        {
+            errorData[i] = "Error, the row of the station "+stationName+" does not have a latitude and longitude";
+            return;
+        }
+
+        bool ok;
+        auto lon = rowStr.at(lonIndex).toDouble(&ok);
+
+        if(!ok)
+        {
+            errorData[i] = "Error longitude to a double, check the value in "+stationName;
+            return;
+        }
+
+        auto lat = rowStr.at(latIndex).toDouble(&ok);
+
+        if(!ok)
+        {
+            errorData[i] = "Error latitude to a double, check the value in "+stationName;
+            return;
+        }
+
+        latData[i] = lat;
+        lonData[i] = lon;
+
+        // Path to station files, e.g., site0.csv
+        auto stationPath = stationDir + QDir::separator() + stationName;
+
+        try
+        {
+            stationDataPtr[i] = readStation(stationPath, lat, lon);
+        }
+        catch(const QString& msg)
+        {
+            errorData[i] = "Error importing the station file: " + stationName+"\n"+msg;
+        }
+        catch(const char* msg)
+        {
+            errorData[i] = "Error importing the station file: " + stationName+"\n"+QString(msg);
+        }
+    });
+
+    // Report the first error in the order of the event grid so that the message does not depend on the thread timing
+    for(auto&& it : errors)
+    {
+        if(!it.isEmpty())
+        {
+            err = it;
+            return false;
+        }
+    }
+
+    if(context->isCanceled())
+    {
+        err = "Reading the station files was canceled";
+        return false;
+    }
+
+    this->setLocations(stationLatitudes, stationLongitudes);
+
+    this->addTextColumn("Station Name", stationNames);
+    this->addNumberColumn("Latitude", stationLatitudes);
+    this->addNumberColumn("Longitude", stationLongitudes);
+
+    if(stationDataOut != nullptr)
+        *stationDataOut = stationData;
+
+    return this->addStationDataColumns(stationHeadings, stationData, err);
+}
+
+
+int StationLayerBuilder::getNumStations(void) const
+{
+    return latitudes.size();
+}
+
+
+QList<QgsField> StationLayerBuilder::getFields(void) const
+{
+    QList<QgsField> attribFields;
+    attribFields.push_back(QgsField("AssetType", QVariant::String));
+    attribFields.push_back(QgsField("TabName", QVariant::String));
+
+    for(auto&& column : columns)
+        attribFields.push_back(QgsField(column.name, column.type));
+
+    return attribFields;
+}
+
+
+bool StationLayerBuilder::createFeatures(QgsFeatureList& features, QString& err) const
+{
+    const int numStations = latitudes.size();
+
+    if(longitudes.size() != numStations)
+    {
+        err = "Error, the number of latitudes does not equal the number of longitudes";
+        return false;
+    }
+
+    for(auto&& column : columns)
+    {
+        auto numValues = column.type == QVariant::Double ? column.numbers.size() : column.text.size();
+
+        if(numValues != numStations)
+        {
+            err = "Error, the number of values in the column "+column.name+" does not equal the number of stations";
+            return false;
+        }
+    }
+
+    const int numColumns = columns.size();
+
+    QVector<QgsFeature> stationFeatures(numStations);
+
+    // Get the raw pointer before going parallel so that the vector is not detached in the worker threads
+    QgsFeature* featureData = stationFeatures.data();
+
+    QVector<int> chunkBegins;
+    const int chunkSize = 4096;
+    for(int i = 0; i<numStations; i += chunkSize)
+        chunkBegins.push_back(i);
+
+    QtConcurrent::blockingMap(chunkBegins, [&](const int begin)
+    {
+        const auto end = std::min(begin+chunkSize, numStations);
+
+        for(int i = begin; i<end; ++i)
+        {
+            QgsAttributes featAttributes(2+numColumns);
+
+            featAttributes[0] = assetType;
+            featAttributes[1] = tabName;
+
+            for(int j = 0; j<numColumns; ++j)
+            {
+                const auto& column = columns.at(j);
+
+                if(column.type == QVariant::Double)
+                {
+                    // A missing number is a null value in the layer
+                    auto val = column.numbers.at(i);
+                    featAttributes[2+j] = std::isnan(val) ? QVariant(QVariant::Double) : QVariant(val);
+                }
+                else
+                {
+                    featAttributes[2+j] = column.text.at(i);
+                }
+            }
+
+            QgsFeature& feature = featureData[i];
+            feature.setGeometry(QgsGeometry::fromPointXY(QgsPointXY(longitudes.at(i),latitudes.at(i))));
+            feature.setAttributes(featAttributes);
+        }
+    });
+
+    features = stationFeatures.toList();
+
+    return true;
+}
+
+
+QgsVectorLayer* StationLayerBuilder::createLayer(QGISVisualizationWidget* visWidget, const QString& layerName, QString& err) const
+{
+    QgsFeatureList features;
+    if(!this->createFeatures(features, err))
+        return nullptr;
+
+    return this->createLayer(visWidget, layerName, features, err);
+}
+
+
+QgsVectorLayer* StationLayerBuilder::createLayer(QGISVisualizationWidget* visWidget, const QString& layerName, const QgsFeatureList& features, QString& err) const
+{
+    auto vectorLayer = visWidget->addVectorLayer("Point", layerName);
+
+    if(vectorLayer == nullptr)
+    {
+        err = "Error creating a layer";
+        return nullptr;
+    }
+
+    auto dProvider = vectorLayer->dataProvider();
+    auto res = dProvider->addAttributes(this->getFields());
+
+    if(!res)
+    {
+        err = "Error adding attribute fields to layer";
+        visWidget->removeLayer(vectorLayer);
+        return nullptr;
+    }
+
+    vectorLayer->updateFields(); // tell the vector layer to fetch changes from the provider
+
+    // The data provider needs a list it can modify
+    QgsFeatureList featureList = features;
+    dProvider->addFeatures(featureList);
+    vectorLayer->updateExtents();
+
+    visWidget->createSymbolRenderer(Qgis::MarkerShape::Cross,Qt::black,2.0,vectorLayer);
+
+    return vectorLayer;
+}
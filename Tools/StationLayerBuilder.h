@@ -0,0 +1,119 @@
+#ifndef STATIONLAYERBUILDER_H
+#define STATIONLAYERBUILDER_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Builds the point layers of hazard stations, e.g., ground motion or wind field grids, from typed columns
+// The features are created in parallel chunks and added to the layer with a single call to the data provider
+
+#include <qgsfeature.h>
+#include <qgsfield.h>
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <functional>
+
+class TaskContext;
+class QGISVisualizationWidget;
+class QgsVectorLayer;
+
+class StationLayerBuilder
+{
+public:
+    StationLayerBuilder(const QString& assetType, const QString& tabName);
+
+    // The locations of the stations, these set the geometry of the features
+    // Add number columns if the latitude and longitude should also be attributes
+    void setLocations(const QVector<double>& latitudes, const QVector<double>& longitudes);
+
+    // Every column has one value per station, the columns are the layer fields in the order they are added after the AssetType and TabName
+    void addTextColumn(const QString& name, const QStringList& values);
+    void addNumberColumn(const QString& name, const QVector<double>& values);
+
+    // Adds one column per heading from the data in the station files, where each station has one or more rows with a value for every heading
+    // A heading that only has numbers becomes a number column with the mean of the rows at each station, when a station has more than one row the column is named '<heading> Mean' and the values of the rows are also listed in a text column '<heading> Values'
+    // A heading that has text becomes a text column that lists the values of the first rows
+    bool addStationDataColumns(const QStringList& headings, const QVector<QVector<QStringList>>& stationData, QString& err, const int maxToDisplay = 20);
+
+    // Reads the station files that are listed in the rows of an event grid file in parallel, the first column of a row is the name of the station file
+    // Sets the locations and adds the Station Name, Latitude and Longitude columns followed by the station data columns
+    // readStation returns the data rows of a station file without the header, it throws a QString if the file cannot be read
+    // If stationDataOut is given it gets the rows of every station in the order of the event grid
+    bool addStationFiles(const QVector<QStringList>& eventGridRows,
+                         const QString& stationDir,
+                         const int latIndex,
+                         const int lonIndex,
+                         const QStringList& stationHeadings,
+                         const std::function<QVector<QStringList>(const QString& stationPath, const double latitude, const double longitude)>& readStation,
+                         QString& err,
+                         TaskContext* context = nullptr,
+                         QVector<QVector<QStringList>>* stationDataOut = nullptr);
+
+    int getNumStations(void) const;
+
+    QList<QgsField> getFields(void) const;
+
+    // Creates the features, this does not touch the GUI so it can run in a worker thread
+    bool createFeatures(QgsFeatureList& features, QString& err) const;
+
+    // Creates the layer with the station symbol and adds all of the features to it, this has to be called from the GUI thread
+    QgsVectorLayer* createLayer(QGISVisualizationWidget* visWidget, const QString& layerName, QString& err) const;
+
+    // Same as above, for features that were already created with createFeatures in a worker thread
+    QgsVectorLayer* createLayer(QGISVisualizationWidget* visWidget, const QString& layerName, const QgsFeatureList& features, QString& err) const;
+
+private:
+
+    struct StationColumn
+    {
+        QString name;
+        QVariant::Type type = QVariant::Double;
+        QVector<double> numbers;
+        QStringList text;
+    };
+
+    QString assetType;
+    QString tabName;
+
+    QVector<double> latitudes;
+    QVector<double> longitudes;
+
+    QVector<StationColumn> columns;
+};
+
+#endif // STATIONLAYERBUILDER_H
@@ -89,3 +89,19 @@ void TablePrinter::printToTable(QTextCursor* cursor, QTableView* tableView, cons
     cursor->insertHtml(strStream);
 
 }
+
+
+int TablePrinter::printToReport(ReportWriter* report, QTableView* tableView, const ReportTableOptions& options)
+{
+    if(report == nullptr || tableView == nullptr || tableView->model() == nullptr)
+        return 0;
+
+    const int columnCount = tableView->model()->columnCount();
+
+    QVector<int> columns;
+    for (int column = 0; column < columnCount; column++)
+        if (!tableView->isColumnHidden(column))
+            columns.push_back(column);
+
+    return report->addTable(tableView->model(), columns, options);
+}
@@ -38,6 +38,8 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 // Written by: Stevan Gavrilovic
 
+#include "ReportWriter.h"
+
 #include <QTextDocument>
 
 class QTableView;
@@ -49,6 +51,10 @@ public:
 
     void printToTable(QTextCursor* cursor, QTableView* tableView, const QString& strTitle);
 
+    // Prints the visible columns of the table to the report in chunks of rows that fit on a page, without building the table in a document first
+    // Returns the number of rows that were printed
+    int printToReport(ReportWriter* report, QTableView* tableView, const ReportTableOptions& options = ReportTableOptions());
+
 };
 
 #endif // TABLEPRINTER_H
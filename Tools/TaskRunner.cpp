@@ -0,0 +1,177 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+#include "TaskRunner.h"
+
+#include <algorithm>
+
+TaskRunner *TaskRunner::theInstance = nullptr;
+
+
+TaskContext::TaskContext() : canceled(false), done(0), total(0)
+{
+
+}
+
+
+bool TaskContext::isCanceled(void) const
+{
+    return canceled.load();
+}
+
+
+void TaskContext::cancel(void)
+{
+    canceled = true;
+}
+
+
+void TaskContext::setTotal(const qint64 value)
+{
+    total = value;
+}
+
+
+void TaskContext::setProgress(const qint64 value)
+{
+    done = value;
+}
+
+
+void TaskContext::addProgress(const qint64 value)
+{
+    done += value;
+}
+
+
+void TaskContext::setStatus(const QString& value)
+{
+    QMutexLocker locker(&statusMutex);
+    status = value;
+}
+
+
+TaskProgress TaskContext::getProgress(void) const
+{
+    TaskProgress progress;
+    progress.done = done.load();
+    progress.total = total.load();
+
+    QMutexLocker locker(&statusMutex);
+    progress.status = status;
+
+    return progress;
+}
+
+
+TaskRunner::TaskRunner()
+{
+    theInstance = this;
+
+    // The long tasks get their own pool so that they do not starve the parallel loops that run in the global pool
+    threadPool.setMaxThreadCount(std::max(2,QThread::idealThreadCount()/2));
+}
+
+
+TaskRunner* TaskRunner::getInstance()
+{
+    if (theInstance == nullptr)
+        theInstance = new TaskRunner();
+
+    return theInstance;
+}
+
+
+void TaskRunner::registerTask(const std::shared_ptr<TaskContext>& context)
+{
+    QMutexLocker locker(&tasksMutex);
+
+    // Forget the tasks that are done
+    runningTasks.erase(std::remove_if(runningTasks.begin(), runningTasks.end(), [](const std::weak_ptr<TaskContext>& it){ return it.expired(); }), runningTasks.end());
+
+    runningTasks.push_back(context);
+}
+
+
+void TaskRunner::cancelAll(void)
+{
+    QMutexLocker locker(&tasksMutex);
+
+    for(auto&& it : runningTasks)
+    {
+        auto context = it.lock();
+        if(context)
+            context->cancel();
+    }
+}
+
+
+int TaskRunner::getUpdateInterval(void) const
+{
+    return updateInterval;
+}
+
+
+QThreadPool* TaskRunner::getThreadPool(void)
+{
+    return &threadPool;
+}
+
+
+void TaskRunner::parallelFor(TaskContext& context, const int n, const std::function<void(int)>& fn, const int chunkSize)
+{
+    if(n <= 0)
+        return;
+
+    QVector<int> chunkBegins;
+    for(int i = 0; i<n; i += chunkSize)
+        chunkBegins.push_back(i);
+
+    auto runChunk = [&](const int begin)
+    {
+        if(context.isCanceled())
+            return;
+
+        const auto end = std::min(begin+chunkSize, n);
+
+        for(int i = begin; i<end; ++i)
+            fn(i);
+
+        context.addProgress(end-begin);
+    };
+
+    QtConcurrent::blockingMap(chunkBegins, runChunk);
+}
@@ -0,0 +1,184 @@
+#ifndef TASKRUNNER_H
+#define TASKRUNNER_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Runs long operations in a thread pool instead of on the GUI thread
+// A task reports its progress and checks for cancellation through a TaskContext, the GUI thread reads the progress at a fixed rate so that the widgets are updated in batches and not once per item
+// The result of a task is handed back in the thread of the receiver, so the callbacks can safely create layers and update widgets
+
+#include <QFutureWatcher>
+#include <QMutex>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QThreadPool>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrent>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+struct TaskProgress
+{
+    qint64 done = 0;
+    qint64 total = 0;
+    QString status;
+};
+
+
+class TaskContext
+{
+public:
+    TaskContext();
+
+    bool isCanceled(void) const;
+    void cancel(void);
+
+    void setTotal(const qint64 value);
+    void setProgress(const qint64 value);
+    void addProgress(const qint64 value = 1);
+    void setStatus(const QString& value);
+
+    TaskProgress getProgress(void) const;
+
+private:
+    std::atomic<bool> canceled;
+    std::atomic<qint64> done;
+    std::atomic<qint64> total;
+
+    mutable QMutex statusMutex;
+    QString status;
+};
+
+
+class TaskRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    static TaskRunner *getInstance(void);
+
+    // Runs the work in the thread pool, onFinished is called with the result in the thread of the receiver when the work is done and onProgress is called there at the update rate while it runs
+    // If the receiver is destroyed before the work is done the task is canceled and the callbacks are not called
+    template <typename T>
+    std::shared_ptr<TaskContext> run(QObject* receiver,
+                                     std::function<T(TaskContext&)> work,
+                                     std::function<void(const T&)> onFinished,
+                                     std::function<void(const TaskProgress&)> onProgress = nullptr)
+    {
+        auto context = std::make_shared<TaskContext>();
+
+        auto watcher = new QFutureWatcher<T>(receiver);
+        auto timer = new QTimer(watcher);
+        timer->setInterval(updateInterval);
+
+        if(onProgress)
+            connect(timer, &QTimer::timeout, watcher, [context, onProgress](){ onProgress(context->getProgress()); });
+
+        connect(watcher, &QFutureWatcherBase::finished, receiver, [watcher, context, onFinished, onProgress]()
+        {
+            if(onProgress)
+                onProgress(context->getProgress());
+
+            if(!context->isCanceled())
+                onFinished(watcher->result());
+
+            watcher->deleteLater();
+        });
+
+        connect(receiver, &QObject::destroyed, watcher, [context](){ context->cancel(); });
+
+        this->registerTask(context);
+
+        watcher->setFuture(QtConcurrent::run(&threadPool, [work, context](){ return work(*context); }));
+        timer->start();
+
+        return context;
+    }
+
+    // Runs the work in the thread pool and blocks until the result is ready, for the synchronous paths that have to return the result, e.g., when a file is deserialized or the input files are staged
+    // No events are processed while waiting so that the caller cannot be entered again, onProgress is only called once the work is done
+    // Use run() with a continuation when the caller does not need the result before it returns
+    template <typename T>
+    T runAndWait(std::function<T(TaskContext&)> work,
+                 std::function<void(const TaskProgress&)> onProgress = nullptr,
+                 std::shared_ptr<TaskContext> context = nullptr)
+    {
+        if(context == nullptr)
+            context = std::make_shared<TaskContext>();
+
+        this->registerTask(context);
+
+        auto future = QtConcurrent::run(&threadPool, [work, context](){ return work(*context); });
+
+        future.waitForFinished();
+
+        if(onProgress)
+            onProgress(context->getProgress());
+
+        return future.result();
+    }
+
+    // Calls fn(i) for i from 0 to n-1 in parallel chunks, the chunks that have not started are skipped once the context is canceled
+    // Every item adds one to the progress of the context
+    static void parallelFor(TaskContext& context, const int n, const std::function<void(int)>& fn, const int chunkSize = 64);
+
+    // Cancels all of the tasks that are still running
+    void cancelAll(void);
+
+    // Interval in milliseconds at which the progress is sent to the GUI
+    int getUpdateInterval(void) const;
+
+    QThreadPool* getThreadPool(void);
+
+private:
+    TaskRunner();
+
+    void registerTask(const std::shared_ptr<TaskContext>& context);
+
+    static TaskRunner *theInstance;
+
+    QThreadPool threadPool;
+
+    int updateInterval = 100;
+
+    QMutex tasksMutex;
+    QVector<std::weak_ptr<TaskContext>> runningTasks;
+};
+
+#endif // TASKRUNNER_H
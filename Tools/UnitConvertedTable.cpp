@@ -0,0 +1,428 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+#include "UnitConvertedTable.h"
+#include "CSVReaderWriter.h"
+#include "SimCenterUnitsCombo.h"
+#include "TaskRunner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Converts n values between a unit and SI units, the loops run over contiguous memory with one factor so that the compiler can vectorize them
+// The input and output may be the same buffer
+void convertValues(const double* in, double* out, const int n, const double scale, const bool logarithmic, const bool toSI)
+{
+    if(logarithmic)
+    {
+        if(toSI)
+        {
+            for(int i = 0; i<n; ++i)
+                out[i] = scale*std::exp(in[i]);
+        }
+        else
+        {
+            for(int i = 0; i<n; ++i)
+                out[i] = std::log(in[i]/scale);
+        }
+    }
+    else
+    {
+        if(toSI)
+        {
+            for(int i = 0; i<n; ++i)
+                out[i] = in[i]*scale;
+        }
+        else
+        {
+            for(int i = 0; i<n; ++i)
+                out[i] = in[i]/scale;
+        }
+    }
+}
+
+}
+
+
+UnitConvertedTable::UnitConvertedTable()
+{
+    numRows = 0;
+}
+
+
+bool UnitConvertedTable::load(const QStringList& headings, const QVector<QStringList>& rows, QString& err, TaskContext* context)
+{
+    return this->load(headings, QVector<QVector<QStringList>>{rows}, err, context);
+}
+
+
+bool UnitConvertedTable::load(const QStringList& headings, const QVector<QVector<QStringList>>& groups, QString& err, TaskContext* context)
+{
+    this->clear();
+
+    const int numColumns = headings.size();
+
+    if(numColumns == 0)
+    {
+        err = "Error, the table does not have any headings";
+        return false;
+    }
+
+    // Use a context of our own if the caller does not need the progress
+    TaskContext localContext;
+    if(context == nullptr)
+        context = &localContext;
+
+    // Number the rows of the groups one after the other
+    QVector<int> begins;
+    begins.reserve(groups.size()+1);
+
+    QVector<const QStringList*> rowPointers;
+
+    int rowCount = 0;
+    for(auto&& group : groups)
+    {
+        begins.push_back(rowCount);
+
+        for(auto&& row : group)
+        {
+            if(row.size() != numColumns)
+            {
+                err = "Error, the row "+QString::number(rowPointers.size()+1)+" does not have a value for every heading";
+                return false;
+            }
+
+            rowPointers.push_back(&row);
+        }
+
+        rowCount += group.size();
+    }
+    begins.push_back(rowCount);
+
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+
+    QVector<double> parsedValues(rowCount*numColumns, nan);
+    QVector<char> isText(rowCount*numColumns, 0);
+
+    // Get the raw pointers before going parallel so that the vectors are not detached in the worker threads
+    const QStringList* const* rowData = rowPointers.constData();
+    double* valueData = parsedValues.data();
+    char* isTextData = isText.data();
+
+    context->setTotal(rowCount);
+    context->setProgress(0);
+    context->setStatus("Converting the values to numbers");
+
+    // Each row writes to its own place in every column so that the threads never touch the same values
+    TaskRunner::parallelFor(*context, rowCount, [&](int i)
+    {
+        const auto& row = *rowData[i];
+
+        for(int j = 0; j<numColumns; ++j)
+        {
+            const auto& str = row.at(j);
+
+            if(str.isEmpty())
+                continue;
+
+            bool OK = false;
+            auto val = str.toDouble(&OK);
+
+            if(OK)
+                valueData[j*rowCount+i] = val;
+            else
+                isTextData[j*rowCount+i] = 1;
+        }
+    }, 1024);
+
+    if(context->isCanceled())
+    {
+        err = "Converting the values to numbers was canceled";
+        return false;
+    }
+
+    // A column is text if any of its values is not a number, its strings are kept for the export
+    QVector<char> columnIsNumber(numColumns, 1);
+    QVector<QStringList> columnText(numColumns);
+
+    for(int j = 0; j<numColumns; ++j)
+    {
+        const char* columnIsText = isText.constData() + j*rowCount;
+
+        if(std::none_of(columnIsText, columnIsText+rowCount, [](const char val){ return val != 0; }))
+            continue;
+
+        columnIsNumber[j] = 0;
+
+        std::fill(valueData + j*rowCount, valueData + (j+1)*rowCount, nan);
+
+        QStringList text;
+        text.reserve(rowCount);
+        for(int i = 0; i<rowCount; ++i)
+            text.append(rowData[i]->at(j));
+
+        columnText[j] = text;
+    }
+
+    this->headings = headings;
+    numRows = rowCount;
+    groupBegins = begins;
+    values = parsedValues;
+    numberColumns = columnIsNumber;
+    textColumns = columnText;
+
+    // The values stay as they were read until the units are declared
+    for(int j = 0; j<numColumns; ++j)
+        units.append(QString());
+
+    scales = QVector<double>(numColumns, 1.0);
+    logarithmic = QVector<char>(numColumns, 0);
+
+    return true;
+}
+
+
+bool UnitConvertedTable::loadFile(const QString& pathToFile, QString& err, TaskContext* context)
+{
+    CSVReaderWriter csvTool;
+
+    QVector<QStringList> data = csvTool.parseCSVFile(pathToFile, err);
+
+    if(!err.isEmpty())
+        return false;
+
+    if(data.isEmpty())
+    {
+        err = "The file " + pathToFile + " is empty";
+        return false;
+    }
+
+    auto fileHeadings = data.first();
+
+    // Pop off the row that contains the header information
+    data.pop_front();
+
+    return this->load(fileHeadings, data, err, context);
+}
+
+
+bool UnitConvertedTable::setUnits(const QMap<QString, QString>& unitsMap, QString& err)
+{
+    for(auto it = unitsMap.cbegin(); it != unitsMap.cend(); ++it)
+    {
+        auto column = headings.indexOf(it.key());
+
+        if(column == -1)
+            continue;
+
+        const auto& unit = it.value();
+
+        if(units.at(column) == unit)
+            continue;
+
+        auto unitType = SimCenter::Unit::fromString(unit);
+
+        if(unitType == SimCenter::Unit::UNDEFINED)
+        {
+            err = "Error, the unit "+unit+" of the column "+it.key()+" is not known";
+            return false;
+        }
+
+        // Go back to the values as they were read before the new unit is applied
+        if(!units.at(column).isEmpty())
+            this->convertColumn(column, false);
+
+        units[column] = unit;
+        scales[column] = SimCenter::Unit::getScaleToSI(unitType);
+        logarithmic[column] = SimCenter::Unit::isLogarithmic(unitType) ? 1 : 0;
+
+        this->convertColumn(column, true);
+    }
+
+    return true;
+}
+
+
+void UnitConvertedTable::convertColumn(const int column, const bool toSI)
+{
+    if(!numberColumns.at(column))
+        return;
+
+    double* columnData = values.data() + column*numRows;
+
+    convertValues(columnData, columnData, numRows, scales.at(column), logarithmic.at(column), toSI);
+}
+
+
+void UnitConvertedTable::clear(void)
+{
+    numRows = 0;
+    headings.clear();
+    groupBegins.clear();
+    values.clear();
+    numberColumns.clear();
+    textColumns.clear();
+    units.clear();
+    scales.clear();
+    logarithmic.clear();
+}
+
+
+int UnitConvertedTable::getNumRows(void) const
+{
+    return numRows;
+}
+
+
+int UnitConvertedTable::getNumColumns(void) const
+{
+    return headings.size();
+}
+
+
+int UnitConvertedTable::getNumGroups(void) const
+{
+    return std::max(0, groupBegins.size()-1);
+}
+
+
+int UnitConvertedTable::getGroupBegin(const int group) const
+{
+    return groupBegins.at(group);
+}
+
+
+const QStringList& UnitConvertedTable::getHeadings(void) const
+{
+    return headings;
+}
+
+
+int UnitConvertedTable::getColumnIndex(const QString& heading) const
+{
+    return headings.indexOf(heading);
+}
+
+
+bool UnitConvertedTable::isNumberColumn(const int column) const
+{
+    return numberColumns.at(column);
+}
+
+
+const double* UnitConvertedTable::getColumn(const int column) const
+{
+    return values.constData() + column*numRows;
+}
+
+
+double UnitConvertedTable::getValue(const int row, const int column) const
+{
+    return values.at(column*numRows+row);
+}
+
+
+const QVector<double>& UnitConvertedTable::getValues(void) const
+{
+    return values;
+}
+
+
+QString UnitConvertedTable::getUnit(const int column) const
+{
+    return units.at(column);
+}
+
+
+double UnitConvertedTable::getScaleToSI(const int column) const
+{
+    return scales.at(column);
+}
+
+
+QVector<QStringList> UnitConvertedTable::toStrings(void) const
+{
+    const int numColumns = headings.size();
+
+    // Convert the columns back to their declared units first so that the rows only have to format the numbers
+    QVector<double> declaredValues(values.size());
+    for(int j = 0; j<numColumns; ++j)
+        convertValues(values.constData() + j*numRows, declaredValues.data() + j*numRows, numRows, scales.at(j), logarithmic.at(j), false);
+
+    QVector<QStringList> data;
+    data.reserve(numRows+1);
+    data.push_back(headings);
+
+    for(int i = 0; i<numRows; ++i)
+    {
+        QStringList row;
+        row.reserve(numColumns);
+
+        for(int j = 0; j<numColumns; ++j)
+        {
+            if(!numberColumns.at(j))
+            {
+                row.append(textColumns.at(j).at(i));
+                continue;
+            }
+
+            auto val = declaredValues.at(j*numRows+i);
+
+            // Fifteen significant digits hide the round off from the conversion to SI units and back
+            row.append(std::isnan(val) ? QString() : QString::number(val, 'g', 15));
+        }
+
+        data.push_back(row);
+    }
+
+    return data;
+}
+
+
+bool UnitConvertedTable::writeFile(const QString& pathToFile, QString& err) const
+{
+    CSVReaderWriter csvTool;
+
+    auto res = csvTool.saveCSVFile(this->toStrings(), pathToFile, err);
+
+    if(res != 0)
+        return false;
+
+    return true;
+}
@@ -0,0 +1,125 @@
+#ifndef UNITCONVERTEDTABLE_H
+#define UNITCONVERTEDTABLE_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// A table of numbers that is parsed once from the strings of a CSV file and kept as doubles in SI units
+// The values are stored column by column in one contiguous buffer so that a column can be handed to numerical code as a pointer
+// The declared unit of each column is kept so that the table can be written back in the units that it was read in
+
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class TaskContext;
+
+class UnitConvertedTable
+{
+public:
+    UnitConvertedTable();
+
+    // Converts the rows to numbers, the values are kept as they are read until the units are set
+    // A column with a value that is not a number, e.g., the file names in a station file, is kept as text and its values are NaN
+    // An empty cell is NaN
+    bool load(const QStringList& headings, const QVector<QStringList>& rows, QString& err, TaskContext* context = nullptr);
+
+    // Same as above for rows that come in groups, e.g., the rows of each station file, the rows of the groups are stored one after the other
+    bool load(const QStringList& headings, const QVector<QVector<QStringList>>& groups, QString& err, TaskContext* context = nullptr);
+
+    // Reads a CSV file where the first row is the header
+    bool loadFile(const QString& pathToFile, QString& err, TaskContext* context = nullptr);
+
+    // Declares the units of the columns by heading with the unit strings of SimCenterUnitsCombo, e.g., "g", and converts the values to SI units
+    // A column that was declared before is converted back from its previous unit first, the values are only touched when the unit of a column changes
+    // The columns that are not in the map keep their current unit, and the headings in the map that are not in the table are skipped
+    bool setUnits(const QMap<QString, QString>& unitsMap, QString& err);
+
+    void clear(void);
+
+    int getNumRows(void) const;
+    int getNumColumns(void) const;
+    int getNumGroups(void) const;
+
+    // The rows of the group i are from getGroupBegin(i) up to but not including getGroupBegin(i+1)
+    int getGroupBegin(const int group) const;
+
+    const QStringList& getHeadings(void) const;
+
+    // Returns -1 if there is no column with the heading
+    int getColumnIndex(const QString& heading) const;
+
+    bool isNumberColumn(const int column) const;
+
+    // The getNumRows values of a column in SI units
+    const double* getColumn(const int column) const;
+
+    double getValue(const int row, const int column) const;
+
+    // All of the values column by column
+    const QVector<double>& getValues(void) const;
+
+    // The unit string that a column was declared in, empty if the unit was not declared
+    QString getUnit(const int column) const;
+
+    // The factor that converted the values of a column to SI units, for ln(g) the factor applies to the exponential of the values
+    double getScaleToSI(const int column) const;
+
+    // Converts the values back to their declared units and returns the header followed by the rows
+    QVector<QStringList> toStrings(void) const;
+
+    bool writeFile(const QString& pathToFile, QString& err) const;
+
+private:
+
+    // Converts the values of a column from its declared unit to SI units in place, or back if toSI is false
+    void convertColumn(const int column, const bool toSI);
+
+    int numRows;
+
+    QStringList headings;
+    QVector<int> groupBegins;
+
+    QVector<double> values;
+    QVector<char> numberColumns;
+    QVector<QStringList> textColumns;
+
+    QStringList units;
+    QVector<double> scales;
+    QVector<char> logarithmic;
+};
+
+#endif // UNITCONVERTEDTABLE_H
@@ -37,14 +37,50 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 // Written by: Stevan Gavrilovic
 
 #include "XMLAdaptor.h"
-
+#include "GmCommon.h"
 #include "QGISVisualizationWidget.h"
+#include "TaskRunner.h"
+
 #include <qgsvectorlayer.h>
 
-#include <QtXml>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
 #include <QFile>
+#include <QFileInfo>
+#include <QXmlStreamReader>
+
+#include <algorithm>
+#include <atomic>
+
+// Increment when the layout of the cache file changes
+const quint32 gridCacheMagicNumber = 0x534D4752;
+const qint32 gridCacheVersion = 1;
+
+QDataStream& operator<<(QDataStream& stream, const ShakeMapGrid& grid)
+{
+    stream << grid.eventName << grid.shakemapID << grid.fieldNames << static_cast<qint32>(grid.indexLat) << static_cast<qint32>(grid.indexLon) << grid.values;
+
+    return stream;
+}
+
 
-XMLAdaptor::XMLAdaptor()
+QDataStream& operator>>(QDataStream& stream, ShakeMapGrid& grid)
+{
+    qint32 indexLat = -1;
+    qint32 indexLon = -1;
+
+    stream >> grid.eventName >> grid.shakemapID >> grid.fieldNames >> indexLat >> indexLon >> grid.values;
+
+    grid.indexLat = indexLat;
+    grid.indexLon = indexLon;
+
+    return stream;
+}
+
+
+XMLAdaptor::XMLAdaptor() : layerBuilder("SHAKEMAP_GRID", "ShakeMap Grid Point")
 {
 
 }
@@ -52,220 +88,312 @@ XMLAdaptor::XMLAdaptor()
 
 QgsVectorLayer* XMLAdaptor::parseXMLFile(const QString& filePath, QString& errMessage, QGISVisualizationWidget* GISVisWidget)
 {
-    // QDomDocument used to import XML data
-    QDomDocument xmlGMs;
+    if(!this->parseXMLGrid(filePath, errMessage))
+        return nullptr;
 
-    // Load xml file
+    return this->createGridLayer(errMessage, GISVisWidget);
+}
+
+
+bool XMLAdaptor::parseXMLGrid(const QString& filePath, QString& errMessage, TaskContext* context)
+{
+    grid = ShakeMapGrid();
+    featureList.clear();
+
+    if(context)
+        context->setStatus("Reading the ShakeMap grid");
+
+    // Hash the contents of the file to find the cached grid
     QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly ))
+    if (!file.open(QIODevice::ReadOnly))
     {
         // Error while loading file
         errMessage = "Error while loading file";
-        return nullptr;
+        return false;
     }
 
-    // Set raw XML content into the QDomDocument
-    xmlGMs.setContent(&file);
-
-    // Close the file now that we are done with it
+    QCryptographicHash fileHash(QCryptographicHash::Sha1);
+    fileHash.addData(&file);
     file.close();
 
-    // Extract the root element
-    QDomElement root=xmlGMs.documentElement();
+    auto pathToCache = getPathToCache(fileHash.result());
+
+    if(!this->readCache(pathToCache))
+    {
+        if(!this->readXMLGrid(filePath, errMessage, context))
+            return false;
 
-    // Get root names and attributes
-    QString Type = root.tagName();
+        this->writeCache(pathToCache);
+    }
 
-    // Check that the XML file is actually a shake map grid
-    if(Type.compare("shakemap_grid") != 0)
+    if(context && context->isCanceled())
     {
-        errMessage = "Error, XML file is not a ShakeMap grid";
-        return nullptr;
+        errMessage = "Loading the ShakeMap grid was canceled";
+        return false;
     }
 
-    // Get some information from the file
-    shakemapID = root.attribute("shakemap_id","NULL");
+    return this->createFeatures(errMessage);
+}
 
-    //    QString shakemapVersion = root.attribute("shakemap_version","NULL");
 
-    //    if(shakemapVersion.compare("10") != 0)
-    //    {
-    //        errMessage = "Error: only shakemap version 10 is supported";
-    //        return nullptr;
-    //    }
+bool XMLAdaptor::readXMLGrid(const QString& filePath, QString& errMessage, TaskContext* context)
+{
+    // Load xml file
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        // Error while loading file
+        errMessage = "Error while loading file";
+        return false;
+    }
 
-    QDomNodeList eventList = root.elementsByTagName("event");
+    QXmlStreamReader xml(&file);
 
-    QDomNodeList GMFieldsList = root.elementsByTagName("grid_field");
+    // Check that the XML file is actually a shake map grid
+    if(!xml.readNextStartElement() || xml.name() != QLatin1String("shakemap_grid"))
+    {
+        errMessage = "Error, XML file is not a ShakeMap grid";
+        return false;
+    }
 
-    auto numFields = GMFieldsList.size();
+    // Get some information from the file
+    grid.shakemapID = xml.attributes().value("shakemap_id").toString();
 
-    if(numFields == 0 || eventList.size() == 0)
-        return nullptr;
+    bool eventFound = false;
+    QString gridData;
 
-    // Get the event name
-    eventName = eventList.item(0).toElement().attribute("event_description","NULL");
+    while(xml.readNextStartElement())
+    {
+        auto tagName = xml.name();
 
-    int indexLon = -1;
-    int indexLat = -1;
+        if(tagName == QLatin1String("event"))
+        {
+            // Get the event name
+            auto eventDescription = xml.attributes().value("event_description");
+            grid.eventName = eventDescription.isNull() ? QString("NULL") : eventDescription.toString();
 
-    // Get all of the grid fields from the XML file
-    QgsFields featFields;
+            eventFound = true;
+            xml.skipCurrentElement();
+        }
+        else if(tagName == QLatin1String("grid_field"))
+        {
+            auto fieldName = xml.attributes().value("name");
+            grid.fieldNames.append(fieldName.isNull() ? QString("NULL") : fieldName.toString());
 
-    QList<QgsField> attribFields;
-    attribFields.push_back(QgsField("AssetType", QVariant::String));
-    attribFields.push_back(QgsField("TabName", QVariant::String));
+            xml.skipCurrentElement();
+        }
+        else if(tagName == QLatin1String("grid_data"))
+        {
+            if(!gridData.isNull())
+            {
+                errMessage = "Error, no grid data in XML file";
+                return false;
+            }
 
-    featFields.append(QgsField("AssetType", QVariant::String));
-    featFields.append(QgsField("TabName", QVariant::String));
+            gridData = xml.readElementText();
+        }
+        else
+        {
+            xml.skipCurrentElement();
+        }
+    }
 
-    for(int i = 0; i < GMFieldsList.count(); ++i)
+    if(xml.hasError())
     {
-        auto item = GMFieldsList.item(i).toElement();
+        errMessage = "Error reading the ShakeMap grid: "+xml.errorString();
+        return false;
+    }
 
-        QString fieldName = item.attribute("name","NULL");
-        attribFields.push_back(QgsField(fieldName, QVariant::String));
+    file.close();
 
-        featFields.append(QgsField(fieldName, QVariant::String));
+    auto numFields = grid.fieldNames.size();
 
-        if(fieldName.compare("LAT") == 0)
-            indexLat = i;
-        if(fieldName.compare("LON") == 0)
-            indexLon = i;
-    }
+    if(numFields == 0 || !eventFound)
+        return false;
 
-    // Get the grid data from the XML file
-    QDomNodeList gridDataElements = root.elementsByTagName("grid_data");
+    grid.indexLat = grid.fieldNames.indexOf("LAT");
+    grid.indexLon = grid.fieldNames.indexOf("LON");
 
-    if(gridDataElements.size() != 1)
+    if(gridData.isNull())
     {
         errMessage = "Error, no grid data in XML file";
-        return nullptr;
+        return false;
     }
 
-    auto gridData =  gridDataElements.at(0).toElement().text();
-
     // Each grid point is separated by a newline
-    auto gridPoints = gridData.split("\n",Qt::SkipEmptyParts);
+    auto gridPoints = gridData.splitRef("\n",Qt::SkipEmptyParts);
 
     if(gridPoints.size() == 0)
-        return nullptr;
+        return false;
 
-    if(indexLat == -1 || indexLon == -1)
+    if(grid.indexLat == -1 || grid.indexLon == -1)
     {
         errMessage = "Error getting the lat and/or lon indexes in the grid xml file";
-        return nullptr;
-    }   
-
-//    // Over 50000 points causes arc gis library to crash... even though, too many points makes the visualization too cluttered
-//    int decim = gridPoints.size()/40000;
-
-//    if(decim == 0)
-//        decim = 1;
+        return false;
+    }
 
-    // Iterate through the grid points to get the data at each point
-    QgsFeatureList featureList;
+    auto numPoints = gridPoints.size();
 
-    auto count = 0;
-    for(auto&& gp : gridPoints)
+    if(context)
     {
-        ++count;
+        context->setTotal(numPoints);
+        context->setStatus("Loading Grid Layer");
+    }
 
-//        if(count%decim != 0)
-//            continue;
+    grid.values.resize(numPoints*numFields);
 
-        // Change for windows compilation
-        gp.remove("\r");
+    // Get the raw pointers before going parallel so that the vectors are not detached in the worker threads
+    const QStringRef* lines = gridPoints.constData();
+    double* values = grid.values.data();
 
-        if(gp.isEmpty())
-            continue;
+    // The number of values in every line, the lines that only contain white space have zero values
+    QVector<int> numValues(numPoints,0);
+    int* numValuesData = numValues.data();
 
-        QStringList pointData;
+    std::atomic<bool> conversionError(false);
 
-        if(gp.contains("\t"))
-            pointData = gp.split("\t");
-        else
-            pointData = gp.split(" ");
+    auto parseLine = [&](int i)
+    {
+        const auto& line = lines[i];
+        const auto lineSize = line.size();
+
+        double* rowValues = values + i*numFields;
 
-        if(pointData.size() != numFields)
+        int count = 0;
+        int tokenBegin = -1;
+        for(int j = 0; j<=lineSize; ++j)
         {
-            errMessage = "Error the number of columns in a point does not equal the number of fields";
-            return nullptr;
-        }
+            // Tokens are separated by spaces or tabs, the windows line endings are ignored
+            auto isSeparator = j == lineSize || line.at(j) == ' ' || line.at(j) == '\t' || line.at(j) == '\r';
 
-        // create the feature attributes
-        QgsAttributes featAttributes(attribFields.size());
+            if(!isSeparator)
+            {
+                if(tokenBegin == -1)
+                    tokenBegin = j;
 
-        featAttributes[0]= "SHAKEMAP_GRID"; // Asset type
-        featAttributes[1]= "ShakeMap Grid Point"; // Tab Name
+                continue;
+            }
 
-        for(int i = 0; i<numFields; ++i)
-        {
-            auto attrbVal = pointData[i];
-            featAttributes[2+i] = attrbVal;
-        }
+            if(tokenBegin == -1)
+                continue;
 
-        bool OK = true;
+            if(count < numFields)
+            {
+                bool OK = false;
+                rowValues[count] = line.mid(tokenBegin, j-tokenBegin).toDouble(&OK);
 
-        auto longitude = pointData[indexLon].toDouble(&OK);
+                if(!OK)
+                    conversionError = true;
+            }
 
-        if(!OK)
-        {
-            errMessage = "Error converting longitude to double";
-            return nullptr;
+            ++count;
+            tokenBegin = -1;
         }
 
-        auto latitude = pointData[indexLat].toDouble(&OK);
+        numValuesData[i] = count;
+    };
+
+    if(context)
+    {
+        TaskRunner::parallelFor(*context, numPoints, parseLine, 2048);
 
-        if(!OK)
+        if(context->isCanceled())
         {
-            errMessage = "Error converting latitude to double";
-            return nullptr;
+            errMessage = "Loading the ShakeMap grid was canceled";
+            return false;
         }
+    }
+    else
+    {
+        for(int i = 0; i<numPoints; ++i)
+            parseLine(i);
+    }
 
-        if(longitude == 0.0 || latitude == 0.0)
+    // Remove the empty lines and check the number of columns in the others
+    int numRows = 0;
+    for(int i = 0; i<numPoints; ++i)
+    {
+        if(numValues[i] == 0)
+            continue;
+
+        if(numValues[i] != numFields)
         {
-            errMessage = "Error, zero lat lon values";
-            return nullptr;
+            errMessage = "Error the number of columns in a point does not equal the number of fields";
+            return false;
         }
 
-        // Create the feature
-        QgsFeature feature;
-        feature.setFields(featFields);
-        feature.setGeometry(QgsGeometry::fromPointXY(QgsPointXY(longitude,latitude)));
-        feature.setAttributes(featAttributes);
-        featureList.append(feature);
-
-        // Create the ground motion station
-        GroundMotionStation station("NULL",latitude,longitude);
-        station.setStationFeature(feature);
-        stationList.push_back(station);
+        if(numRows != i)
+            std::copy(values + i*numFields, values + (i+1)*numFields, values + numRows*numFields);
+
+        ++numRows;
     }
 
+    grid.values.resize(numRows*numFields);
 
-    auto vectorLayer = GISVisWidget->addVectorLayer("Point", "ShakeMap Grid");
-    if(vectorLayer == nullptr)
+    if(conversionError)
     {
-        errMessage = "Error creating a layer";
-        return nullptr;
+        errMessage = "Error, the ShakeMap grid contains a value that is not a number";
+        return false;
     }
 
-    auto dProvider = vectorLayer->dataProvider();
-    auto res = dProvider->addAttributes(attribFields);
+    return true;
+}
+
+
+bool XMLAdaptor::createFeatures(QString& errMessage)
+{
+    auto numFields = grid.fieldNames.size();
+    auto numPoints = grid.getNumPoints();
 
-    if(!res)
+    if(numPoints == 0)
     {
-        errMessage = "Error adding attribute fields to layer";
-        GISVisWidget->removeLayer(vectorLayer);
-        return nullptr;
+        errMessage = "Error, the ShakeMap grid does not have any points";
+        return false;
+    }
+
+    // The values of the grid are number columns of the layer
+    QVector<QVector<double>> columnValues(numFields, QVector<double>(numPoints));
+
+    for(int i = 0; i<numPoints; ++i)
+    {
+        for(int j = 0; j<numFields; ++j)
+            columnValues[j][i] = grid.getValue(i,j);
+    }
+
+    const auto& latitudes = columnValues.at(grid.indexLat);
+    const auto& longitudes = columnValues.at(grid.indexLon);
+
+    for(int i = 0; i<numPoints; ++i)
+    {
+        if(longitudes.at(i) == 0.0 || latitudes.at(i) == 0.0)
+        {
+            errMessage = "Error, zero lat lon values";
+            return false;
+        }
     }
 
-    vectorLayer->updateFields(); // tell the vector layer to fetch changes from the provider
+    layerBuilder = StationLayerBuilder("SHAKEMAP_GRID", "ShakeMap Grid Point");
+    layerBuilder.setLocations(latitudes, longitudes);
 
-    dProvider->addFeatures(featureList);
-    vectorLayer->updateExtents();
+    for(int j = 0; j<numFields; ++j)
+        layerBuilder.addNumberColumn(grid.fieldNames.at(j), columnValues.at(j));
 
-    GISVisWidget->createSymbolRenderer(Qgis::MarkerShape::Cross,Qt::black,2.0,vectorLayer);
+    return layerBuilder.createFeatures(featureList, errMessage);
+}
+
+
+QgsVectorLayer* XMLAdaptor::createGridLayer(QString& errMessage, QGISVisualizationWidget* GISVisWidget)
+{
+    if(featureList.isEmpty())
+    {
+        errMessage = "Error, the ShakeMap grid does not have any points";
+        return nullptr;
+    }
+
+    auto vectorLayer = layerBuilder.createLayer(GISVisWidget, "ShakeMap Grid", featureList, errMessage);
+
+    // The layer keeps its own copies of the features
+    featureList.clear();
 
     return vectorLayer;
 }
@@ -273,11 +401,64 @@ QgsVectorLayer* XMLAdaptor::parseXMLFile(const QString& filePath, QString& errMe
 
 QString XMLAdaptor::getEventName() const
 {
-    return eventName;
+    return grid.eventName;
+}
+
+
+const ShakeMapGrid& XMLAdaptor::getGrid() const
+{
+    return grid;
+}
+
+
+bool XMLAdaptor::readCache(const QString& pathToCache)
+{
+    QFile file(pathToCache);
+    if(!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_12);
+
+    quint32 magicNumber = 0;
+    qint32 version = 0;
+
+    stream >> magicNumber >> version;
+
+    if(magicNumber != gridCacheMagicNumber || version != gridCacheVersion)
+        return false;
+
+    stream >> grid;
+
+    if(stream.status() != QDataStream::Ok || grid.getNumPoints() == 0 || grid.values.size() != grid.getNumPoints()*grid.fieldNames.size())
+    {
+        grid = ShakeMapGrid();
+        return false;
+    }
+
+    return true;
+}
+
+
+void XMLAdaptor::writeCache(const QString& pathToCache) const
+{
+    QDir().mkpath(QFileInfo(pathToCache).absolutePath());
+
+    QFile file(pathToCache);
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        qDebug()<<"Could not write the ShakeMap grid cache "<<pathToCache;
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_12);
+
+    stream << gridCacheMagicNumber << gridCacheVersion << grid;
 }
 
 
-QVector<GroundMotionStation> XMLAdaptor::getStationList() const
+QString XMLAdaptor::getPathToCache(const QByteArray& fileHash)
 {
-    return stationList;
+    return GmCommon::getCacheLocation() + QDir::separator() + "ShakeMapGrids" + QDir::separator() + QString(fileHash.toHex()) + ".bin";
 }
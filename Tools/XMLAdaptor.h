@@ -38,15 +38,51 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 // Written by: Stevan Gavrilovic
 
-// This class imports a XML ShakeMap grid into a ArcGIS feature collection layer
+// This class imports a XML ShakeMap grid into a QGIS vector layer
+// The grid values are stored as typed columns, and the parsed grid is cached in a binary file that is keyed by the hash of the grid file, so that loading the same event again skips the parsing
 
-#include "GroundMotionStation.h"
+#include "StationLayerBuilder.h"
+
+#include <qgsfeature.h>
 
 #include <QString>
+#include <QStringList>
+#include <QVector>
 
 class QObject;
+class QDataStream;
+class TaskContext;
 class QGISVisualizationWidget;
 class QgsVectorLayer;
+
+// The values at the grid points of a ShakeMap, one row per grid point and one column per grid field
+struct ShakeMapGrid
+{
+    QString eventName;
+    QString shakemapID;
+
+    QStringList fieldNames;
+
+    int indexLat = -1;
+    int indexLon = -1;
+
+    // Row major, numPoints x fieldNames.size()
+    QVector<double> values;
+
+    inline int getNumPoints(void) const
+    {
+        return fieldNames.isEmpty() ? 0 : values.size()/fieldNames.size();
+    }
+
+    inline double getValue(const int point, const int field) const
+    {
+        return values.at(point*fieldNames.size()+field);
+    }
+};
+
+QDataStream& operator<<(QDataStream& stream, const ShakeMapGrid& grid);
+QDataStream& operator>>(QDataStream& stream, ShakeMapGrid& grid);
+
 class XMLAdaptor
 {
 public:
@@ -54,16 +90,33 @@ public:
 
     QgsVectorLayer* parseXMLFile(const QString& filePath, QString& errMessage, QGISVisualizationWidget* GISVisWidget);
 
+    // Reads the grid points into typed columns and creates the features, this does not touch the GUI so it can run in a worker thread
+    // The grid is read from the cache if the same file was loaded before
+    bool parseXMLGrid(const QString& filePath, QString& errMessage, TaskContext* context = nullptr);
+
+    // Creates the grid layer from the features read by parseXMLGrid, this has to be called from the GUI thread
+    QgsVectorLayer* createGridLayer(QString& errMessage, QGISVisualizationWidget* GISVisWidget);
+
     QString getEventName() const;
 
-    QVector<GroundMotionStation> getStationList() const;
+    const ShakeMapGrid& getGrid() const;
+
+    // Returns the path to the cached grid of the file with the given content hash
+    static QString getPathToCache(const QByteArray& fileHash);
 
 private:
-    QString eventName;
 
-    QString shakemapID;
+    bool readXMLGrid(const QString& filePath, QString& errMessage, TaskContext* context);
+
+    bool readCache(const QString& pathToCache);
+    void writeCache(const QString& pathToCache) const;
+
+    bool createFeatures(QString& errMessage);
+
+    ShakeMapGrid grid;
 
-    QVector<GroundMotionStation> stationList;
+    StationLayerBuilder layerBuilder;
+    QgsFeatureList featureList;
 };
 
 #endif // XMLADAPTOR_H
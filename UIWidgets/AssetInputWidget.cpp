@@ -41,6 +41,8 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "AssetInputWidget.h"
 #include "VisualizationWidget.h"
 #include "CSVReaderWriter.h"
+#include "StagingQueue.h"
+#include "TaskRunner.h"
 #include "ComponentTableView.h"
 #include "ComponentTableModel.h"
 #include "ComponentDatabaseManager.h"
@@ -65,10 +67,20 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 #include "QGISVisualizationWidget.h"
 
+#include <qgsvectorlayer.h>
 
 // Std library headers
 #include <string>
 #include <algorithm>
+#include <memory>
+
+// The inventory read in the background, and the cache that it was read from or that it is written to
+struct AssetFileLoadResult
+{
+    QVector<QStringList> data;
+    AssetInventoryCache cache;
+    QString err;
+};
 
 AssetInputWidget::AssetInputWidget(QWidget *parent, VisualizationWidget* visWidget, QString assetType, QString appType) : SimCenterAppWidget(parent), appType(appType), assetType(assetType)
 {
@@ -109,7 +121,7 @@ AssetInputWidget::~AssetInputWidget()
 }
 
 
-bool AssetInputWidget::loadAssetData(bool message)
+bool AssetInputWidget::loadAssetData(bool message, bool wait)
 {
     // Ask for the file path if the file path has not yet been set, and return if it is still null
     if(pathToComponentInputFile.compare("NULL") == 0)
@@ -141,103 +153,170 @@ bool AssetInputWidget::loadAssetData(bool message)
     // Test to remove
     // auto start = high_resolution_clock::now();
 
-    CSVReaderWriter csvTool;
-    
-    QString err;
-    QVector<QStringList> data = csvTool.parseCSVFile(pathToComponentInputFile,err);
-    
-    if(!err.isEmpty())
-    {
-        this->errorMessage(err);
-        return false;
-    }
-    
-    if(data.empty())
-    {
-        this->errorMessage("Input file is empty");
-        return false;
-    }
-    
-    // Get the header file
-    QStringList tableHeadings = data.first();
-    
-    tableHorizontalHeadings = tableHeadings;
-    
-    tableHeadings.push_front("N/A");
-    
-    emit headingValuesChanged(tableHeadings);
-    
-    // Pop off the row that contains the header information
-    data.pop_front();
-    
-    auto numRows = data.size();
-    
-    if(numRows == 0)
+    this->statusMessage("Reading the asset file "+pathToComponentInputFile);
+
+    // Read the inventory from the cache if the file did not change since it was cached, otherwise parse the file
+    // Both are done in the thread pool so that large inventories are parsed in parallel
+    const auto pathToFile = pathToComponentInputFile;
+    auto readAssetFile = [pathToFile](TaskContext& context)
     {
-        this->errorMessage("Input file is empty");
-        return false;
-    }
-    else{
-        this->statusMessage("Loading visualization for " + QString::number(numRows)+ " assets");
-        QApplication::processEvents();
-    }
-    
-    auto firstRow = data.first();
-    
-    if(firstRow.empty())
+        AssetFileLoadResult result;
+
+        if(result.cache.readCache(pathToFile))
+        {
+            result.data = result.cache.getRows();
+            result.data.push_front(result.cache.getHeadings());
+            return result;
+        }
+
+        context.setStatus("Parsing the asset file");
+
+        CSVReaderWriter csvTool;
+        result.data = csvTool.parseCSVFile(pathToFile,result.err);
+
+        if(result.err.isEmpty() && result.data.size() > 1)
+            result.cache.setInventory(pathToFile, result.data.first(), result.data.mid(1));
+
+        return result;
+    };
+
+    // Fill the table and create the layers in the GUI thread when the file is read
+    auto createAssetLayers = [this](const AssetFileLoadResult& result)
     {
-        this->errorMessage("First row is empty");
-        return false;
-    }
-    
-    componentTableWidget->getTableModel()->populateData(data, tableHorizontalHeadings);
+        loadingTask.reset();
+
+        if(!result.err.isEmpty())
+        {
+            this->errorMessage(result.err);
+            return false;
+        }
+
+        auto data = result.data;
+
+        if(data.empty())
+        {
+            this->errorMessage("Input file is empty");
+            return false;
+        }
+
+        inventoryCache = result.cache;
+
+        // Get the header file
+        QStringList tableHeadings = data.first();
+
+        tableHorizontalHeadings = tableHeadings;
+
+        tableHeadings.push_front("N/A");
+
+        emit headingValuesChanged(tableHeadings);
+
+        // Pop off the row that contains the header information
+        data.pop_front();
+
+        auto numRows = data.size();
+
+        if(numRows == 0)
+        {
+            this->errorMessage("Input file is empty");
+            return false;
+        }
+        else{
+            this->statusMessage("Loading visualization for " + QString::number(numRows)+ " assets");
+        }
+
+        auto firstRow = data.first();
+
+        if(firstRow.empty())
+        {
+            this->errorMessage("First row is empty");
+            return false;
+        }
+
+        componentTableWidget->getTableModel()->populateData(data, tableHorizontalHeadings);
 
 #ifdef OpenSRA
-    label3->show();
+        label3->show();
 #endif
-    
-    componentTableWidget->show();
-    componentTableWidget->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Interactive);
 
-    // Clear the old layers if any
-    if(mainLayer != nullptr)
-        theVisualizationWidget->removeLayer(mainLayer);
+        componentTableWidget->show();
+        componentTableWidget->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Interactive);
 
-    if(selectedFeaturesLayer != nullptr)
-        theVisualizationWidget->removeLayer(selectedFeaturesLayer);
+        // Clear the old layers if any
+        if(mainLayer != nullptr)
+            theVisualizationWidget->removeLayer(mainLayer);
 
+        if(selectedFeaturesLayer != nullptr)
+            theVisualizationWidget->removeLayer(selectedFeaturesLayer);
 
-    auto res = this->loadAssetVisualization();
 
-    if(res != 0)
-        return false;
+        auto res = this->loadAssetVisualization();
 
-    // Get the ID of the first and last component
-    bool OK;
-    auto firstID = componentTableWidget->item(0,0).toInt(&OK);
+        if(res != 0)
+            return false;
 
-    if(!OK)
+        // Get the ID of the first and last component
+        bool OK;
+        auto firstID = componentTableWidget->item(0,0).toInt(&OK);
+
+        if(!OK)
+        {
+            QString msg = "Error in getting the component ID in " + QString(__FUNCTION__);
+            this->errorMessage(msg);
+            return false;
+        }
+
+
+        offset = 1-firstID;
+
+        theComponentDb->setOffset(offset);
+
+        // The offset only holds for contiguous IDs, map each ID to its feature if every row was added to the layer in order
+        const auto& idToFidMap = inventoryCache.getIdToFidMap();
+        if(mainLayer != nullptr && idToFidMap.size() == numRows && mainLayer->featureCount() == numRows)
+            theComponentDb->setIdToFidMap(idToFidMap);
+
+        // Write the cache after the layer is created so that the asset geometries are cached as well
+        // The copy of the cache shares its data with the member, so the write does not have to wait for the GUI
+        auto cache = std::make_shared<AssetInventoryCache>(inventoryCache);
+        TaskRunner::getInstance()->run<QString>(this, [cache](TaskContext&)
+        {
+            QString cacheErr;
+            cache->writeCache(cacheErr);
+            return cacheErr;
+        }, [this](const QString& cacheErr)
+        {
+            if(!cacheErr.isEmpty())
+                this->statusMessage(cacheErr);
+        });
+
+        // Test to remove
+        //    auto stop = high_resolution_clock::now();
+        //    auto duration = duration_cast<milliseconds>(stop - start);
+        //    this->statusMessage("Done ALL "+QString::number(duration.count()));
+
+        this->statusMessage("Done loading assets");
+
+        emit doneLoadingComponents();
+
+        return true;
+    };
+
+    // A load that is still running is replaced by this one
+    if(loadingTask)
     {
-        QString msg = "Error in getting the component ID in " + QString(__FUNCTION__);
-        this->errorMessage(msg);
-        return false;
+        loadingTask->cancel();
+        loadingTask.reset();
     }
 
+    if(wait)
+    {
+        auto result = TaskRunner::getInstance()->runAndWait<AssetFileLoadResult>(readAssetFile);
 
-    offset = 1-firstID;
+        return createAssetLayers(result);
+    }
 
-    theComponentDb->setOffset(offset);
-    
-    // Test to remove
-    //    auto stop = high_resolution_clock::now();
-    //    auto duration = duration_cast<milliseconds>(stop - start);
-    //    this->statusMessage("Done ALL "+QString::number(duration.count()));
-    
-    this->statusMessage("Done loading assets");
-    QApplication::processEvents();
+    loadingTask = TaskRunner::getInstance()->run<AssetFileLoadResult>(this, readAssetFile, createAssetLayers);
 
-    emit doneLoadingComponents();
-    
     return true;
 }
 
@@ -260,7 +339,8 @@ void AssetInputWidget::chooseComponentInfoFileDialog(void)
     // Set file name & entry in qLine edit
     componentFileLineEdit->setText(pathToComponentInputFile);
     
-    this->loadAssetData();
+    // Nothing waits for a file picked by the user, so it is read without blocking the GUI
+    this->loadAssetData(true, false);
     
     return;
 }
@@ -333,6 +413,8 @@ void AssetInputWidget::createComponentsBox(void)
     componentTableWidget = new ComponentTableView();
     
     connect(componentTableWidget->getTableModel(), &ComponentTableModel::handleCellChanged, this, &AssetInputWidget::handleCellChanged);
+    connect(componentTableWidget->getTableModel(), &ComponentTableModel::bulkEditStarted, this, &AssetInputWidget::handleBulkEditStarted);
+    connect(componentTableWidget->getTableModel(), &ComponentTableModel::bulkEditFinished, this, &AssetInputWidget::handleBulkEditFinished);
     
     pathLayout = new QHBoxLayout();
     pathLayout->addWidget(pathText);
@@ -422,6 +504,8 @@ void AssetInputWidget::createComponentsBox(void)
     componentTableWidget = new ComponentTableView();
     
     connect(componentTableWidget->getTableModel(), &ComponentTableModel::handleCellChanged, this, &AssetInputWidget::handleCellChanged);
+    connect(componentTableWidget->getTableModel(), &ComponentTableModel::bulkEditStarted, this, &AssetInputWidget::handleBulkEditStarted);
+    connect(componentTableWidget->getTableModel(), &ComponentTableModel::bulkEditFinished, this, &AssetInputWidget::handleBulkEditFinished);
 
     mainWidgetLayout->addWidget(label1, 1,0);
     mainWidgetLayout->addWidget(componentFileLineEdit, 1,1);
@@ -881,19 +965,22 @@ bool AssetInputWidget::copyFiles(QString &destName)
     if(nRows == 0)
         return false;
 
-    auto data = componentTableWidget->getTableModel()->getTableData();
-
-    auto headerValues = componentTableWidget->getTableModel()->getHeaderStringList();
-
-    data.push_front(headerValues);
+    // The table is snapshotted now and the file is written with the other deferred staging jobs
+    auto writeCSVFile = componentTableWidget->getTableModel()->createCSVFileWriter(pathToSaveFile);
 
-    CSVReaderWriter csvTool;
+    auto writeJob = [writeCSVFile](QString& err)
+    {
+        return writeCSVFile(err) == 0 && err.isEmpty();
+    };
 
     QString err;
-    csvTool.saveCSVFile(data,pathToSaveFile,err);
+    auto resWrite = StagingQueue::runOrDefer(writeJob, err);
 
-    if(!err.isEmpty())
+    if(!resWrite)
+    {
+        this->errorMessage("Error saving the asset file " + pathToSaveFile + ": " + err);
         return false;
+    }
 
     // Put this here because copy files gets called first and we need to select the components before we can create the input file
     QString filterData = this->getFilterString();
@@ -963,7 +1050,15 @@ bool AssetInputWidget::copyFiles(QString &destName)
 
 void AssetInputWidget::clearTableData(void)
 {
+    // The file that is still being read is not shown anymore
+    if(loadingTask)
+    {
+        loadingTask->cancel();
+        loadingTask.reset();
+    }
+
     theComponentDb->clear();
+    inventoryCache.clear();
     pathToComponentInputFile.clear();
     componentFileLineEdit->clear();
     selectComponentsLineEdit->clear();
@@ -988,17 +1083,23 @@ void AssetInputWidget::clear(void)
 
 void AssetInputWidget::handleCellChanged(const int row, const int col)
 {
-    auto ID = componentTableWidget->item(row,0).toInt();
-
-    auto attrib = componentTableWidget->horizontalHeaderItem(col);
+    QString err;
+    if(!tableEditor.applyCellChange(componentTableWidget->getTableModel(),theComponentDb,row,col,err))
+        this->errorMessage(err);
+}
 
-    auto attribVal = componentTableWidget->item(row,col);
 
+void AssetInputWidget::handleBulkEditStarted(void)
+{
+    tableEditor.startBulkEdit(theComponentDb);
+}
 
-    auto res = theComponentDb->updateComponentAttribute(ID,attrib,attribVal);
-    if(res == false)
-        this->errorMessage("Error could not update asset "+QString::number(ID)+" after cell change");
 
+void AssetInputWidget::handleBulkEditFinished(const QString& err)
+{
+    QString editErr;
+    if(!tableEditor.finishBulkEdit(componentTableWidget->getTableModel(),theComponentDb,err,editErr))
+        this->errorMessage(editErr);
 }
 
 
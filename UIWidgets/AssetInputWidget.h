@@ -43,7 +43,10 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "SimCenterAppWidget.h"
 #include "GISSelectable.h"
 #include "ComponentDatabase.h"
+#include "ComponentTableEditor.h"
+#include "AssetInventoryCache.h"
 
+#include <memory>
 #include <set>
 
 #include <QString>
@@ -54,6 +57,8 @@ class AssetFilterDelegate;
 class ComponentTableView;
 class VisualizationWidget;
 
+class TaskContext;
+
 class QgsFeature;
 class QGISVisualizationWidget;
 class QgsVectorLayer;
@@ -144,10 +149,13 @@ signals:
 public slots:
     void handleComponentSelection(void);
     void handleCellChanged(const int row, const int col);
+    void handleBulkEditStarted(void);
+    void handleBulkEditFinished(const QString& err);
 
 protected slots:
     void selectComponents(void);
-    virtual bool loadAssetData(bool message = true);
+    // Reads the file in the thread pool, the call waits for the layers unless wait is false, then they are created when the file is read
+    virtual bool loadAssetData(bool message = true, bool wait = true);
     void chooseComponentInfoFileDialog(void);
     void clearComponentSelection(void);
     void handleComponentFilter(void);
@@ -159,6 +167,15 @@ protected:
     ComponentTableView* componentTableWidget = nullptr;
     ComponentDatabase*  theComponentDb = nullptr;
 
+    // Applies the cell edits of the table to the database
+    ComponentTableEditor tableEditor;
+
+    // Binary cache of the inventory file, holds the parsed rows and the asset geometries
+    AssetInventoryCache inventoryCache;
+
+    // The file that is being read in the background, if any
+    std::shared_ptr<TaskContext> loadingTask;
+
     // Returns a vector of sorted items that are unique
     template <typename T>
     void uniqueVec(std::vector<T>& vec)
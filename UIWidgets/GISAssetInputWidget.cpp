@@ -45,6 +45,9 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "ComponentDatabaseManager.h"
 #include "CRSSelectionWidget.h"
 #include "CSVReaderWriter.h"
+#include "NetworkInventoryLoader.h"
+#include "StagingQueue.h"
+#include "TaskRunner.h"
 
 #include "QGISVisualizationWidget.h"
 
@@ -59,6 +62,9 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QMessageBox>
 
 #include <qgsfillsymbol.h>
+#include <qgsproject.h>
+#include <qgsvectordataprovider.h>
+#include <qgsvectorlayereditbuffer.h>
 #include <qgsmarkersymbol.h>
 #include <qgslinesymbol.h>
 
@@ -292,8 +298,11 @@ int GISAssetInputWidget::loadAssetVisualization()
 }
 
 
-bool GISAssetInputWidget::loadAssetData(bool message)
+bool GISAssetInputWidget::loadAssetData(bool message, bool wait)
 {
+    // The layers of a GIS file are always created before the call returns
+    Q_UNUSED(wait);
+
     // Ask for the file path if the file path has not yet been set, and return if it is still null
     if(pathToComponentInputFile.compare("NULL") == 0)
         this->chooseComponentInfoFileDialog();
@@ -331,7 +340,10 @@ bool GISAssetInputWidget::loadAssetData(bool message)
     // Name the layer according to the filename
     auto fName = file.fileName();
 
-    mainLayer = theVisualizationWidget->addVectorLayer(pathToComponentInputFile, fName, "ogr");
+    if(useInventoryLoader)
+        mainLayer = this->loadInventoryLayer(fName);
+    else
+        mainLayer = theVisualizationWidget->addVectorLayer(pathToComponentInputFile, fName, "ogr");
 
     if(mainLayer == nullptr)
     {
@@ -339,7 +351,11 @@ bool GISAssetInputWidget::loadAssetData(bool message)
         return false;
     }
 
-    this->setCRS(mainLayer->crs());
+    // The memory layer is in WGS84, the selector shows the CRS of the file that it was reprojected from
+    if(useInventoryLoader)
+        this->setCRS(inventorySourceCrs);
+    else
+        this->setCRS(mainLayer->crs());
 
     auto numFeat = mainLayer->featureCount();
 
@@ -359,8 +375,6 @@ bool GISAssetInputWidget::loadAssetData(bool message)
     auto layerId = mainLayer->id();
     theVisualizationWidget->registerLayerForSelection(layerId,this);
 
-    auto features = mainLayer->getFeatures();
-
     auto fields = mainLayer->fields();
 
     if(fields.size() == 0)
@@ -378,54 +392,11 @@ bool GISAssetInputWidget::loadAssetData(bool message)
         fieldsStrList.push_back(fieldName);
     }
 
-    // Add the ID column to the headers
-//    fieldsStrList.push_front("Index");
-
     tableHorizontalHeadings = fieldsStrList;
 
-    auto numFields = fieldsStrList.size();
-
-    // Data containing the table
-    QVector<QStringList> data(numFeat);
-
-    // Test to remove
-    // auto start = high_resolution_clock::now();
-
-    QgsFeature feat;
-    int i = 0;
-    while (features.nextFeature(feat))
-    {
-        //QStringList attributeStrList = {QString::number(i+1)};
-        QStringList attributeStrList;
-//        attributeStrList.push_back(QString::number(i));
-
-        auto attributes = feat.attributes();
-        for(int i = 0; i<attributes.size(); ++i)
-        {
-            auto attribute = attributes[i];
-            auto attributeStr = attribute.toString();
-
-            attributeStrList.push_back(attributeStr);
-        }
-
-        if(attributeStrList.size() != numFields)
-        {
-            this->errorMessage("Error, the number of attributes: "+QString::number(attributeStrList.size())+" for feature " +QString::number(feat.id())+" does not equal the number of fields "+QString::number(numFields));
-            return false;
-        }
-
-        data[i] = attributeStrList;
-
-        ++i;
-    }
-
-    // Test to remove
-    //    auto stop = high_resolution_clock::now();
-    //    auto duration = duration_cast<milliseconds>(stop - start);
-    //    this->statusMessage("Done shapefile results "+QString::number(duration.count()));
-
+    // The table reads the attributes directly from the layer, so they are not copied into strings here
     componentTableWidget->clear();
-    componentTableWidget->getTableModel()->populateData(data, tableHorizontalHeadings);
+    componentTableWidget->getTableModel()->populateData(mainLayer);
 #ifdef OpenSRA
     label3->show();
 #endif
@@ -608,6 +579,21 @@ bool GISAssetInputWidget::copyFiles(QString &destName)
     if (!componentFile.exists())
         return false;
 
+    // The cell edits stay in the edit buffer of the layer, they are written into the staged copy so that the files of the user are left as they are
+    QgsChangedAttributesMap editedValues;
+    if(mainLayer != nullptr && mainLayer->editBuffer() != nullptr)
+    {
+        const auto changedValues = mainLayer->editBuffer()->changedAttributeValues();
+        for(auto it = changedValues.cbegin(); it != changedValues.cend(); ++it)
+        {
+            // The features of the memory layer have their own ids, they are matched to the features of the file
+            auto fid = useInventoryLoader ? inventorySourceFids.value(it.key(), FID_NULL) : it.key();
+
+            if(!FID_IS_NULL(fid))
+                editedValues.insert(fid, it.value());
+        }
+    }
+
     // if compLineEditText is a folder, then set it as sourceDir, if shp or gdb, get dirName as set as sourceDir
 
     QString sourceDir;
@@ -642,18 +628,49 @@ bool GISAssetInputWidget::copyFiles(QString &destName)
         }
     }
     QString fileSuffix = componentFile.completeSuffix();
-    auto res = false;
-    if (fileSuffix.contains("json")){
-        auto destFilePath = destPath + QDir::separator()+componentFile.fileName();
-        res = QFile::copy(componentFile.absoluteFilePath(), destFilePath);
-    } else{
-        // RecursiveCopy is needed for .shp GIS files
-        res = SCUtils::recursiveCopy(srcPath, destPath);
-    }
+    auto srcFilePath = componentFile.absoluteFilePath();
+    auto destFilePath = destPath + QDir::separator()+componentFile.fileName();
+
+    // A folder, e.g., a gdb, is copied as the destination folder itself
+    auto stagedFilePath = componentFile.isDir() ? destPath : destFilePath;
+
+    // The copy is deferred with the other staging jobs, it only uses the paths and the snapshot of the edits
+    auto copyJob = [fileSuffix, srcFilePath, destFilePath, srcPath, destPath, stagedFilePath, editedValues](QString& err)
+    {
+        auto res = false;
+        if (fileSuffix.contains("json")){
+            res = QFile::copy(srcFilePath, destFilePath);
+        } else{
+            // RecursiveCopy is needed for .shp GIS files
+            res = SCUtils::recursiveCopy(srcPath, destPath);
+        }
+
+        if(!res)
+        {
+            err = "Error copying GIS files over to the directory " + destPath;
+            return false;
+        }
+
+        if(editedValues.isEmpty())
+            return true;
+
+        // The layer only lives in this thread and it only opens the staged copy
+        QgsVectorLayer stagedLayer(stagedFilePath, "staged", "ogr");
+
+        if(!stagedLayer.isValid() || !stagedLayer.dataProvider()->changeAttributeValues(editedValues))
+        {
+            err = "Error writing the edited cells into the GIS file " + stagedFilePath;
+            return false;
+        }
+
+        return true;
+    };
+
+    QString err;
+    auto res = StagingQueue::runOrDefer(copyJob, err);
     if(!res)
     {
-        QString msg = "Error copying GIS files over to the directory " + destPath;
-        errorMessage(msg);
+        errorMessage(err);
 
         return res;
     }
@@ -720,11 +737,87 @@ void GISAssetInputWidget::setCRS(const QgsCoordinateReferenceSystem & val)
 
 void GISAssetInputWidget::handleLayerCrsChanged(const QgsCoordinateReferenceSystem & val)
 {
+    if(useInventoryLoader)
+    {
+        // The features were reprojected from the CRS that the file was loaded with, so they are read again from the new one
+        if(mainLayer && val.isValid() && val != inventorySourceCrs)
+        {
+            pendingSourceCrs = val;
+            this->loadAssetData(false);
+        }
+
+        return;
+    }
+
     if(mainLayer)
         mainLayer->setCrs(val);
 }
 
 
+void GISAssetInputWidget::setUseInventoryLoader(bool value)
+{
+    useInventoryLoader = value;
+}
+
+
+QgsVectorLayer* GISAssetInputWidget::loadInventoryLayer(const QString& layerName)
+{
+    // A new file is reprojected from its own CRS unless the user picked another one
+    auto sourceCrs = pendingSourceCrs;
+    pendingSourceCrs = QgsCoordinateReferenceSystem();
+
+    const auto pathToFile = pathToComponentInputFile;
+
+    // The project can only be used on the GUI thread
+    const auto transformContext = QgsProject::instance()->transformContext();
+
+    NetworkInventory inventory;
+    QString err;
+    auto res = TaskRunner::getInstance()->runAndWait<bool>([&](TaskContext& context)
+    {
+        return NetworkInventoryLoader::read(pathToFile, sourceCrs, transformContext, inventory, err, context);
+    });
+
+    if(!res)
+    {
+        this->errorMessage(err);
+        return nullptr;
+    }
+
+    // The ids of the features in the file, in the order that they are added to the memory layer
+    QVector<QgsFeatureId> sourceFids;
+    sourceFids.reserve(inventory.features.size());
+    for(auto&& feat : inventory.features)
+        sourceFids.push_back(feat.id());
+
+    auto layer = NetworkInventoryLoader::createLayer(theVisualizationWidget, inventory, layerName, err);
+
+    if(layer == nullptr)
+    {
+        this->errorMessage(err);
+        return nullptr;
+    }
+
+    inventorySourceCrs = inventory.sourceCrs;
+
+    // The memory layer gives the features new ids in the order that they were added
+    inventorySourceFids.clear();
+    inventorySourceFids.reserve(sourceFids.size());
+
+    QgsFeatureRequest request;
+    request.setFlags(QgsFeatureRequest::NoGeometry);
+    request.setNoAttributes();
+
+    auto features = layer->getFeatures(request);
+
+    QgsFeature feat;
+    for(int i = 0; i<sourceFids.size() && features.nextFeature(feat); ++i)
+        inventorySourceFids.insert(feat.id(), sourceFids.at(i));
+
+    return layer;
+}
+
+
 void GISAssetInputWidget::clear(void)
 {
     crsSelectorWidget->clear();
@@ -41,6 +41,11 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "AssetInputWidget.h"
 #include "qgsvectorfilewriter.h"
 
+#include <qgscoordinatereferencesystem.h>
+#include <qgsfeatureid.h>
+
+#include <QHash>
+
 class QgsVectorLayer;
 class CRSSelectionWidget;
 
@@ -80,8 +85,11 @@ public:
     int getOffset(void);
     CRSSelectionWidget* getCRSSelectorWidget(void);
 
+    // Load the file with the network inventory loader, the features are then read once and reprojected to WGS84 into a memory layer
+    void setUseInventoryLoader(bool value);
+
 public slots:
-    bool loadAssetData(bool message = true) override;
+    bool loadAssetData(bool message = true, bool wait = true) override;
 
 private slots:
     void handleLayerCrsChanged(const QgsCoordinateReferenceSystem & val);
@@ -90,6 +98,20 @@ protected:
 
     CRSSelectionWidget* crsSelectorWidget = nullptr;
 
+private:
+
+    // Reads the file into a memory layer in WGS84 with the network inventory loader
+    QgsVectorLayer* loadInventoryLayer(const QString& layerName);
+
+    bool useInventoryLoader = false;
+
+    // The CRS that the memory layer was reprojected from, and the CRS to reproject from the next time the file is loaded
+    QgsCoordinateReferenceSystem inventorySourceCrs;
+    QgsCoordinateReferenceSystem pendingSourceCrs;
+
+    // The id in the file of every feature of the memory layer, the cell edits are written into the staged copy of the file by these ids
+    QHash<QgsFeatureId, QgsFeatureId> inventorySourceFids;
+
 };
 
 #endif // GISAssetInputWidget_H
@@ -39,14 +39,167 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "GISTransportNetworkInputWidget.h"
 #include "QGISVisualizationWidget.h"
 #include "GISAssetInputWidget.h"
+#include "NetworkInventoryLoader.h"
+#include "StagingQueue.h"
 
+#include <qgscsexception.h>
 #include <qgslinesymbol.h>
 #include <qgsmarkersymbol.h>
+#include <qgsvectorlayerfeatureiterator.h>
 
 #include <QFileDialog>
 #include <QSplitter>
 #include <QGroupBox>
 #include <QVBoxLayout>
+#include <QtConcurrent/QtConcurrent>
+
+#include <memory>
+
+namespace
+{
+
+// The parts of a layer that are needed to export it, taken on the GUI thread
+struct TransportLayerSnapshot
+{
+    QString assetType;
+
+    // The feature source can be read in a worker thread, unlike the layer itself
+    std::shared_ptr<QgsVectorLayerFeatureSource> featureSource;
+
+    QgsCoordinateTransform transform;
+    bool needReproject = false;
+};
+
+
+TransportLayerSnapshot takeLayerSnapshot(QgsVectorLayer* layer, const QString& assetType)
+{
+    TransportLayerSnapshot snapshot;
+
+    snapshot.assetType = assetType;
+    snapshot.featureSource = std::make_shared<QgsVectorLayerFeatureSource>(layer);
+
+    QgsCoordinateReferenceSystem source_crs = layer->sourceCrs();
+    QgsCoordinateReferenceSystem target_crs = QgsCoordinateReferenceSystem("EPSG:4326");
+    snapshot.needReproject = (source_crs.toWkt() != target_crs.toWkt());
+
+    // One cached transform for the CRS, each chunk works on its own copy
+    // The layers loaded by the inventory loader are already in WGS84 and are not reprojected again
+    snapshot.transform = NetworkInventoryLoader::getTransformToWGS84(source_crs, QgsProject::instance()->transformContext());
+
+    return snapshot;
+}
+
+
+// Writes the features of the layer to the file as GeoJSON features in EPSG:4326, with the asset type added to the properties
+// The features are written in batches as they are read, separated by commas, firstFeature is false once a feature has been written to the file
+bool exportLayerToGeoJSON(const TransportLayerSnapshot& snapshot, QIODevice& file, bool& firstFeature, QString& err)
+{
+    // The geometries are reprojected below, so the exporter only needs to write them
+    // The exporter is not given the layer, it writes the attributes from the fields of the features read from the feature source
+    // With a layer it would format the values with the field formatters of the layer, which are GUI objects that cannot be used in the worker threads
+    QgsJsonExporter exporter;
+    exporter.setTransformGeometries(false);
+
+    const auto& assetType = snapshot.assetType;
+    const auto& transform = snapshot.transform;
+    const auto need_reproject = snapshot.needReproject;
+
+    // The asset type is added to the properties of each feature by the exporter
+    const QVariantMap typeProperty = {{"type", assetType}};
+
+    const int batchSize = 16384;
+    const int chunkSize = 1024;
+
+    auto featIt = snapshot.featureSource->getFeatures();
+
+    QVector<QgsFeature> batch;
+    QVector<QByteArray> batchJson;
+    batch.reserve(batchSize);
+
+    QgsFeature feat;
+    bool moreFeatures = true;
+
+    while(moreFeatures)
+    {
+        // Read a batch of features in order, the iterator can only be used in this thread
+        batch.clear();
+        while(batch.size() < batchSize && (moreFeatures = featIt.nextFeature(feat)))
+            batch.push_back(feat);
+
+        if(batch.isEmpty())
+            break;
+
+        auto numFeatures = batch.size();
+
+        QVector<int> chunkBegins;
+        for(int i = 0; i<numFeatures; i += chunkSize)
+            chunkBegins.push_back(i);
+
+        batchJson.resize(numFeatures);
+        QVector<QString> chunkErrors(chunkBegins.size());
+
+        // Get the raw pointers before going parallel so that the vectors are not detached in the worker threads
+        auto featData = batch.data();
+        auto jsonData = batchJson.data();
+        auto errData = chunkErrors.data();
+
+        QtConcurrent::blockingMap(chunkBegins, [&](const int begin)
+        {
+            auto end = std::min(begin + chunkSize, numFeatures);
+
+            auto chunkTransform = transform;
+            auto chunkExporter = exporter;
+
+            for(int i = begin; i<end; ++i)
+            {
+                auto& feature = featData[i];
+
+                if(need_reproject && feature.hasGeometry())
+                {
+                    QgsGeometry geom = feature.geometry();
+
+                    try
+                    {
+                        geom.transform(chunkTransform);
+                    }
+                    catch (QgsCsException&)
+                    {
+                        errData[begin/chunkSize] = "Could not reproject the feature "+QString::number(feature.id())+" of the "+assetType+" layer";
+                        return;
+                    }
+
+                    feature.setGeometry(geom);
+                }
+
+                jsonData[i] = chunkExporter.exportFeature(feature, typeProperty).toUtf8();
+            }
+        });
+
+        // Report the first error in order so that the message does not depend on the thread timing
+        for(auto&& it : chunkErrors)
+        {
+            if(!it.isEmpty())
+            {
+                err = it;
+                return false;
+            }
+        }
+
+        for(int i = 0; i<numFeatures; ++i)
+        {
+            if(!firstFeature)
+                file.write(",\n");
+
+            file.write(batchJson.at(i));
+            firstFeature = false;
+        }
+    }
+
+    return true;
+}
+
+}
+
 
 GISTransportNetworkInputWidget::GISTransportNetworkInputWidget(QWidget *parent, VisualizationWidget* visWidget) : SimCenterAppWidget(parent)
 {
@@ -56,14 +209,17 @@ GISTransportNetworkInputWidget::GISTransportNetworkInputWidget(QWidget *parent,
     theBridgesWidget = new GISAssetInputWidget(this, theVisualizationWidget, "Bridges");
 
     theBridgesWidget->setLabel1("Load Bridge Data from a GIS file");
+    theBridgesWidget->setUseInventoryLoader(true);
 
     theRoadwaysWidget = new GISAssetInputWidget(this, theVisualizationWidget, "Roads");
 
     theRoadwaysWidget->setLabel1("Load Roadway Data from a GIS file");
+    theRoadwaysWidget->setUseInventoryLoader(true);
 
     theTunnelsWidget = new GISAssetInputWidget(this, theVisualizationWidget, "Tunnels");
 
     theTunnelsWidget->setLabel1("Load Tunnel Data from a GIS file");
+    theTunnelsWidget->setUseInventoryLoader(true);
 
 
     connect(theBridgesWidget,&GISAssetInputWidget::doneLoadingComponents,this,&GISTransportNetworkInputWidget::handleAssetsLoaded);
@@ -137,87 +293,61 @@ bool GISTransportNetworkInputWidget::copyFiles(QString &destName)
         return false;
     }
     destFolder = destName;
-    QJsonArray featuresArray;
-    QJsonObject combinedGeoJSON;
-    combinedGeoJSON["type"]="FeatureCollection";
 
-    QString crsString = R"(
-        {
-            "type": "name",
-            "properties": {
-                "name": "urn:ogc:def:crs:OGC:1.3:CRS84"
-            }
-        }
-    )";
-    QJsonDocument crsDoc = QJsonDocument::fromJson(crsString.toUtf8());
-    QJsonObject crsJson = crsDoc.object();
-    combinedGeoJSON.insert("crs", crsJson);
-    if(theBridgesWidget->getSelectedLayer() != nullptr){
-        QgsVectorLayer* layer = theBridgesWidget->getSelectedLayer();
-        QString type = "Bridge";
-        exportLayerToGeoJSON(layer, featuresArray, type);
-    }
-    if(theRoadwaysWidget->getSelectedLayer() != nullptr){
-        QgsVectorLayer* layer = theRoadwaysWidget->getSelectedLayer();
-        QString type = "Roadway";
-        exportLayerToGeoJSON(layer, featuresArray, type);
-    }
-    if(theTunnelsWidget->getSelectedLayer() != nullptr){
-        QgsVectorLayer* layer = theTunnelsWidget->getSelectedLayer();
-        QString type = "Tunnel";
-        exportLayerToGeoJSON(layer, featuresArray, type);
-    }
-    combinedGeoJSON.insert("features", featuresArray);
     QString destFile = destFolder + QDir::separator() + tr("simcenter_trnsp_inventory.geojson");
-    QFile file(destFile);
-    if (!file.open(QFile::WriteOnly | QFile::Text)) {
-        return false;
-    }
-    QJsonDocument doc(combinedGeoJSON);
-    file.write(doc.toJson());
-    file.close();
 
-    return true;
+    QVector<QPair<GISAssetInputWidget*, QString>> assetWidgets = {{theBridgesWidget, "Bridge"},
+                                                                   {theRoadwaysWidget, "Roadway"},
+                                                                   {theTunnelsWidget, "Tunnel"}};
 
+    // Take the snapshots of the layers here, the export job does not touch the layers
+    QVector<TransportLayerSnapshot> snapshots;
 
-}
+    for(auto&& it : assetWidgets)
+    {
+        QgsVectorLayer* layer = it.first->getSelectedLayer();
 
-void GISTransportNetworkInputWidget::exportLayerToGeoJSON(QgsVectorLayer* layer, QJsonArray& featArray, QString assetType){
-    QgsJsonExporter exporter = QgsJsonExporter(layer);
-    QgsCoordinateReferenceSystem source_crs = layer->sourceCrs();
-    QgsCoordinateReferenceSystem target_crs = QgsCoordinateReferenceSystem("EPSG:4326");
-    bool need_reproject = (source_crs.toWkt() != target_crs.toWkt());
-    QgsFeatureIterator featIt = layer->getFeatures();
-    QgsFeature feat;
-    if (need_reproject){
-        while (featIt.nextFeature(feat))
-        {
-            auto newFeat = QgsFeature(feat); // Use the feature copy constructor
-            // Do a deep clone of the geometry
-            QgsGeometry newGeom = QgsGeometry(feat.geometry().get()->clone());
-            newGeom.transform(QgsCoordinateTransform(source_crs, target_crs, QgsProject::instance()));
-            newFeat.setGeometry(newGeom);
-            QString featData = exporter.exportFeature(newFeat);
-            QJsonDocument doc = QJsonDocument::fromJson(featData.toUtf8());
-            QJsonObject featJSON = doc.object();
-            QJsonObject prop = featJSON["properties"].toObject();
-            prop.insert("type",assetType);
-            featJSON["properties"] = prop;
-            featArray.append(featJSON);
+        if(layer == nullptr)
+            continue;
+
+        snapshots.push_back(takeLayerSnapshot(layer, it.second));
+    }
+
+    // The export is deferred with the other staging jobs
+    auto exportJob = [destFile, snapshots](QString& err)
+    {
+        QFile file(destFile);
+        if (!file.open(QFile::WriteOnly | QFile::Text)) {
+            err = "Could not create the file " + destFile;
+            return false;
         }
-    } else {
-        while (featIt.nextFeature(feat))
+
+        // The feature collection is written piece by piece so that the features of large networks are not all held in memory
+        file.write("{\n"
+                   "\"type\": \"FeatureCollection\",\n"
+                   "\"crs\": {\"type\": \"name\", \"properties\": {\"name\": \"urn:ogc:def:crs:OGC:1.3:CRS84\"}},\n"
+                   "\"features\": [\n");
+
+        bool firstFeature = true;
+
+        for(auto&& snapshot : snapshots)
         {
-            QString featData = exporter.exportFeature(feat);
-            QJsonDocument doc = QJsonDocument::fromJson(featData.toUtf8());
-            QJsonObject featJSON = doc.object();
-            QJsonObject prop = featJSON["properties"].toObject();
-            prop.insert("type",assetType);
-            featJSON["properties"] = prop;
-            featArray.append(featJSON);
+            if(!exportLayerToGeoJSON(snapshot, file, firstFeature, err))
+                return false;
         }
-    }
 
+        file.write("\n]\n}\n");
+        file.close();
+
+        return true;
+    };
+
+    QString err;
+    auto res = StagingQueue::runOrDefer(exportJob, err);
+    if(!res)
+        this->errorMessage(err);
+
+    return res;
 }
 
 
@@ -371,7 +501,7 @@ int GISTransportNetworkInputWidget::loadTunnelsVisualization()
 {
     tunnelsMainLayer = theTunnelsWidget->getMainLayer();
 
-    if(bridgesMainLayer==nullptr)
+    if(tunnelsMainLayer==nullptr)
         return -1;
 
     QgsSymbol* markerSymbol = new QgsMarkerSymbol();
@@ -96,7 +96,6 @@ protected:
     QgsVectorLayer* roadwaysMainLayer = nullptr;
     QgsVectorLayer* tunnelsMainLayer = nullptr;
 
-    void exportLayerToGeoJSON(QgsVectorLayer* layer, QJsonArray& featArray,QString assetType);
 private:
 //    QLineEdit *roadLengthLineEdit;
 //    QWidget* roadLengthWidget = nullptr;
@@ -56,10 +56,12 @@ GISWaterNetworkInputWidget::GISWaterNetworkInputWidget(QWidget *parent, Visualiz
     theNodesWidget = new GISAssetInputWidget(this, theVisualizationWidget, "Water Network Nodes");
 
     theNodesWidget->setLabel1("Load water network node information from a GIS file");
+    theNodesWidget->setUseInventoryLoader(true);
 
     thePipelinesWidget = new GISAssetInputWidget(this, theVisualizationWidget, "Water Network Pipelines");
 
     thePipelinesWidget->setLabel1("Load water network pipeline information from a GIS file");
+    thePipelinesWidget->setUseInventoryLoader(true);
 
     connect(theNodesWidget,&GISAssetInputWidget::doneLoadingComponents,this,&GISWaterNetworkInputWidget::handleAssetsLoaded);
     connect(thePipelinesWidget,&GISAssetInputWidget::doneLoadingComponents,this,&GISWaterNetworkInputWidget::handleAssetsLoaded);
@@ -61,6 +61,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QButtonGroup>
 #include <QRadioButton>
 #include <QStackedWidget>
+#include <QtConcurrent/QtConcurrent>
 
 #include <qgsprojectionselectionwidget.h>
 #include <qgsfillsymbol.h>
@@ -69,6 +70,10 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <qgsgeometryengine.h>
 #include <qgsproject.h>
 #include <qgsmapcanvas.h>
+#include <qgsvectorlayerfeatureiterator.h>
+#include <qgsvectordataprovider.h>
+
+#include <algorithm>
 
 // Test to remove start
 #include <chrono>
@@ -109,6 +114,9 @@ HousingUnitAllocationWidget::HousingUnitAllocationWidget(QWidget *parent, Visual
 
     connect(this,&HousingUnitAllocationWidget::emitDownloadMainThread,this,&HousingUnitAllocationWidget::handleDownloadMainThread);
 
+    // The join thread waits until the results are written so that it does not touch the layers while they are being edited
+    connect(this,&HousingUnitAllocationWidget::emitWriteJoinResultsMainThread,this,&HousingUnitAllocationWidget::handleWriteJoinResultsMainThread,Qt::BlockingQueuedConnection);
+
     // Test to remove start
     //    auto buildingsGISFile =  "/Users/steve/Desktop/SimCenter/Examples/SanFranciscoTestbed/SanFranciscoBuildingFootprints/SanFrancisco_buildingfootprints_2014.shp";
 
@@ -521,6 +529,20 @@ int HousingUnitAllocationWidget::handleRunJoinButtonPressed()
     //    parcelsLayer->setCrs(QgsCoordinateReferenceSystem("EPSG:3857"));
 
 
+    if(censusBlockLayer == nullptr || ACSBlockGroupLayer == nullptr || assetLayer == nullptr)
+    {
+        this->errorMessage("Error in extracting census data. Either a census layer, ACS layer, or assets layer is missing.");
+        return -1;
+    }
+
+    // The feature sources have to be created in the main thread, afterwards they can be iterated in the join thread without locking the layers
+    assetSource = std::make_unique<QgsVectorLayerFeatureSource>(assetLayer);
+    censusSource = std::make_unique<QgsVectorLayerFeatureSource>(censusBlockLayer);
+    ACSSource = std::make_unique<QgsVectorLayerFeatureSource>(ACSBlockGroupLayer);
+
+    censusTransform = QgsCoordinateTransform(censusBlockLayer->crs(), assetLayer->crs(), QgsProject::instance());
+    ACSTransform = QgsCoordinateTransform(ACSBlockGroupLayer->crs(), assetLayer->crs(), QgsProject::instance());
+
     this->statusMessage("Starting extraction of census data,  linking buildings to parcels,  and addresses to parcels.  Process running in the background and it may take a while.");
     QApplication::processEvents();
 
@@ -632,30 +654,75 @@ int HousingUnitAllocationWidget::importJoinAssets()
 {
     emit emitStatusMsg("Extracting informatiom from census layer(s) to add to assets.");
 
-    auto future1 = std::async(&HousingUnitAllocationWidget::extractCensusData, this);
+    // Read the asset centroids and index the census block and ACS block group polygons at the same time
+    auto buildCensusIndex = [this]()
+    {
+        QString err;
+        if(!censusIndex.build(censusSource.get(), censusTransform, err))
+        {
+            emit emitErrorMsg(err);
+            return -1;
+        }
+
+        return 0;
+    };
 
-    if(future1.get() != 0)
+    auto buildACSIndex = [this]()
     {
-        emit emitErrorMsg("Error extracting census data");
+        QString err;
+        if(!ACSIndex.build(ACSSource.get(), ACSTransform, err))
+        {
+            emit emitErrorMsg(err);
+            return -1;
+        }
+
+        return 0;
+    };
+
+    auto future1 = QtConcurrent::run(buildCensusIndex);
+    auto future2 = QtConcurrent::run(buildACSIndex);
+
+    auto resBuildings = this->getBuildingFeatures();
+
+    if(future1.result() != 0)
+    {
+        emit emitErrorMsg("Error indexing the census layer");
         return -1;
     }
 
-    auto future2 = std::async(&HousingUnitAllocationWidget::extractACSData, this);
+    if(future2.result() != 0)
+    {
+        emit emitErrorMsg("Error indexing the ACS layer");
+        return -1;
+    }
 
-    if(future2.get() != 0)
+    if(resBuildings != 0)
     {
-        emit emitErrorMsg("Error extracting ACS data");
+        emit emitErrorMsg("Error getting the asset features");
         return -1;
     }
 
-    auto future3 = std::async(&HousingUnitAllocationWidget::getBuildingFeatures, this);
+    // Both joins only read the centroids and their own index so they run concurrently without a lock
+    auto future3 = QtConcurrent::run(this, &HousingUnitAllocationWidget::extractCensusData);
 
-    if(future3.get() != 0)
+    auto resACS = this->extractACSData();
+
+    if(future3.result() != 0)
     {
-        emit emitErrorMsg("Error getting the asset features");
+        emit emitErrorMsg("Error extracting census data");
         return -1;
     }
 
+    if(resACS != 0)
+    {
+        emit emitErrorMsg("Error extracting ACS data");
+        return -1;
+    }
+
+    emit emitStatusMsg("Writing the census and ACS data to the assets.");
+
+    emit emitWriteJoinResultsMainThread();
+
     // TODO: implement parcels
     //    if(parcelsLayer == nullptr)
     //    {
@@ -711,19 +778,25 @@ int HousingUnitAllocationWidget::getBuildingFeatures(void)
 {
     emit emitStatusMsg("Parsing assets.");
 
-    buildingLayerSemaphore.lock();
-
-    if(assetLayer == nullptr)
+    if(assetSource == nullptr)
     {
         emit emitErrorMsg("Error: no assets layer");
-        buildingLayerSemaphore.unlock();
-
         return -1;
     }
 
-    auto features = assetLayer->getFeatures();
+    buildingsMap.clear();
 
-    //buildingsMap.reserve(buildingsLayer->featureCount());
+    assetCentroids = SpatialJoinPoints();
+
+    auto numFeatures = assetSource->featureCount();
+    if(numFeatures > 0)
+    {
+        assetCentroids.fids.reserve(numFeatures);
+        assetCentroids.x.reserve(numFeatures);
+        assetCentroids.y.reserve(numFeatures);
+    }
+
+    auto features = assetSource->getFeatures();
 
     QgsFeature feat;
     while (features.nextFeature(feat))
@@ -733,21 +806,20 @@ int HousingUnitAllocationWidget::getBuildingFeatures(void)
         // Create a deep copy
         newBuilding->buildingFeat = QgsFeature(feat);
 
-        auto buildGeom = feat.geometry().get()->clone();
-
-        auto buildCentroid = buildGeom->centroid();
+        auto buildCentroid = feat.geometry().centroid().asPoint();
 
         newBuilding->buildingCentroidXY = buildCentroid;
 
         auto featId = feat.id();
         buildingsMap.insert(featId,newBuilding);
 
-        // buildingsMap.push_back(newBuilding);
+        // The centroids are read once here and shared by all of the joins
+        assetCentroids.fids.push_back(featId);
+        assetCentroids.x.push_back(buildCentroid.x());
+        assetCentroids.y.push_back(buildCentroid.y());
     }
 
-    emit emitStatusMsg("Loaded "+QString::number(assetLayer->featureCount())+" assets");
-
-    buildingLayerSemaphore.unlock();
+    emit emitStatusMsg("Loaded "+QString::number(assetCentroids.size())+" assets");
 
     return 0;
 }
@@ -890,20 +962,17 @@ int HousingUnitAllocationWidget::extractCensusData(void)
 {
     emit emitStatusMsg("Extracting census population demographics data.");
 
-    // Lock access to the building layer
-    std::unique_lock<std::mutex> lck (buildingLayerSemaphore);
-
-    if(censusBlockLayer == nullptr || assetLayer == nullptr)
+    if(censusIndex.numPolygons() == 0 || assetCentroids.size() == 0)
     {
-        emit emitErrorMsg("Error in extracting census data. Either a census layer or buildings layer is missing.");
+        emit emitErrorMsg("Error in extracting census data. Either a census layer or buildings layer is empty.");
         return -1;
     }
 
-    QString errMsg;
+    censusJoin = censusIndex.join(assetCentroids);
 
-    auto res = theVisualizationWidget->joinLayers(censusBlockLayer,assetLayer,"CENSUSLAYER_",errMsg);
-    if(res != 0)
-        emit emitErrorMsg(errMsg);
+    auto numNotFound = std::count(censusJoin.cbegin(), censusJoin.cend(), -1);
+    if(numNotFound > 0)
+        emit emitInfoMsg("Warning: "+QString::number(numNotFound)+" assets are not inside of a census block");
 
     emit emitStatusMsg("Done extracting census data.");
 
@@ -915,20 +984,17 @@ int HousingUnitAllocationWidget::extractACSData(void)
 {
     emit emitStatusMsg("Extracting ACS household income data.");
 
-    // Lock access to the building layer
-    std::unique_lock<std::mutex> lck (buildingLayerSemaphore);
-
-    if(ACSBlockGroupLayer == nullptr || assetLayer == nullptr)
+    if(ACSIndex.numPolygons() == 0 || assetCentroids.size() == 0)
     {
-        emit emitErrorMsg("Error in extracting ACS data. Either a ACS layer or assets layer is missing.");
+        emit emitErrorMsg("Error in extracting ACS data. Either a ACS layer or assets layer is empty.");
         return -1;
     }
 
-    QString errMsg;
+    ACSJoin = ACSIndex.join(assetCentroids);
 
-    auto res = theVisualizationWidget->joinLayers(ACSBlockGroupLayer,assetLayer,"ACSLAYER_",errMsg);
-    if(res != 0)
-        emit emitErrorMsg(errMsg);
+    auto numNotFound = std::count(ACSJoin.cbegin(), ACSJoin.cend(), -1);
+    if(numNotFound > 0)
+        emit emitInfoMsg("Warning: "+QString::number(numNotFound)+" assets are not inside of an ACS block group");
 
     emit emitStatusMsg("Done extracting ACS data.");
 
@@ -936,6 +1002,113 @@ int HousingUnitAllocationWidget::extractACSData(void)
 }
 
 
+void HousingUnitAllocationWidget::handleWriteJoinResultsMainThread(void)
+{
+    if(assetLayer == nullptr)
+    {
+        this->errorMessage("Error: no assets layer");
+        return;
+    }
+
+    auto provider = assetLayer->dataProvider();
+
+    // Add the fields of both polygon layers with a prefix, fields that exist from a previous join are reused
+    QList<QgsField> newFields;
+    QStringList censusNames;
+    QStringList ACSNames;
+
+    auto addPrefixedFields = [&](const QgsFields& fields, const QString& prefix, QStringList& names)
+    {
+        for(auto&& field : fields)
+        {
+            auto name = prefix + field.name();
+            names.append(name);
+
+            if(provider->fields().indexOf(name) != -1)
+                continue;
+
+            QgsField newField(field);
+            newField.setName(name);
+            newFields.append(newField);
+        }
+    };
+
+    addPrefixedFields(censusIndex.fields(),"CENSUSLAYER_",censusNames);
+    addPrefixedFields(ACSIndex.fields(),"ACSLAYER_",ACSNames);
+
+    if(!newFields.isEmpty() && !provider->addAttributes(newFields))
+    {
+        this->errorMessage("Error adding the census and ACS fields to the assets layer");
+        return;
+    }
+
+    assetLayer->updateFields();
+
+    auto layerFields = provider->fields();
+
+    QVector<int> censusIndices;
+    for(auto&& name : censusNames)
+        censusIndices.push_back(layerFields.indexOf(name));
+
+    QVector<int> ACSIndices;
+    for(auto&& name : ACSNames)
+        ACSIndices.push_back(layerFields.indexOf(name));
+
+    auto addJoinedAttributes = [](const SpatialJoinPolygonIndex& index, const int polygonIndex, const QVector<int>& fieldIndices, QgsAttributeMap& attributes)
+    {
+        if(polygonIndex < 0)
+            return;
+
+        const auto& values = index.attributes(polygonIndex);
+
+        for(int j = 0; j<fieldIndices.size() && j<values.size(); ++j)
+            attributes.insert(fieldIndices.at(j),values.at(j));
+    };
+
+    QgsChangedAttributesMap changedAttributes;
+
+    for(int i = 0; i<assetCentroids.size(); ++i)
+    {
+        QgsAttributeMap attributes;
+
+        addJoinedAttributes(censusIndex, censusJoin.value(i,-1), censusIndices, attributes);
+        addJoinedAttributes(ACSIndex, ACSJoin.value(i,-1), ACSIndices, attributes);
+
+        if(attributes.isEmpty())
+            continue;
+
+        auto fid = assetCentroids.fids.at(i);
+
+        // Keep the copies of the asset features in sync with the layer
+        auto building = buildingsMap.value(fid,nullptr);
+        if(building != nullptr)
+        {
+            auto featAttributes = building->buildingFeat.attributes();
+            featAttributes.resize(layerFields.size());
+
+            for(auto it = attributes.cbegin(); it != attributes.cend(); ++it)
+                featAttributes[it.key()] = it.value();
+
+            building->buildingFeat.setFields(layerFields,false);
+            building->buildingFeat.setAttributes(featAttributes);
+        }
+
+        changedAttributes.insert(fid,attributes);
+    }
+
+    // One batch for all of the assets
+    if(!provider->changeAttributeValues(changedAttributes))
+    {
+        this->errorMessage("Error writing the census and ACS data to the assets layer");
+        return;
+    }
+
+    assetLayer->triggerRepaint();
+
+    this->statusMessage("Added census and ACS data to "+QString::number(changedAttributes.size())+" assets");
+}
+
+
 void HousingUnitAllocationWidget::clear()
 {
     Layermap.clear();
@@ -39,9 +39,11 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 // Written by: Dr. Stevan Gavrilovic, UC Berkeley
 
 #include "SimCenterAppWidget.h"
+#include "SpatialJoinEngine.h"
 
 #include <qgscoordinatereferencesystem.h>
 #include <qgsfeature.h>
+#include <qgscoordinatetransform.h>
 
 #include <QMap>
 #include <QProcess>
@@ -51,10 +53,12 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <set>
 #include <thread>
 #include <mutex>
+#include <memory>
 
 class VisualizationWidget;
 
 class QgsVectorLayer;
+class QgsVectorLayerFeatureSource;
 class QGISVisualizationWidget;
 class QgsProjectionSelectionWidget;
 
@@ -163,6 +167,8 @@ signals:
 
     void emitDownloadMainThread(QString,QString);
 
+    void emitWriteJoinResultsMainThread();
+
 
 private slots:
 
@@ -207,6 +213,9 @@ private slots:
 
     void handleDownloadMainThread(const QString& url, const QString& path);
 
+    // Writes the joined census and ACS attributes to the asset layer in a single batch
+    void handleWriteJoinResultsMainThread(void);
+
     void handleDownloadFinished(QNetworkReply* reply);
 
     void handleDownloadProgress(qint64 bytesReceived, qint64 bytesTotal);
@@ -253,6 +262,25 @@ private:
     int extractCensusData(void);
     int extractACSData(void);
 
+    // Snapshots of the layers that are created in the main thread and read by the join thread, the layers themselves are not touched until the results are written back
+    std::unique_ptr<QgsVectorLayerFeatureSource> assetSource;
+    std::unique_ptr<QgsVectorLayerFeatureSource> censusSource;
+    std::unique_ptr<QgsVectorLayerFeatureSource> ACSSource;
+
+    // Transforms from the census and ACS layers to the asset layer coordinate system
+    QgsCoordinateTransform censusTransform;
+    QgsCoordinateTransform ACSTransform;
+
+    // Asset centroids that are read once and shared by both joins
+    SpatialJoinPoints assetCentroids;
+
+    SpatialJoinPolygonIndex censusIndex;
+    SpatialJoinPolygonIndex ACSIndex;
+
+    // Index of the census block and ACS block group polygon containing each asset centroid, -1 if none
+    QVector<int> censusJoin;
+    QVector<int> ACSJoin;
+
     QProcess* process = nullptr;
 
     QgsProjectionSelectionWidget* mCensusCrsSelector = nullptr;
@@ -43,10 +43,10 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "HurricaneParameterWidget.h"
 #include "SimCenterPreferences.h"
 #include "SiteConfig.h"
-#include "GridNode.h"
 #include "NodeHandle.h"
 #include "LayerTreeItem.h"
 #include "CSVReaderWriter.h"
+#include "HurricaneWindFieldModel.h"
 #include "Utils/ProgramOutputDialog.h"
 
 //Test
@@ -58,6 +58,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QJsonArray>
 #include <QComboBox>
 #include <QDialog>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QFileDialog>
 #include <QFileInfo>
@@ -72,6 +73,11 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QStackedWidget>
 #include <QVBoxLayout>
 #include <QDir>
+#include <QtMath>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 #include "SimCenterMapcanvasWidget.h"
 #include "RectangleGrid.h"
@@ -99,6 +105,7 @@ HurricaneSelectionWidget::HurricaneSelectionWidget(VisualizationWidget* visWidge
     trackLineEdit = nullptr;
     typeOfScenarioWidget = nullptr;
     runButton = nullptr;
+    previewButton = nullptr;
     divLatSpinBox = nullptr;
     divLonSpinBox = nullptr;
 
@@ -476,6 +483,11 @@ QStackedWidget* HurricaneSelectionWidget::getHurricaneSelectionWidget(void)
     bottomLayout->addWidget(runLabel);
     bottomLayout->addWidget(runButton);
 
+    previewButton = new QPushButton(tr("&Preview Peak Wind Speeds"));
+    connect(previewButton,&QPushButton::clicked,this,&HurricaneSelectionWidget::previewWindField);
+
+    bottomLayout->addWidget(previewButton);
+
 
     mainLayout->addLayout(topLayout, 0,0);
     mainLayout->addWidget(hurricaneParamsWidget, 0,1,2,1);
@@ -551,9 +563,13 @@ void HurricaneSelectionWidget::loadHurricaneTrackData(void)
     theStackedWidget->setCurrentWidget(progressBarWidget);
     progressBarWidget->setVisible(true);
 
-    QString errMsg;
-    auto res = this->importHurricaneTrackData(eventDatabaseFile,errMsg);
+    // The database is read in the background, the widget goes back to the input pane when it is loaded
+    this->importHurricaneTrackData(eventDatabaseFile);
+}
+
 
+void HurricaneSelectionWidget::handleHurricaneTrackDataLoaded(const QString& errMsg)
+{
     progressLabel->setVisible(false);
 
     // Reset the widget back to the input pane and close
@@ -565,7 +581,7 @@ void HurricaneSelectionWidget::loadHurricaneTrackData(void)
 
     emit loadingComplete(true);
 
-    if(res != 0)
+    if(!errMsg.isEmpty())
         this->errorMessage(errMsg);
 
     return;
@@ -898,6 +914,199 @@ void HurricaneSelectionWidget::runHazardSimulation(void)
 }
 
 
+void HurricaneSelectionWidget::previewWindField(void)
+{
+    if(gridData.size()<2)
+    {
+        QString msg = "Specify a site grid before continuing";
+        this->statusMessage(msg);
+        return;
+    }
+
+    // Check if a hurricane exists
+    if(selectedHurricaneObj.empty())
+    {
+        this->statusMessage("Select or specify a hurricane before running");
+        return;
+    }
+
+    QJsonObject landfallObj = hurricaneParamsWidget->getLandfallParamsJson();
+    if(landfallObj.empty())
+    {
+        this->statusMessage("Some landfall parameters are not specified");
+        return;
+    }
+
+    // Get the track
+    auto paramLabels = selectedHurricaneObj.parameterLabels;
+
+    auto indexLat = paramLabels.indexOf("LAT");
+    auto indexLon = paramLabels.indexOf("LON");
+
+    if(indexLat == -1 || indexLon == -1)
+    {
+        this->errorMessage("Could not get the lat/lon indexes to populate the track");
+        return;
+    }
+
+    QVector<double> trackLat;
+    QVector<double> trackLon;
+
+    for(auto&& it : selectedHurricaneObj.getHurricaneData())
+    {
+        bool OK1 = false, OK2 = false;
+        auto lat = it.at(indexLat).toDouble(&OK1);
+        auto lon = it.at(indexLon).toDouble(&OK2);
+
+        if(!OK1 || !OK2)
+            continue;
+
+        trackLat.push_back(lat);
+        trackLon.push_back(lon);
+    }
+
+    if(trackLat.isEmpty())
+    {
+        this->errorMessage("The track of the hurricane has no valid points");
+        return;
+    }
+
+    // The reference landfall is the one of the hurricane record, or the track point closest to the specified landfall if the record has none
+    double refLat = 0.0;
+    double refLon = 0.0;
+    double refAngle = 0.0;
+
+    auto landfallLat = landfallObj["Latitude"].toDouble();
+    auto landfallLon = landfallObj["Longitude"].toDouble();
+    auto landfallAngle = landfallObj["LandingAngle"].toDouble();
+
+    if(!selectedHurricaneObj.getDataAtLandfall().isEmpty())
+    {
+        refLat = selectedHurricaneObj.getLatitudeAtLandfall();
+        refLon = selectedHurricaneObj.getLongitudeAtLandfall();
+        refAngle = selectedHurricaneObj.getLandingAngle();
+    }
+    else
+    {
+        int closest = 0;
+        double minDist = std::numeric_limits<double>::max();
+        for(int i = 0; i<trackLat.size(); ++i)
+        {
+            auto dLat = trackLat.at(i)-landfallLat;
+            auto dLon = trackLon.at(i)-landfallLon;
+            auto dist = dLat*dLat + dLon*dLon;
+
+            if(dist < minDist)
+            {
+                minDist = dist;
+                closest = i;
+            }
+        }
+
+        refLat = trackLat.at(closest);
+        refLon = trackLon.at(closest);
+
+        // The storm direction at the closest point, clockwise from north
+        auto before = std::max(0, closest-1);
+        auto after = std::min(trackLat.size()-1, closest+1);
+
+        auto dx = (trackLon.at(after)-trackLon.at(before))*std::cos(qDegreesToRadians(refLat));
+        auto dy = trackLat.at(after)-trackLat.at(before);
+
+        refAngle = (dx == 0.0 && dy == 0.0) ? landfallAngle : qRadiansToDegrees(std::atan2(dx,dy));
+    }
+
+    // Move and turn the track to the landfall, as the hurricane simulation does
+    HurricaneWindFieldModel::moveTrackToLandfall(trackLat, trackLon, refLat, refLon, refAngle, landfallLat, landfallLon, landfallAngle);
+
+    HurricaneWindFieldModel windFieldModel;
+
+    QString err;
+    if(!windFieldModel.setTrack(trackLat, trackLon, err))
+    {
+        this->errorMessage(err);
+        return;
+    }
+
+    // The landfall parameters are in mb, kts and nmile, the pressure is the central pressure
+    auto pressureDeficit = 1013.0 - landfallObj["Pressure"].toDouble();
+
+    if(pressureDeficit <= 0.0)
+    {
+        this->errorMessage("The central pressure at landfall must be lower than the ambient pressure of 1013 mb");
+        return;
+    }
+
+    HurricaneStormParameters stormParams;
+    stormParams.pressureDeficit = 100.0*pressureDeficit;
+    stormParams.translationSpeed = 0.514444*landfallObj["Speed"].toDouble();
+    stormParams.radiusMaxWinds = 1852.0*landfallObj["Radius"].toDouble();
+
+    windFieldModel.setStormParameters(stormParams);
+
+    auto intMeasObj = hurricaneParamsWidget->getEventJson()["IntensityMeasure"].toObject();
+
+    windFieldModel.setReferenceHeight(intMeasObj["ReferenceHeight"].toDouble(10.0));
+    windFieldModel.setGustDuration(intMeasObj["GustDuration"].toDouble(3.0));
+
+    auto roughness = HurricaneWindFieldModel::getRoughnessLength(intMeasObj["Exposure"].toString());
+
+    // The first row in the grid data is the header
+    auto numSites = gridData.size()-1;
+
+    HurricaneSiteArrays sites;
+    sites.resize(numSites);
+
+    for(int i = 0; i<numSites; ++i)
+    {
+        const auto& row = gridData.at(i+1);
+
+        sites.latitude[i] = row.at(1).toDouble();
+        sites.longitude[i] = row.at(2).toDouble();
+        sites.roughness[i] = roughness;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QVector<double> peakWindSpeeds;
+    if(!windFieldModel.computePeakWindSpeeds(sites, peakWindSpeeds, err))
+    {
+        this->errorMessage(err);
+        return;
+    }
+
+    auto elapsed = timer.elapsed();
+
+    // Update the grid features, the peak wind speeds are in mph like the results of the hazard simulation
+    QgsFeatureList featList;
+    featList.reserve(numSites);
+
+    for(int i = 0; i<numSites; ++i)
+    {
+        auto stationName = gridData.at(i+1).at(0);
+
+        auto station = stationMap.find(stationName);
+
+        if(station == stationMap.end())
+        {
+            this->errorMessage("Error, could not find the station in the map");
+            return;
+        }
+
+        auto feat = station->getStationFeature();
+
+        feat.setAttribute("Peak Wind Speeds", QString::number(2.23694*peakWindSpeeds.at(i),'f',1));
+
+        featList.push_back(feat);
+    }
+
+    this->updateGridLayerFeatures(featList);
+
+    this->statusMessage("Computed the peak wind speeds at "+QString::number(numSites)+" sites over "+QString::number(windFieldModel.getNumTimeSteps())+" time steps in "+QString::number(elapsed)+" ms");
+}
+
+
 void HurricaneSelectionWidget::handleProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
 {
     this->runButton->setEnabled(true);
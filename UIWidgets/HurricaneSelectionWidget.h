@@ -86,7 +86,8 @@ public:
 
     virtual int createHurricaneVisuals(HurricaneObject* hurricane) = 0;
 
-    virtual QgsVectorLayer* importHurricaneTrackData(const QString &eventFile, QString &err) = 0;
+    // Starts loading the database of hurricane tracks, handleHurricaneTrackDataLoaded has to be called when it is done
+    virtual void importHurricaneTrackData(const QString &eventFile) = 0;
     virtual int updateGridLayerFeatures(QgsFeatureList& featList) = 0;
 
     QString getTerrainGeojsonPath();
@@ -107,8 +108,13 @@ public slots:
 protected slots:
 
     void runHazardSimulation(void);
+
+    // Computes the peak wind speeds at the grid sites in the application and shows them on the map, without running the backend simulation
+    void previewWindField(void);
+
     void handleHurricaneTrackImport(void);
     void loadHurricaneTrackData(void);
+    void handleHurricaneTrackDataLoaded(const QString& errMsg);
     void loadHurricaneButtonClicked(void);
     void showGridOnMap(void);
     void showPointOnMap(void);
@@ -175,6 +181,7 @@ protected:
 
     QProcess* process;
     QPushButton* runButton;
+    QPushButton* previewButton;
 
     VisualizationWidget* theVizWidget;
 };
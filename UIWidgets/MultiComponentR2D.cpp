@@ -39,6 +39,8 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "MultiComponentR2D.h"
 #include "SecondaryComponentSelection.h"
 #include "sectiontitle.h"
+#include "StagingQueue.h"
+#include "TaskRunner.h"
 #include "VisualizationWidget.h"
 
 // Qt headers
@@ -258,19 +260,40 @@ bool MultiComponentR2D::inputAppDataFromJSON(QJsonObject &jsonObject)
 
 bool MultiComponentR2D::copyFiles(QString &destDir)
 {
+    // The components stage their files on the GUI thread and defer their copies and exports to the queue, which runs the components concurrently once all of them are done
+    // A nested multi-component widget passes its jobs on to the queue of the outermost one
+    StagingQueue queue;
+
     bool res = true;
     int length = theNames.length();
     for (int i =0; i<length; i++) {
         QPushButton *theButton = thePushButtons.at(i);
         if (theButton->isHidden() == false) {
             SimCenterAppWidget *theWidget = theComponents.at(i);
+
+            if (queue.isActive())
+                queue.beginGroup(theNames.at(i));
+
             bool res1 = theWidget->copyFiles(destDir);
             if (res1 != true) {
                 res = false;
             }
         }
     }
-    return res;
+
+    if (!queue.isActive() || queue.getNumJobs() == 0)
+        return res;
+
+    QStringList errors;
+    auto resJobs = TaskRunner::getInstance()->runAndWait<bool>([&](TaskContext& context)
+    {
+        return queue.run(context, errors);
+    });
+
+    for (auto&& err : errors)
+        this->errorMessage(err);
+
+    return res && resJobs;
 }
 
 
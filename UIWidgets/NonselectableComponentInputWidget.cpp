@@ -303,6 +303,8 @@ void NonselectableComponentInputWidget::createComponentsBox(void)
     componentTableWidget = new ComponentTableView();
     
     connect(componentTableWidget->getTableModel(), &ComponentTableModel::handleCellChanged, this, &NonselectableComponentInputWidget::handleCellChanged);
+    connect(componentTableWidget->getTableModel(), &ComponentTableModel::bulkEditStarted, this, &NonselectableComponentInputWidget::handleBulkEditStarted);
+    connect(componentTableWidget->getTableModel(), &ComponentTableModel::bulkEditFinished, this, &NonselectableComponentInputWidget::handleBulkEditFinished);
 
     QHBoxLayout* pathLayout = new QHBoxLayout();
     pathLayout->addWidget(pathText);
@@ -554,13 +556,23 @@ void NonselectableComponentInputWidget::clear(void)
 
 void NonselectableComponentInputWidget::handleCellChanged(const int row, const int col)
 {
-    auto ID = componentTableWidget->item(row,0).toInt();
+    QString err;
+    if(!tableEditor.applyCellChange(componentTableWidget->getTableModel(),theComponentDb,row,col,err))
+        this->errorMessage(err);
+}
 
-    auto attrib = componentTableWidget->horizontalHeaderItem(col);
 
-    auto attribVal = componentTableWidget->item(row,col);
+void NonselectableComponentInputWidget::handleBulkEditStarted(void)
+{
+    tableEditor.startBulkEdit(theComponentDb);
+}
+
 
-    theComponentDb->updateComponentAttribute(ID,attrib,attribVal);
+void NonselectableComponentInputWidget::handleBulkEditFinished(const QString& err)
+{
+    QString editErr;
+    if(!tableEditor.finishBulkEdit(componentTableWidget->getTableModel(),theComponentDb,err,editErr))
+        this->errorMessage(editErr);
 }
 
 
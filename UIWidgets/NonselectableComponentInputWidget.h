@@ -40,6 +40,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 #include "SimCenterAppWidget.h"
 #include "ComponentDatabase.h"
+#include "ComponentTableEditor.h"
 
 #include <set>
 
@@ -98,6 +99,8 @@ signals:
 
 public slots:
     void handleCellChanged(const int row, const int col);
+    void handleBulkEditStarted(void);
+    void handleBulkEditFinished(const QString& err);
     virtual bool loadComponentData(void);
 
 protected slots:
@@ -111,6 +114,9 @@ protected:
 
     ComponentDatabase*  theComponentDb;
 
+    // Applies the cell edits of the table to the database
+    ComponentTableEditor tableEditor;
+
     // Returns a vector of sorted items that are unique
     template <typename T>
     void uniqueVec(std::vector<T>& vec)
@@ -253,16 +253,7 @@ void OpenQuakeSelectionWidget::loadOpenQuakeXMLData(void)
 
     auto filePath = xmlImportPathLineEdit->text();
 
-    // Load xml file
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly ))
-    {
-        // Error while loading file
-        this->errorMessage("Error while loading file "+filePath);
-        return;
-    }
-
-    if(!xmlGMs.isNull())
+    if(!sourceModel.isEmpty())
     {
         this->clear();
         xmlImportPathLineEdit->setText(filePath);
@@ -271,135 +262,44 @@ void OpenQuakeSelectionWidget::loadOpenQuakeXMLData(void)
     theStackedWidget->setCurrentWidget(progressBarWidget);
     progressBarWidget->setVisible(true);
 
-    // QDomDocument used to import XML data
-    // Set raw XML content into the QDomDocument
-    xmlGMs.setContent(&file);
-
-    // Close the file now that we are done with it
-    file.close();
-
-    // Extract the root element
-    auto root = xmlGMs.documentElement();
-
-    // Get root names and attributes
-    //QString Type = root.tagName();
-
-
-    auto sourceModelList = root.elementsByTagName("sourceModel");
-
-    if(sourceModelList.size() == 0)
-    {
-        this->errorMessage("Could not find sourceModel tag in .xml file");
-        // Reset the widget back to the input pane and close
-        theStackedWidget->setCurrentWidget(fileInputWidget);
-        fileInputWidget->setVisible(true);
-        return;
-    }
-
-    auto sourceModelRoot = sourceModelList.at(0);
-
-    auto sourceList = sourceModelRoot.childNodes();
-
-    auto numSources = sourceList.size();
-
-    if(numSources==0)
-    {
-        this->errorMessage("Number of sources in the source model is zero");
-        // Reset the widget back to the input pane and close
-        theStackedWidget->setCurrentWidget(fileInputWidget);
-        fileInputWidget->setVisible(true);
-        return;
-    }
-
-    auto sourceName = sourceModelRoot.attributes().namedItem("name").nodeValue();
-    this->statusMessage("Importing sources "+sourceName);
-
-    // For testing start
-    //    QSet<QString> sourceTypes;
-
-    //    for(int i = 0; i<numSources; ++i)
-    //    {
-    //        auto sourceType = sourceList.at(i).nodeName();
-
-    //        sourceTypes.insert(sourceType);
-    //    }
-
-    //    for(auto&& it: sourceTypes)
-    //        qDebug()<<it;
-    // For testing end
-
-    QDomNodeList pointSources = root.elementsByTagName("pointSource");
-
-    auto res = this->getPointSources(&pointSources);
-
-    if(res == -1)
+    // Reset the widget back to the input pane
+    auto resetToInputPane = [this]()
     {
-        this->errorMessage("Failed to import point sources. Something went wrong");
-        // Reset the widget back to the input pane and close
         theStackedWidget->setCurrentWidget(fileInputWidget);
         fileInputWidget->setVisible(true);
-        return;
-    }
-
-    QDomNodeList characLineSources = root.elementsByTagName("characteristicFaultSource");
-
-    res = this->getCharacteristicComplexLineSources(&characLineSources,true);
-
-    if(res == -1)
-    {
-        this->errorMessage("Failed to import line sources. Something went wrong");
-        // Reset the widget back to the input pane and close
-        theStackedWidget->setCurrentWidget(fileInputWidget);
-        fileInputWidget->setVisible(true);
-        return;
-    }
-
-
-    QDomNodeList compLineSources = root.elementsByTagName("complexFaultSource");
-
-    res = this->getCharacteristicComplexLineSources(&compLineSources,false);
+    };
 
-    if(res == -1)
+    // The source model is streamed from the file, or read from the cache if the file was loaded before
+    QString err;
+    if(!sourceModel.load(filePath, err))
     {
-        this->errorMessage("Failed to import line sources. Something went wrong");
-        // Reset the widget back to the input pane and close
-        theStackedWidget->setCurrentWidget(fileInputWidget);
-        fileInputWidget->setVisible(true);
+        this->errorMessage(err);
+        resetToInputPane();
         return;
     }
 
+    // The model loaded but its cache could not be written
+    if(!err.isEmpty())
+        this->statusMessage(err);
 
-    QDomNodeList simpleFaultSources = root.elementsByTagName("simpleFaultSource");
+    this->statusMessage("Importing sources "+sourceModel.getName());
 
-    res = this->getSimpleFaultSources(&simpleFaultSources);
-
-    if(res == -1)
+    for(auto&& sourceTable : sourceModel.getSourceTables())
     {
-        this->errorMessage("Failed to import area sources. Something went wrong");
-        // Reset the widget back to the input pane and close
-        theStackedWidget->setCurrentWidget(fileInputWidget);
-        fileInputWidget->setVisible(true);
-        return;
-    }
-
-    QDomNodeList areaSources = root.elementsByTagName("areaSource");
-
-    res = this->getAreaSources(&areaSources);
+        auto res = this->addSourceLayer(sourceTable);
 
-    if(res == -1)
-    {
-        this->errorMessage("Failed to import area sources. Something went wrong");
-        // Reset the widget back to the input pane and close
-        theStackedWidget->setCurrentWidget(fileInputWidget);
-        fileInputWidget->setVisible(true);
-        return;
+        if(res == -1)
+        {
+            this->errorMessage("Failed to import the sources of type "+sourceTable.sourceType+". Something went wrong");
+            resetToInputPane();
+            return;
+        }
     }
 
     progressLabel->setVisible(false);
 
     // Reset the widget back to the input pane and close
-    theStackedWidget->setCurrentWidget(fileInputWidget);
-    fileInputWidget->setVisible(true);
+    resetToInputPane();
 
     if(theStackedWidget->isModal())
         theStackedWidget->close();
@@ -414,13 +314,14 @@ void OpenQuakeSelectionWidget::loadOpenQuakeXMLData(void)
         this->errorMessage("Failed to load OpenQuake sources");
     }
 
+    auto numSources = sourceModel.getNumSourcesInFile();
+
     auto numImportedSources = 0;
 
     if(pointReferenceLayer)
         numImportedSources += pointReferenceLayer->featureCount();
 
     if(lineReferenceLayer)
-
         numImportedSources += lineReferenceLayer->featureCount();
 
     if(areaReferenceLayer)
@@ -494,7 +395,7 @@ void OpenQuakeSelectionWidget::clear(void)
     xmlImportPathLineEdit->clear();
     xmlExportPathLineEdit->clear();
 
-    xmlGMs.clear();
+    sourceModel.clear();
 
     selectedLayerGroup.clear();
     referenceLayerGroup.clear();
@@ -538,632 +439,147 @@ void OpenQuakeSelectionWidget::clearSelection(void)
         areaReferenceLayer->removeSelection();
 }
 
-int OpenQuakeSelectionWidget::getPointSources(QDomNodeList* pointSources)
+int OpenQuakeSelectionWidget::addSourceLayer(const OQSourceTable& sourceTable)
 {
-
-    auto numSources = pointSources->size();
+    auto numSources = sourceTable.size();
     if(numSources == 0)
         return 0;
 
-    QDomNode firstItem = pointSources->item(0);
-
-    //auto nodeName = firstItem.nodeName();
-
-    QDomNamedNodeMap xmlAtrb = firstItem.attributes();
-
-    // Create the fields
-    QList<QgsField> attribFields;
-    for(int i = 0; i< xmlAtrb.size(); ++i)
-    {
-        QDomNode item = xmlAtrb.item(i);
-
-        auto name = item.nodeName();
-
-        attribFields.push_back(QgsField(name, QVariant::String));
-    }
+    // The sources are added to the reference layer of their geometry type, which is created the first time it is needed
+    QgsVectorLayer** layerPtr = nullptr;
 
-    // auto numFields = attribFields.size();
+    if(sourceTable.geometryType == OQSourceTable::Point)
+        layerPtr = &pointReferenceLayer;
+    else if(sourceTable.geometryType == OQSourceTable::Line)
+        layerPtr = &lineReferenceLayer;
+    else
+        layerPtr = &areaReferenceLayer;
 
-    QgsFeatureList featureList;
-    featureList.reserve(numSources);
-    for(int i = 0; i < numSources; ++i)
+    if(*layerPtr == nullptr)
     {
-        QDomNode item = pointSources->item(i);
-
-        QDomNamedNodeMap xmlAtrb = item.attributes();
-
-        auto numAtributes = xmlAtrb.size();
-
-        // create the feature attributes
-        QgsAttributes featAttributes(numAtributes);
-
-        // Get the feature attibutes
-        for(int i = 0; i< numAtributes; ++i)
-        {
-            QDomNode item = xmlAtrb.item(i);
-            auto val = item.nodeValue();
-
-            featAttributes[i] = val;
-        }
-
-        QDomNode geom = item.namedItem("pointGeometry").namedItem("gml:Point").namedItem("gml:pos");
-
-        if(geom.isNull())
-        {
-            this->errorMessage("Could not get geometry for node "+item.nodeName());
-            return -1;
-        }
-
-        auto val = geom.toElement().text();
-
-        // Split according to space
-        auto pointsList = val.split(" ",Qt::SkipEmptyParts);
-
-        // First number is lon, second is lat
-        bool OK = true;
-
-        auto longitude = pointsList[0].toDouble(&OK);
-
-        if(!OK)
-        {
-            this->errorMessage("Error converting longitude to double for node "+item.nodeName());
-            return -1;
-        }
+        QgsVectorLayer* layer = nullptr;
 
-        auto latitude = pointsList[1].toDouble(&OK);
+        if(sourceTable.geometryType == OQSourceTable::Point)
+            layer = theVisualizationWidget->addVectorLayer("Point", "Point Sources");
+        else if(sourceTable.geometryType == OQSourceTable::Line)
+            layer = theVisualizationWidget->addVectorLayer("linestring", sourceTable.sourceType == "simpleFaultSource" ? "Line Fault Sources" : "Line Sources");
+        else
+            layer = theVisualizationWidget->addVectorLayer("polygon", "Area Sources");
 
-        if(!OK)
+        if(layer == nullptr)
         {
-            this->errorMessage("Error converting latitude to double for node "+item.nodeName());
+            this->errorMessage("Error creating a layer");
             return -1;
         }
 
-        if(longitude == 0.0 || latitude == 0.0)
+        if(sourceTable.geometryType == OQSourceTable::Point)
         {
-            this->errorMessage("Error, zero lat lon values for node "+item.nodeName());
-            return -1;
+            theVisualizationWidget->createSymbolRenderer(Qgis::MarkerShape::Cross,Qt::black,2.0,layer);
         }
-
-        // Create the feature
-        QgsFeature feature;
-        feature.setGeometry(QgsGeometry::fromPointXY(QgsPointXY(longitude,latitude)));
-        feature.setAttributes(featAttributes);
-        featureList.append(feature);
-    }
-
-    pointReferenceLayer = theVisualizationWidget->addVectorLayer("Point", "Point Sources");
-
-    if(pointReferenceLayer == nullptr)
-    {
-        this->errorMessage("Error creating a layer");
-        return -1;
-    }
-
-    referenceLayerGroup.append(pointReferenceLayer);
-
-    auto dProvider = pointReferenceLayer->dataProvider();
-    auto res = dProvider->addAttributes(attribFields);
-
-    if(!res)
-    {
-        this->errorMessage("Error adding attribute fields to layer");
-        theVisualizationWidget->removeLayer(pointReferenceLayer);
-        return -1;
-    }
-
-    pointReferenceLayer->updateFields(); // tell the vector layer to fetch changes from the provider
-
-    dProvider->addFeatures(featureList);
-    pointReferenceLayer->updateExtents();
-
-    theVisualizationWidget->createSymbolRenderer(Qgis::MarkerShape::Cross,Qt::black,2.0,pointReferenceLayer);
-
-
-    return 0;
-}
-
-
-int OpenQuakeSelectionWidget::getCharacteristicComplexLineSources(QDomNodeList* lineSources, bool isCharacteristic)
-{
-
-    auto numSources = lineSources->size();
-    if(numSources == 0)
-        return 0;
-
-    QDomNode firstItem = lineSources->item(0);
-
-    // auto nodeName = firstItem.nodeName();
-
-    QDomNamedNodeMap xmlAtrb = firstItem.attributes();
-
-    // Create the fields
-    QList<QgsField> attribFields;
-    for(int i = 0; i< xmlAtrb.size(); ++i)
-    {
-        QDomNode item = xmlAtrb.item(i);
-
-        auto name = item.nodeName();
-
-        attribFields.push_back(QgsField(name, QVariant::String));
-    }
-
-    // auto numFields = attribFields.size();
-
-    auto getFeature = [=](const QStringList& pointsList, const QgsAttributes& featAttributes, const QDomNode& item) -> QgsFeature
-    {
-
-        QgsPolylineXY lineGeom;
-        for(int i = 0; i<pointsList.size()-1; i+=3)
+        else if(sourceTable.geometryType == OQSourceTable::Line)
         {
-            // First number is lon, second is lat
-            bool OK = true;
+            auto lineSymbol = new QgsLineSymbol();
 
-            auto longitude = pointsList[i].toDouble(&OK);
-
-            if(!OK)
-            {
-                this->errorMessage("Error converting longitude to double for node "+item.nodeName());
-                return -1;
-            }
+            lineSymbol->setWidth(0.75);
 
-            auto latitude = pointsList[i+1].toDouble(&OK);
-
-            if(!OK)
-            {
-                this->errorMessage("Error converting latitude to double for node "+item.nodeName());
-                return -1;
-            }
-
-            if(longitude == 0.0 || latitude == 0.0)
-            {
-                continue;
-                //this->errorMessage("Error, zero lat lon values for node "+item.nodeName());
-                //return -1;
-            }
-
-            lineGeom.append(QgsPointXY(longitude,latitude));
-        }
-
-        // Create the feature
-        QgsFeature feature;
-        feature.setGeometry(QgsGeometry::fromPolylineXY(lineGeom));
-        feature.setAttributes(featAttributes);
-
-        return feature;
-    };
-
-    QgsFeatureList featureList;
-    featureList.reserve(numSources);
-    for(int i = 0; i < numSources; ++i)
-    {
-        QDomNode item = lineSources->item(i);
-
-        QDomNamedNodeMap xmlAtrb = item.attributes();
-
-        auto numAtributes = xmlAtrb.size();
-
-        // create the feature attributes
-        QgsAttributes featAttributes(numAtributes);
-
-        // Get the feature attibutes
-        for(int i = 0; i< numAtributes; ++i)
-        {
-            QDomNode item = xmlAtrb.item(i);
-            auto val = item.nodeValue();
-
-            featAttributes[i] = val;
+            theVisualizationWidget->createSimpleRenderer(lineSymbol,layer);
         }
-
-        // The top edge of the fault
-        QDomNode topEdgeGeom;
-
-        if(isCharacteristic)
-            topEdgeGeom = item.namedItem("surface");
         else
-            topEdgeGeom = item;
-
-        topEdgeGeom = topEdgeGeom.namedItem("complexFaultGeometry").namedItem("faultTopEdge").namedItem("gml:LineString").namedItem("gml:posList");
-
-        if(topEdgeGeom.isNull())
-        {
-            this->errorMessage("Could not get geometry for node "+item.nodeName());
-            return -1;
-        }
-
-        auto topVal = topEdgeGeom.toElement().text();
-
-        // Split according to space
-        auto topEdgepointsList = topVal.split(" ",Qt::SkipEmptyParts);
-
-        auto topEdgefeature = getFeature(topEdgepointsList,featAttributes,item);
-
-        featureList.append(topEdgefeature);
-
-        // The bottom edge of the fault
-        //        QDomNode bottomEdgeGeom;
-
-        //        if(isCharacteristic)
-        //            bottomEdgeGeom = item.namedItem("surface");
-        //        else
-        //            bottomEdgeGeom = item;
-
-        //        bottomEdgeGeom = bottomEdgeGeom.namedItem("complexFaultGeometry").namedItem("faultBottomEdge").namedItem("gml:LineString").namedItem("gml:posList");
-
-
-        //        if(bottomEdgeGeom.isNull())
-        //        {
-        //            this->errorMessage("Could not get geometry for node "+item.nodeName());
-        //            return -1;
-        //        }
-
-        //        auto botVal = bottomEdgeGeom.toElement().text();
-
-        //        // Split according to space
-        //        auto botEdgepointsList = botVal.split(" ",Qt::SkipEmptyParts);
-
-        //        auto botEdgefeature = getFeature(botEdgepointsList,featAttributes,item);
-
-        //        featureList.append(botEdgefeature);
-    }
-
-    if(lineReferenceLayer == nullptr)
-    {
-        lineReferenceLayer = theVisualizationWidget->addVectorLayer("linestring", "Line Sources");
-
-        if(lineReferenceLayer == nullptr)
         {
-            this->errorMessage("Error creating a layer");
-            return -1;
-        }
+            auto markerSymbol = new QgsFillSymbol();
 
-        referenceLayerGroup.append(lineReferenceLayer);
+            markerSymbol->setColor(Qt::darkGray);
+            markerSymbol->setOpacity(0.30);
 
-        auto dProvider = lineReferenceLayer->dataProvider();
-        auto res = dProvider->addAttributes(attribFields);
-
-        if(!res)
-        {
-            this->errorMessage("Error adding attribute fields to layer");
-            theVisualizationWidget->removeLayer(lineReferenceLayer);
-            return -1;
+            theVisualizationWidget->createSimpleRenderer(markerSymbol,layer);
         }
 
-        lineReferenceLayer->updateFields(); // tell the vector layer to fetch changes from the provider
-
-        dProvider->addFeatures(featureList);
-        lineReferenceLayer->updateExtents();
+        referenceLayerGroup.append(layer);
 
-        auto lineSymbol = new QgsLineSymbol();
-
-        lineSymbol->setWidth(0.75);
-
-        theVisualizationWidget->createSimpleRenderer(lineSymbol,lineReferenceLayer);
+        *layerPtr = layer;
     }
-    else
-    {
-        auto dProvider = lineReferenceLayer->dataProvider();
-
-        auto res = dProvider->addFeatures(featureList);
-
-        if(!res)
-        {
-            this->errorMessage("Error adding features to layer");
-            theVisualizationWidget->removeLayer(lineReferenceLayer);
-            return -1;
-        }
-
-        lineReferenceLayer->updateExtents();
-    }
-
-    return 0;
-}
 
+    auto layer = *layerPtr;
+    auto dProvider = layer->dataProvider();
 
-int OpenQuakeSelectionWidget::getSimpleFaultSources(QDomNodeList* lineSources)
-{
-
-    auto numSources = lineSources->size();
-    if(numSources == 0)
-        return 0;
-
-    QDomNode firstItem = lineSources->item(0);
-
-    // auto nodeName = firstItem.nodeName();
-
-    QDomNamedNodeMap xmlAtrb = firstItem.attributes();
-
-    // Create the fields
+    // Add the typed fields of this source type that are not in the layer yet
     QList<QgsField> attribFields;
-    for(int i = 0; i< xmlAtrb.size(); ++i)
-    {
-        QDomNode item = xmlAtrb.item(i);
-
-        auto name = item.nodeName();
-
-        attribFields.push_back(QgsField(name, QVariant::String));
-    }
-
-    // auto numFields = attribFields.size();
-
-    auto getFeature = [=](const QStringList& pointsList, const QgsAttributes& featAttributes, const QDomNode& item) -> QgsFeature
-    {
-
-        QgsPolylineXY lineGeom;
-        for(int i = 0; i<pointsList.size()-1; i+=2)
-        {
-            // First number is lon, second is lat
-            bool OK = true;
-
-            auto longitude = pointsList[i].toDouble(&OK);
-
-            if(!OK)
-            {
-                this->errorMessage("Error converting longitude to double for node "+item.nodeName());
-                return -1;
-            }
-
-            auto latitude = pointsList[i+1].toDouble(&OK);
-
-            if(!OK)
-            {
-                this->errorMessage("Error converting latitude to double for node "+item.nodeName());
-                return -1;
-            }
-
-            if(longitude == 0.0 || latitude == 0.0)
-            {
-                continue;
-                //this->errorMessage("Error, zero lat lon values for node "+item.nodeName());
-                //return -1;
-            }
-
-            lineGeom.append(QgsPointXY(longitude,latitude));
-        }
-
-        // Create the feature
-        QgsFeature feature;
-        feature.setGeometry(QgsGeometry::fromPolylineXY(lineGeom));
-        feature.setAttributes(featAttributes);
-
-        return feature;
-    };
-
-    QgsFeatureList featureList;
-    featureList.reserve(numSources);
-    for(int i = 0; i < numSources; ++i)
+    for(auto&& column : sourceTable.columns)
     {
-        QDomNode item = lineSources->item(i);
-
-        QDomNamedNodeMap xmlAtrb = item.attributes();
-
-        auto numAtributes = xmlAtrb.size();
-
-        // create the feature attributes
-        QgsAttributes featAttributes(numAtributes);
-
-        // Get the feature attibutes
-        for(int i = 0; i< numAtributes; ++i)
-        {
-            QDomNode item = xmlAtrb.item(i);
-            auto val = item.nodeValue();
-
-            featAttributes[i] = val;
-        }
-
-        // The top edge of the fault
-        QDomNode edgeGeom = item.namedItem("simpleFaultGeometry").namedItem("gml:LineString").namedItem("gml:posList");
-
-        if(edgeGeom.isNull())
-        {
-            this->errorMessage("Could not get geometry for node "+item.nodeName());
-            return -1;
-        }
-
-        auto lineVal = edgeGeom.toElement().text();
-
-        // Split according to space
-        auto linePointsList = lineVal.split(" ",Qt::SkipEmptyParts);
-
-        auto linefeature = getFeature(linePointsList,featAttributes,item);
-
-        featureList.append(linefeature);
-
+        if(layer->fields().indexOf(column.name) == -1)
+            attribFields.push_back(QgsField(column.name, column.type()));
     }
 
-    if(lineReferenceLayer == nullptr)
+    if(!attribFields.isEmpty())
     {
-        lineReferenceLayer = theVisualizationWidget->addVectorLayer("linestring", "Line Fault Sources");
-
-        if(lineReferenceLayer == nullptr)
-        {
-            this->errorMessage("Error creating a layer");
-            return -1;
-        }
-
-        referenceLayerGroup.append(lineReferenceLayer);
-
-        auto dProvider = lineReferenceLayer->dataProvider();
         auto res = dProvider->addAttributes(attribFields);
 
         if(!res)
         {
             this->errorMessage("Error adding attribute fields to layer");
-            theVisualizationWidget->removeLayer(lineReferenceLayer);
+            referenceLayerGroup.removeAll(layer);
+            theVisualizationWidget->removeLayer(layer);
+            *layerPtr = nullptr;
             return -1;
         }
 
-        lineReferenceLayer->updateFields(); // tell the vector layer to fetch changes from the provider
-
-        dProvider->addFeatures(featureList);
-        lineReferenceLayer->updateExtents();
-
-        auto lineSymbol = new QgsLineSymbol();
-
-        lineSymbol->setWidth(0.75);
-
-        theVisualizationWidget->createSimpleRenderer(lineSymbol,lineReferenceLayer);
+        layer->updateFields(); // tell the vector layer to fetch changes from the provider
     }
-    else
-    {
-        auto dProvider = lineReferenceLayer->dataProvider();
 
-        auto res = dProvider->addFeatures(featureList);
+    const auto layerFields = layer->fields();
+    const auto numFields = layerFields.size();
 
-        if(!res)
-        {
-            this->errorMessage("Error adding features to layer");
-            theVisualizationWidget->removeLayer(lineReferenceLayer);
-            return -1;
-        }
+    QVector<int> fieldIndexes;
+    for(auto&& column : sourceTable.columns)
+        fieldIndexes.push_back(layerFields.indexOf(column.name));
 
-        lineReferenceLayer->updateExtents();
-    }
-
-    return 0;
-}
-
-
-int OpenQuakeSelectionWidget::getAreaSources(QDomNodeList* lineSources)
-{
-
-    auto numSources = lineSources->size();
-    if(numSources == 0)
-        return 0;
-
-    QDomNode firstItem = lineSources->item(0);
-
-    // auto nodeName = firstItem.nodeName();
-
-    QDomNamedNodeMap xmlAtrb = firstItem.attributes();
-
-    // Create the fields
-    QList<QgsField> attribFields;
-    for(int i = 0; i< xmlAtrb.size(); ++i)
-    {
-        QDomNode item = xmlAtrb.item(i);
-
-        auto name = item.nodeName();
-
-        attribFields.push_back(QgsField(name, QVariant::String));
-    }
-
-    // auto numFields = attribFields.size();
-
-    auto getFeature = [=](const QStringList& pointsList, const QgsAttributes& featAttributes, const QDomNode& item) -> QgsFeature
-    {
-
-        QgsPolygonXY polygon;
-        QgsPolylineXY polyLineRing;
-        for(int i = 0; i<pointsList.size()-1; i+=2)
-        {
-            // First number is lon, second is lat
-            bool OK = true;
-
-            auto longitude = pointsList[i].toDouble(&OK);
-
-            if(!OK)
-            {
-                this->errorMessage("Error converting longitude to double for node "+item.nodeName());
-                return -1;
-            }
-
-            auto latitude = pointsList[i+1].toDouble(&OK);
-
-            if(!OK)
-            {
-                this->errorMessage("Error converting latitude to double for node "+item.nodeName());
-                return -1;
-            }
-
-            if(longitude == 0.0 || latitude == 0.0)
-                continue;
-
-
-            polyLineRing.append(QgsPointXY(longitude,latitude));
-        }
-
-        polygon.append(polyLineRing);
-
-        // Create the feature
-        QgsFeature feature;
-        feature.setGeometry(QgsGeometry::fromPolygonXY(polygon));
-        feature.setAttributes(featAttributes);
-
-        return feature;
-    };
+    const auto numColumns = sourceTable.columns.size();
 
     QgsFeatureList featureList;
     featureList.reserve(numSources);
     for(int i = 0; i < numSources; ++i)
     {
-        QDomNode item = lineSources->item(i);
-
-        QDomNamedNodeMap xmlAtrb = item.attributes();
-
-        auto numAtributes = xmlAtrb.size();
-
         // create the feature attributes
-        QgsAttributes featAttributes(numAtributes);
+        QgsAttributes featAttributes(numFields);
 
-        // Get the feature attibutes
-        for(int i = 0; i< numAtributes; ++i)
-        {
-            QDomNode item = xmlAtrb.item(i);
-            auto val = item.nodeValue();
+        for(int j = 0; j<numColumns; ++j)
+            featAttributes[fieldIndexes.at(j)] = sourceTable.columns.at(j).value(i);
 
-            featAttributes[i] = val;
-        }
+        QgsFeature feature;
 
-        // The top edge of the fault
-        QDomNode polygonGeom = item.namedItem("areaGeometry").namedItem("gml:Polygon").namedItem("gml:exterior").namedItem("gml:LinearRing").namedItem("gml:posList");
+        auto numPoints = sourceTable.getNumPoints(i);
 
-        if(polygonGeom.isNull())
+        if(sourceTable.geometryType == OQSourceTable::Point)
         {
-            this->errorMessage("Could not get geometry for node "+item.nodeName());
-            return -1;
+            feature.setGeometry(QgsGeometry::fromPointXY(QgsPointXY(sourceTable.getLongitude(i,0),sourceTable.getLatitude(i,0))));
         }
+        else
+        {
+            QgsPolylineXY lineGeom;
+            lineGeom.reserve(numPoints);
 
-        auto posList = polygonGeom.toElement().text();
-
-        // Split according to space
-        auto polygonPointsList = posList.split(" ",Qt::SkipEmptyParts);
-
-        auto polygonFeature = getFeature(polygonPointsList,featAttributes,item);
-
-        featureList.append(polygonFeature);
-    }
+            for(int j = 0; j<numPoints; ++j)
+                lineGeom.append(QgsPointXY(sourceTable.getLongitude(i,j),sourceTable.getLatitude(i,j)));
 
-    areaReferenceLayer = theVisualizationWidget->addVectorLayer("polygon", "Area Sources");
+            if(sourceTable.geometryType == OQSourceTable::Line)
+                feature.setGeometry(QgsGeometry::fromPolylineXY(lineGeom));
+            else
+                feature.setGeometry(QgsGeometry::fromPolygonXY(QgsPolygonXY() << lineGeom));
+        }
 
-    if(areaReferenceLayer == nullptr)
-    {
-        this->errorMessage("Error creating a layer");
-        return -1;
+        feature.setAttributes(featAttributes);
+        featureList.append(feature);
     }
 
-    referenceLayerGroup.append(areaReferenceLayer);
-
-    auto dProvider = areaReferenceLayer->dataProvider();
-    auto res = dProvider->addAttributes(attribFields);
+    auto res = dProvider->addFeatures(featureList);
 
     if(!res)
     {
-        this->errorMessage("Error adding attribute fields to layer");
-        theVisualizationWidget->removeLayer(areaReferenceLayer);
+        this->errorMessage("Error adding features to layer");
         return -1;
     }
 
-    areaReferenceLayer->updateFields(); // tell the vector layer to fetch changes from the provider
-
-    dProvider->addFeatures(featureList);
-    areaReferenceLayer->updateExtents();
-
-    auto markerSymbol = new QgsFillSymbol();
-
-    markerSymbol->setColor(Qt::darkGray);
-    markerSymbol->setOpacity(0.30);
-
-    theVisualizationWidget->createSimpleRenderer(markerSymbol,areaReferenceLayer);
+    layer->updateExtents();
 
     return 0;
 }
@@ -1376,79 +792,16 @@ void OpenQuakeSelectionWidget::handleSelectionDone(void)
         return;
     }
 
-    auto exportDoc = QDomDocument();
-
-    exportDoc.setContent(xmlGMs.toString());
-
-    auto root = exportDoc.documentElement();
-
-    QDomNodeList sourceModelList = root.elementsByTagName("sourceModel");
-
-    QVector<QDomNode> nodesToKeep;
-
-    // Lambda to do a one deep nested search for nodes
-    std::function<void(QDomNodeList&,bool)> nestedSearch = [&](QDomNodeList& list, bool checkChildren){
-
-        for(int i = 0; i<list.size(); ++i)
-        {
-            auto it = list.at(i);
-
-            auto nodeAttb = it.attributes();
-
-            auto id = nodeAttb.namedItem("id").nodeValue();
+    // Stream the selected sources from the original file into the new file
+    QString err;
+    auto res = sourceModel.exportSources(QSet<QString>(selectedIds.begin(), selectedIds.end()), filePathToSave, err);
 
-            if(!id.isEmpty())
-            {
-                if(selectedIds.contains(id))
-                    nodesToKeep.push_back(it);
-            }
-            else
-            {
-                auto childNodes = it.childNodes();
-
-                if(!childNodes.isEmpty() && checkChildren == true)
-                    nestedSearch(childNodes,false);
-            }
-        }
-    };
-
-
-    nestedSearch(sourceModelList,true);
-
-    if(nodesToKeep.size() != selectedIds.size())
-    {
-        this->errorMessage("Failed to find all of the selected nodes. Export failed!");
-        return;
-    }
-
-    auto sourceModelElem = root.firstChildElement("sourceModel");
-
-    auto nodes = sourceModelElem.childNodes();
-
-    // Remove the old nodes from the source model
-    while(!nodes.isEmpty())
-    {
-        QDomNode node = nodes.at(0);
-        node.parentNode().removeChild(node);
-    }
-
-    // Put back the nodes we want to keep
-    for(auto&& it : nodesToKeep)
-        sourceModelElem.appendChild(it);
-
-
-    // Save the new xml file
-    QFile file(filePathToSave);
-    if( !file.open( QIODevice::WriteOnly | QIODevice::Text ) )
+    if(!res)
     {
-        this->errorMessage("Failed to open file for writing.");
+        this->errorMessage(err);
         return;
     }
 
-    QTextStream stream( &file );
-    stream << exportDoc.toString();
-    file.close();
-
     this->statusMessage("Successfully saved file to: "+filePathToSave);
 
     auto grp = theVisualizationWidget->getLayerGroup("OpenQuake Selected Sources");
@@ -39,8 +39,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 // Written by: Stevan Gavrilovic
 
 #include "SimCenterAppWidget.h"
-
-#include <qdom.h>
+#include "OpenQuakeSourceModel.h"
 
 class SimCenterMapcanvasWidget;
 class QGISVisualizationWidget;
@@ -50,7 +49,6 @@ class QgsMapLayer;
 class QgsVectorLayer;
 class QgsLayerTreeGroup;
 
-class QDomNodeList;
 class QStackedWidget;
 class QProgressBar;
 class QLabel;
@@ -94,20 +92,13 @@ private slots:
 private:
     void loadOpenQuakeXMLData(void);
 
-    QDomDocument xmlGMs;
+    OpenQuakeSourceModel sourceModel;
 
     QVector<QgsMapLayer*> referenceLayerGroup;
     QVector<QgsMapLayer*> selectedLayerGroup;
 
-    int getPointSources(QDomNodeList* pointSources);
-
-    int getCharacteristicComplexLineSources(QDomNodeList* lineSources, bool isCharacteristic);
-
-    int getSimpleFaultSources(QDomNodeList* lineSources);
-
-    int getComplexFaultSources(QDomNodeList* lineSources);
-
-    int getAreaSources(QDomNodeList* lineSources);
+    // Adds the sources of one type to the point, line or area reference layer
+    int addSourceLayer(const OQSourceTable& sourceTable);
 
     QWidget* fileInputWidget = nullptr;
     QProgressBar* progressBar = nullptr;
@@ -124,6 +124,16 @@ int PointAssetInputWidget::loadAssetVisualization()
 
     auto numAtrb = attribFields.size();
 
+    // Use the geometries from the inventory cache if it has them, otherwise create them and add them to the cache
+    auto useCachedGeometries = inventoryCache.hasGeometries() && inventoryCache.getRows().size() == nRows;
+
+    QVector<QgsGeometry> geometries;
+    if(!useCachedGeometries)
+        geometries.reserve(nRows);
+
+    QgsFeatureList featureList;
+    featureList.reserve(nRows);
+
     for(int i = 0; i<nRows; ++i)
     {
         // create the feature attributes
@@ -152,12 +162,22 @@ int PointAssetInputWidget::loadAssetVisualization()
             featureAttributes[2+j] = attrbVal;
         }
 
-        auto latitude = componentTableWidget->item(i,indexLatitude).toDouble();
-        auto longitude = componentTableWidget->item(i,indexLongitude).toDouble();
-
         QgsFeature feature;
         feature.setFields(featFields);
 
+        if(useCachedGeometries)
+        {
+            feature.setGeometry(inventoryCache.getGeometry(i));
+            feature.setAttributes(featureAttributes);
+
+            featureList.push_back(feature);
+
+            continue;
+        }
+
+        auto latitude = componentTableWidget->item(i,indexLatitude).toDouble();
+        auto longitude = componentTableWidget->item(i,indexLongitude).toDouble();
+
         // If a footprint is given use that
         if(indexFootprint != -1)
         {
@@ -197,19 +217,22 @@ int PointAssetInputWidget::loadAssetVisualization()
         if(!feature.isValid())
             return -1;
 
+        geometries.push_back(feature.geometry());
 
-        auto res = pr->addFeature(feature, QgsFeatureSink::FastInsert);
-        if(!res)
-        {
-            this->errorMessage("Error adding the feature to the layer");
-            return -1;
-        }
-
-        //        auto id = feature.id();
+        featureList.push_back(feature);
+    }
 
-        //        qDebug()<<id;
+    // Add all of the features in one call
+    auto resAdd = pr->addFeatures(featureList, QgsFeatureSink::FastInsert);
+    if(!resAdd)
+    {
+        this->errorMessage("Error adding the features to the layer");
+        return -1;
     }
 
+    if(!useCachedGeometries)
+        inventoryCache.setGeometries(geometries);
+
     mainLayer->commitChanges(true);
     mainLayer->updateExtents();
 
@@ -42,7 +42,6 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "HurricaneParameterWidget.h"
 
 #include "NodeHandle.h"
-#include "GridNode.h"
 #include "RectangleGrid.h"
 
 #include <QPushButton>
@@ -82,20 +81,35 @@ QGISHurricaneSelectionWidget::~QGISHurricaneSelectionWidget()
 }
 
 
-QgsVectorLayer* QGISHurricaneSelectionWidget::importHurricaneTrackData(const QString &eventFile, QString &err)
+void QGISHurricaneSelectionWidget::importHurricaneTrackData(const QString &eventFile)
 {
-    auto allHurricanesLayer = hurricaneImportTool->loadHurricaneDatabaseData(eventFile,err);
+    // A load that is still running is replaced by this one
+    if(loadingTask)
+        loadingTask->cancel();
 
-    // Set as the current layer so selection of tracks will register
-    mapViewSubWidget->setCurrentLayer(allHurricanesLayer);
+    loadingTask = hurricaneImportTool->loadHurricaneDatabaseData(eventFile, this, [this](QgsVectorLayer* allHurricanesLayer, const QString& err)
+    {
+        loadingTask.reset();
+
+        // Set as the current layer so selection of tracks will register
+        if(allHurricanesLayer != nullptr)
+            mapViewSubWidget->setCurrentLayer(allHurricanesLayer);
 
-    return allHurricanesLayer;
+        this->handleHurricaneTrackDataLoaded(err);
+    });
 }
 
 void QGISHurricaneSelectionWidget::clear(void)
 {
     HurricaneSelectionWidget::clear();
 
+    // The database that is still being read is not shown anymore
+    if(loadingTask)
+    {
+        loadingTask->cancel();
+        loadingTask.reset();
+    }
+
     hurricaneImportTool->clear();
 
     theVisualizationWidget->removeLayer(gridLayer);
@@ -286,7 +300,8 @@ void QGISHurricaneSelectionWidget::handleGridSelected(void)
     if(gridNodeVec.isEmpty())
         return;
 
-    auto mapCanvas = mapViewSubWidget->mapCanvas();
+    // Flat buffer of latitude, longitude pairs
+    auto numNodes = gridNodeVec.size()/2;
 
     // Create the fields
     QgsFields featFields;
@@ -306,18 +321,16 @@ void QGISHurricaneSelectionWidget::handleGridSelected(void)
     QStringList headerRow = {"GP_file", "Latitude", "Longitude"};
     gridData.push_back(headerRow);
 
-    for(int i = 0; i<gridNodeVec.size(); ++i)
-    {
-        auto gridNode = gridNodeVec.at(i);
+    featureList.reserve(numNodes);
 
+    for(int i = 0; i<numNodes; ++i)
+    {
         // The station id
         auto stationName = QString::number(i+1);
 
-        auto screenPoint = gridNode->getPoint();
-
         // The latitude and longitude
-        auto longitude = theVisualizationWidget->getLongFromScreenPoint(screenPoint,mapCanvas);
-        auto latitude = theVisualizationWidget->getLatFromScreenPoint(screenPoint,mapCanvas);
+        auto latitude = gridNodeVec.at(2*i);
+        auto longitude = gridNodeVec.at(2*i+1);
 
         WindFieldStation station(stationName,latitude,longitude);
 
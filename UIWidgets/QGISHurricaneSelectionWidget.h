@@ -77,7 +77,7 @@ public slots:
     void handleClearSelectAreaMap(void);
     void handleAreaSelected(void);
 
-    QgsVectorLayer* importHurricaneTrackData(const QString &eventFile, QString &err);
+    void importHurricaneTrackData(const QString &eventFile);
 
 private slots:
 
@@ -99,6 +99,9 @@ signals:
 private:
 
     std::unique_ptr<QGISHurricanePreprocessor> hurricaneImportTool;
+
+    // The database that is being read in the background, if any
+    std::shared_ptr<TaskContext> loadingTask;
     QGISVisualizationWidget* theVisualizationWidget = nullptr;
 
     QgsFeature selectedHurricaneFeature;
@@ -47,8 +47,15 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "ComponentDatabaseManager.h"
 #include "ComponentDatabase.h"
 #include "CRSSelectionWidget.h"
+#include "StagingQueue.h"
+#include "TaskRunner.h"
+#include "Utils/ProgramOutputDialog.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdlib>
+#include <memory>
+#include <vector>
 
 #include <QApplication>
 #include <QDialog>
@@ -65,6 +72,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QPushButton>
 #include <QSpacerItem>
 #include <QStackedWidget>
+#include <QThread>
 #include <QVBoxLayout>
 #include <QDir>
 
@@ -490,7 +498,9 @@ bool RasterHazardInputWidget::copyFiles(QString &destDir)
     }
 
 
-    QVector<QStringList> pointDataVector;
+    // Get the asset locations in the GUI thread, the sampling and the writing of the files is done in the thread pool
+    QVector<double> xCoords;
+    QVector<double> yCoords;
 
     // Iterate through the asset databases
     for(auto&& theAssetDB :  theAssetDBs)
@@ -503,7 +513,8 @@ bool RasterHazardInputWidget::copyFiles(QString &destDir)
 
         auto numPoints = theAssetDB->getSelectedLayer()->featureCount();
 
-        pointDataVector.reserve(pointDataVector.size() + numPoints);
+        xCoords.reserve(xCoords.size() + numPoints);
+        yCoords.reserve(yCoords.size() + numPoints);
 
         QgsFeatureIterator fit = theAssetDB->getSelectedLayer()->getFeatures();
 
@@ -545,83 +556,167 @@ bool RasterHazardInputWidget::copyFiles(QString &destDir)
                 y = centroid.y();
             }
 
-            auto xstr = QString::number(x,'g', 10);
-            auto ystr = QString::number(y,'g', 10);
+            xCoords.push_back(x);
+            yCoords.push_back(y);
+        }
+    }
 
-            QStringList pointData;
-            pointData.append(xstr);
-            pointData.append(ystr);
+    if(dataProvider == nullptr)
+    {
+        this->errorMessage("Error, attempting to sample a raster layer that has not been loaded");
+        return false;
+    }
 
-            for(int i = 0; i< selectedIMs.size(); ++i)
-            {
-                auto val = this->sampleRaster(x, y, i+1);
-                auto valStr = QString::number(val);
+    auto numAssets = xCoords.size();
 
-                pointData.append(valStr);
-            }
+    // The raster data provider is not thread safe, so every block of assets samples from its own clone of the provider
+    // The clones are made here in the GUI thread, one per thread is enough
+    auto numBlocks = std::max(1, std::min(QThread::idealThreadCount(), (numAssets+255)/256));
+    auto blockSize = (numAssets+numBlocks-1)/numBlocks;
+
+    std::vector<std::unique_ptr<QgsRasterDataProvider>> providers;
+    for(int i = 0; i<numBlocks; ++i)
+    {
+        auto clone = dataProvider->clone();
 
-            pointDataVector.push_back(pointData);
+        if(clone == nullptr)
+        {
+            this->errorMessage("Error, could not create a copy of the raster data provider for sampling");
+            return false;
         }
+
+        providers.emplace_back(clone);
     }
 
-    // Save the hazards as a bunch of csv files
-    if(!asHdf5)
+    this->statusMessage("Sampling the raster at "+QString::number(numAssets)+" assets");
+
+    // The sampling and the writing of the files are deferred with the other staging jobs, the job only uses the copies that it is given here
+    auto sharedProviders = std::make_shared<std::vector<std::unique_ptr<QgsRasterDataProvider>>>(std::move(providers));
+    const auto saveAsHdf5 = asHdf5;
+    const auto eventFilePath = pathToEventFile;
+
+    auto sampleJob = [xCoords, yCoords, numAssets, numBands, numBlocks, blockSize, sharedProviders, saveAsHdf5, selectedIMs, destDir, eventFilePath](QString& err)
     {
-        CSVReaderWriter csvTool;
+        // The job has no progress to report, so it uses a context of its own
+        TaskContext context;
 
-        // First create the event grid file
-        QVector<QStringList> gridData;
+        QVector<double> sampledValues(numAssets*numBands);
+        std::atomic<int> numFailedSamples(0);
 
-        QStringList headerRow = {"GP_file", "Latitude", "Longitude"};
-        gridData.push_back(headerRow);
+        // Get the raw pointers before going parallel so that the vectors are not detached in the worker threads
+        const double* xData = xCoords.constData();
+        const double* yData = yCoords.constData();
+        double* values = sampledValues.data();
+
+        TaskRunner::parallelFor(context, numBlocks, [&](int block)
+        {
+            auto provider = (*sharedProviders)[block].get();
+
+            const auto end = std::min(numAssets, (block+1)*blockSize);
+
+            for(int i = block*blockSize; i<end; ++i)
+            {
+                QgsPointXY point(xData[i],yData[i]);
+
+                for(int j = 0; j<numBands; ++j)
+                {
+                    // Use the sample method as this is considerably more efficient than identify
+                    bool OK;
+                    auto val = provider->sample(point,j+1,&OK);
 
-        // QStringList stationHeader = bandNames;
+                    if(!OK)
+                    {
+                        val = 0.0;
+                        ++numFailedSamples;
+                    }
 
-        QApplication::processEvents();
+                    values[i*numBands+j] = val;
+                }
+            }
+        }, 1);
 
-        for(int i = 0; i<pointDataVector.size(); ++i)
+        // The warning goes to the output dialog in the GUI thread
+        if(numFailedSamples > 0)
         {
-            auto stationFile = "Site_"+QString::number(i)+".csv";
+            auto msg = "Warning, error sampling the raster at "+QString::number(numFailedSamples)+" asset locations, the assets may be out of bounds. Setting the raster values to zero at these locations";
+
+            auto outputDialog = ProgramOutputDialog::getInstance();
+            QMetaObject::invokeMethod(outputDialog, [outputDialog, msg]()
+            {
+                outputDialog->appendInfoMessage(msg);
+            }, Qt::QueuedConnection);
+        }
 
-            auto point = pointDataVector.at(i);
+        // Save the hazards as a bunch of csv files
+        if(saveAsHdf5)
+            return true;
 
-            auto lon = point.at(0);
-            auto lat = point.at(1);
+        QVector<QString> errors(numAssets);
+        QString* errorData = errors.data();
 
-            // Get the grid row
-            QStringList gridRow = {stationFile, lat, lon};
-            gridData.push_back(gridRow);
+        TaskRunner::parallelFor(context, numAssets, [&](int i)
+        {
+            auto stationFile = "Site_"+QString::number(i)+".csv";
 
-            QStringList stationRow = {point.begin()+2,point.end()};
+            QStringList stationRow;
+            for(int j = 0; j<numBands; ++j)
+                stationRow.append(QString::number(values[i*numBands+j]));
 
             // Save the station data
-            QVector<QStringList> stationData = {selectedIMs};
-						
-
-            stationData.push_back(stationRow);
+            QVector<QStringList> stationData = {selectedIMs, stationRow};
 
             QString pathToStationFile = destDir + QDir::separator() + stationFile;
 
-            QString err;
-            auto res2 = csvTool.saveCSVFile(stationData, pathToStationFile, err);
-            if(res2 != 0)
+            CSVReaderWriter csvTool;
+            auto res2 = csvTool.saveCSVFile(stationData, pathToStationFile, errorData[i]);
+            if(res2 != 0 && errorData[i].isEmpty())
+                errorData[i] = "Error saving the file "+pathToStationFile;
+        });
+
+        // Report the first error in the order of the sites so that the message does not depend on the thread timing
+        for(auto&& it : errors)
+        {
+            if(!it.isEmpty())
             {
-                this->errorMessage(err);
+                err = it;
                 return false;
             }
-
         }
 
-        // Now save the site grid .csv file
-        QString err2;
-        auto res2 = csvTool.saveCSVFile(gridData, pathToEventFile, err2);
-        if(res2 != 0)
+        // Now create the event grid file
+        QVector<QStringList> gridData;
+        gridData.reserve(numAssets+1);
+
+        QStringList headerRow = {"GP_file", "Latitude", "Longitude"};
+        gridData.push_back(headerRow);
+
+        for(int i = 0; i<numAssets; ++i)
         {
-            this->errorMessage(err2);
-            return false;
+            auto stationFile = "Site_"+QString::number(i)+".csv";
+
+            auto lon = QString::number(xData[i],'g', 10);
+            auto lat = QString::number(yData[i],'g', 10);
+
+            // Get the grid row
+            QStringList gridRow = {stationFile, lat, lon};
+            gridData.push_back(gridRow);
         }
-    }
 
+        // Now save the site grid .csv file
+        CSVReaderWriter csvTool;
+        auto res2 = csvTool.saveCSVFile(gridData, eventFilePath, err);
+
+        return res2 == 0;
+    };
+
+    QString err;
+    auto res = StagingQueue::runOrDefer(sampleJob, err);
+
+    if(!res)
+    {
+        this->errorMessage(err);
+        return false;
+    }
 
     return true;
 }
@@ -41,7 +41,10 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "RegionalSiteResponseWidget.h"
 #include "VisualizationWidget.h"
 #include "WorkflowAppR2D.h"
+#include "SimCenterUnitsCombo.h"
 #include "SimCenterUnitsWidget.h"
+#include "StationLayerBuilder.h"
+#include "TaskRunner.h"
 #include "SiteWidget.h"
 #include "SiteConfig.h"
 #include "SiteConfigWidget.h"
@@ -51,9 +54,10 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "Vs30Widget.h"
 #include "BedrockDepthWidget.h"
 #include "SoilModelWidget.h"
-#include "GridNode.h"
 #include "SimCenterPreferences.h"
 #include "QGISSiteInputWidget.h"
+#include "SiteResponseEngine.h"
+#include "GroundMotionStation.h"
 
 #include "QGISVisualizationWidget.h"
 
@@ -64,6 +68,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 #include <QApplication>
 #include <QDialog>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QFileDialog>
 #include <QFileInfo>
@@ -79,9 +84,148 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QDir>
 #include <QGroupBox>
 #include <QGridLayout>
+#include <QHBoxLayout>
+#include <QHash>
 #include <QByteArray>
+#include <QJsonObject>
+#include <QSet>
 #include <QStringList>
 
+#include <cmath>
+#include <memory>
+
+namespace
+{
+
+// The number of OpenSees stations that are compared in the validation
+const int validationSampleSize = 10;
+
+// The sites in a filter string such as 1-10,15
+QSet<int> getFilteredIDs(const QString& filter)
+{
+    QSet<int> IDs;
+
+    for(auto&& it : filter.split(",", QString::SkipEmptyParts))
+    {
+        auto range = it.split("-", QString::SkipEmptyParts);
+
+        bool OK1 = false, OK2 = false;
+        auto first = range.value(0).trimmed().toInt(&OK1);
+        auto last = range.size() > 1 ? range.at(1).trimmed().toInt(&OK2) : first;
+
+        if(!OK1 || (range.size() > 1 && !OK2))
+            continue;
+
+        for(int id = first; id<=last; ++id)
+            IDs.insert(id);
+    }
+
+    return IDs;
+}
+
+
+// Index of the closest point, the distances are measured on the equirectangular projection which is enough to rank them
+int getClosestPoint(const double lat, const double lon, const QVector<double>& latitudes, const QVector<double>& longitudes)
+{
+    const auto cosLat = std::cos(lat*3.14159265358979323846/180.0);
+
+    int closest = -1;
+    double minDistance = 0.0;
+
+    for(int i = 0; i<latitudes.size(); ++i)
+    {
+        const auto dLat = latitudes.at(i) - lat;
+        const auto dLon = (longitudes.at(i) - lon)*cosLat;
+        const auto distance = dLat*dLat + dLon*dLon;
+
+        if(closest == -1 || distance < minDistance)
+        {
+            closest = i;
+            minDistance = distance;
+        }
+    }
+
+    return closest;
+}
+
+
+// Reads the motions listed in a station file, every horizontal component is a separate motion
+bool readStationMotions(const QString& stationFilePath, const double scaleToG, QVector<SiteResponseMotion>& motions, QString& err)
+{
+    GroundMotionStation station(stationFilePath, 0.0, 0.0);
+
+    try
+    {
+        station.importGroundMotions();
+    }
+    catch (const QString& msg)
+    {
+        err = msg;
+        return false;
+    }
+    catch (const char* msg)
+    {
+        err = QString(msg);
+        return false;
+    }
+
+    for(auto&& it : station.getStationGroundMotions())
+    {
+        const auto scale = scaleToG*it.getScalingFactor();
+
+        const QVector<QPair<QString, QVector<double>>> components = {{"_x", it.getX()}, {"_y", it.getY()}};
+
+        for(auto&& component : components)
+        {
+            if(component.second.isEmpty())
+                continue;
+
+            SiteResponseMotion motion;
+            motion.name = it.getName() + component.first;
+            motion.dT = it.getDT();
+            motion.acceleration = component.second;
+
+            for(auto&& val : motion.acceleration)
+                val *= scale;
+
+            motions.push_back(motion);
+        }
+    }
+
+    return true;
+}
+
+
+// The result of the equivalent linear analysis in the background
+struct EquivalentLinearResult
+{
+    QVector<SiteResponseColumn> columns;
+    QVector<SiteResponseMotion> motions;
+    SiteResponseResults results;
+    QString err;
+    bool OK = false;
+};
+
+
+// The comparison of the equivalent linear analysis with the OpenSees results in the background
+struct ValidationResult
+{
+    // One row for every compared intensity measure
+    QVector<QStringList> comparison;
+
+    int numCompared = 0;
+    int numSkipped = 0;
+
+    QVector<int> numRatios;
+    QVector<double> sumLogRatio;
+    QVector<double> maxLogRatio;
+
+    QString err;
+    bool OK = false;
+};
+
+}
+
 RegionalSiteResponseWidget::RegionalSiteResponseWidget(VisualizationWidget* visWidget, QWidget *parent) : SimCenterAppWidget(parent), theVisualizationWidget(visWidget)
 {
     progressBar = nullptr;
@@ -464,6 +608,20 @@ QStackedWidget* RegionalSiteResponseWidget::getRegionalSiteResponseWidget(void)
         }
     );
 
+    // The equivalent linear analysis runs all of the sites in the application, its validation needs the surface motions of an OpenSees run
+    m_equivalentLinearButton = new QPushButton(tr("Run Equivalent Linear Analysis"));
+    m_validateButton = new QPushButton(tr("Validate Against OpenSees Results"));
+
+    connect(m_equivalentLinearButton, &QPushButton::clicked, this, &RegionalSiteResponseWidget::runEquivalentLinearAnalysis);
+    connect(m_validateButton, &QPushButton::clicked, this, &RegionalSiteResponseWidget::validateEquivalentLinearAnalysis);
+
+    QHBoxLayout* equivalentLinearLayout = new QHBoxLayout();
+    equivalentLinearLayout->addWidget(m_equivalentLinearButton);
+    equivalentLinearLayout->addWidget(m_validateButton);
+    equivalentLinearLayout->addStretch();
+
+    soilLayout->addLayout(equivalentLinearLayout, 1, 0, 1, 3);
+
 
     //soilLayout->addWidget(new QLabel("Filter"), 1, 0);
     filterLineEdit = new QLineEdit();
@@ -753,9 +911,6 @@ void RegionalSiteResponseWidget::loadUserGMData(void)
 
     this->showProgressBar();
 
-    QApplication::processEvents();
-
-    //progressBar->setRange(0,inputFiles.size());
     progressBar->setRange(0, data.count());
     progressBar->setValue(0);
 
@@ -785,19 +940,8 @@ void RegionalSiteResponseWidget::loadUserGMData(void)
     // Get the header file
     auto stationDataHeadings = sampleStationData.first();
 
-    // Create the fields
-    QList<QgsField> attribFields;
-    attribFields.push_back(QgsField("AssetType", QVariant::String));
-    attribFields.push_back(QgsField("TabName", QVariant::String));
-    attribFields.push_back(QgsField("Station Name", QVariant::String));
-    attribFields.push_back(QgsField("Latitude", QVariant::Double));
-    attribFields.push_back(QgsField("Longitude", QVariant::Double));
-
     for(auto&& it : stationDataHeadings)
-    {
-        attribFields.push_back(QgsField(it, QVariant::String));
         unitsWidget->addNewUnitItem(it);
-    }
 
     // Set the scale at which the layer will become visible - if scale is too high, then the entire view will be filled with symbols
     // gridLayer->setMinScale(80000);
@@ -805,164 +949,579 @@ void RegionalSiteResponseWidget::loadUserGMData(void)
     // Pop off the row that contains the header information
     data.pop_front();
 
-    auto numRows = data.size();
+    // Read the station files in parallel in the thread pool and wait for the result
+    // The longitude is in the second column and the latitude in the third column of the event grid
+    StationLayerBuilder layerBuilder("GroundMotionGridPoint", "Ground Motion Grid Point");
+    QgsFeatureList featureList;
 
-    int count = 0;
+    auto res = TaskRunner::getInstance()->runAndWait<bool>([&](TaskContext& context)
+    {
+        auto readStation = [](const QString& stationPath, const double lat, const double lon)
+        {
+            GroundMotionStation GMStation(stationPath,lat,lon);
+            GMStation.importGroundMotions();
 
-    auto maxToDisp = 20;
+            return GMStation.getStationData();
+        };
 
-    QgsFeatureList featureList;
-    // Get the data
-    for(int i = 0; i<numRows; ++i)
+        if(!layerBuilder.addStationFiles(data, motionDir, 2, 1, stationDataHeadings, readStation, err, &context))
+            return false;
+
+        return layerBuilder.createFeatures(featureList, err);
+    }, [this](const TaskProgress& progress){
+        progressBar->setRange(0, progress.total);
+        progressBar->setValue(progress.done);
+    });
+
+    if(!res)
     {
-        auto rowStr = data.at(i);
+        this->errorMessage(err);
+        this->hideProgressBar();
+        return;
+    }
 
-        auto stationName = rowStr[0];
+    auto vectorLayer = layerBuilder.createLayer(qgisVizWidget, "Ground Motion Input Grid", featureList, err);
+
+    if(vectorLayer == nullptr)
+    {
+        this->errorMessage(err);
+        this->hideProgressBar();
+        return;
+    }
+
+    progressLabel->setVisible(false);
+
+    // Reset the widget back to the input pane and close
+    this->hideProgressBar();
+
+    /*
+    if(theStackedWidget->isModal())
+        theStackedWidget->close();
+    */
+    
+   emit loadingComplete(true);
+
+    emit outputDirectoryPathChanged(motionDir, eventFile);
 
-        // Path to station files, e.g., site0.csv
-        auto stationPath = motionDir + QDir::separator() + stationName;
+    return;
+}
+
+double RegionalSiteResponseWidget::getMotionScaleToG(void)
+{
+    // The first acceleration unit is used for the motions, g is assumed if there is none
+    auto units = unitsWidget->getUnits();
+    for(auto&& unit : units)
+    {
+        auto unitType = SimCenter::Unit::fromString(unit);
 
-        bool ok;
-        auto lon = rowStr[1].toDouble(&ok);
+        if(unitType > SimCenter::Unit::ACCEL && unitType < SimCenter::Unit::DIMEMSIONLESS && !SimCenter::Unit::isLogarithmic(unitType))
+            return SimCenter::Unit::getScaleToSI(unitType)/SimCenter::Unit::getScaleToSI(SimCenter::Unit::g);
+    }
+
+    return 1.0;
+}
 
-        if(!ok)
+
+void RegionalSiteResponseWidget::setSiteResponseButtonsEnabled(const bool value)
+{
+    m_equivalentLinearButton->setEnabled(value);
+    m_validateButton->setEnabled(value);
+}
+
+
+bool RegionalSiteResponseWidget::loadSiteResponseInputs(const QString& pathToSiteFile, const QString& pathToEventFile, const QString& pathToMotionDir, const QString& soilModelType, const QString& filter, const double scaleToG,
+                                                        QVector<SiteResponseColumn>& columns, QVector<SiteResponseMotion>& motions, QVector<QVector<int>>& motionsOfSite,
+                                                        QString& err, TaskContext* context)
+{
+    CSVReaderWriter csvTool;
+
+    auto siteData = csvTool.parseCSVFile(pathToSiteFile, err);
+    if(!err.isEmpty())
+        return false;
+
+    if(siteData.size() < 2)
+    {
+        err = "The site data file " + pathToSiteFile + " is empty";
+        return false;
+    }
+
+    const auto headings = siteData.first();
+
+    auto indexLat = headings.indexOf("Latitude");
+    auto indexLon = headings.indexOf("Longitude");
+    auto indexVs30 = headings.indexOf("Vs30");
+    auto indexDepth = headings.indexOf("DepthToRock");
+    auto indexDensity = headings.indexOf("Den");
+    auto indexModel = headings.indexOf("Model");
+    auto indexID = headings.indexOf("ID");
+    if(indexID == -1)
+        indexID = headings.indexOf("Station");
+
+    if(indexLat == -1 || indexLon == -1 || indexVs30 == -1 || indexDepth == -1)
+    {
+        err = "The site data file needs the Latitude, Longitude, Vs30 and DepthToRock columns, please fetch the site data";
+        return false;
+    }
+
+    auto filteredIDs = getFilteredIDs(filter);
+
+    columns.clear();
+
+    for(int i = 1; i<siteData.size(); ++i)
+    {
+        const auto& row = siteData.at(i);
+
+        if(row.size() != headings.size())
+            continue;
+
+        auto siteID = indexID != -1 ? row.at(indexID) : QString::number(i-1);
+
+        if(!filteredIDs.isEmpty() && !filteredIDs.contains(siteID.toInt()))
+            continue;
+
+        // The soil model of the row takes precedence over the one in the soil model widget
+        auto model = indexModel != -1 ? row.at(indexModel) : soilModelType;
+        if(model.compare("USER", Qt::CaseInsensitive) == 0)
         {
-            QString errMsg = "Error longitude to a double, check the value";
-            this->errorMessage(errMsg);
+            err = "The equivalent linear analysis cannot run the user defined soil model of the site " + siteID + ", run the OpenSees workflow instead";
+            return false;
+        }
 
-            this->hideProgressBar();
+        bool OK1 = false, OK2 = false, OK3 = false, OK4 = false;
 
-            return;
+        SiteResponseColumn column;
+        column.siteID = siteID;
+        column.latitude = row.at(indexLat).toDouble(&OK1);
+        column.longitude = row.at(indexLon).toDouble(&OK2);
+
+        auto vs30 = row.at(indexVs30).toDouble(&OK3);
+        auto depthToRock = row.at(indexDepth).toDouble(&OK4);
+
+        if(!OK1 || !OK2 || !OK3 || !OK4)
+        {
+            err = "Could not read the location, Vs30 or DepthToRock of the site " + siteID;
+            return false;
         }
 
-        auto lat = rowStr[2].toDouble(&ok);
+        // A density of 2 t/m^3 is assumed if there is none
+        auto density = 2.0;
+        if(indexDensity != -1 && !row.at(indexDensity).isEmpty())
+            density = row.at(indexDensity).toDouble();
+
+        if(!SiteResponseEngine::createColumn(vs30, depthToRock, density, column, err))
+            return false;
+
+        columns.push_back(column);
+    }
+
+    if(columns.isEmpty())
+    {
+        err = "No sites were selected for the site response analysis";
+        return false;
+    }
+
+    // Every site gets the motions of the closest station of the event grid, as in the OpenSees workflow
+    auto eventData = csvTool.parseCSVFile(pathToEventFile, err);
+    if(!err.isEmpty())
+        return false;
 
-        if(!ok)
+    if(eventData.size() < 2)
+    {
+        err = "The event grid file " + pathToEventFile + " is empty";
+        return false;
+    }
+
+    eventData.pop_front();
+
+    const auto numStations = eventData.size();
+
+    QVector<double> stationLat(numStations);
+    QVector<double> stationLon(numStations);
+
+    for(int i = 0; i<numStations; ++i)
+    {
+        const auto& row = eventData.at(i);
+
+        if(row.size() < 3)
         {
-            QString errMsg = "Error latitude to a double, check the value";
-            this->errorMessage(errMsg);
+            err = "The row " + QString::number(i+1) + " of the event grid file needs the station file, longitude and latitude";
+            return false;
+        }
 
-            this->hideProgressBar();
+        stationLon[i] = row.at(1).toDouble();
+        stationLat[i] = row.at(2).toDouble();
+    }
 
-            return;
+    QVector<int> stationOfSite(columns.size());
+    QVector<int> usedStations;
+    QHash<int, int> indexOfStation;
+
+    for(int s = 0; s<columns.size(); ++s)
+    {
+        auto station = getClosestPoint(columns.at(s).latitude, columns.at(s).longitude, stationLat, stationLon);
+
+        stationOfSite[s] = station;
+
+        if(!indexOfStation.contains(station))
+        {
+            indexOfStation.insert(station, usedStations.size());
+            usedStations.push_back(station);
         }
+    }
+
+    // Read the motions of the stations that are used in parallel
+    QVector<QVector<SiteResponseMotion>> stationMotions(usedStations.size());
+    QVector<QString> errors(usedStations.size());
+
+    // Get the raw pointers before going parallel so that the vectors are not detached in the worker threads
+    auto motionsData = stationMotions.data();
+    auto errData = errors.data();
 
-        GroundMotionStation GMStation(stationPath,lat,lon);
+    TaskContext localContext;
+    auto& readContext = context ? *context : localContext;
 
-        try
+    readContext.setStatus("Reading the input motions");
+    readContext.setTotal(usedStations.size());
+    readContext.setProgress(0);
+
+    TaskRunner::parallelFor(readContext, usedStations.size(), [&](int i)
+    {
+        auto stationFilePath = pathToMotionDir + QDir::separator() + eventData.at(usedStations.at(i)).at(0);
+
+        readStationMotions(stationFilePath, scaleToG, motionsData[i], errData[i]);
+    }, 1);
+
+    if(readContext.isCanceled())
+    {
+        err = "The site response analysis was canceled";
+        return false;
+    }
+
+    // Report the first error in order so that the message does not depend on the thread timing
+    for(auto&& it : errors)
+    {
+        if(!it.isEmpty())
         {
-            GMStation.importGroundMotions();
+            err = it;
+            return false;
         }
-        catch(QString msg)
+    }
+
+    motions.clear();
+    QVector<int> firstMotionOfStation(usedStations.size());
+
+    for(int i = 0; i<usedStations.size(); ++i)
+    {
+        firstMotionOfStation[i] = motions.size();
+        motions.append(stationMotions.at(i));
+    }
+
+    motionsOfSite.resize(columns.size());
+
+    for(int s = 0; s<columns.size(); ++s)
+    {
+        auto i = indexOfStation.value(stationOfSite.at(s));
+
+        motionsOfSite[s].clear();
+        for(int m = 0; m<stationMotions.at(i).size(); ++m)
+            motionsOfSite[s].push_back(firstMotionOfStation.at(i) + m);
+    }
+
+    readContext.setStatus("Running the equivalent linear analysis");
+
+    return true;
+}
+
+
+void RegionalSiteResponseWidget::runEquivalentLinearAnalysis(void)
+{
+    if(eventFile.isEmpty() || motionDir.isEmpty())
+    {
+        this->statusMessage("Load the input motions before running the equivalent linear analysis");
+        return;
+    }
+
+    auto pathToSiteFile = soilFileLineEdit->text();
+    if(!QFileInfo::exists(pathToSiteFile))
+    {
+        this->statusMessage("Fetch or load the site data before running the equivalent linear analysis");
+        return;
+    }
+
+    // Read the widgets before going to the thread pool
+    auto soilModelType = m_soilModel->type().compare("User") == 0 ? QString("USER") : QString("EI");
+    auto filter = this->getFilterString();
+    auto scaleToG = this->getMotionScaleToG();
+    auto pathToEventFile = eventFile;
+    auto pathToMotionDir = motionDir;
+
+    auto runAnalysis = [this, pathToSiteFile, pathToEventFile, pathToMotionDir, soilModelType, filter, scaleToG](TaskContext& context)
+    {
+        EquivalentLinearResult result;
+        QVector<QVector<int>> motionsOfSite;
+
+        if(!this->loadSiteResponseInputs(pathToSiteFile, pathToEventFile, pathToMotionDir, soilModelType, filter, scaleToG, result.columns, result.motions, motionsOfSite, result.err, &context))
+            return result;
+
+        SiteResponseEngine engine;
+        result.OK = engine.run(result.columns, result.motions, motionsOfSite, result.results, result.err, &context);
+
+        return result;
+    };
+
+    auto timer = std::make_shared<QElapsedTimer>();
+    timer->start();
+
+    // Write the results in the GUI thread when the analysis is done
+    auto writeResults = [this, timer](const EquivalentLinearResult& result)
+    {
+        this->hideProgressBar();
+        this->setSiteResponseButtonsEnabled(true);
+
+        if(!result.OK)
         {
-            auto errorMessage = "Error importing ground motion file: " + stationName+"\n"+msg;
-            this->errorMessage(errorMessage);
+            this->errorMessage(result.err);
+            return;
+        }
 
-            this->hideProgressBar();
+        auto elapsed = timer->elapsed();
 
+        auto pathToResults = outputSiteDataDir + QDir::separator() + "SiteResponseIMs.csv";
+
+        QString err;
+        if(!SiteResponseEngine::writeResults(pathToResults, result.columns, result.motions, result.results, err))
+        {
+            this->errorMessage(err);
             return;
         }
 
-        auto stationData = GMStation.getStationData();
+        this->statusMessage("Ran the equivalent linear analysis of " + QString::number(result.results.numRecords()) + " motions at " + QString::number(result.columns.size())
+                            + " sites in " + QString::number(0.001*elapsed) + " s, the surface intensity measures are in " + pathToResults);
+    };
 
-        // create the feature attributes
-        QgsAttributes featAttributes(attribFields.size());
+    this->showProgressBar();
+    progressLabel->setVisible(true);
+    this->setSiteResponseButtonsEnabled(false);
 
-        auto latitude = GMStation.getLatitude();
-        auto longitude = GMStation.getLongitude();
+    TaskRunner::getInstance()->run<EquivalentLinearResult>(this, runAnalysis, writeResults, [this](const TaskProgress& progress){
+        progressLabel->setText(progress.status);
+        progressBar->setRange(0, progress.total);
+        progressBar->setValue(progress.done);
+    });
+}
 
-        featAttributes[0] = "GroundMotionGridPoint";     // "AssetType"
-        featAttributes[1] = "Ground Motion Grid Point";  // "TabName"
-        featAttributes[2] = stationName;                 // "Station Name"
-        featAttributes[3] = latitude;                    // "Latitude"
-        featAttributes[4] = longitude;                   // "Longitude"
 
-        // The number of headings in the file
-        auto numParams = stationData.front().size();
+void RegionalSiteResponseWidget::validateEquivalentLinearAnalysis(void)
+{
+    if(eventFile.isEmpty() || motionDir.isEmpty())
+    {
+        this->statusMessage("Load the input motions before validating the equivalent linear analysis");
+        return;
+    }
 
-        maxToDisp = (maxToDisp<stationData.size() ? maxToDisp : stationData.size());
+    auto pathToSiteFile = soilFileLineEdit->text();
+    if(!QFileInfo::exists(pathToSiteFile))
+    {
+        this->statusMessage("Fetch or load the site data before validating the equivalent linear analysis");
+        return;
+    }
+
+    // The OpenSees surface motions are listed in an event grid in the same format as the input motions
+    QString openSeesDir = QFileDialog::getExistingDirectory(this, tr("Folder Containing the OpenSees Surface Motions"));
+    if(openSeesDir.isEmpty())
+        return;
+
+    auto openSeesEventFile = openSeesDir + QDir::separator() + "EventGrid.csv";
+    if(!QFileInfo::exists(openSeesEventFile))
+    {
+        this->errorMessage("Could not find the file EventGrid.csv in the folder " + openSeesDir);
+        return;
+    }
+
+    auto soilModelType = m_soilModel->type().compare("User") == 0 ? QString("USER") : QString("EI");
+    auto filter = this->getFilterString();
+    auto scaleToG = this->getMotionScaleToG();
+    auto pathToEventFile = eventFile;
+    auto pathToMotionDir = motionDir;
+
+    auto periods = SiteResponseEngine().getPeriods();
+    auto imNames = SiteResponseEngine::getIntensityMeasureNames(periods);
+    auto numIMs = imNames.size();
 
-        QVector<QString> dataStrs(numParams);
+    auto compareMotions = [this, pathToSiteFile, pathToEventFile, pathToMotionDir, soilModelType, filter, scaleToG, openSeesDir, openSeesEventFile, periods, imNames, numIMs](TaskContext& context)
+    {
+        ValidationResult result;
+        result.comparison.push_back({"ID", "Motion", "IntensityMeasure", "EquivalentLinear", "OpenSees", "Ratio"});
+        result.numRatios.fill(0, numIMs);
+        result.sumLogRatio.fill(0.0, numIMs);
+        result.maxLogRatio.fill(0.0, numIMs);
+
+        SiteResponseEngine engine;
+
+        QVector<SiteResponseColumn> columns;
+        QVector<SiteResponseMotion> motions;
+        QVector<QVector<int>> motionsOfSite;
+
+        if(!this->loadSiteResponseInputs(pathToSiteFile, pathToEventFile, pathToMotionDir, soilModelType, filter, scaleToG, columns, motions, motionsOfSite, result.err, &context))
+            return result;
+
+        CSVReaderWriter csvTool;
+        auto openSeesData = csvTool.parseCSVFile(openSeesEventFile, result.err);
+        if(!result.err.isEmpty())
+            return result;
+
+        openSeesData.pop_front();
 
-        for(int i = 0; i<maxToDisp-1; ++i)
+        if(openSeesData.isEmpty())
         {
-            auto stationParams = stationData[i];
+            result.err = "The OpenSees event grid file " + openSeesEventFile + " is empty";
+            return result;
+        }
 
-            for(int j = 0; j<numParams; ++j)
+        QVector<double> siteLat;
+        QVector<double> siteLon;
+        for(auto&& it : columns)
+        {
+            siteLat.push_back(it.latitude);
+            siteLon.push_back(it.longitude);
+        }
+
+        // Take an evenly spaced sample of the OpenSees stations and match every one to the closest site
+        const auto sampleSize = std::min(validationSampleSize, static_cast<int>(openSeesData.size()));
+
+        QVector<SiteResponseColumn> sampleColumns;
+        QVector<QVector<int>> sampleMotionsOfSite;
+        QVector<QVector<SiteResponseMotion>> openSeesMotions;
+
+        context.setStatus("Reading the OpenSees surface motions");
+
+        for(int i = 0; i<sampleSize; ++i)
+        {
+            const auto& row = openSeesData.at(i*openSeesData.size()/sampleSize);
+
+            if(row.size() < 3)
             {
-                dataStrs[j] += stationParams[j] + ", ";
+                result.err = "The OpenSees event grid needs the station file, longitude and latitude in every row";
+                return result;
             }
+
+            auto site = getClosestPoint(row.at(2).toDouble(), row.at(1).toDouble(), siteLat, siteLon);
+
+            QVector<SiteResponseMotion> stationMotions;
+            if(!readStationMotions(openSeesDir + QDir::separator() + row.at(0), scaleToG, stationMotions, result.err))
+                return result;
+
+            sampleColumns.push_back(columns.at(site));
+            sampleMotionsOfSite.push_back(motionsOfSite.at(site));
+            openSeesMotions.push_back(stationMotions);
         }
 
-        for(int j = 0; j<numParams; ++j)
+        SiteResponseResults results;
+        if(!engine.run(sampleColumns, motions, sampleMotionsOfSite, results, result.err, &context))
+            return result;
+
+        // The motions of a site are in the same order in both runs, the sites where the number of motions differ are skipped
+        QVector<double> openSeesIMs(numIMs);
+
+        for(int r = 0, s = -1, k = 0; r<results.numRecords(); ++r)
         {
-            auto str = dataStrs[j] ;
-            str += stationData[maxToDisp-1][j];
+            k = results.siteIndex.at(r) == s ? k+1 : 0;
+            s = results.siteIndex.at(r);
 
-            if(maxToDisp<stationData.size())
-                str += "...";
+            const auto& siteMotions = openSeesMotions.at(s);
 
-            featAttributes[5+j] = str;
-        }
+            if(siteMotions.size() != sampleMotionsOfSite.at(s).size())
+            {
+                ++result.numSkipped;
+                continue;
+            }
 
-        // Create the feature
-        QgsFeature feature;
-        feature.setGeometry(QgsGeometry::fromPointXY(QgsPointXY(longitude,latitude)));
-        feature.setAttributes(featAttributes);
-        featureList.append(feature);
+            const auto& openSeesMotion = siteMotions.at(k);
+            engine.computeIntensityMeasures(openSeesMotion.acceleration, openSeesMotion.dT, openSeesIMs[0], openSeesIMs[1], openSeesIMs.data() + 2);
 
-        ++count;
-        progressLabel->clear();
-        progressBar->setValue(count);
+            for(int j = 0; j<numIMs; ++j)
+            {
+                auto nativeIM = j == 0 ? results.pga.at(r) : j == 1 ? results.pgv.at(r) : results.psa.at(r*periods.size() + j-2);
 
-        QApplication::processEvents();
-    }
+                if(!(openSeesIMs.at(j) > 0.0) || !(nativeIM > 0.0))
+                    continue;
 
+                auto ratio = nativeIM/openSeesIMs.at(j);
 
-    auto vectorLayer = qgisVizWidget->addVectorLayer("Point", "Ground Motion Input Grid");
+                result.numRatios[j] += 1;
+                result.sumLogRatio[j] += std::log(ratio);
+                result.maxLogRatio[j] = std::max(result.maxLogRatio.at(j), std::abs(std::log(ratio)));
 
-    if(vectorLayer == nullptr)
-    {
-        this->errorMessage("Error creating a layer");
-        this->hideProgressBar();
-        return;
-    }
+                result.comparison.push_back({sampleColumns.at(s).siteID, motions.at(results.motionIndex.at(r)).name, imNames.at(j),
+                                             QString::number(nativeIM), QString::number(openSeesIMs.at(j)), QString::number(ratio)});
+            }
 
-    auto dProvider = vectorLayer->dataProvider();
-    auto res = dProvider->addAttributes(attribFields);
+            ++result.numCompared;
+        }
 
-    if(!res)
+        result.OK = true;
+
+        return result;
+    };
+
+    // Write the comparison in the GUI thread when it is done
+    auto writeComparison = [this, imNames, numIMs](const ValidationResult& result)
     {
-        this->errorMessage("Error adding attribute fields to layer");
-        qgisVizWidget->removeLayer(vectorLayer);
         this->hideProgressBar();
-        return;
-    }
+        this->setSiteResponseButtonsEnabled(true);
 
-    vectorLayer->updateFields(); // tell the vector layer to fetch changes from the provider
+        if(!result.OK)
+        {
+            this->errorMessage(result.err);
+            return;
+        }
 
-    dProvider->addFeatures(featureList);
-    vectorLayer->updateExtents();
+        if(result.numCompared == 0)
+        {
+            this->errorMessage("None of the OpenSees surface motions could be matched to the motions of the equivalent linear analysis");
+            return;
+        }
 
-    qgisVizWidget->createSymbolRenderer(Qgis::MarkerShape::Cross,Qt::black,2.0,vectorLayer);
+        auto pathToComparison = outputSiteDataDir + QDir::separator() + "SiteResponseValidation.csv";
 
-    progressLabel->setVisible(false);
+        QString err;
+        CSVReaderWriter csvTool;
+        if(csvTool.saveCSVFile(result.comparison, pathToComparison, err) != 0)
+        {
+            this->errorMessage(err);
+            return;
+        }
 
-    // Reset the widget back to the input pane and close
-    this->hideProgressBar();
+        // The geometric mean ratio and the largest difference of every intensity measure
+        for(int j = 0; j<numIMs; ++j)
+        {
+            if(result.numRatios.at(j) == 0)
+                continue;
 
-    /*
-    if(theStackedWidget->isModal())
-        theStackedWidget->close();
-    */
-    
-   emit loadingComplete(true);
+            auto meanRatio = std::exp(result.sumLogRatio.at(j)/result.numRatios.at(j));
+            auto maxDifference = 100.0*(std::exp(result.maxLogRatio.at(j)) - 1.0);
 
-    emit outputDirectoryPathChanged(motionDir, eventFile);
+            this->statusMessage(imNames.at(j) + ": mean ratio to OpenSees " + QString::number(meanRatio, 'f', 3) + ", largest difference " + QString::number(maxDifference, 'f', 1) + "%");
+        }
 
-    return;
+        if(result.numSkipped > 0)
+            this->statusMessage("Skipped " + QString::number(result.numSkipped) + " motions where the number of OpenSees motions did not match the input motions");
+
+        this->statusMessage("Compared " + QString::number(result.numCompared) + " motions against the OpenSees results, the comparison is in " + pathToComparison);
+    };
+
+    this->showProgressBar();
+    progressLabel->setVisible(true);
+    this->setSiteResponseButtonsEnabled(false);
+
+    TaskRunner::getInstance()->run<ValidationResult>(this, compareMotions, writeComparison, [this](const TaskProgress& progress){
+        progressLabel->setText(progress.status);
+        progressBar->setRange(0, progress.total);
+        progressBar->setValue(progress.done);
+    });
 }
 
+
 void RegionalSiteResponseWidget::soilParamaterFileDialog(void)
 {
     theStackedWidget->show();
@@ -1341,18 +1900,17 @@ void RegionalSiteResponseWidget::getSiteData(void)
             return;
         }
         // Get the vector of grid nodes
+        // Flat buffer of latitude, longitude pairs
         auto gridNodeVec = userGrid->getGridNodeVec();
-        auto mapCanvas = mapViewSubWidget->getMapCanvasWidget()->mapCanvas();
-        for(int i = 0; i<gridNodeVec.size(); ++i)
+        auto numNodes = gridNodeVec.size()/2;
+        for(int i = 0; i<numNodes; ++i)
         {
-            auto gridNode = gridNodeVec.at(i);
             QStringList stationRow;
             // The station id
             stationRow.push_back(QString::number(i));
-            auto screenPoint = gridNode->getPoint();
             // The latitude and longitude
-            auto longitude = theVisualizationWidget->getLongFromScreenPoint(screenPoint,mapCanvas);
-            auto latitude = theVisualizationWidget->getLatFromScreenPoint(screenPoint,mapCanvas);
+            auto latitude = gridNodeVec.at(2*i);
+            auto longitude = gridNodeVec.at(2*i+1);
             stationRow.push_back(QString::number(latitude));
             stationRow.push_back(QString::number(longitude));
             gridData.push_back(stationRow);
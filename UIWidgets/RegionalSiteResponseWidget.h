@@ -49,6 +49,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 class VisualizationWidget;
 class SimCenterUnitsWidget;
+class TaskContext;
 
 class AssetInputWidget;
 class QStackedWidget;
@@ -81,6 +82,9 @@ class BedrockDepthWidget;
 class SoilModel;
 class SoilModelWidget;
 
+struct SiteResponseColumn;
+struct SiteResponseMotion;
+
 
 class RegionalSiteResponseWidget : public SimCenterAppWidget
 {
@@ -127,6 +131,12 @@ private slots:
     void soilParamaterFileDialog(void);
     void soilScriptFileDialog(void);
 
+    // Runs the equivalent linear site response of all of the sites in the application instead of the OpenSees workflow
+    void runEquivalentLinearAnalysis(void);
+
+    // Compares the equivalent linear surface motions against the OpenSees surface motions of a previous run on a sample of the sites
+    void validateEquivalentLinearAnalysis(void);
+
 signals:
     void eventTypeChangedSignal(QString eventType);
     void outputDirectoryPathChanged(QString motionDir, QString eventFile);
@@ -143,6 +153,18 @@ private:
     void setDir(void); // set directories up
     QString getFilterString(void);
 
+    // Creates the soil columns from the site data file and assigns the motions of the closest input station to every site
+    // The paths are passed in because this runs in the thread pool while the widgets can still be changed
+    bool loadSiteResponseInputs(const QString& pathToSiteFile, const QString& pathToEventFile, const QString& pathToMotionDir, const QString& soilModelType, const QString& filter, const double scaleToG,
+                                QVector<SiteResponseColumn>& columns, QVector<SiteResponseMotion>& motions, QVector<QVector<int>>& motionsOfSite,
+                                QString& err, TaskContext* context = nullptr);
+
+    // The factor that converts the input motions to g, from the units widget
+    double getMotionScaleToG(void);
+
+    // Disables the equivalent linear buttons while an analysis runs in the background
+    void setSiteResponseButtonsEnabled(const bool value);
+
     QStackedWidget* theStackedWidget;
     QStackedWidget* theSiteStackedWidget;
 
@@ -187,6 +209,8 @@ private:
     SoilModelWidget* m_soilModelWidget;
 
     QPushButton* m_runButton;
+    QPushButton* m_equivalentLinearButton;
+    QPushButton* m_validateButton;
     QProcess* processSiteData;
 
     bool siteDataFlag;
@@ -42,6 +42,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "XMLAdaptor.h"
 #include "CSVReaderWriter.h"
 #include "TreeItem.h"
+#include "TaskRunner.h"
 #include "Utils/FileOperations.h"
 
 
@@ -76,6 +77,13 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <qgsvectorlayer.h>
 #include <qgsfillsymbol.h>
 
+// The grids of the events parsed in the background, the error of an event is empty if its grid was parsed or if it has no grid to parse
+struct ShakeMapGridsResult
+{
+    QVector<XMLAdaptor> adaptors;
+    QVector<QString> errors;
+};
+
 ShakeMapWidget::ShakeMapWidget(VisualizationWidget* visWidget, QWidget *parent) : SimCenterAppWidget(parent), theVisualizationWidget(visWidget)
 {
     shakeMapStackedWidget = nullptr;
@@ -155,7 +163,7 @@ QStackedWidget* ShakeMapWidget::getStackedWidget(void)
 
     connect(browseFileButton,SIGNAL(clicked()),this,SLOT(chooseShakeMapDirectoryDialog()));
 
-    connect(loadButton,SIGNAL(clicked()),this,SLOT(loadShakeMapData()));
+    connect(loadButton,SIGNAL(clicked()),this,SLOT(loadShakeMaps()));
 
     QLabel* shakeMapText1 = new QLabel("At a minimum, the folder must contain the 'grid.xml' file.");
     shakeMapText1->setWordWrap(true);
@@ -238,7 +246,14 @@ void ShakeMapWidget::showLoadShakeMapDialog(void)
 }
 
 
-int ShakeMapWidget::loadShakeMapData(void)
+void ShakeMapWidget::loadShakeMaps(void)
+{
+    // Nothing waits for the ShakeMaps loaded from the button, so the grids are parsed without blocking the GUI
+    this->loadShakeMapData(false);
+}
+
+
+int ShakeMapWidget::loadShakeMapData(const bool wait)
 {
 
     // Return if the user cancels
@@ -280,7 +295,7 @@ int ShakeMapWidget::loadShakeMapData(void)
 #endif
 
     // First load files from the current directory
-    this->loadDataFromDirectory(inputDir);
+    QStringList eventDirs = {inputDir};
 
     // Then check to see if an array of events was provided
     if(!shakeMapList.empty())
@@ -288,7 +303,7 @@ int ShakeMapWidget::loadShakeMapData(void)
         for(auto&& event : shakeMapList)
         {
             auto dir = pathToShakeMapDirectory + QDir::separator() + event;
-            this->loadDataFromDirectory(dir);
+            eventDirs.append(dir);
         }
     }
     else // If no list provided iterate through sub-dirs to try to find additional shakemap dirs
@@ -299,22 +314,119 @@ int ShakeMapWidget::loadShakeMapData(void)
         {
             auto dir = iter.next();
 
-            this->loadDataFromDirectory(dir);
+            eventDirs.append(dir);
         }
     }
 
-    emit loadingComplete(true);
+    auto numEvents = eventDirs.size();
 
-    if(this->getNumShakeMapsLoaded() == 0)
+    // Create the layers in the GUI thread when the grids are parsed
+    auto createLayers = [this, eventDirs, numEvents](const ShakeMapGridsResult& result)
     {
-        this->errorMessage("Failed to load the ShakeMaps. Check the folder and try again.");
-        return -1;
+        loadingTask.reset();
+
+        auto gridAdaptors = result.adaptors;
+
+        for(int i = 0; i<numEvents; ++i)
+        {
+            if(!result.errors.at(i).isEmpty())
+            {
+                this->errorMessage(result.errors.at(i));
+                continue;
+            }
+
+            this->loadDataFromDirectory(eventDirs.at(i), &gridAdaptors[i]);
+        }
+
+        emit loadingComplete(true);
+
+        if(this->getNumShakeMapsLoaded() == 0)
+        {
+            this->errorMessage("Failed to load the ShakeMaps. Check the folder and try again.");
+            return -1;
+        }
+
+        return 0;
+    };
+
+    // A load that is still running is replaced by this one
+    if(loadingTask)
+    {
+        loadingTask->cancel();
+        loadingTask.reset();
     }
 
+#ifdef OpenSRA
+    Q_UNUSED(wait);
+
+    ShakeMapGridsResult result;
+    result.adaptors.resize(numEvents);
+    result.errors.resize(numEvents);
+
+    return createLayers(result);
+#else
+    // Find the grids of the events that are not loaded yet
+    QStringList gridFiles;
+    for(auto&& dir : eventDirs)
+    {
+        auto gridFile = dir + QDir::separator() + "grid.xml";
+
+        if(shakeMapContainer.contains(QDir(dir).dirName()) || !QFileInfo::exists(gridFile))
+            gridFiles.append(QString());
+        else
+            gridFiles.append(gridFile);
+    }
+
+    shakeMapStackedWidget->setCurrentWidget(progressBarWidget);
+    progressBarWidget->setVisible(true);
+    progressLabel->setVisible(true);
+    progressBar->setRange(0,numEvents);
+    progressBar->setValue(0);
+
+    this->statusMessage("Loading the ShakeMap grids of "+QString::number(numEvents)+" events");
+
+    // Parse the grids of all of the events in parallel, the layers are created afterwards in the GUI thread
+    auto parseGrids = [gridFiles, numEvents](TaskContext& context)
+    {
+        ShakeMapGridsResult result;
+        result.adaptors.resize(numEvents);
+        result.errors.resize(numEvents);
+
+        // Get the raw pointers before going parallel so that the vectors are not detached in the worker threads
+        XMLAdaptor* adaptors = result.adaptors.data();
+        QString* errors = result.errors.data();
+
+        TaskRunner::parallelFor(context, numEvents, [&](int i)
+        {
+            if(gridFiles.at(i).isEmpty())
+                return;
+
+            if(!adaptors[i].parseXMLGrid(gridFiles.at(i), errors[i]) && errors[i].isEmpty())
+                errors[i] = "Error loading the ShakeMap grid "+gridFiles.at(i);
+        }, 1);
+
+        return result;
+    };
+
+    auto updateProgress = [this](const TaskProgress& progress){
+        progressLabel->setText("Loading ShakeMap Grids");
+        progressBar->setValue(progress.done);
+    };
+
+    if(wait)
+    {
+        auto result = TaskRunner::getInstance()->runAndWait<ShakeMapGridsResult>(parseGrids, updateProgress);
+
+        return createLayers(result);
+    }
+
+    loadingTask = TaskRunner::getInstance()->run<ShakeMapGridsResult>(this, parseGrids, createLayers, updateProgress);
+
     return 0;
+#endif
 }
 
-int ShakeMapWidget::loadDataFromDirectory(const QString& dir)
+int ShakeMapWidget::loadDataFromDirectory(const QString& dir, XMLAdaptor* gridAdaptor)
 {
 
     auto qGsVisWidget = static_cast<QGISVisualizationWidget*>(theVisualizationWidget);
@@ -364,8 +476,6 @@ int ShakeMapWidget::loadDataFromDirectory(const QString& dir)
 
     progressBarWidget->setVisible(true);
 
-    QApplication::processEvents();
-
     progressBar->setRange(0,inputFiles.size());
 
     progressBar->setValue(0);
@@ -389,12 +499,17 @@ int ShakeMapWidget::loadDataFromDirectory(const QString& dir)
             progressLabel->setText("Loading Grid Layer");
             this->statusMessage("Loading Grid Layer");
             progressLabel->setVisible(true);
-            QApplication::processEvents();
-
-            XMLAdaptor XMLImportAdaptor;
 
             QString errMess;
-            auto XMLlayer = XMLImportAdaptor.parseXMLFile(inFilePath, errMess, qGsVisWidget);
+
+            // The grid was parsed in the thread pool by loadShakeMapData
+            if(gridAdaptor == nullptr || gridAdaptor->getGrid().getNumPoints() == 0)
+            {
+                this->errorMessage("Error, the ShakeMap grid "+inFilePath+" has no points");
+                return -1;
+            }
+
+            auto XMLlayer = gridAdaptor->createGridLayer(errMess, qGsVisWidget);
 
             if(XMLlayer == nullptr)
             {
@@ -404,7 +519,7 @@ int ShakeMapWidget::loadDataFromDirectory(const QString& dir)
 
             XMLlayer->setName("Grid");
 
-            inputShakeMap->stationList = XMLImportAdaptor.getStationList();
+            inputShakeMap->grid = gridAdaptor->getGrid();
 
             inputShakeMap->gridLayer = XMLlayer;
             layerGroup.push_back(XMLlayer);
@@ -416,7 +531,6 @@ int ShakeMapWidget::loadDataFromDirectory(const QString& dir)
             progressLabel->setText("Loading PGA Contour Layer");
             this->statusMessage("Loading PGA Contour Layer");
 
-            QApplication::processEvents();
             auto contPGAlayer = qGsVisWidget->addVectorLayer(inFilePath, "PGA Contours", "ogr");
 
             if(contPGAlayer == nullptr)
@@ -438,8 +552,6 @@ int ShakeMapWidget::loadDataFromDirectory(const QString& dir)
             progressLabel->setText("Loading Rupture Layer");
             this->statusMessage("Loading Rupture Layer");
 
-            QApplication::processEvents();
-
             auto rupLayer = qGsVisWidget->addVectorLayer(inFilePath, "Rupture Plane", "ogr");
 
             if(rupLayer == nullptr)
@@ -510,8 +622,6 @@ int ShakeMapWidget::loadDataFromDirectory(const QString& dir)
         ++count;
         progressLabel->clear();
         progressBar->setValue(count);
-
-        QApplication::processEvents();
     }
 
     if (layerGroup.length() > 1)
@@ -712,7 +822,7 @@ bool ShakeMapWidget::inputAppDataFromJSON(QJsonObject &jsonObject)
         }
     }
 
-    auto res = this->loadShakeMapData();
+    auto res = this->loadShakeMapData(true);
 
     if(res != 0)
         return false;
@@ -761,7 +871,7 @@ bool ShakeMapWidget::inputFromJSON(QJsonObject &jsonObject)
     for(auto&& event : eventsArray)
         shakeMapList<<event.toString();
 
-    auto res = this->loadShakeMapData();
+    auto res = this->loadShakeMapData(true);
 
     if(res != 0)
         return false;
@@ -835,23 +945,20 @@ bool ShakeMapWidget::copyFiles(QString &destDir)
         return false;
     }
 
-    CSVReaderWriter csvTool;
+    const auto& grid = selectedShakeMap->grid;
 
-    auto stationList = selectedShakeMap->stationList;
+    auto numStations = grid.getNumPoints();
 
-    if(stationList.empty())
+    if(numStations == 0)
     {
         this->errorMessage("Error, the station list is empty for "+currItemName);
         return false;
     }
 
-    // First create the event grid file
-    QVector<QStringList> gridData;
-
-    QStringList headerRow = {"GP_file", "Latitude", "Longitude"};
-    gridData.push_back(headerRow);
-
+    // Get the grid columns of the selected IMs
     QStringList stationHeader;
+    QVector<int> IMColumns;
+    QVector<double> IMScaleFactors;
     for(int i = 0; i < IMListWidget->count(); ++i)
     {
         auto item = IMListWidget->item(i);
@@ -861,112 +968,101 @@ bool ShakeMapWidget::copyFiles(QString &destDir)
 
         auto IMtag = item->text();
 
-        stationHeader.append(IMtag);
-    }
-
-    this->statusMessage("Creating ground motion station files from ShakeMap, this may take some time.");
-
-    QApplication::processEvents();
-
-    for(int i = 0; i<stationList.size(); ++i)
-    {
-        auto stationFile = "Site_"+QString::number(i)+".csv";
-
-        auto station = stationList.at(i);
-
-        auto lat = QString::number(station.getLatitude());
-        auto lon = QString::number(station.getLongitude());
+        double scaleFactor = 1.0;
 
-        QStringList stationRow = {stationFile, lat, lon};
-
-        gridData.push_back(stationRow);
+        if(IMtag.compare("PGA") == 0)
+        {
+            // Convert from pct g into g
+            scaleFactor = 0.01;
+        }
+        else if(IMtag.compare("PGV") == 0)
+        {
+            // Units cmps
+            scaleFactor = 1.0;
+        }
+        else
+        {
+            this->errorMessage("Could not recognize the provided intensity measure "+IMtag);
+            continue;
+        }
 
-        QStringList IMstrList;
+        auto IMColumn = grid.fieldNames.indexOf(IMtag);
 
-        for(int i = 0; i < IMListWidget->count(); ++i)
+        if(IMColumn == -1)
         {
-            auto item = IMListWidget->item(i);
+            this->errorMessage("Error getting the desired IM "+IMtag+" from ShakeMap grid data");
+            return false;
+        }
 
-            if(item->checkState() == Qt::Unchecked)
-                continue;
+        stationHeader.append(IMtag);
+        IMColumns.append(IMColumn);
+        IMScaleFactors.append(scaleFactor);
+    }
 
-            auto IMtag = item->text();
+    this->statusMessage("Creating the ground motion station files from ShakeMap");
 
-            if(IMtag.compare("PGA") == 0)
-            {
-                auto attribVal = station.getAttributeValue(IMtag);
+    // The event grid lists the station files in the GP_file column, as the other hazards do
+    QVector<QStringList> gridData(numStations+1);
+    gridData[0] = QStringList({"GP_file", "Latitude", "Longitude"});
 
-                if(attribVal.isNull())
-                {
-                    this->errorMessage("Error getting the desired IM "+IMtag+" from ShakeMap grid data");
-                    return false;
-                }
+    QString err;
+    auto res2 = TaskRunner::getInstance()->runAndWait<int>([&](TaskContext& context)
+    {
+        QVector<QString> errors(numStations);
 
-                bool Ok = false;
-                auto PGAval = attribVal.toDouble(&Ok);
+        // Get the raw pointers before going parallel so that the vectors are not detached in the worker threads
+        QStringList* rows = gridData.data() + 1;
+        QString* errorData = errors.data();
 
-                if(!Ok)
-                {
-                    this->errorMessage("Error getting the desired IM "+IMtag+" from ShakeMap grid data");
-                    return false;
-                }
+        auto numIMs = IMColumns.size();
 
-                // Convert from pct g into g
-                PGAval /= 100.0;
+        TaskRunner::parallelFor(context, numStations, [&](int i)
+        {
+            auto stationFile = "Site_"+QString::number(i)+".csv";
 
-                auto PGAstr = QString::number(PGAval);
-                IMstrList.append(PGAstr);
+            rows[i] = QStringList({stationFile, QString::number(grid.getValue(i,grid.indexLat)), QString::number(grid.getValue(i,grid.indexLon))});
 
-            }
-            else if(IMtag.compare("PGV") == 0)
-            {
-                auto attribVal = station.getAttributeValue(IMtag);
+            QStringList IMRow;
+            IMRow.reserve(numIMs);
 
-                if(attribVal.isNull())
-                {
-                    this->errorMessage("Error getting the desired IM "+IMtag+" from ShakeMap grid data");
-                    return false;
-                }
+            for(int j = 0; j<numIMs; ++j)
+                IMRow.append(QString::number(grid.getValue(i,IMColumns.at(j))*IMScaleFactors.at(j)));
 
-                bool Ok = false;
-                auto IMVal = attribVal.toDouble(&Ok);
+            // Save the station data
+            QVector<QStringList> stationData = {stationHeader, IMRow};
 
-                if(!Ok)
-                {
-                    this->errorMessage("Error getting the desired IM "+IMtag+" from ShakeMap grid data");
-                    return false;
-                }
+            QString pathToStationFile = motionDir + QDir::separator() + stationFile;
 
-                // Units cmps
-                auto IMstr = QString::number(IMVal);
-                IMstrList.append(IMstr);
-            }
-            else
+            CSVReaderWriter csvTool;
+            auto res = csvTool.saveCSVFile(stationData, pathToStationFile, errorData[i]);
+            if(res != 0 && errorData[i].isEmpty())
+                errorData[i] = "Error saving the file "+pathToStationFile;
+        }, 256);
+
+        // Report the first error in the order of the stations so that the message does not depend on the thread timing
+        for(auto&& it : errors)
+        {
+            if(!it.isEmpty())
             {
-                this->errorMessage("Could not recognize the provided intensity measure "+IMtag);
+                err = it;
+                return -1;
             }
         }
 
-        QVector<QStringList> stationData = {stationHeader,IMstrList};
-
-        QString pathToStationFile = motionDir + QDir::separator() + stationFile;
-
-        QString err;
-        auto res2 = csvTool.saveCSVFile(stationData, pathToStationFile, err);
-        if(res2 != 0)
+        if(context.isCanceled())
         {
-            this->errorMessage(err);
-            return false;
+            err = "Writing the ShakeMap station files was canceled";
+            return -1;
         }
 
-    }
+        // Now save the site grid .csv file
+        CSVReaderWriter csvTool;
+        return csvTool.saveCSVFile(gridData, pathToEventFile, err);
+    });
 
-    // Now save the site grid .csv file
-    QString err2;
-    auto res2 = csvTool.saveCSVFile(gridData, pathToEventFile, err2);
     if(res2 != 0)
     {
-        this->errorMessage(err2);
+        this->errorMessage(err);
         return false;
     }
 #endif
@@ -983,6 +1079,13 @@ int ShakeMapWidget::getNumShakeMapsLoaded()
 
 void ShakeMapWidget::clear()
 {
+    // The grids that are still being parsed are not shown anymore
+    if(loadingTask)
+    {
+        loadingTask->cancel();
+        loadingTask.reset();
+    }
+
     listWidget->clear();
     shakeMapDirectoryLineEdit->clear();
     pathToShakeMapDirectory = "NULL";
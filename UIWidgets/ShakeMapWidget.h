@@ -39,7 +39,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 // Written by: Stevan Gavrilovic
 
 #include "SimCenterAppWidget.h"
-#include "GroundMotionStation.h"
+#include "XMLAdaptor.h"
 
 #include <QMap>
 
@@ -47,6 +47,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 class CustomListWidget;
 class VisualizationWidget;
+class TaskContext;
 
 class QListWidget;
 class QStackedWidget;
@@ -92,7 +93,8 @@ struct ShakeMap{
         return layers;
     }
 
-    QVector<GroundMotionStation> stationList;
+    // The grid points with their intensity measures
+    ShakeMapGrid grid;
 };
 
 
@@ -123,8 +125,9 @@ public slots:
 
 private slots:
 
-    int loadShakeMapData(void);
-    int loadDataFromDirectory(const QString& dir);
+    void loadShakeMaps(void);
+    // The grid of the event is parsed beforehand in the thread pool
+    int loadDataFromDirectory(const QString& dir, XMLAdaptor* gridAdaptor);
     void chooseShakeMapDirectoryDialog(void);
 
 signals:
@@ -136,6 +139,12 @@ signals:
 private:
     void selectClear();
 
+    // Parses the grids in the thread pool, the call waits for the layers unless wait is false, then they are created when the grids are parsed
+    int loadShakeMapData(const bool wait);
+
+    // The grids that are being parsed in the background, if any
+    std::shared_ptr<TaskContext> loadingTask;
+
     QStackedWidget* shakeMapStackedWidget = nullptr;
 
     QStringList shakeMapList;
@@ -225,3 +225,27 @@ QList<QString> SimCenterUnitsWidget::getParameterNames()
 
     return paramList;
 }
+
+
+QMap<QString, QString> SimCenterUnitsWidget::getUnits(void)
+{
+    QMap<QString, QString> units;
+    auto numItems = unitsLayout->count();
+    for(int i = 0; i<numItems; ++i)
+    {
+        QLayoutItem *child = unitsLayout->itemAt(i);
+
+        auto widget = dynamic_cast<SimCenterUnitsCombo*>(child->widget());
+        if (widget)
+        {
+            auto unit = widget->getCurrentUnitString();
+
+            if(unit.compare("UNDEFINED") == 0)
+                continue;
+
+            units.insert(widget->getName(), unit);
+        }
+    }
+
+    return units;
+}
@@ -42,6 +42,7 @@ class SimCenterUnitsCombo;
 class QGridLayout;
 
 #include <QGroupBox>
+#include <QMap>
 #include "JsonSerializable.h"
 
 class SimCenterUnitsWidget : public QGroupBox, public JsonSerializable
@@ -65,6 +66,9 @@ public:
 
     QList<QString> getParameterNames();
 
+    // Returns the unit string of every parameter, e.g., "g", the parameters with an undefined unit are left out
+    QMap<QString, QString> getUnits(void);
+
 private:
     QGridLayout *unitsLayout = nullptr;
 
@@ -37,11 +37,13 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 // Written by: Stevan Gavrilovic, Frank McKenna
 
 #include "CSVReaderWriter.h"
+#include "FaultRuptureSet.h"
 #include "LayerTreeView.h"
 #include "UserInputFaultWidget.h"
 #include "VisualizationWidget.h"
 #include "WorkflowAppR2D.h"
 #include "SimCenterUnitsWidget.h"
+#include "TaskRunner.h"
 
 #include <QApplication>
 #include <QDialog>
@@ -412,105 +414,50 @@ void UserInputFaultWidget::clear(void)
 
 void UserInputFaultWidget::loadUserGMData(void)
 {
-
-    CSVReaderWriter csvTool;
-
-    QString err;
-    QVector<QStringList> data = csvTool.parseCSVFile(eventFile, err);
-
-    if(!err.isEmpty())
+    if(!QFileInfo::exists(eventFile))
     {
-        this->errorMessage(err);
+        this->errorMessage("Error, the fault rupture file "+eventFile+" does not exist");
         return;
     }
 
-    if(data.empty())
-        return;
-
     this->showProgressBar();
 
-    QApplication::processEvents();
-
-    //progressBar->setRange(0,inputFiles.size());
-    progressBar->setRange(0, data.count());
+    progressBar->setRange(0, 0);
     progressBar->setValue(0);
 
-    // Get the headers
-    auto stationDataHeadings = data.front();
-
-
-    // Create the fields
-    QList<QgsField> attribFields;
-    attribFields.push_back(QgsField("AssetType", QVariant::String));
-    attribFields.push_back(QgsField("TabName", QVariant::String));
-
-    for(auto&& it : stationDataHeadings)
-        attribFields.push_back(QgsField(it, QVariant::String));
-
-    // Pop off the row that contains the header information
-    data.pop_front();
-
-    auto numRows = data.size();
-
-    int count = 0;
-
-    int faultIdx = theVisualizationWidget->getIndexOfVal(stationDataHeadings, "FaultTrace");
+    // Parse the ruptures, or read them from the cache, and create the features in the thread pool
+    FaultRuptureSet ruptureSet;
+    QgsFeatureList featureList;
 
-    if(faultIdx == -1)
+    QString err;
+    auto res = TaskRunner::getInstance()->runAndWait<bool>([&](TaskContext& context)
     {
-        this->infoMessage("Warning, could not find the index for fault trace geometry in "+eventFile+ ". The fault trace heading should be 'FaultTrace' ");
-    }
+        if(!ruptureSet.load(eventFile, err, &context))
+            return false;
 
-    // The number of headings in the file
-    auto numParams = stationDataHeadings.size();
+        context.setStatus("Creating the fault rupture features");
 
+        return ruptureSet.createFeatures(featureList, err);
+    }, [this](const TaskProgress& progress){
+        progressLabel->setText(progress.status);
+        progressBar->setRange(0, progress.total);
+        progressBar->setValue(progress.done);
+    });
 
-    QgsFeatureList featureList;
-    // Get the data
-    for(int i = 0; i<numRows; ++i)
+    if(!res)
     {
-        auto rowStr = data.at(i);
-
-        // create the feature attributes
-        QgsAttributes featAttributes(attribFields.size());
-
-        auto faultTrace = rowStr[faultIdx];
-
-        featAttributes[0] = "FaultRuptureTrace";     // "AssetType"
-        featAttributes[1] = "Fault Rupture Trace";  // "TabName"
-
-        for(int j = 0; j<numParams; ++j)
-        {
-            auto str = rowStr[j] ;
-
-            featAttributes[2+j] = str;
-        }
-
-        // Create the feature
-        QgsFeature feature;
-
-        auto geom = theVisualizationWidget->getMultilineStringGeometryFromJson(faultTrace);
-        if(geom.isEmpty())
-        {
-            this->errorMessage("Error getting the fault trace geometry");
-            return;
-        }
-
-        feature.setGeometry(geom);
-
-
-        feature.setAttributes(featAttributes);
-        featureList.append(feature);
-
-        ++count;
-        progressLabel->clear();
-        progressBar->setValue(count);
-
-        QApplication::processEvents();
+        this->errorMessage(err);
+        this->hideProgressBar();
+        return;
     }
 
+    // The ruptures loaded but their cache could not be written
+    if(!err.isEmpty())
+        this->statusMessage(err);
+
+    auto attribFields = ruptureSet.getFields();
 
-    auto vectorLayer = theVisualizationWidget->addVectorLayer("linestring", "Fault Ruptures");
+    auto vectorLayer = theVisualizationWidget->addVectorLayer("multilinestring", "Fault Ruptures");
 
     if(vectorLayer == nullptr)
     {
@@ -520,7 +467,7 @@ void UserInputFaultWidget::loadUserGMData(void)
     }
 
     auto dProvider = vectorLayer->dataProvider();
-    auto res = dProvider->addAttributes(attribFields);
+    res = dProvider->addAttributes(attribFields);
 
     if(!res)
     {
@@ -42,6 +42,8 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "VisualizationWidget.h"
 #include "WorkflowAppR2D.h"
 #include "SimCenterUnitsWidget.h"
+#include "StationLayerBuilder.h"
+#include "TaskRunner.h"
 
 #include <QApplication>
 #include <QDialog>
@@ -65,6 +67,8 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 #include <qgsvectorlayer.h>
 
+#include <cmath>
+
 
 UserInputGMWidget::UserInputGMWidget(VisualizationWidget* visWidget, QWidget *parent) : SimCenterAppWidget(parent), theVisualizationWidget(visWidget)
 {
@@ -220,6 +224,8 @@ bool UserInputGMWidget::inputFromJSON(QJsonObject &jsonObject)
         this->infoMessage("Warning \\!/: Check if the units are correct!");
     }
 
+    this->updateIntensityMeasureUnits();
+
     return res;
 }
 
@@ -440,8 +446,68 @@ void UserInputGMWidget::clear(void)
     motionDirLineEdit->clear();
 
     unitsWidget->clear();
+
+    intensityMeasures.clear();
+}
+
+
+const UnitConvertedTable& UserInputGMWidget::getIntensityMeasures(void)
+{
+    this->updateIntensityMeasureUnits();
+
+    return intensityMeasures;
+}
+
+
+void UserInputGMWidget::updateIntensityMeasureUnits(void)
+{
+    // Only the columns whose unit changed since the last call are converted
+    QString err;
+    if(!intensityMeasures.setUnits(unitsWidget->getUnits(), err))
+        this->errorMessage(err);
+}
+
+bool UserInputGMWidget::checkIntensityMeasures(QString& err)
+{
+    const auto& table = this->getIntensityMeasures();
+
+    const auto& headings = table.getHeadings();
+    const auto numGroups = table.getNumGroups();
+
+    for(int col = 0; col<table.getNumColumns(); ++col)
+    {
+        // Only the columns with a declared unit are intensity measures, e.g., the file names do not have a unit
+        if(table.getUnit(col).isEmpty())
+            continue;
+
+        if(!table.isNumberColumn(col))
+        {
+            err = "The intensity measure "+headings.at(col)+" in the station files contains values that are not numbers";
+            return false;
+        }
+
+        // The values are in SI units, ln(g) is converted to m/s^2, so every intensity measure has to be a finite positive number or zero
+        const double* values = table.getColumn(col);
+
+        for(int group = 0; group<numGroups; ++group)
+        {
+            const auto end = table.getGroupBegin(group+1);
+
+            for(int row = table.getGroupBegin(group); row<end; ++row)
+            {
+                if(!std::isfinite(values[row]) || values[row] < 0.0)
+                {
+                    err = "The intensity measure "+headings.at(col)+" of the station in row "+QString::number(group+1)+" of the event file is missing or negative in row "+QString::number(row-table.getGroupBegin(group)+1)+" of its station file";
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
 }
 
+
 void UserInputGMWidget::loadUserGMData(void)
 {
     auto qgisVizWidget = static_cast<QGISVisualizationWidget*>(theVisualizationWidget);
@@ -455,6 +521,8 @@ void UserInputGMWidget::loadUserGMData(void)
     // Clear the units widget
     unitsWidget->clear();
 
+    intensityMeasures.clear();
+
     CSVReaderWriter csvTool;
 
     QString err;
@@ -471,9 +539,6 @@ void UserInputGMWidget::loadUserGMData(void)
 
     this->showProgressBar();
 
-    QApplication::processEvents();
-
-    //progressBar->setRange(0,inputFiles.size());
     progressBar->setRange(0, data.count());
     progressBar->setValue(0);
 
@@ -505,19 +570,8 @@ void UserInputGMWidget::loadUserGMData(void)
     // Get the header file
     auto stationDataHeadings = sampleStationData.first();
 
-    // Create the fields
-    QList<QgsField> attribFields;
-    attribFields.push_back(QgsField("AssetType", QVariant::String));
-    attribFields.push_back(QgsField("TabName", QVariant::String));
-    attribFields.push_back(QgsField("Station Name", QVariant::String));
-    attribFields.push_back(QgsField("Latitude", QVariant::Double));
-    attribFields.push_back(QgsField("Longitude", QVariant::Double));
-
     for(auto&& it : stationDataHeadings)
-    {
-        attribFields.push_back(QgsField(it, QVariant::String));
         unitsWidget->addNewUnitItem(it);
-    }
 
     // Set the scale at which the layer will become visible - if scale is too high, then the entire view will be filled with symbols
     // gridLayer->setMinScale(80000);
@@ -525,12 +579,6 @@ void UserInputGMWidget::loadUserGMData(void)
     // Pop off the row that contains the header information
     data.pop_front();
 
-    auto numRows = data.size();
-
-    int count = 0;
-
-    auto maxToDisp = 20;
-
     int latIndex = theVisualizationWidget->getIndexOfVal(eventColHeaders, "latitude");
     int lonIndex = theVisualizationWidget->getIndexOfVal(eventColHeaders, "longitude");
 
@@ -546,140 +594,54 @@ void UserInputGMWidget::loadUserGMData(void)
         lonIndex = 1;
     }
 
+    // Read the station files in parallel in the thread pool and wait for the result
+    StationLayerBuilder layerBuilder("GroundMotionGridPoint", "Ground Motion Grid Point");
     QgsFeatureList featureList;
-    // Get the data
-    for(int i = 0; i<numRows; ++i)
-    {
-        auto rowStr = data.at(i);
-
-        auto stationName = rowStr[0];
 
-        // Path to station files, e.g., site0.csv
-        auto stationPath = motionDir + QDir::separator() + stationName;
+    // The intensity measures are parsed to numbers once here, the units are applied when they are set
+    UnitConvertedTable stationTable;
 
-        bool ok;
-        auto lon = rowStr[lonIndex].toDouble(&ok);
-
-        if(!ok)
-        {
-            QString errMsg = "Error longitude to a double, check the value in "+stationName;
-            this->errorMessage(errMsg);
-
-            this->hideProgressBar();
-
-            return;
-        }
-
-        auto lat = rowStr[latIndex].toDouble(&ok);
-
-        if(!ok)
-        {
-            QString errMsg = "Error latitude to a double, check the value in "+stationName;
-            this->errorMessage(errMsg);
-
-            this->hideProgressBar();
-
-            return;
-        }
-
-        GroundMotionStation GMStation(stationPath,lat,lon);
-
-        try
+    auto res = TaskRunner::getInstance()->runAndWait<bool>([&](TaskContext& context)
+    {
+        auto readStation = [](const QString& stationPath, const double lat, const double lon)
         {
+            GroundMotionStation GMStation(stationPath,lat,lon);
             GMStation.importGroundMotions();
-        }
-        catch(QString msg)
-        {
-            auto errorMessage = "Error importing ground motion file: " + stationName+"\n"+msg;
-            this->errorMessage(errorMessage);
-
-            this->hideProgressBar();
-
-            return;
-        }
-
-        auto stationData = GMStation.getStationData();
-
-        // create the feature attributes
-        QgsAttributes featAttributes(attribFields.size());
-
-        auto latitude = GMStation.getLatitude();
-        auto longitude = GMStation.getLongitude();
-
-        featAttributes[0] = "GroundMotionGridPoint";     // "AssetType"
-        featAttributes[1] = "Ground Motion Grid Point";  // "TabName"
-        featAttributes[2] = stationName;                 // "Station Name"
-        featAttributes[3] = latitude;                    // "Latitude"
-        featAttributes[4] = longitude;                   // "Longitude"
-
-        // The number of headings in the file
-        auto numParams = stationData.front().size();
-
-        maxToDisp = (maxToDisp<stationData.size() ? maxToDisp : stationData.size());
 
-        QVector<QString> dataStrs(numParams);
+            return GMStation.getStationData();
+        };
 
-        for(int i = 0; i<maxToDisp-1; ++i)
-        {
-            auto stationParams = stationData[i];
-
-            for(int j = 0; j<numParams; ++j)
-            {
-                dataStrs[j] += stationParams[j] + ", ";
-            }
-        }
-
-        for(int j = 0; j<numParams; ++j)
-        {
-            auto str = dataStrs[j] ;
-            str += stationData[maxToDisp-1][j];
+        QVector<QVector<QStringList>> stationData;
 
-            if(maxToDisp<stationData.size())
-                str += "...";
-
-            featAttributes[5+j] = str;
-        }
-
-        // Create the feature
-        QgsFeature feature;
-        feature.setGeometry(QgsGeometry::fromPointXY(QgsPointXY(longitude,latitude)));
-        feature.setAttributes(featAttributes);
-        featureList.append(feature);
-
-        ++count;
-        progressLabel->clear();
-        progressBar->setValue(count);
-
-        QApplication::processEvents();
-    }
+        if(!layerBuilder.addStationFiles(data, motionDir, latIndex, lonIndex, stationDataHeadings, readStation, err, &context, &stationData))
+            return false;
 
+        if(!stationTable.load(stationDataHeadings, stationData, err, &context))
+            return false;
 
-    auto vectorLayer = qgisVizWidget->addVectorLayer("Point", "Ground Motion Grid");
+        return layerBuilder.createFeatures(featureList, err);
+    }, [this](const TaskProgress& progress){
+        progressBar->setRange(0, progress.total);
+        progressBar->setValue(progress.done);
+    });
 
-    if(vectorLayer == nullptr)
+    if(!res)
     {
-        this->errorMessage("Error creating a layer");
+        this->errorMessage(err);
         this->hideProgressBar();
         return;
     }
 
-    auto dProvider = vectorLayer->dataProvider();
-    auto res = dProvider->addAttributes(attribFields);
+    auto vectorLayer = layerBuilder.createLayer(qgisVizWidget, "Ground Motion Grid", featureList, err);
 
-    if(!res)
+    if(vectorLayer == nullptr)
     {
-        this->errorMessage("Error adding attribute fields to layer");
-        qgisVizWidget->removeLayer(vectorLayer);
+        this->errorMessage(err);
         this->hideProgressBar();
         return;
     }
 
-    vectorLayer->updateFields(); // tell the vector layer to fetch changes from the provider
-
-    dProvider->addFeatures(featureList);
-    vectorLayer->updateExtents();
-
-    qgisVizWidget->createSymbolRenderer(Qgis::MarkerShape::Cross,Qt::black,2.0,vectorLayer);
+    intensityMeasures = stationTable;
 
     progressLabel->setVisible(false);
 
@@ -714,6 +676,12 @@ UserInputGMWidget::copyFiles(QString &destDir)
         return false;
     }
 
+    // Check the intensity measures before they are handed to the backend
+    // Missing values are allowed in the station files, so the problems are only reported and the files are staged as they are
+    QString err;
+    if(!this->checkIntensityMeasures(err))
+        this->infoMessage("Warning: "+err);
+
     QFileInfo eventFileInfo(eventFile);
     if (eventFileInfo.exists()) {
         this->copyFile(eventFile, destDir);
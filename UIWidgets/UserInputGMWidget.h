@@ -40,6 +40,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 #include "GroundMotionStation.h"
 #include "SimCenterAppWidget.h"
+#include "UnitConvertedTable.h"
 
 #include <memory>
 
@@ -71,6 +72,10 @@ public:
     bool copyFiles(QString &destDir);
     void clear(void);
 
+    // The intensity measures of the station files in SI units, the rows of a station are the group with the index of the station in the event grid
+    // The values are converted with the units that are set in the units widget, the original units are kept for the export
+    const UnitConvertedTable& getIntensityMeasures(void);
+
 public slots:
 
     void showUserGMSelectDialog(void);
@@ -91,6 +96,11 @@ private:
     void showProgressBar(void);
     void hideProgressBar(void);
 
+    void updateIntensityMeasureUnits(void);
+
+    // Checks that the intensity measures with a declared unit are numbers that are finite and not negative, err holds the first problem found
+    bool checkIntensityMeasures(QString& err);
+
     QStackedWidget* theStackedWidget;
 
     VisualizationWidget* theVisualizationWidget;
@@ -110,6 +120,8 @@ private:
 
     SimCenterUnitsWidget* unitsWidget;
 
+    UnitConvertedTable intensityMeasures;
+
 };
 
 #endif // UserInputGMWidget_H
@@ -44,6 +44,8 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "WorkflowAppR2D.h"
 #include "WindFieldStation.h"
 #include "SimCenterUnitsWidget.h"
+#include "StationLayerBuilder.h"
+#include "TaskRunner.h"
 
 #include "QGISHurricanePreprocessor.h"
 #include "QGISVisualizationWidget.h"
@@ -67,6 +69,15 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QVBoxLayout>
 #include <QDir>
 
+// The result of importing the wind field stations in the background
+struct WindFieldLoadResult
+{
+    StationLayerBuilder layerBuilder = StationLayerBuilder("HurricaneGridPoint", "Hurricane Grid Point");
+    QgsFeatureList features;
+    QString err;
+};
+
+
 UserInputHurricaneWidget::UserInputHurricaneWidget(VisualizationWidget* visWidget, QWidget *parent) : SimCenterAppWidget(parent), theVisualizationWidget(visWidget)
 {
     progressBar = nullptr;
@@ -187,7 +198,9 @@ bool UserInputHurricaneWidget::inputFromJSON(QJsonObject &jsonObject)
   // set the line dit
   eventDirLineEdit->setText(eventDir);
 
-  this->loadUserWFData();	
+  // The layer has to be loaded before the input is done, so the stations are imported synchronously here
+  if(!this->loadWindFieldData(true))
+    return false;
   
   // Set the units
   auto res = unitsWidget->inputFromJSON(jsonObject);
@@ -469,19 +482,31 @@ void UserInputHurricaneWidget::clear(void)
     eventFileLineEdit->clear();
     eventDirLineEdit->clear();
 
+    if(loadingTask)
+    {
+        loadingTask->cancel();
+        loadingTask.reset();
+    }
+
     this->hideProgressBar();
     unitsWidget->clear();
 }
 
 
 void UserInputHurricaneWidget::loadUserWFData(void)
+{
+    this->loadWindFieldData(false);
+}
+
+
+bool UserInputHurricaneWidget::loadWindFieldData(const bool wait)
 {
     auto QGsVisWidget = static_cast<QGISVisualizationWidget*>(theVisualizationWidget);
 
     if(QGsVisWidget == nullptr)
     {
         qDebug()<<"Failed to cast to QGISVisualizationWidget";
-        return;
+        return false;
     }
 
     // Clear the units widget
@@ -496,21 +521,14 @@ void UserInputHurricaneWidget::loadUserWFData(void)
     if(!err.isEmpty())
     {
         this->errorMessage(err);
-        return;
+        return false;
     }
 
     if(data.empty())
-        return;
+        return false;
 
     this->showProgressBar();
 
-    QApplication::processEvents();
-
-    //progressBar->setRange(0,inputFiles.size());
-    progressBar->setRange(0, data.count());
-
-    progressBar->setValue(0);
-
     // Get the headers in the first station file - assume that the rest will be the same
     auto rowStr = data.at(1);
     auto stationName = rowStr[0];
@@ -525,32 +543,21 @@ void UserInputHurricaneWidget::loadUserWFData(void)
     if(!err2.isEmpty())
     {
         this->errorMessage("Could not parse the first station with the following error: "+err2);
-        return;
+        return false;
     }
 
     if(sampleStationData.size() < 2)
     {
         this->errorMessage("The file " + stationFilePath + " is empty");
-        return;
+        return false;
     }
 
     // Get the header file
     auto stationDataHeadings = sampleStationData.first();
 
 
-    // Create the fields
-    QList<QgsField> attribFields;
-    attribFields.push_back(QgsField("AssetType", QVariant::String));
-    attribFields.push_back(QgsField("TabName", QVariant::String));
-    attribFields.push_back(QgsField("Station Name", QVariant::String));
-    attribFields.push_back(QgsField("Latitude", QVariant::Double));
-    attribFields.push_back(QgsField("Longitude", QVariant::Double));
-
     for(auto&& it : stationDataHeadings)
-    {
-        attribFields.push_back(QgsField(it, QVariant::String));
         unitsWidget->addNewUnitItem(it);
-    }
 
 
     auto headerInfo = data.front();
@@ -562,159 +569,97 @@ void UserInputHurricaneWidget::loadUserWFData(void)
     {
         this->errorMessage("Could not find the Latitude and Longitude headsers in the EventGrid.csv file");
         this->hideProgressBar();
-        return;
+        return false;
     }
 
     // Pop off the row that contains the header information
     data.pop_front();
 
     auto numRows = data.size();
+    auto stationDir = eventDir;
 
-    int count = 0;
+    progressBar->setRange(0, numRows);
+    progressBar->setValue(0);
 
-    QgsFeatureList featureList;
-    // Get the data
-    for(int i = 0; i<numRows; ++i)
-    {
-        auto rowStr = data.at(i);
+    // Cancel a load of a previous event that is still running
+    if(loadingTask)
+        loadingTask->cancel();
 
-        auto stationName = rowStr[0];
+    // Import the station files and create the features in the thread pool
+    auto importStations = [data, stationDir, latIndex, lonIndex, stationDataHeadings](TaskContext& context)
+    {
+        WindFieldLoadResult result;
 
-        // Path to station files, e.g., site0.csv
-        auto stationPath = eventDir + QDir::separator() + stationName;
+        auto readStation = [](const QString& stationPath, const double lat, const double lon)
+        {
+            WindFieldStation WFStation(QFileInfo(stationPath).fileName(),lat,lon);
+            WFStation.setStationFilePath(stationPath);
+            WFStation.importWindFieldStation();
 
-        bool ok;
-        auto longitude = rowStr[lonIndex].toDouble(&ok);
+            return WFStation.getStationData();
+        };
 
-        if(!ok)
-        {
-            QString errMsg = "Error casting longitude to a double, check the input value";
-            this->errorMessage(errMsg);
+        if(!result.layerBuilder.addStationFiles(data, stationDir, latIndex, lonIndex, stationDataHeadings, readStation, result.err, &context))
+            return result;
 
-            this->hideProgressBar();
+        result.layerBuilder.createFeatures(result.features, result.err);
 
-            return;
-        }
+        return result;
+    };
 
-        auto latitude = rowStr[latIndex].toDouble(&ok);
+    // Create the layer in the GUI thread when all of the stations are imported
+    auto createLayer = [this, QGsVisWidget](const WindFieldLoadResult& result)
+    {
+        loadingTask.reset();
 
-        if(!ok)
+        if(!result.err.isEmpty())
         {
-            QString errMsg = "Error casting latitude to a double, check the input value";
-            this->errorMessage(errMsg);
-
+            this->errorMessage(result.err);
             this->hideProgressBar();
-
-            return;
+            return false;
         }
 
-        WindFieldStation WFStation(stationName,latitude,longitude);
+        QString err;
+        auto vectorLayer = result.layerBuilder.createLayer(QGsVisWidget, "Hurricane Grid", result.features, err);
 
-        WFStation.setStationFilePath(stationPath);
-
-        try
+        if(vectorLayer == nullptr)
         {
-            WFStation.importWindFieldStation();
-        }
-        catch(QString msg)
-        {
-            auto errorMessage = "Error importing wind field file: " + stationName+"\n"+msg;
-
-            this->errorMessage(errorMessage);
-
+            this->errorMessage(err);
             this->hideProgressBar();
-
-            return;
+            return false;
         }
 
-        auto stationData = WFStation.getStationData();
-
-        // create the feature attributes
-        QgsAttributes featAttributes(attribFields.size());
-
-        featAttributes[0] = "HurricaneGridPoint"; // AssetType
-        featAttributes[1] = "Hurricane Grid Point"; // TabName
-        featAttributes[2] = stationName; // Station Name
-        featAttributes[3] = latitude; // Latitude
-        featAttributes[4] = longitude; // Longitude
-
-        // The number of headings in the file
-        auto numParams =stationData.front().size();
-
-        QVector<QString> dataStrs(numParams);
-
-        for(int i = 0; i<stationData.size(); ++i)
-        {
-            auto stationParams = stationData[i];
+        progressLabel->setVisible(false);
 
-            for(int j = 0; j<numParams; ++j)
-            {
-                dataStrs[j] += stationParams[j] + " ";
-            }
-        }
-
-        for(int i = 0; i<numParams; ++i)
-        {
-            featAttributes[5+i] = dataStrs[i];
-        }
+        // Reset the widget back to the input pane and close
+        this->hideProgressBar();
 
-        // Create the point and add it to the feature table
-        QgsFeature feature;
-        feature.setGeometry(QgsGeometry::fromPointXY(QgsPointXY(longitude,latitude)));
-        feature.setAttributes(featAttributes);
-        featureList.append(feature);
+        if(theStackedWidget->isModal())
+            theStackedWidget->close();
 
-        WFStation.setStationFeature(feature);
+        this->statusMessage("Wind field data loading complete.");
 
-        ++count;
-        progressLabel->clear();
-        progressBar->setValue(count);
+        emit loadingComplete(true);
 
-        QApplication::processEvents();
-    }
+        emit outputDirectoryPathChanged(eventDir, eventFile);
 
+        return true;
+    };
 
-    auto vectorLayer = QGsVisWidget->addVectorLayer("Point", "Hurricane Grid");
+    auto updateProgress = [this](const TaskProgress& progress){
+        progressBar->setValue(progress.done);
+    };
 
-    if(vectorLayer == nullptr)
+    if(wait)
     {
-        this->errorMessage("Error creating a layer");
-        this->hideProgressBar();
-        return;
-    }
-
-
-    auto dProvider = vectorLayer->dataProvider();
-    auto res = dProvider->addAttributes(attribFields);
+        auto result = TaskRunner::getInstance()->runAndWait<WindFieldLoadResult>(importStations, updateProgress);
 
-    if(!res)
-    {
-        this->errorMessage("Error adding attribute fields to layer");
-        QGsVisWidget->removeLayer(vectorLayer);
-        this->hideProgressBar();
-        return;
+        return createLayer(result);
     }
 
-    vectorLayer->updateFields(); // tell the vector layer to fetch changes from the provider
-
-    dProvider->addFeatures(featureList);
-    vectorLayer->updateExtents();
-
-    QGsVisWidget->createSymbolRenderer(Qgis::MarkerShape::Cross,Qt::black,2.0,vectorLayer);
-
-    progressLabel->setVisible(false);
-
-    // Reset the widget back to the input pane and close
-    this->hideProgressBar();
-
-    if(theStackedWidget->isModal())
-        theStackedWidget->close();
+    loadingTask = TaskRunner::getInstance()->run<WindFieldLoadResult>(this, importStations, createLayer, updateProgress);
 
-    emit loadingComplete(true);
-
-    emit outputDirectoryPathChanged(eventDir, eventFile);
-
-    return;
+    return true;
 }
 
 
@@ -46,6 +46,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 class VisualizationWidget;
 class SimCenterUnitsWidget;
+class TaskContext;
 
 class QStackedWidget;
 class QLineEdit;
@@ -90,6 +91,10 @@ private:
     void showProgressBar(void);
     void hideProgressBar(void);
 
+    // Imports the wind field stations in the background and creates the layer when they are done
+    // If wait is true the call returns once the layer is created, this is used when the input file is deserialized
+    bool loadWindFieldData(const bool wait);
+
     QStackedWidget* theStackedWidget;
 
     VisualizationWidget* theVisualizationWidget;
@@ -107,6 +112,8 @@ private:
 
     SimCenterUnitsWidget* unitsWidget;
 
+    // The wind field stations are imported in the background, this is the task that is currently running
+    std::shared_ptr<TaskContext> loadingTask;
 };
 
 #endif // UserInputHurricaneWidget_H